@@ -9,6 +9,12 @@ LOCAL_CPP_FEATURES += rtti
 
 LOCAL_MODULE    := nit
 
+# Files with NEON kernels: built with NEON on armeabi-v7a, used only when CpuFeatures::hasNeon()
+NIT_NEON :=
+ifeq ($(TARGET_ARCH_ABI),armeabi-v7a)
+NIT_NEON := .neon
+endif
+
 LOCAL_SRC_FILES += \
 	nit/nit.cpp \
 
@@ -53,7 +59,7 @@ LOCAL_SRC_FILES += \
 	nit/content/ContentManager.cpp \
 	nit/content/ContentsService.cpp \
 	nit/content/Image.cpp \
-	nit/content/PixelFormat.cpp \
+	nit/content/PixelFormat.cpp$(NIT_NEON) \
 	nit/content/Texture.cpp \
 	
 ### data
@@ -120,6 +126,7 @@ LOCAL_SRC_FILES += \
 LOCAL_SRC_FILES += \
 	nit/math/AxisAlignedBox.cpp \
 	nit/math/Curves.cpp \
+	nit/math/MathBatch.cpp$(NIT_NEON) \
 	nit/math/Matrix3.cpp \
 	nit/math/Matrix4.cpp \
 	nit/math/NitMath.cpp \
@@ -140,6 +147,7 @@ LOCAL_SRC_FILES += \
 LOCAL_SRC_FILES += \
 	nit/platform/android/android_native_app_glue.c \
 	nit/platform/android/AndroidSupport.cpp \
+	nit/platform/CpuFeatures.cpp \
 	nit/platform/SystemTimer_android.cpp \
 
 ### ref
@@ -75,6 +75,7 @@ LOCAL_SRC_FILES += \
 	../ext/cocos2dx/CCSpriteBatchNode.cpp \
 	../ext/cocos2dx/CCSpriteFrame.cpp \
 	../ext/cocos2dx/CCSpriteFrameCache.cpp \
+	../ext/cocos2dx/CCSpriteQueue.cpp \
 	../ext/cocos2dx/CCTextFieldTTF.cpp \
 	../ext/cocos2dx/CCTexture2D.cpp \
 	../ext/cocos2dx/CCTextureAtlas.cpp \
@@ -13,11 +13,19 @@ LOCAL_MODULE    := nitnet
 
 LOCAL_SRC_FILES := \
 	nitnet/nitnet.cpp \
+	nitnet/HttpCache.cpp \
+	nitnet/HttpDownload.cpp \
 	nitnet/HttpRequest.cpp \
 	nitnet/NetService.cpp \
 	nitnet/NitLibNet.cpp \
 	nitnet/URLRequest.cpp \
 
+### test fixtures: left out of shipping builds (see NIT_TESTS in nit/config/BuildConfig.h)
+
+ifeq ($(filter -DNIT_SHIPPING -DNIT_NO_TESTS,$(APP_CFLAGS) $(LOCAL_CFLAGS)),)
+LOCAL_SRC_FILES += nitnet/HttpTestServer.cpp
+endif
+
 ### compile options
 
 LOCAL_ARM_MODE := arm
@@ -17,6 +17,8 @@ LOCAL_SRC_FILES := \
 	nitrender/GLESRenderView_android.cpp \
 	nitrender/GLESTexture.cpp \
 	nitrender/nitrender.cpp \
+	nitrender/NullRenderDevice.cpp \
+	nitrender/RenderCommand.cpp \
 	nitrender/RenderContext.cpp \
 	nitrender/RenderDevice.cpp \
 	nitrender/RenderHandle.cpp \
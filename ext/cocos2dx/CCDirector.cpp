@@ -45,6 +45,7 @@ THE SOFTWARE.
 #include "CCKeypadDispatcher.h"
 #include "CCAnimationCache.h"
 #include "CCTouch.h"
+#include "CCSpriteQueue.h"
 
 #include <string>
 
@@ -115,6 +116,7 @@ bool CCDirector::init(void)
 
 	m_Timer = new TickTimer();
 	m_Scheduler = new TimeScheduler();
+	m_pSpriteQueue = new CCSpriteQueue();
 
 	m_DebugBound		= false;
 	m_DebugSprite		= false;
@@ -142,6 +144,8 @@ CCDirector::~CCDirector(void)
 
 	// delete fps string
 	delete []m_pszFPS;
+
+	CC_SAFE_DELETE(m_pSpriteQueue);
 }
 
 void CCDirector::applyGLDefaults(RenderContext* ctx)
@@ -158,17 +162,17 @@ void CCDirector::applyGLDefaults(RenderContext* ctx)
 
 void CCDirector::enableDefaultGLStates(RenderContext* ctx)
 {
+	// Through the context so that it restores these states after its own batches
 	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-	glEnable(GL_TEXTURE_2D);
+	ctx->setState(ctx->getState() | RenderState::DEFAULT_2D);
 }
 
 void CCDirector::disableDefaultGLStates(RenderContext* ctx)
 {
-	glDisable(GL_TEXTURE_2D);
-	glDisableClientState(GL_COLOR_ARRAY);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	// Queued sprites and recorded primitives need the default states
+	ctx->flush();
+
+	ctx->setState(ctx->getState() & ~RenderState::DEFAULT_2D);
 	glDisableClientState(GL_VERTEX_ARRAY);
 }
 
@@ -139,6 +139,7 @@ class CCScene;
 class CCEGLView;
 class CCNode;
 class CCProjectionProtocol;
+class CCSpriteQueue;
 
 /**
 @brief Class that creates and handle the main Window and manages how
@@ -330,9 +331,13 @@ public:
 	TickTimer* getTimer() { return m_Timer; }
 	TimeScheduler* getScheduler() { return m_Scheduler; }
 
+	/** queue which batches CCSprites outside of CCSpriteBatchNode automatically */
+	CCSpriteQueue* getSpriteQueue() { return m_pSpriteQueue; }
+
 protected:
 	Ref<TickTimer> m_Timer;
 	Ref<TimeScheduler>	m_Scheduler;
+	CCSpriteQueue* m_pSpriteQueue;
 
 public:
 	/** returns a shared instance of the director */
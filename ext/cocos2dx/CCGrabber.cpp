@@ -77,6 +77,8 @@ bool CCGrabber::activateFBO(RenderContext* ctx, CCTexture2D *pTexture)
 
 void CCGrabber::beforeRender(RenderContext* ctx, CCTexture2D *pTexture)
 {
+	ctx->flush();
+
 	if (!activateFBO(ctx, pTexture)) 
 		return;
 
@@ -98,6 +100,8 @@ void CCGrabber::beforeRender(RenderContext* ctx, CCTexture2D *pTexture)
 
 void CCGrabber::afterRender(RenderContext* ctx)
 {
+	ctx->flush();
+
 	glBindFramebufferOES(GL_FRAMEBUFFER_OES, m_oldFBO);
 	glColorMask(true, true, true, true);	// #631
 }
@@ -161,10 +161,11 @@ void CCGridBase::set2DProjection(RenderContext* ctx)
 {
 	CCSize winSize = CCDirector::sharedDirector()->getWinSizeInPixels();
 
-	glLoadIdentity();
-
     // set view port for user FBO, fixed bug #543 #544
-	glViewport((GLsizei)0, (GLsizei)0, (GLsizei)winSize.width, (GLsizei)winSize.height);
+	// (through the context, which submits what was queued for the previous viewport first)
+	ctx->viewport(0, 0, (int)winSize.width, (int)winSize.height);
+
+	glLoadIdentity();
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
 	glOrthof(0, winSize.width, 0, winSize.height, -1024, 1024);
@@ -177,7 +178,8 @@ void CCGridBase::set3DProjection(RenderContext* ctx)
 	CCSize	winSize = CCDirector::sharedDirector()->getDisplaySizeInPixels();
 
     // set view port for user FBO, fixed bug #543 #544
-	glViewport(0, 0, (GLsizei)winSize.width, (GLsizei)winSize.height);
+	// (through the context, which submits what was queued for the previous viewport first)
+	ctx->viewport(0, 0, (int)winSize.width, (int)winSize.height);
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
 	ctx->perspective(60, (GLfloat)winSize.width/winSize.height, 0.5f, 1500.0f);
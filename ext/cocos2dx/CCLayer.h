@@ -107,6 +107,8 @@ public:
 	bool init();
 	static CCLayer *node(void);
 
+	virtual bool needsQueueFlush() { return false; }		// draws nothing by itself
+
 	virtual void onEnter();
 	virtual void onExit();
     virtual void onEnterTransitionDidFinish();
@@ -218,6 +220,7 @@ public:
 	virtual ~CCLayerColor();
 
 	virtual void draw(RenderContext* ctx);
+	virtual bool needsQueueFlush() { return true; }
 	virtual void setContentSize(const CCSize& var);
 
 	/** creates a CCLayer with color, width and height in Points */
@@ -67,6 +67,7 @@ public:
         , m_bIsEnabled(false)            
 	{}
 	virtual ~CCMenuItem(){}
+	virtual bool needsQueueFlush() { return false; }		// draws nothing by itself
 	/** Creates a CCMenuItem with a target/selector */
 	static CCMenuItem * itemWithTarget(EventHandler* handler);
 	/** Initializes a CCMenuItem with a target/selector */
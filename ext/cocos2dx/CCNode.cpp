@@ -876,6 +876,9 @@ void CCNode::visit(RenderContext* ctx)
 
 	if (m_IsClipActive && !debugClip)
 	{
+		// Queued sprites are out of this scissor
+		ctx->flushRenderQueue();
+
 		// TODO: refactor to render context
 		glEnable(GL_SCISSOR_TEST);
 
@@ -935,7 +938,12 @@ void CCNode::visit(RenderContext* ctx)
 	}
 
 	if (!clipped)
+	{
+		if (needsQueueFlush())
+			ctx->flushRenderQueue();
+
 		this->draw(ctx);
+	}
 
 	// TODO: Handle cases with drawing outside the bound clipping
 	// (think about particles)
@@ -955,7 +963,10 @@ void CCNode::visit(RenderContext* ctx)
 	}
 
 	if (m_IsClipActive && !debugClip)
+	{
+		ctx->flushRenderQueue();
 		glDisable(GL_SCISSOR_TEST);
+	}
 
 	if (m_IsClipActive)
 		g_BoundClipping = false;
@@ -368,6 +368,11 @@ public:
 	*/
 	virtual void draw(RenderContext* ctx);
 
+	/** Sprites queued into CCSpriteQueue so far are drawn before this node, as draw() may issue OpenGL calls by itself.
+	Override this to return false only for nodes which queue their drawing or draw nothing by themselves (ex: containers).
+	*/
+	virtual bool needsQueueFlush() { return true; }
+
 	/** recursive method that visit its children and draw them */
 	virtual void visit(RenderContext* ctx);
 
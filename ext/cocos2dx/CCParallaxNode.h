@@ -57,6 +57,7 @@ public:
 	virtual void removeChild(CCNode* child, bool cleanup);
 	virtual void removeAllChildrenWithCleanup(bool cleanup);
 	virtual void visit(RenderContext* ctx);
+	virtual bool needsQueueFlush() { return false; }		// draws nothing by itself
 private:
 	CCPoint absolutePosition();
 protected:
@@ -150,6 +150,9 @@ bool CCRenderTexture::activateFBO(RenderContext* ctx)
 
 void CCRenderTexture::begin(RenderContext* ctx)
 {
+	// Sprites queued so far belong to the previous frame buffer
+	ctx->flush();
+
 	if (!activateFBO(ctx))
 		return;
 
@@ -198,6 +201,9 @@ void CCRenderTexture::end(RenderContext* ctx)
 {
 	// NOTE: avoid sharedDirector()->disableDefaultGLStates(), because it would disrupt further rendering process.
 
+	// Submit primitives recorded while drawing into this texture
+	ctx->flush();
+
 	glBindFramebufferOES(GL_FRAMEBUFFER_OES, m_nOldFBO);
 	// Restore the original matrix and viewport
 	glPopMatrix();
@@ -218,6 +224,9 @@ Image* CCRenderTexture::newImageCopy(RenderContext* ctx, int x, int y, int nWidt
 	if (!m_FrameBuffer->isValid(ctx))
 		return NULL;
 
+	// Pending sprites may still draw into this texture
+	ctx->flush();
+
 	const CCSize& s = m_pTexture->getContentSizeInPixels();
 	int tx = (int)s.width;
 	int ty = (int)s.height;
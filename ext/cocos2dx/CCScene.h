@@ -56,6 +56,7 @@ public:
 	static CCScene *node(void);
 	inline ccSceneFlag getSceneType(void) { return m_eSceneType; }
 	virtual CCScene* getScene()			{ return this; }
+	virtual bool needsQueueFlush()		{ return false; }		// draws nothing by itself
 
 protected:
 	ccSceneFlag m_eSceneType;
@@ -38,6 +38,7 @@ THE SOFTWARE.
 #include "CCGeometry.h"
 #include "CCTexture2D.h"
 #include "CCAffineTransform.h"
+#include "CCSpriteQueue.h"
 
 #include <string.h>
 
@@ -680,48 +681,60 @@ void CCSprite::draw(RenderContext* ctx)
 
 	assert(! m_bUsesBatchNode);
 
-	// Default GL states: GL_TEXTURE_2D, GL_VERTEX_ARRAY, GL_COLOR_ARRAY, GL_TEXTURE_COORD_ARRAY
-	// Needed states: GL_TEXTURE_2D, GL_VERTEX_ARRAY, GL_COLOR_ARRAY, GL_TEXTURE_COORD_ARRAY
-	// Unneeded states: -
-	bool newBlend = m_sBlendFunc.src != CC_BLEND_SRC || m_sBlendFunc.dst != CC_BLEND_DST;
-	if (newBlend)
+	CCSpriteQueue* queue = CCDirector::sharedDirector()->getSpriteQueue();
+
+	if (queue && queue->isEnabled())
 	{
-		glBlendFunc(m_sBlendFunc.src, m_sBlendFunc.dst);
+		// Merged with neighbor sprites sharing texture and blend func
+		queue->push(ctx, m_pobTexture, m_sBlendFunc, m_sQuad);
 	}
+	else
+	{
+		ctx->flushRenderQueue();
+
+		// Default GL states: GL_TEXTURE_2D, GL_VERTEX_ARRAY, GL_COLOR_ARRAY, GL_TEXTURE_COORD_ARRAY
+		// Needed states: GL_TEXTURE_2D, GL_VERTEX_ARRAY, GL_COLOR_ARRAY, GL_TEXTURE_COORD_ARRAY
+		// Unneeded states: -
+		bool newBlend = m_sBlendFunc.src != CC_BLEND_SRC || m_sBlendFunc.dst != CC_BLEND_DST;
+		if (newBlend)
+		{
+			glBlendFunc(m_sBlendFunc.src, m_sBlendFunc.dst);
+		}
 
 #define kQuadSize sizeof(m_sQuad.bl)
-    if (m_pobTexture)
-    {
-        glBindTexture(GL_TEXTURE_2D, m_pobTexture->activate(ctx));
-    }
-    else
-    {
-        glBindTexture(GL_TEXTURE_2D, 0);
-    }
+		if (m_pobTexture)
+		{
+			glBindTexture(GL_TEXTURE_2D, m_pobTexture->activate(ctx));
+		}
+		else
+		{
+			glBindTexture(GL_TEXTURE_2D, 0);
+		}
 
-	// TODO: Reported that GL_TEXTURE_2D to be off occasionally on some android devices (e.g. galaxy note)
-	// TODO: link RenderSpec
-	glEnable(GL_TEXTURE_2D);
+		// TODO: Reported that GL_TEXTURE_2D to be off occasionally on some android devices (e.g. galaxy note)
+		// TODO: link RenderSpec
+		glEnable(GL_TEXTURE_2D);
 
-	long offset = (long)&m_sQuad;
+		long offset = (long)&m_sQuad;
 
-	// vertex
-	int diff = offsetof(ccV3F_C4B_T2F, vertices);
-	glVertexPointer(3, GL_FLOAT, kQuadSize, (void*)(offset + diff));
+		// vertex
+		int diff = offsetof(ccV3F_C4B_T2F, vertices);
+		glVertexPointer(3, GL_FLOAT, kQuadSize, (void*)(offset + diff));
 
-	// color
-	diff = offsetof( ccV3F_C4B_T2F, colors);
-	glColorPointer(4, GL_UNSIGNED_BYTE, kQuadSize, (void*)(offset + diff));
+		// color
+		diff = offsetof( ccV3F_C4B_T2F, colors);
+		glColorPointer(4, GL_UNSIGNED_BYTE, kQuadSize, (void*)(offset + diff));
 	
-	// tex coords
-	diff = offsetof( ccV3F_C4B_T2F, texCoords);
-	glTexCoordPointer(2, GL_FLOAT, kQuadSize, (void*)(offset + diff));
+		// tex coords
+		diff = offsetof( ccV3F_C4B_T2F, texCoords);
+		glTexCoordPointer(2, GL_FLOAT, kQuadSize, (void*)(offset + diff));
 	
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 	
-	if( newBlend )
-	{
-		glBlendFunc(CC_BLEND_SRC, CC_BLEND_DST);
+		if( newBlend )
+		{
+			glBlendFunc(CC_BLEND_SRC, CC_BLEND_DST);
+		}
 	}
 
 #ifndef NIT_SHIPPING
@@ -99,6 +99,7 @@ class CC_DLL CCSprite : public CCNode, public CCTextureProtocol, public CCRGBAPr
 	CC_PROPERTY_PASS_BY_REF(ccColor3B, m_sColor, Color);
 public:
 	virtual void draw(RenderContext* ctx);
+	virtual bool needsQueueFlush() { return false; }		// queued, or flushes by itself when the queue is disabled
 
 public:
 	// attributes
@@ -131,6 +131,9 @@ void CCSpriteBatchNode::visit(RenderContext* ctx)
 		return;
 	}
 
+	// Draws its own atlas: submit sprites queued so far first
+	ctx->flushRenderQueue();
+
 	glPushMatrix();
 
 	if (m_pGrid && m_pGrid->isActive())
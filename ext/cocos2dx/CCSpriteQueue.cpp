@@ -0,0 +1,219 @@
+﻿/// nit - Noriter Framework
+/// A Cross-platform Open Source Integration for Game-oriented Apps
+///
+/// http://www.github.com/ellongrey/nit
+///
+/// Copyright (c) 2013 by Jun-hyeok Jang
+/// 
+/// (see each file to see the different copyright owners)
+/// 
+/// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// Author: ellongrey
+
+#include "nit2d_pch.h"
+
+#include "CCSpriteQueue.h"
+
+#include "CCTexture2D.h"
+
+#include "nitrender/RenderDevice.h"
+#include "nitrender/NullRenderDevice.h"
+
+NS_CC_BEGIN;
+
+////////////////////////////////////////////////////////////////////////////////
+
+CCSpriteQueue::CCSpriteQueue()
+{
+	_enabled = true;
+	resetStats();
+}
+
+CCSpriteQueue::~CCSpriteQueue()
+{
+	clear();
+}
+
+void CCSpriteQueue::resetStats()
+{
+	memset(&_stats, 0, sizeof(_stats));
+}
+
+static inline void ToClip(const float* m, const ccV3F_C4B_T2F& src, GLfloat* out)
+{
+	const ccVertex3F& p = src.vertices;
+
+	out[0] = m[0] * p.x + m[4] * p.y + m[8]  * p.z + m[12];
+	out[1] = m[1] * p.x + m[5] * p.y + m[9]  * p.z + m[13];
+	out[2] = m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14];
+	out[3] = m[3] * p.x + m[7] * p.y + m[11] * p.z + m[15];
+}
+
+void CCSpriteQueue::push(RenderContext* ctx, CCTexture2D* texture, const ccBlendFunc& blendFunc, const ccV3F_C4B_T2F_Quad& quad)
+{
+	if (ctx->getRenderQueue() != this)
+	{
+		// Pending quads were pushed under another context
+		flush(ctx);
+		ctx->setRenderQueue(this);
+	}
+
+	unsigned int index = _vertices.size() / 4;
+
+	Batch* batch = _batches.empty() ? NULL : &_batches.back();
+
+	bool merge = batch 
+		&& batch->texture == texture 
+		&& batch->blendFunc.src == blendFunc.src 
+		&& batch->blendFunc.dst == blendFunc.dst
+		&& batch->count < MAX_BATCH_QUADS;
+
+	if (merge)
+	{
+		++batch->count;
+	}
+	else
+	{
+		// A sprite may release its texture before the queue gets flushed
+		CC_SAFE_RETAIN(texture);
+
+		Batch b;
+		b.texture	= texture;
+		b.blendFunc	= blendFunc;
+		b.first		= index;
+		b.count		= 1;
+		_batches.push_back(b);
+	}
+
+	float clip[16];
+	ctx->getDevice()->captureTransform(clip);
+
+	// Keep the order of the triangle strip which CCSprite used: tl, bl, tr, br
+	const ccV3F_C4B_T2F* src[4] = { &quad.tl, &quad.bl, &quad.tr, &quad.br };
+
+	_vertices.resize(_vertices.size() + 4);
+	Vertex* dst = &_vertices[index * 4];
+
+	for (int i = 0; i < 4; ++i)
+	{
+		ToClip(clip, *src[i], &dst[i].x);
+		dst[i].color		= src[i]->colors;
+		dst[i].texCoords	= src[i]->texCoords;
+	}
+
+	++_stats.quads;
+}
+
+void CCSpriteQueue::prepareIndices(unsigned int numQuads)
+{
+	unsigned int prepared = _indices.size() / 6;
+	if (prepared >= numQuads) return;
+
+	_indices.resize(numQuads * 6);
+
+	for (unsigned int i = prepared; i < numQuads; ++i)
+	{
+		GLushort* idx = &_indices[i * 6];
+		GLushort v = GLushort(i * 4);
+
+		// tl, bl, tr / tr, bl, br : same winding as the strip
+		idx[0] = v + 0; idx[1] = v + 1; idx[2] = v + 2;
+		idx[3] = v + 2; idx[4] = v + 1; idx[5] = v + 3;
+	}
+}
+
+void CCSpriteQueue::flush(RenderContext* ctx)
+{
+	if (_batches.empty()) return;
+
+	++_stats.flushes;
+	_stats.batches += _batches.size();
+
+	if (dynamic_cast<NullRenderDevice*>(ctx->getDevice()))
+	{
+		// Null device: count only
+		clear();
+		return;
+	}
+
+	unsigned int maxCount = 0;
+	for (unsigned int i = 0; i < _batches.size(); ++i)
+		maxCount = std::max(maxCount, _batches[i].count);
+
+	prepareIndices(maxCount);
+
+	// Vertices are already in clip space.
+	// Matrices are saved and loaded back rather than pushed: GL_PROJECTION stack may hold only 2 entries,
+	// one of which CCRenderTexture::begin() already takes.
+	GLfloat projection[16], modelView[16];
+	glGetFloatv(GL_PROJECTION_MATRIX, projection);
+	glGetFloatv(GL_MODELVIEW_MATRIX, modelView);
+
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+
+	// Default GL states: GL_TEXTURE_2D, GL_VERTEX_ARRAY, GL_COLOR_ARRAY, GL_TEXTURE_COORD_ARRAY
+	// TODO: Reported that GL_TEXTURE_2D to be off occasionally on some android devices (e.g. galaxy note)
+	glEnable(GL_TEXTURE_2D);
+
+	ccBlendFunc blend = { CC_BLEND_SRC, CC_BLEND_DST };
+
+	for (unsigned int i = 0; i < _batches.size(); ++i)
+	{
+		const Batch& b = _batches[i];
+
+		if (b.blendFunc.src != blend.src || b.blendFunc.dst != blend.dst)
+		{
+			blend = b.blendFunc;
+			glBlendFunc(blend.src, blend.dst);
+		}
+
+		glBindTexture(GL_TEXTURE_2D, b.texture ? b.texture->activate(ctx) : 0);
+
+		// Rebase pointers to the batch so that 16-bit indices can address it
+		const Vertex* base = &_vertices[b.first * 4];
+
+		glVertexPointer(4, GL_FLOAT, sizeof(Vertex), &base->x);
+		glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), &base->color);
+		glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &base->texCoords);
+
+		glDrawElements(GL_TRIANGLES, b.count * 6, GL_UNSIGNED_SHORT, &_indices[0]);
+	}
+
+	if (blend.src != CC_BLEND_SRC || blend.dst != CC_BLEND_DST)
+		glBlendFunc(CC_BLEND_SRC, CC_BLEND_DST);
+
+	glMatrixMode(GL_PROJECTION);
+	glLoadMatrixf(projection);
+
+	glMatrixMode(GL_MODELVIEW);
+	glLoadMatrixf(modelView);
+
+	clear();
+}
+
+void CCSpriteQueue::clear()
+{
+	for (unsigned int i = 0; i < _batches.size(); ++i)
+		CC_SAFE_RELEASE(_batches[i].texture);
+
+	_vertices.clear();
+	_batches.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+NS_CC_END;
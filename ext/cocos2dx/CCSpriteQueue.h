@@ -0,0 +1,110 @@
+﻿/// nit - Noriter Framework
+/// A Cross-platform Open Source Integration for Game-oriented Apps
+///
+/// http://www.github.com/ellongrey/nit
+///
+/// Copyright (c) 2013 by Jun-hyeok Jang
+/// 
+/// (see each file to see the different copyright owners)
+/// 
+/// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// Author: ellongrey
+
+#pragma once
+
+#include "ccTypes.h"
+
+#include "nitrender/RenderContext.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+NS_CC_BEGIN;
+
+class CCTexture2D;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// CCSpriteQueue collects quads of CCSprites which are not in a CCSpriteBatchNode during visit(),
+// and draws consecutive runs sharing a texture and a blend func with a single draw call.
+// Quads are queued in traversal order, so z-order is preserved as it is.
+//
+// Quads are transformed into clip space when pushed, so the current matrices may change freely after that.
+// Every node flushes the queue before its draw() unless it opts out (see CCNode::needsQueueFlush()).
+// RenderContext flushes the queue by itself on state change, viewport change and RenderContext::flush().
+//
+// On a NullRenderDevice nothing is submitted but batches are counted the same way,
+// so a scene can be checked for its draw call count without a gl context.
+
+class CC_DLL CCSpriteQueue : public RenderQueue
+{
+public:
+	struct Stats
+	{
+		unsigned int					quads;			// quads pushed
+		unsigned int					batches;		// draw calls emitted (or counted on a null device)
+		unsigned int					flushes;		// non-empty flushes
+	};
+
+public:
+	CCSpriteQueue();
+	virtual ~CCSpriteQueue();
+
+public:
+	bool								isEnabled()								{ return _enabled; }
+	void								setEnabled(bool flag)					{ _enabled = flag; }
+
+	void								push(RenderContext* ctx, CCTexture2D* texture, const ccBlendFunc& blendFunc, const ccV3F_C4B_T2F_Quad& quad);
+
+	unsigned int						getPendingCount()						{ return _vertices.size() / 4; }
+	unsigned int						getPendingBatchCount()					{ return _batches.size(); }
+
+public:									// RenderQueue impl
+	virtual void						flush(RenderContext* ctx);
+
+public:
+	const Stats&						getStats()								{ return _stats; }
+	void								resetStats();
+
+private:
+	// 16-bit indices addresses up to 65536 vertices per draw call
+	enum { MAX_BATCH_QUADS = 65536 / 4 };
+
+	struct Vertex
+	{
+		GLfloat							x, y, z, w;
+		ccColor4B						color;
+		ccTex2F							texCoords;
+	};
+
+	struct Batch
+	{
+		CCTexture2D*					texture;		// retained until flushed
+		ccBlendFunc						blendFunc;
+		unsigned int					first;			// in quads
+		unsigned int					count;			// in quads
+	};
+
+	bool								_enabled;
+	Stats								_stats;
+
+	vector<Vertex>::type				_vertices;
+	vector<Batch>::type					_batches;
+	vector<GLushort>::type				_indices;
+
+	void								prepareIndices(unsigned int numQuads);
+	void								clear();
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+NS_CC_END;
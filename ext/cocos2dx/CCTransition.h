@@ -82,6 +82,7 @@ public:
 	CCTransitionScene();
 	virtual ~CCTransitionScene();
 	virtual void draw(RenderContext* ctx);
+	virtual bool needsQueueFlush() { return true; }
 	virtual void onEnter();
 	virtual void onExit();
 	virtual void cleanup();
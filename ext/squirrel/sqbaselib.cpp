@@ -965,10 +965,7 @@ STRING_TOFUNCZ(toupper)
 static SQInteger string_utf8_len(HSQUIRRELVM v)
 {
 	SQObject self = stack_get(v, 1);
-	SQInteger utf8len = sqi_string(self)->_utf8_len;
-	if (utf8len < 0)
-		utf8len = sqi_string(self)->_utf8_len = (SQInteger)nit::Unicode::utf8Length(sqi_stringval(self));
-	v->Push(utf8len);
+	v->Push(sqi_string(self)->Utf8Len());
 	return 1;
 }
 
@@ -990,8 +987,9 @@ static SQInteger string_utf8_chars(HSQUIRRELVM v)
 	using namespace nit;
 
 	SQObject self = stack_get(v, 1);
-	const SQChar* str = sqi_stringval(self);
-	SQInteger len = sqi_string(self)->_len;
+	SQString* sstr = sqi_string(self);
+	const SQChar* str = sstr->_val;
+	SQInteger len = sstr->_len;
 
 	SQInteger top = sq_gettop(v);
 
@@ -999,20 +997,18 @@ static SQInteger string_utf8_chars(HSQUIRRELVM v)
 	if (top >= 2) 
 	{
 		sq_getinteger(v, 2, &begin);
-		if (begin > 0)
-			begin = Unicode::utf8Next(str, str + len, begin) - str;
-		else if (begin < 0)
-			begin = Unicode::utf8Prev(str + len, str, -begin) - str;
+		if (begin < 0)
+			begin += sstr->Utf8Len();
+		begin = sstr->Utf8Offset(begin);
 	}
 
 	SQInteger end;
 	if (top >= 3)
 	{
 		sq_getinteger(v, 3, &end);
-		if (end > 0)
-			end = Unicode::utf8Next(str, str + len, end) - str;
-		else if (end < 0)
-			end = Unicode::utf8Prev(str + len, str, -end) - str;
+		if (end < 0)
+			end += sstr->Utf8Len();
+		end = sstr->Utf8Offset(end);
 	}
 	else end = len;
 
@@ -1033,11 +1029,10 @@ static SQInteger string_utf8_chars(HSQUIRRELVM v)
 
 static SQInteger string_utf8_slice(HSQUIRRELVM v)
 {
-	using namespace nit;
-
 	SQObject self = stack_get(v, 1);
-	const SQChar* str = sqi_stringval(self);
-	SQInteger len = sqi_string(self)->_len;
+	SQString* sstr = sqi_string(self);
+	const SQChar* str = sstr->_val;
+	SQInteger len = sstr->_len;
 
 	SQInteger top = sq_gettop(v);
 
@@ -1045,20 +1040,18 @@ static SQInteger string_utf8_slice(HSQUIRRELVM v)
 	if (top >= 2) 
 	{
 		sq_getinteger(v, 2, &begin);
-		if (begin > 0)
-			begin = Unicode::utf8Next(str, str + len, begin) - str;
-		else if (begin < 0)
-			begin = Unicode::utf8Prev(str + len, str, -begin) - str;
+		if (begin < 0)
+			begin += sstr->Utf8Len();
+		begin = sstr->Utf8Offset(begin);
 	}
 
 	SQInteger end;
 	if (top >= 3)
 	{
 		sq_getinteger(v, 3, &end);
-		if (end > 0)
-			end = Unicode::utf8Next(str, str + len, end) - str;
-		else if (end < 0)
-			end = Unicode::utf8Prev(str + len, str, -end) - str;
+		if (end < 0)
+			end += sstr->Utf8Len();
+		end = sstr->Utf8Offset(end);
 	}
 	else end = len;
 
@@ -1079,11 +1072,11 @@ static SQInteger string_utf8_find(HSQUIRRELVM v)
 		SQInteger ascii_len = sq_getsize(v, 1);
 		if (top>2)
 		{
+			SQString* sstr = sqi_string(stack_get(v, 1));
 			sq_getinteger(v,3,&start_idx);
-			if (start_idx > 0)
-				start_idx = Unicode::utf8Next(str, str + ascii_len, start_idx) - str;
-			else if (start_idx < 0)
-				start_idx = Unicode::utf8Prev(str + ascii_len, str, -start_idx) - str;
+			if (start_idx < 0)
+				start_idx += sstr->Utf8Len();
+			start_idx = sstr->Utf8Offset(start_idx);
 		}
 
 		if ((ascii_len > start_idx) && (start_idx>=0))
@@ -88,13 +88,12 @@ public:
 	}
 	void Error(const SQChar *s, ...)
 	{
-		static SQChar temp[256];
 		va_list vl;
 		va_start(vl, s);
-		SQInteger len = scvsnprintf(temp, sizeof(temp), s, vl);
+		SQInteger len = scvsnprintf(_errorbuf, sizeof(_errorbuf), s, vl);
 		assert(len < 256);
 		va_end(vl);
-		compilererror = temp;
+		compilererror = _errorbuf;
 		longjmp(_errorjmp,1);
 	}
 	void Lex(){	_token = _lex.Lex();}
@@ -2235,6 +2234,7 @@ private:
 	SQExpState   _es;
 	SQScope _scope;
 	SQChar *compilererror;
+	SQChar _errorbuf[256]; // per compiler, so that separate states can compile concurrently
 	jmp_buf _errorjmp;
 	SQVM *_vm;
 };
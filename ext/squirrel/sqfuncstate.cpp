@@ -340,6 +340,8 @@ bool SQFuncState::IsConstant(const SQObject &name,SQObject &e)
 		e = val;
 		return true;
 	}
+	if(sqi_type(_sharedstate->_unresolved) == OT_TABLE)
+		sqi_table(_sharedstate->_unresolved)->NewSlot(SQObjectPtr(name), SQObjectPtr(true));
 	return false;
 }
 
@@ -458,6 +458,7 @@ void SQSharedState::MarkRootSet(SQGC* gc)
 	gc->mark(_root_table);
 	gc->mark(_registry);
 	gc->mark(_consts);
+	gc->mark(_unresolved);
 	gc->mark(_metamethodsmap);
 	gc->mark(_null_default_delegate);
  	gc->mark(_table_default_delegate);
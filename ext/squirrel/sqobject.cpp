@@ -59,6 +59,53 @@ void SQString::Release()
 	REMOVE_STRING(_sharedstate,this);
 }
 
+#define SQ_UTF8_ISLEAD(c) (((c) & 0xC0) != 0x80)
+
+SQInteger SQString::Utf8Len()
+{
+	if(_utf8_len < 0) {
+		SQInteger n = 0;
+		for(SQInteger i = 0; i < _len; i++)
+			if(SQ_UTF8_ISLEAD(_val[i])) n++;
+		_utf8_len = n;
+	}
+	return _utf8_len;
+}
+
+SQInteger SQString::Utf8Offset(SQInteger charidx)
+{
+	SQInteger utf8len = Utf8Len();
+	if(charidx <= 0) return 0;
+	if(charidx >= utf8len) return _len;
+	if(utf8len == _len) return charidx; //plain ascii: direct indexing
+
+	if(!_utf8_index) {
+		SQInteger slots = (utf8len >> SQ_UTF8_INDEX_SHIFT) + 1;
+		_utf8_index = (SQInteger *)SQ_MALLOC(sizeof(SQInteger) * slots);
+		SQInteger n = 0;
+		for(SQInteger i = 0; i < _len; i++) {
+			if(!SQ_UTF8_ISLEAD(_val[i])) continue;
+			if((n & SQ_UTF8_INDEX_MASK) == 0) _utf8_index[n >> SQ_UTF8_INDEX_SHIFT] = i;
+			n++;
+		}
+	}
+
+	SQInteger pos = _utf8_index[charidx >> SQ_UTF8_INDEX_SHIFT];
+	for(SQInteger skip = charidx & SQ_UTF8_INDEX_MASK; skip > 0; skip--) {
+		pos++;
+		while(pos < _len && !SQ_UTF8_ISLEAD(_val[pos])) pos++;
+	}
+	return pos;
+}
+
+void SQString::FreeUtf8Index()
+{
+	if(_utf8_index) {
+		SQ_FREE(_utf8_index, sizeof(SQInteger) * ((_utf8_len >> SQ_UTF8_INDEX_SHIFT) + 1));
+		_utf8_index = NULL;
+	}
+}
+
 SQInteger SQString::Next(const SQObjectPtr &refpos, SQObjectPtr &outkey, SQObjectPtr &outval)
 {
 	SQInteger idx = (SQInteger)TranslateIndex(refpos);
@@ -213,6 +213,7 @@ SQSharedState::~SQSharedState()
 	sqi_table(_metamethodsmap)->Finalize();
 	_registry = _null_;
 	_consts = _null_;
+	_unresolved = _null_;
 	_metamethodsmap = _null_;
 	while(!_systemstrings->empty()) {
 		_systemstrings->back()=_null_;
@@ -519,6 +520,7 @@ SQString *SQStringTable::Add(const SQChar *news,SQInteger len)
 	t->_val[len] = _SC('\0');
 	t->_len = len;
 	t->_utf8_len = -1; // will calculate later
+	t->_utf8_index = NULL;
 	t->_hash = ::_hashstr(news,len);
 	t->_next = _strings[h];
 	_strings[h] = t;
@@ -560,6 +562,7 @@ void SQStringTable::Remove(SQString *bs)
 				_strings[h] = s->_next;
 			_slotused--;
 			SQInteger slen = s->_len;
+			s->FreeUtf8Index();
 			s->~SQString();
 			SQ_FREE(s,sizeof(SQString) + rsl(slen));
 			return;
@@ -82,6 +82,7 @@ public:
 	RefTable _refs_table;
 	SQObjectPtr _registry;
 	SQObjectPtr _consts;
+	SQObjectPtr _unresolved; // when a table, collects identifiers the compiler didn't find in _consts
 	SQObjectPtr _thisidx;
 	SQObjectPtr _classnameidx;
 	SQObjectPtr _namespaceidx;
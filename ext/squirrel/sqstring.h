@@ -11,6 +11,10 @@ inline SQHash _hashstr (const SQChar *s, size_t l)
 		return h;
 }
 
+// Sparse utf8 index: byte offset of every (1 << SQ_UTF8_INDEX_SHIFT)-th code point
+#define SQ_UTF8_INDEX_SHIFT 5
+#define SQ_UTF8_INDEX_MASK ((1 << SQ_UTF8_INDEX_SHIFT) - 1)
+
 struct SQString : public SQRefCounted
 {
 	SQString(){}
@@ -19,10 +23,14 @@ public:
 	static SQString *Create(SQSharedState *ss, const SQChar *, SQInteger len = -1 );
 	SQInteger Next(const SQObjectPtr &refpos, SQObjectPtr &outkey, SQObjectPtr &outval);
 	void Release();
+	SQInteger Utf8Len();
+	SQInteger Utf8Offset(SQInteger charidx);
+	void FreeUtf8Index();
 	SQSharedState *_sharedstate;
 	SQString *_next; //chain for the string table
 	SQInteger _len;
 	SQInteger _utf8_len;
+	SQInteger *_utf8_index; // built on first non-ascii Utf8Offset() call
 	SQHash _hash;
 	SQChar _val[1];
 };
@@ -1531,7 +1531,8 @@ bool SQVM::Get(const SQObjectPtr &self,const SQObjectPtr &key,SQObjectPtr &dest,
 	case OT_STRING:
 		if(sq_isnumeric(key)){
 			SQInteger n=sqi_tointeger(key);
-			dest = nit::Unicode::uniCharAt(sqi_stringval(self), n);
+			SQString *str=sqi_string(self);
+			dest = nit::Unicode::toUniChar(str->_val + str->Utf8Offset(n));
 			return true;
 		}
 		break;
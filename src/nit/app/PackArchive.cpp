@@ -153,6 +153,7 @@ void PackArchive::unload()
 	}
 
 	_files.clear();
+	_deltaBase = NULL;
 }
 
 StreamSource* PackArchive::locateLocal(const String& streamName)
@@ -171,6 +172,52 @@ void PackArchive::findLocal(const String& pattern, StreamSourceMap& varResults)
 	}
 }
 
+uint32 PackArchive::calcBlockHashes(StreamReader* content, vector<uint32>::type& outHashes)
+{
+	Ref<StreamReader> safe = content;
+
+	outHashes.clear();
+
+	vector<uint8>::type block(HASH_BLOCK_SIZE);
+	uint32 size = 0;
+
+	while (true)
+	{
+		size_t blockSize = 0;
+
+		while (blockSize < HASH_BLOCK_SIZE)
+		{
+			size_t bytesRead = content->readRaw(&block[blockSize], HASH_BLOCK_SIZE - blockSize);
+			if (bytesRead == 0) break;
+			blockSize += bytesRead;
+		}
+
+		if (blockSize == 0) break;
+
+		outHashes.push_back(StreamUtil::calcCrc32(&block[0], blockSize));
+		size += blockSize;
+
+		if (blockSize < HASH_BLOCK_SIZE) break;
+	}
+
+	return size;
+}
+
+uint32 PackArchive::calcBlockHashes(const void* content, size_t size, vector<uint32>::type& outHashes)
+{
+	outHashes.clear();
+
+	const uint8* buf = (const uint8*)content;
+
+	for (size_t pos = 0; pos < size; pos += HASH_BLOCK_SIZE)
+	{
+		size_t blockSize = std::min(size - pos, size_t(HASH_BLOCK_SIZE));
+		outHashes.push_back(StreamUtil::calcCrc32(buf + pos, blockSize));
+	}
+
+	return size;
+}
+
 StreamReader* PackArchive::processPayload(FileEntry* entry, FileReader* reader)
 {
 	switch (entry->payloadType)
@@ -180,12 +227,119 @@ StreamReader* PackArchive::processPayload(FileEntry* entry, FileReader* reader)
 
 	case PAYLOAD_ZLIB:					return new ZStreamReader(reader);
 	case PAYLOAD_ZLIB_FAST:				return new MemoryBuffer::Reader(new ZStreamReader(reader), entry->memorySize);
+	case PAYLOAD_ZLIB_CHUNKED:			return new ZChunkedStreamReader(reader);
+	case PAYLOAD_DELTA:					return applyDelta(entry, reader);
 
 	default:
 		NIT_THROW_FMT(EX_NOT_SUPPORTED, "'%s': not supported payload (%d)", reader->getUrl().c_str(), entry->payloadType);
 	}
 }
 
+static size_t ReadDeltaVarint(const uint8*& pos, const uint8* end)
+{
+	size_t value = 0;
+
+	// A value that doesn't fit in size_t can't describe anything in memory
+	for (uint shift = 0; pos < end && shift < sizeof(size_t) * 8; shift += 7)
+	{
+		uint8 b = *pos++;
+		size_t bits = size_t(b & 0x7F);
+
+		if (shift > 0 && (bits >> (sizeof(size_t) * 8 - shift)) != 0)
+			break;
+
+		value |= bits << shift;
+		if ((b & 0x80) == 0)
+			return value;
+	}
+
+	NIT_THROW(EX_CORRUPTED);
+	return 0;
+}
+
+StreamReader* PackArchive::applyDelta(FileEntry* entry, FileReader* reader)
+{
+	Ref<FileReader> safe = reader;
+
+	StreamSource* source = reader->getSource();
+	const String& name = source->getName();
+
+	StreamSource* baseSource = _deltaBase ? _deltaBase->locateLocal(name) : NULL;
+
+	if (baseSource == NULL || baseSource == source)
+		NIT_THROW_FMT(EX_NOT_FOUND, "'%s': delta base not linked", reader->getUrl().c_str());
+
+	Ref<MemoryBuffer> base = new MemoryBuffer(baseSource->open());
+
+	if (base->calcCrc32() != entry->payloadParam0)
+		NIT_THROW_FMT(EX_CORRUPTED, "'%s': delta base mismatch: '%s'", reader->getUrl().c_str(), baseSource->getUrl().c_str());
+
+	Ref<MemoryBuffer> delta = new MemoryBuffer(reader);
+	delta->uncompress();
+
+	vector<uint8>::type ops(delta->getSize());
+	if (!ops.empty())
+		delta->copyTo(&ops[0], 0, ops.size());
+	delta = NULL;
+
+	Ref<MemoryBuffer> result = decodeDelta(base, ops.empty() ? NULL : &ops[0], ops.size(), reader->getUrl());
+
+	if (result->calcCrc32() != entry->payloadParam1)
+		NIT_THROW_FMT(EX_CORRUPTED, "'%s': delta result mismatch", reader->getUrl().c_str());
+
+	return new MemoryBuffer::Reader(result, source);
+}
+
+Ref<MemoryBuffer> PackArchive::decodeDelta(MemoryBuffer* base, const void* ops, size_t opsSize, const String& url)
+{
+	// Op stream: [varint targetSize] { [varint (len << 1) | copy] [varint baseOffset] or [len bytes] }
+	const uint8* pos = (const uint8*)ops;
+	const uint8* end = pos + opsSize;
+
+	size_t baseSize = base->getSize();
+	size_t targetSize = ReadDeltaVarint(pos, end);
+
+	// Each op takes two bytes at least and yields the whole base at most:
+	// a larger target is corrupted, and isn't worth reserving for
+	size_t maxOps = size_t(end - pos) / 2;
+	if (baseSize > 0 && maxOps > (size_t(-1) - opsSize) / baseSize)
+		maxOps = (size_t(-1) - opsSize) / baseSize;
+
+	if (targetSize > opsSize + maxOps * baseSize)
+		NIT_THROW_FMT(EX_CORRUPTED, "'%s': delta target size out of range", url.c_str());
+
+	Ref<MemoryBuffer> result = new MemoryBuffer();
+	result->reserve(std::min(targetSize, baseSize + opsSize));
+
+	while (result->getSize() < targetSize)
+	{
+		size_t tag = ReadDeltaVarint(pos, end);
+		size_t len = tag >> 1;
+
+		if (len > targetSize - result->getSize())
+			NIT_THROW_FMT(EX_CORRUPTED, "'%s': delta op beyond target size", url.c_str());
+
+		if (tag & 1)
+		{
+			size_t offset = ReadDeltaVarint(pos, end);
+			if (offset > baseSize || len > baseSize - offset)
+				NIT_THROW_FMT(EX_CORRUPTED, "'%s': delta copy out of range", url.c_str());
+
+			result->pushBack(base, offset, len);
+		}
+		else
+		{
+			if (len > size_t(end - pos))
+				NIT_THROW_FMT(EX_CORRUPTED, "'%s': delta insert out of range", url.c_str());
+
+			result->pushBack(pos, len);
+			pos += len;
+		}
+	}
+
+	return result;
+}
+
 StreamReader* PackArchive::openExtHeader()
 {
 	if (_header.signature == 0) return NULL;
@@ -221,6 +375,44 @@ FileReader* PackArchive::File::openPayload()
 	return reader;
 }
 
+bool PackArchive::File::loadBlockHashes(vector<uint32>::type& outHashes)
+{
+	outHashes.resize(_fileEntry.blockHashCount);
+
+	if (outHashes.empty())
+		return false;
+
+	PackArchive* pack = getPack();
+
+	// The table follows the payload
+	// TODO: apply uint64 on offset
+	Ref<StreamReader> reader = pack->_realFile->openRange(
+		size_t(pack->_realFileOffset + _fileEntry.offset + _fileEntry.payloadSize), outHashes.size() * sizeof(uint32), this);
+
+	reader->read(&outHashes[0], outHashes.size() * sizeof(uint32));
+
+	if (pack->_flipEndian)
+	{
+		for (uint i = 0; i < outHashes.size(); ++i)
+			StreamUtil::flipEndian(outHashes[i]);
+	}
+
+	return true;
+}
+
+bool PackArchive::File::verify()
+{
+	vector<uint32>::type expected;
+
+	if (!loadBlockHashes(expected))
+		return StreamUtil::calcCrc32(openPayload()) == _fileEntry.payloadCRC32;
+
+	vector<uint32>::type actual;
+	uint32 size = calcBlockHashes(open(), actual);
+
+	return size == _fileEntry.contentSize && actual == expected;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////
 
 void PackArchive::Header::flipEndian()
@@ -240,7 +432,9 @@ void PackArchive::FileEntry::flipEndian()
 	StreamUtil::flipEndian(offset);
 	StreamUtil::flipEndian(contentType);
 	StreamUtil::flipEndian(payloadType);
+	StreamUtil::flipEndian(blockHashCount);
 	StreamUtil::flipEndian(sourceSize);
+	StreamUtil::flipEndian(contentSize);
 	StreamUtil::flipEndian(memorySize);
 	StreamUtil::flipEndian(sourceCRC32);
 	StreamUtil::flipEndian(timestamp);
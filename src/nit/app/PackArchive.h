@@ -66,10 +66,10 @@ public:
 		uint64							offset;			//  8
 		ContentType::ValueType			contentType;	// 10
 		uint16							payloadType;	// 12
-		uint32							_reserved0;		// 16
+		uint32							blockHashCount;	// 16	(crc32 of each HASH_BLOCK_SIZE block of the content, stored after the payload)
 
 		uint32							sourceSize;		// 20
-		uint32							_reserved1;		// 24
+		uint32							contentSize;	// 24	(size of the content the block hashes cover)
 		uint32							memorySize;		// 28
 		uint32							_reserved2;		// 32
 		
@@ -91,13 +91,25 @@ public:
 		PAYLOAD_VOID					= 1,
 		PAYLOAD_ZLIB					= 2,
 		PAYLOAD_ZLIB_FAST				= 3,
+		PAYLOAD_DELTA					= 4,		// zlib'ed binary delta against the same entry of the delta base (param0: base crc32, param1: result crc32)
+		PAYLOAD_ZLIB_CHUNKED			= 5,		// independently zlib'ed blocks with an index, seekable (see ZChunkedStreamReader)
 	};
 
+	static const uint32					HASH_BLOCK_SIZE = 64 * 1024;
+
 	class File;
 
 public:
 	PackArchive(const String& name, StreamSource* packFile);
 
+public:
+	// Calculates block hashes of a content, returns the content size
+	static uint32						calcBlockHashes(StreamReader* content, vector<uint32>::type& outHashes);
+	static uint32						calcBlockHashes(const void* content, size_t size, vector<uint32>::type& outHashes);
+
+	// Rebuilds a PAYLOAD_DELTA content from its base and the uncompressed op stream, throws EX_CORRUPTED on a bad stream
+	static Ref<MemoryBuffer>			decodeDelta(MemoryBuffer* base, const void* ops, size_t opsSize, const String& url = StringUtil::BLANK());
+
 public:									// StreamLocator implementation
 	virtual bool						isCaseSensitive()						{ return false; }
 
@@ -125,6 +137,11 @@ public:
 
 	bool								isEndianFlip()							{ return _flipEndian; }
 
+public:
+	// Locator which resolves the base entries of PAYLOAD_DELTA entries (usually the base package or bundle)
+	StreamLocator*						getDeltaBase()							{ return _deltaBase; }
+	void								setDeltaBase(StreamLocator* base)		{ _deltaBase = base; }
+
 private:
 	void								readHeader(StreamReader* reader);
 	void								readFileEntry(StreamReader* reader);
@@ -141,7 +158,10 @@ private:
 	Files								_files;
 	bool								_flipEndian;
 
+	Ref<StreamLocator>					_deltaBase;
+
 	StreamReader*						processPayload(FileEntry* entry, FileReader* reader);
+	StreamReader*						applyDelta(FileEntry* entry, FileReader* reader);
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -170,6 +190,13 @@ public:
 	uint32								getPayloadParam1()						{ return _fileEntry.payloadParam1; }
 	uint32								getSourceSize()							{ return _fileEntry.sourceSize; }
 	uint32								getSourceCRC32()						{ return _fileEntry.sourceCRC32; }
+	uint32								getBlockHashCount()						{ return _fileEntry.blockHashCount; }
+	uint32								getContentSize()						{ return _fileEntry.contentSize; }
+
+	bool								loadBlockHashes(vector<uint32>::type& outHashes);
+
+	// Checks the content against the block hashes (or the payload against its crc32 when there are none)
+	bool								verify();
 
 protected:
 	FileEntry							_fileEntry;
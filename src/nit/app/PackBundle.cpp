@@ -58,6 +58,7 @@ PackBundle::PackBundle(StreamSource* bundleFile, PackBundle* base)
 	if (bundleFile)
 	{
 		_pack = new PackArchive(_name, bundleFile);
+		_pack->setDeltaBase(base);
 		_locator = _pack;
 	}
 
@@ -140,6 +141,11 @@ Package* PackBundle::link(const String& packName)
 		// link base pack
 		pack->_base = basePack;
 
+		// delta entries of the pack are patched against the base pack
+		PackArchive* packArchive = dynamic_cast<PackArchive*>(pack->_archive.get());
+		if (packArchive)
+			packArchive->setDeltaBase(basePack);
+
 		if (basePack && !basePack->hasProxy())
 			basePack->setProxy(pack);
 
@@ -461,6 +467,9 @@ Ref<PackBundle> PackBundle::linkBundles(AppConfig* appConfig)
 
 		bundle->_base = base;
 
+		if (bundle->_pack)
+			bundle->_pack->setDeltaBase(base);
+
 		if (base)
 		{
 			PackBundle* other = static_cast<PackBundle*>(base->_proxy.get());
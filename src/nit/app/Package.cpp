@@ -410,6 +410,15 @@ ContentSource* Package::linkCustom(const String& streamName, Ref<Content> conten
 
 StreamSource* Package::locateLocal(const String& streamName)
 {
+	// Serve what prepare() has read ahead, till afterPrepared() is done with them
+	{
+		Mutex::ScopedLock lock(_mutex);
+
+		PreparedSources::iterator itr = _preparedSources.find(streamName);
+		if (itr != _preparedSources.end())
+			return itr->second;
+	}
+
 	// Search from local contents
 	ContentSources::iterator itr = _localContents.find(streamName);
 
@@ -552,7 +561,7 @@ void Package::load()
 	afterPrepared();
 }
 
-void Package::loadAsync(bool hurry)
+void Package::loadAsync(bool hurry, int priority)
 {
 	checkLinked();
 
@@ -562,16 +571,37 @@ void Package::loadAsync(bool hurry)
 		return load();
 	}
 
+	if (hurry && priority < PackageService::PRIORITY_URGENT)
+		priority = PackageService::PRIORITY_URGENT;
+
+	bool queued = false;
+
 	{
 		Mutex::ScopedLock lock(_mutex);
 
 		if (_loaded) return;
-		if (_loading) return;
 		if (_prepared) return;
 
-		_hurry = hurry;
+		queued = _loading;
+
+		if (hurry) _hurry = true;
 		_loading = true;
-		_prepared = false;
+	}
+
+	if (queued)
+	{
+		// Already on the way: promote it instead, required ones first
+		for (uint i=0; i<_required.size(); ++i)
+		{
+			Package* pack = dynamic_cast<Package*>(_required[i].get());
+			if (pack && pack->isLoading())
+				pack->loadAsync(hurry, priority);
+		}
+
+		if (_service->raisePreload(this, priority))
+			LOG(0, ".. package '%s': async loading promoted to %d\n", _name.c_str(), priority);
+
+		return;
 	}
 
 	LOG(0, "%s package '%s': async loading\n", Thread::current() ? "&&" : "..", _name.c_str());
@@ -581,10 +611,34 @@ void Package::loadAsync(bool hurry)
 	{
 		Package* pack = dynamic_cast<Package*>(_required[i].get());
 		if (pack)
-			pack->loadAsync(hurry);
+			pack->loadAsync(hurry, priority);
+	}
+
+	_service->queuePreload(this, priority);
+}
+
+bool Package::cancelLoadAsync()
+{
+	{
+		Mutex::ScopedLock lock(_mutex);
+
+		if (_loaded || !_loading) return false;
+
+		// Tells a running prepare() to give up. When already prepared, the result waiting for
+		// afterPrepared() is dropped too so a later load starts over.
+		_loading = false;
+		_hurry = false;
+		_prepared = false;
+		_preparedSources.clear();
 	}
 
-	_service->queuePreload(this);
+	LOG(0, "-- package '%s': async loading canceled\n", _name.c_str());
+
+	// Removes it from the queue, or waits till the loader gives up
+	if (!_service->cancelPreload(this))
+		_service->joinAsyncLoader(this);
+
+	return true;
 }
 
 // TODO: Tear off script reference from Session!
@@ -627,6 +681,10 @@ bool Package::initScripts()
 	Ref<StreamLocator> oldLocator = script->getLocatorOverride();
 	script->setLocatorOverride(this);
 
+	// let workers compile the rest while the first ones are required
+	for (uint i=1; i<_requiredScripts.size(); ++i)
+		script->precompile(_requiredScripts[i], this);
+
 	// add all required scripts
 	for (uint i=0; i<_requiredScripts.size(); ++i)
 	{
@@ -752,6 +810,7 @@ void Package::unload()
 
 	_loaded = false;
 	_prepared = false;
+	releasePreparedSources();
 
 	LOG(0, "-- package '%s': Unloaded\n", _name.c_str());
 
@@ -906,14 +965,75 @@ void Package::collectPrepareFiles(PreloadFiles& varFiles, bool async)
 
 // NOTE: Package vars which are accessed by async Preload:
 // - [r] _loading
-// - [w] _prepared
+// - [w] _prepared, _preparedSources
 // - [r] _hurry
 // These are to be synced (using locked IsXXX(), SetXXX()
 // Make sure that other vars not touched by async thread!
 
 void Package::prepare(bool async)
 {
-	// TODO: impl this
+	PreloadFiles files;
+	collectPrepareFiles(files, async);
+
+	// Scripts are required by initScripts() right after this, so read them in whole and keep them
+	// till then. Other contents are linked and loaded on demand much later, so reading them here
+	// would only be thrown away: just open them to have the entries located and checked ahead.
+	// Checked between files to give up quickly when canceled.
+	PreparedSources prepared;
+
+	size_t totalSize = 0;
+	uint numFiles = 0;
+
+	for (PreloadFiles::iterator itr = files.begin(), end = files.end(); itr != end; ++itr)
+	{
+		if (!isLoading())
+		{
+			LOG(0, "%s package '%s': preload canceled after %d files\n", async ? "&&" : "..", _name.c_str(), numFiles);
+			return;
+		}
+
+		StreamSource* source = itr->second;
+
+		try
+		{
+			Ref<StreamReader> reader = source->open();
+
+			if (itr->first == RO_SCRIPT)
+			{
+				Ref<MemoryBuffer> buf = new MemoryBuffer(reader);
+				totalSize += buf->getSize();
+				prepared.insert(std::make_pair(source->getName(), new MemorySource(source, buf)));
+			}
+		}
+		catch (Exception& ex)
+		{
+			// Leave it to the actual load which reports the error in context
+			LOG(0, "?? package '%s': can't preload '%s': %s\n", _name.c_str(), source->getName().c_str(), ex.getFullDescription().c_str());
+		}
+
+		++numFiles;
+	}
+
+	if (numFiles > 0)
+		LOG(0, "%s package '%s': preloaded %d files, %d script bytes kept\n", async ? "&&" : "..", _name.c_str(), numFiles, (uint)totalSize);
+
+	Mutex::ScopedLock lock(_mutex);
+
+	// Canceled or unloaded meanwhile
+	if (!_loading) return;
+
+	_preparedSources.swap(prepared);
+	_prepared = true;
+}
+
+void Package::releasePreparedSources()
+{
+	PreparedSources released;
+
+	{
+		Mutex::ScopedLock lock(_mutex);
+		released.swap(_preparedSources);
+	}
 }
 
 void Package::afterPrepared()
@@ -925,6 +1045,9 @@ void Package::afterPrepared()
 	initScripts();
 	_loaded = true;
 
+	// Scripts are compiled by now: drop the copies kept by prepare()
+	releasePreparedSources();
+
 	LOG(0, "-- package '%s' loaded\n", _name.c_str());
 
 	if (_channel) 
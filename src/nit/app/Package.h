@@ -128,7 +128,11 @@ public:									// Archive Implemenatation
 	virtual void						rename(const String& streamName, const String& newName)	{ ASSERT_THROW(_archive, EX_NOT_SUPPORTED); return _archive->rename(streamName, newName); }
 
 public:									// Async Support
-	void								loadAsync(bool hurry=false);
+	// Calling again on a package still queued raises its priority (with its required packages)
+	void								loadAsync(bool hurry=false, int priority=PackageService::PRIORITY_NORMAL);
+
+	// Drops a queued or running async load, returns false when there's nothing to cancel
+	bool								cancelLoadAsync();
 
 public:
 	virtual void						require(StreamLocator* req, bool first = false);
@@ -207,6 +211,9 @@ private:
 
 private:
 	typedef multimap<PrepareOrder, Ref<StreamSource> >::type PreloadFiles;
+	typedef map<String, Ref<StreamSource>, StringUtil::LessIgnoreCase>::type PreparedSources;
+
+	PreparedSources						_preparedSources;			// scripts read ahead by prepare(), guarded by _mutex
 
 	bool								isHurry() { Mutex::ScopedLock lock(_mutex); return _hurry; }
 
@@ -215,6 +222,7 @@ private:
 	void								prepare(bool async);
 
 	void								afterPrepared();
+	void								releasePreparedSources();
 	void								collectPrepareFiles(PreloadFiles& varFiles, bool async);
 };
 
@@ -45,124 +45,148 @@ NS_NIT_BEGIN;
 
 ////////////////////////////////////////////////////////////////////////////////
 
-class PackageService::AsyncLoader : public Runnable
+// AsyncLoader runs a pool of low priority worker threads which prepare packages from a shared queue.
+// The queue is ordered by priority, then by request order, so an urgent package does not wait behind
+// large ones queued earlier - it waits only for a worker to become free.
+
+class PackageService::AsyncLoader
 {
 public:
-	AsyncLoader(PackageService* svc, int processorNo = DEFAULT_PROCESSOR_NO)
+	AsyncLoader(PackageService* svc, uint numWorkers)
 	{
 		_service = svc;
-		_processorNo = processorNo;
 		_terminated = false;
+		_nextSeq = 0;
+
+		resetStats();
 
-		_myThread = new Thread("AsyncLoader");
-		_myThread->start(*this);
-		_myThread->setPriority(Thread::PRIO_LOW);
+		for (uint i = 0; i < numWorkers; ++i)
+			_workers.push_back(new Worker(this, i));
 	}
 
-	virtual ~AsyncLoader()
+	~AsyncLoader()
 	{
 		ASSERT(_terminated);
-		safeDelete(_myThread);
+
+		for (uint i = 0; i < _workers.size(); ++i)
+			safeDelete(_workers[i]);
 	}
 
-	virtual void run()
+	uint GetWorkerCount() { return _workers.size(); }
+
+	void Terminate() // outer thread
 	{
-#ifdef _XBOX
-		XSetThreadProcessor(GetCurrentThread(), _processorNo);
-#endif
-		Thread::yield();
+		_mutex.lock();
+		_terminated = true;
+		_queue.clear();
+		_mutex.unlock();
 
-		LOG(0, "&& AsyncLoader @%d: started\n", CurrentProcessorNo());
+		// Each worker wakes the next one on its way out
+		_queueReady.set();
 
-		while (!_terminated)
-		{
-			_mutex.lock();
-			_current = NULL;
-			PopFront(_current);
-			_mutex.unlock();
+		for (uint i = 0; i < _workers.size(); ++i)
+			_workers[i]->_thread->join();
+	}
 
-			if (_current == NULL)
-			{
-				LOG(0, "&& AsyncLoader @%d: idle\n", CurrentProcessorNo());
-				_queueReady.wait();
-				continue;
-			}
+	void Enqueue(Package* pack, int priority) // outer thread
+	{
+		Entry e;
+		e.pack		= pack;
+		e.priority	= priority;
+		e.queuedTime = SystemTimer::now();
 
-			LOG(0, "&& AsyncLoader @%d: pick-up '%s'\n", CurrentProcessorNo(), _current->getName().c_str());
+		_mutex.lock();
+		e.seq		= _nextSeq++;
+		_queue.push_back(e);
+		++_stats.queued;
+		_mutex.unlock();
 
-			try
-			{
-				_current->prepare(true);
-			}
-			catch (...)
-			{
-				LOG(0, "&& AsyncLoader @%d: Terminated due to an exception.\n", CurrentProcessorNo());
-#ifdef _XBOX
-				XLaunchNewImage( XLAUNCH_KEYWORD_DASH_ARCADE, 0 );
-				return;
-#endif				
-			}
+		_queueReady.set();
+	}
 
-			LOG(0, "&& AsyncLoader @%d: output '%s'\n", CurrentProcessorNo(), _current->getName().c_str());
-			AddOutput(_current);
-		}
+	bool Raise(Package* pack, int priority) // outer thread
+	{
+		Mutex::ScopedLock lock(_mutex);
 
-		LOG(0, "&& AsyncLoader @%d: terminated\n", CurrentProcessorNo());
-	}
+		Entry* e = Find(pack);
+		if (e == NULL || e->priority >= priority) return false;
 
-	Thread* GetThread() { return _myThread; }
+		e->priority = priority;
+		++_stats.promoted;
+		return true;
+	}
 
-	void Terminate() // outer thread
+	bool Cancel(Package* pack) // outer thread
 	{
-		_queueMutex.lock();
-		_terminated = true;
-		_queue.clear();
-		_queueMutex.unlock();
+		Mutex::ScopedLock lock(_mutex);
 
-		_queueReady.set();
+		if (!Remove(pack)) return false;
 
-		_myThread->join();
+		++_stats.cancelled;
+		return true;
 	}
 
 	void Join(Package* p) // outer thread
 	{
 		Ref<Package> pack = p;
 
-		LOG(0, ".. AsyncLoader: Removing %s\n", pack->getName().c_str());
+		Worker* worker = NULL;
+
+		_mutex.lock();
+
+		// Still queued: the caller prepares it by itself rather than waiting for a free worker
+		if (Remove(pack))
+		{
+			_mutex.unlock();
+			LOG(0, ".. AsyncLoader: Removed %s\n", pack->getName().c_str());
+			return;
+		}
+
+		for (uint i = 0; i < _workers.size(); ++i)
+		{
+			if (_workers[i]->_current == pack)
+				worker = _workers[i];
+		}
+		_mutex.unlock();
 
-		_queueMutex.lock();
-		_queue.remove(pack);
-		_queueMutex.unlock();
+		if (worker == NULL) return;
 
 		LOG(0, ".. AsyncLoader: Joining %s\n", pack->getName().c_str());
 
+		// The caller blocks on it: let the worker run at the caller's pace meanwhile
+		worker->_thread->setPriority(Thread::PRIO_NORMAL);
+
+		// A signal may be left over from an earlier package: check again each time it wakes
 		while (true)
 		{
 			_mutex.lock();
-			bool loading = _current == pack;
+			bool loading = worker->_current == pack;
 			_mutex.unlock();
 
 			if (!loading) break;
-			Thread::sleep(10);
+			worker->_idle.wait();
 		}
+
+		worker->_thread->setPriority(Thread::PRIO_LOW);
 	}
 
 	bool IsBusy() // outer thread
 	{
-		_mutex.lock();
-		bool busy = _current != NULL;
-		_mutex.unlock();
+		Mutex::ScopedLock lock(_mutex);
+
+		for (uint i = 0; i < _workers.size(); ++i)
+		{
+			if (_workers[i]->_current)
+				return true;
+		}
 
-		return busy;
+		return false;
 	}
 
 	bool IsQueued() // outer thread
 	{
-		_queueMutex.lock();
-		bool queued = !_queue.empty();
-		_queueMutex.unlock();
-
-		return queued;
+		Mutex::ScopedLock lock(_mutex);
+		return !_queue.empty();
 	}
 
 	bool HasOutput() // outer thread
@@ -174,15 +198,6 @@ public:
 		return hasOutput;
 	}
 
-	void Enqueue(Package* pack) // outer thread
-	{
-		_queueMutex.lock();
-		_queue.push_back(pack);
-		_queueMutex.unlock();
-
-		_queueReady.set();
-	}
-
 	void NextOutput(Ref<Package>& ret) // outer thread
 	{
 		_outputMutex.lock();
@@ -191,48 +206,203 @@ public:
 		_outputMutex.unlock();
 	}
 
-private:
-	void PopFront(Ref<Package>& ret)
+	void GetStats(AsyncStats& outStats) // outer thread
 	{
-		_queueMutex.lock();
-		ret = _queue.empty() ? NULL : _queue.front();
-		if (ret) _queue.pop_front();
-		_queueMutex.unlock();
+		Mutex::ScopedLock lock(_mutex);
+		outStats = _stats;
 	}
 
-	void AddOutput(Package* pack)
+	void resetStats()
 	{
-		_outputMutex.lock();
-		_output.push_back(pack);
-		_outputMutex.unlock();
+		Mutex::ScopedLock lock(_mutex);
+		memset(&_stats, 0, sizeof(_stats));
 	}
 
-	Thread* _myThread;
+private:
+	class Worker : public Runnable
+	{
+	public:
+		Worker(AsyncLoader* loader, uint no)
+		{
+			_loader = loader;
+			_no = no;
 
-	typedef list<Ref<Package> >::type Queue;
+			_thread = new Thread("AsyncLoader");
+			_thread->start(*this);
+			_thread->setPriority(Thread::PRIO_LOW);
+		}
 
-	PackageService*	_service;
+		virtual ~Worker()
+		{
+			safeDelete(_thread);
+		}
 
-	Ref<Package>	_current;
-	Mutex			_mutex;
+		virtual void run()
+		{
+#ifdef _XBOX
+			// Keep off the cores the main and render threads run on
+			XSetThreadProcessor(GetCurrentThread(), XBOX_FIRST_PROCESSOR_NO + _no % XBOX_NUM_PROCESSORS);
+#endif
+			Thread::yield();
+
+			LOG(0, "&& AsyncLoader #%d: started\n", _no);
+
+			while (true)
+			{
+				Entry e;
+				if (!_loader->Pop(this, e))
+				{
+					if (_loader->IsTerminated()) break;
 
-	Queue			_queue;
-	Mutex			_queueMutex;
-	EventSemaphore	_queueReady;
+					_loader->_queueReady.wait();
+					continue;
+				}
+
+				double startTime = SystemTimer::now();
+
+				LOG(0, "&& AsyncLoader #%d: pick-up '%s' (priority %d, waited %.3f sec)\n", _no, e.pack->getName().c_str(), e.priority, float(startTime - e.queuedTime));
+
+				try
+				{
+					e.pack->prepare(true);
+				}
+				catch (...)
+				{
+					LOG(0, "&& AsyncLoader #%d: '%s': exception while preparing\n", _no, e.pack->getName().c_str());
+				}
+
+				double endTime = SystemTimer::now();
+
+				LOG(0, "&& AsyncLoader #%d: output '%s' (ready in %.3f sec)\n", _no, e.pack->getName().c_str(), float(endTime - e.queuedTime));
+
+				_loader->Done(this, e, startTime, endTime);
+			}
+
+			// Wake the next idle worker to let it terminate also
+			_loader->_queueReady.set();
+
+			LOG(0, "&& AsyncLoader #%d: terminated\n", _no);
+		}
 
-	Queue			_output;
-	Mutex			_outputMutex;
+	private:
+		friend class AsyncLoader;
 
-	int				_processorNo;
-	bool			_terminated;
+		AsyncLoader*					_loader;
+		uint							_no;
+		Thread*							_thread;
+		Ref<Package>					_current;		// guarded by AsyncLoader::_mutex
+		EventSemaphore					_idle;			// set whenever _current is cleared
 
 #ifdef _XBOX
-	const static int DEFAULT_PROCESSOR_NO = 4; // TODO: refactor to AppConfig
-	int CurrentProcessorNo()			{ return GetCurrentProcessorNumber(); }
-#else
-	const static int DEFAULT_PROCESSOR_NO = 0;
-	int CurrentProcessorNo()			{ return _processorNo; }
+		const static int XBOX_FIRST_PROCESSOR_NO = 4; // TODO: refactor to AppConfig
+		const static int XBOX_NUM_PROCESSORS = 2;
 #endif
+	};
+
+	struct Entry
+	{
+		Ref<Package>					pack;
+		int								priority;
+		uint							seq;
+		double							queuedTime;
+	};
+
+	typedef vector<Entry>::type Queue;
+	typedef list<Ref<Package> >::type OutputQueue;
+
+	bool IsTerminated()
+	{
+		Mutex::ScopedLock lock(_mutex);
+		return _terminated;
+	}
+
+	Entry* Find(Package* pack)
+	{
+		for (uint i = 0; i < _queue.size(); ++i)
+		{
+			if (_queue[i].pack == pack)
+				return &_queue[i];
+		}
+
+		return NULL;
+	}
+
+	bool Remove(Package* pack)
+	{
+		for (Queue::iterator itr = _queue.begin(); itr != _queue.end(); ++itr)
+		{
+			if (itr->pack != pack) continue;
+
+			_queue.erase(itr);
+			return true;
+		}
+
+		return false;
+	}
+
+	bool Pop(Worker* worker, Entry& outEntry)
+	{
+		Mutex::ScopedLock lock(_mutex);
+
+		if (_terminated || _queue.empty())
+			return false;
+
+		// Highest priority first, then in request order
+		uint best = 0;
+		for (uint i = 1; i < _queue.size(); ++i)
+		{
+			const Entry& e = _queue[i];
+			if (e.priority > _queue[best].priority || (e.priority == _queue[best].priority && e.seq < _queue[best].seq))
+				best = i;
+		}
+
+		outEntry = _queue[best];
+		_queue.erase(_queue.begin() + best);
+		worker->_current = outEntry.pack;
+
+		// Signals are not counted: wake another worker for the rest
+		if (!_queue.empty())
+			_queueReady.set();
+
+		return true;
+	}
+
+	void Done(Worker* worker, Entry& e, double startTime, double endTime)
+	{
+		_outputMutex.lock();
+		_output.push_back(e.pack);
+		_outputMutex.unlock();
+
+		_mutex.lock();
+		worker->_current = NULL;
+
+		double ready = endTime - e.queuedTime;
+
+		++_stats.completed;
+		_stats.waitTime += startTime - e.queuedTime;
+		_stats.prepareTime += endTime - startTime;
+		_stats.readyTime += ready;
+		if (_stats.maxReadyTime < ready)
+			_stats.maxReadyTime = ready;
+		_mutex.unlock();
+
+		worker->_idle.set();
+	}
+
+	PackageService*						_service;
+
+	vector<Worker*>::type				_workers;
+
+	Queue								_queue;
+	uint								_nextSeq;
+	bool								_terminated;
+	Mutex								_mutex;
+	EventSemaphore						_queueReady;
+
+	OutputQueue							_output;
+	Mutex								_outputMutex;
+
+	AsyncStats							_stats;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -264,7 +434,25 @@ void PackageService::onInit()
 	bool useAsyncLoading = DataValue(g_App->getConfig("async_loading", "false")).toBool();
 
 	if (useAsyncLoading)
-		_asyncLoader = new AsyncLoader(this);
+	{
+		// 0: platform default - loading is mostly bound to storage, but leave cores for the main thread on small devices
+		int numLoaders = DataValue(g_App->getConfig("async_loaders", "0")).toInt();
+
+		if (numLoaders <= 0)
+		{
+#if defined(NIT_IOS) || defined(NIT_ANDROID)
+			numLoaders = 2;
+#else
+			numLoaders = 4;
+#endif
+			int concurrency = Thread::getMaxConcurrency();
+			if (concurrency > 0 && numLoaders > concurrency)
+				numLoaders = concurrency;
+		}
+
+		LOG(0, ".. PackageService: %d async loaders\n", numLoaders);
+		_asyncLoader = new AsyncLoader(this, numLoaders);
+	}
 
 	g_App->getClock()->channel()->bind(EVT::CLOCK, this, &PackageService::onClock);
 	g_App->channel()->bind(EVT::SESSION_START, this, &PackageService::onSessionStart);
@@ -452,13 +640,13 @@ Package* PackageService::load(const char* name)
 	return pack;
 }
 
-Package* PackageService::loadAsync(const char* name, bool hurry)
+Package* PackageService::loadAsync(const char* name, bool hurry, int priority)
 {
 	Package* pack = link(name);
 
 	if (pack) 
 	{
-		pack->loadAsync(hurry);
+		pack->loadAsync(hurry, priority);
 	}
 	else
 	{
@@ -543,13 +731,27 @@ void PackageService::onSessionChange(const SessionEvent* evt)
 	}
 }
 
-void PackageService::queuePreload(Package* pack)
+void PackageService::queuePreload(Package* pack, int priority)
 {
 	ASSERT(_asyncLoader);
 
 	if (_asyncLoader == NULL) return;
 
-	_asyncLoader->Enqueue(pack);
+	_asyncLoader->Enqueue(pack, priority);
+}
+
+bool PackageService::raisePreload(Package* pack, int priority)
+{
+	if (_asyncLoader == NULL) return false;
+
+	return _asyncLoader->Raise(pack, priority);
+}
+
+bool PackageService::cancelPreload(Package* pack)
+{
+	if (_asyncLoader == NULL) return false;
+
+	return _asyncLoader->Cancel(pack);
 }
 
 void PackageService::onClock(const Event* evt)
@@ -571,6 +773,13 @@ void PackageService::updatePreloads(float timeLimit)
 		if (pack == NULL)
 			break;
 
+		if (!pack->isLoading())
+		{
+			// cancelLoadAsync() after the loader was done with it
+			LOG(0, ".. package '%s': prepared but canceled\n", pack->getName().c_str());
+			continue;
+		}
+
 		if (pack->isPrepared())
 		{
 			LOG(0, ".. package '%s': prepare completed\n", pack->getName().c_str());
@@ -582,7 +791,7 @@ void PackageService::updatePreloads(float timeLimit)
 		double now = SystemTimer::now();
 		if (now - startTime > timeLimit)
 		{
-			LOG(0, ".. package prepare time limit %.3f > %.3f\n", float(now - startTime) / float(CLOCKS_PER_SEC), timeLimit);
+			LOG(0, ".. package prepare time limit %.3f > %.3f\n", float(now - startTime), timeLimit);
 			break;
 		}
 	}
@@ -595,6 +804,29 @@ bool PackageService::isAsyncLoading()
 	return _asyncLoader->IsBusy() || _asyncLoader->IsQueued() || _asyncLoader->HasOutput();
 }
 
+uint PackageService::getAsyncLoaderCount()
+{
+	return _asyncLoader ? _asyncLoader->GetWorkerCount() : 0;
+}
+
+PackageService::AsyncStats PackageService::getAsyncStats()
+{
+	AsyncStats stats;
+
+	if (_asyncLoader)
+		_asyncLoader->GetStats(stats);
+	else
+		memset(&stats, 0, sizeof(stats));
+
+	return stats;
+}
+
+void PackageService::resetAsyncStats()
+{
+	if (_asyncLoader)
+		_asyncLoader->resetStats();
+}
+
 void PackageService::joinAsyncLoader(Package* pack)
 {
 	if (_asyncLoader == NULL) return;
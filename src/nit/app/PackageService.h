@@ -55,17 +55,42 @@ public:
 	typedef map<String, Ref<Package>, StringUtil::LessIgnoreCase>::type PackageNameMap;
 	typedef map<String, String>::type UIDLookup;
 
+	// Async load priorities - the higher first. A hurry load is queued at least as PRIORITY_URGENT.
+	enum Priority
+	{
+		PRIORITY_LOW					= -100,
+		PRIORITY_NORMAL					= 0,
+		PRIORITY_URGENT					= 100,
+	};
+
+	struct NIT_API AsyncStats
+	{
+		uint							queued;
+		uint							completed;
+		uint							cancelled;
+		uint							promoted;
+		double							waitTime;		// sum of queued -> picked up by a loader (sec)
+		double							prepareTime;	// sum of picked up -> prepared (sec)
+		double							readyTime;		// sum of queued -> prepared (sec)
+		double							maxReadyTime;
+	};
+
 public:
 	Package*							link(const char* name, bool optional = false);
 	Package*							linkCustom(const String& name, Archive* archive, Settings* settings);
 
 	Package*							load(const char* name);
-	Package*							loadAsync(const char* name, bool hurry=true);
+	Package*							loadAsync(const char* name, bool hurry=true, int priority=PRIORITY_NORMAL);
 	bool								isAsyncLoading();
 	bool								isAsyncLoadingEnabled()					{ return _asyncLoader != NULL; }
 
 	void								find(const String& pattern, vector<Package*>::type& varResults);
 
+public:
+	uint								getAsyncLoaderCount();
+	AsyncStats							getAsyncStats();
+	void								resetAsyncStats();
+
 public:
 	const PackageNameMap&				allLinked()								{ return _linkedPackages; }
 	void								compact();
@@ -116,7 +141,9 @@ private:
 	void								onSessionChange(const SessionEvent* evt);
 
 	void								updatePreloads(float timeLimit = 0.1f);
-	void								queuePreload(Package* pack);
+	void								queuePreload(Package* pack, int priority);
+	bool								raisePreload(Package* pack, int priority);
+	bool								cancelPreload(Package* pack);
 	void								joinAsyncLoader(Package* pack);
 private:
 	class								AsyncLoader;
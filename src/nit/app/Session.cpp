@@ -131,6 +131,10 @@ void Session::start()
 	_script = createRuntime();
 	_script->setDefaultLocator(_package);
 
+	_world = new World();
+
+	// Handlers bound later are called first: bind the world before the script so it ticks after it
+	_timer->channel()->bind(EVT::TICK, _world.get(), &World::onTick);
 	_timer->channel()->bind(EVT::TICK, _script->tickHandler());
 	g_App->getClock()->channel()->bind(EVT::CLOCK, _script->clockHandler());
 	g_App->getScheduler()->repeat(_script->gcLoopHandler(), 0.1f);
@@ -143,8 +147,6 @@ void Session::start()
 	NitBind::newSlot(v, -1, "session", this);
 	sq_poptop(v);
 
-	_world = new World();
-	
 	openPackage();
 
 	onStart();
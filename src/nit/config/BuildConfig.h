@@ -82,3 +82,11 @@
 #endif
 
 ////////////////////////////////////////////////////////////////////////////////
+
+// Test fixtures and self checks for packs-tests (selfTest, benchmark, ...) - left out of shipping build
+
+#if !defined(NIT_SHIPPING) && !defined(NIT_NO_TESTS)
+#	define NIT_TESTS
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
@@ -93,6 +93,25 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Determine SIMD instruction set available to the compiler
+// (both are still checked at runtime before use: android enables NEON only on the files built with it, see nit.mk)
+
+#undef NIT_SIMD_SSE2
+#undef NIT_SIMD_NEON
+
+#if defined(NIT_NO_SIMD)
+	// forced to use scalar code only
+
+#elif defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#	define NIT_SIMD_SSE2
+
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#	define NIT_SIMD_NEON
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
 // Determine endian-ness
 
 #define NIT_ENDIAN_LITTLE	0
@@ -46,13 +46,13 @@ NS_NIT_BEGIN;
 ////////////////////////////////////////////////////////////////////////////////
 
 Image::Image()
-: Content(NULL), _pixelBuffer(NULL), _pitch(0), _bitsPerPixel(0)
+: Content(NULL), _pixelBuffer(NULL), _pitch(0), _bitsPerPixel(0), _loadBudget(0), _srgb(false)
 {
 	memset(&_header, 0, sizeof(_header));
 }
 
 Image::Image(const Header& header, uint8* pixelBuffer)
-: Content(NULL), _header(header), _pixelBuffer(pixelBuffer)
+: Content(NULL), _header(header), _pixelBuffer(pixelBuffer), _loadBudget(0), _srgb(false)
 {
 	_bitsPerPixel = PixelFormat::calcBitsPerPixel(header.pixelFormat);
 	_pitch = PixelFormat::calcPitch(header.pixelFormat, header.width);
@@ -61,7 +61,7 @@ Image::Image(const Header& header, uint8* pixelBuffer)
 }
 
 Image::Image(StreamSource* source, ContentType treatAs)
-: Content(NULL), _pixelBuffer(NULL), _pitch(0), _bitsPerPixel(0)
+: Content(NULL), _pixelBuffer(NULL), _pitch(0), _bitsPerPixel(0), _loadBudget(0), _srgb(false)
 {
 	memset(&_header, 0, sizeof(_header));
 
@@ -72,7 +72,7 @@ Image::Image(StreamSource* source, ContentType treatAs)
 }
 
 Image::Image(const Header& header, uint8* srcBuffer, int srcWidth, int srcHeight, int srcPitch, bool yFlip)
-: Content(NULL), _header(header)
+: Content(NULL), _header(header), _loadBudget(0), _srgb(false)
 {
 	_bitsPerPixel = PixelFormat::calcBitsPerPixel(header.pixelFormat);
 	_pitch = PixelFormat::calcPitch(header.pixelFormat, header.width);
@@ -154,6 +154,14 @@ void Image::onLoad(bool async)
 {
 	ASSERT_THROW(_source, EX_INVALID_STATE);
 
+	// Finish a pending background decode right now rather than decoding again
+	if (_decoder && !async)
+	{
+		Ref<ImageDecoder> decoder = _decoder;
+		if (decoder->finish(this))
+			return;
+	}
+
 	// TODO: implement a codec register mechanism
 	if (_source && _contentType == ContentType::UNKNOWN)
 		_contentType = _source->getContentType();
@@ -178,6 +186,9 @@ void Image::onLoad(bool async)
 	}
 
 	_headerLoaded = true;
+
+	if (_loadBudget > 0 && _header.memorySize > _loadBudget)
+		fitToBudget(_loadBudget, PixelConverter::FILTER_BOX, isSrgb());
 }
 
 void Image::onUnload()
@@ -191,11 +202,32 @@ void Image::onUnload()
 
 void Image::onDispose()
 {
+	if (_decoder)
+		_decoder->cancel(this);
+
 	unload();
 
 	_contentType = ContentType::UNKNOWN;
 }
 
+void Image::adoptDecoded(Image* decoded)
+{
+	onUnload();
+
+	// Move the buffer - the decoded image is a plain Image hence allocated by the same allocator
+	_header				= decoded->_header;
+	_contentType		= decoded->_contentType;
+	_pitch				= decoded->_pitch;
+	_bitsPerPixel		= decoded->_bitsPerPixel;
+	_pixelBuffer		= decoded->_pixelBuffer;
+
+	decoded->_pixelBuffer = NULL;
+
+	_headerLoaded		= true;
+	_loaded				= true;
+	_error				= false;
+}
+
 uint8* Image::Allocate(size_t size)
 {
 	return (uint8*)NIT_ALLOC(size);
@@ -216,16 +248,11 @@ uint8* Image::getMipData(int mipLevel)
 	if (mipLevel < 0 || mipLevel >= _header.mipmapCount)
 		return NULL;
 
-	int pitch = _pitch;
-	int height = _header.height;
-
 	uint8* start = _pixelBuffer;
 
 	for (int i=0; i<mipLevel; ++i)
 	{
-		start += pitch * height;
-		pitch >>= 1;
-		height >>= 1;
+		start += getMipPitch(i) * getMipHeight(i);
 	}
 
 	return start;
@@ -1056,19 +1083,6 @@ void Image::replaceHeader(const Header& header)
 	_header = header;
 }
 
-template <typename TPixel>
-static void PremultiplyAlpha(uint8* buf, size_t size)
-{
-	TPixel* end = (TPixel*)(buf + size);
-	for (TPixel* pix = (TPixel*)buf; pix < end; ++pix)
-	{
-		int a = pix->a + 1;
-		pix->r = (pix->r * a) >> TPixel::A_BITS;
-		pix->g = (pix->g * a) >> TPixel::A_BITS;
-		pix->b = (pix->b * a) >> TPixel::A_BITS;
-	}
-}
-
 void Image::makeAlphaPremultiplied()
 {
 	PixelFormat fmt = PixelFormat(_header.pixelFormat);
@@ -1082,11 +1096,11 @@ void Image::makeAlphaPremultiplied()
 	// Assume that byte order of alpha components are consistant RGB*A*  BGR*A*
 	if (fmt == PixelFormat::RGBA_8888 || fmt == PixelFormat::BGRA_8888)
 	{
-		PremultiplyAlpha<PixelRGBA_8888>(_pixelBuffer, _header.memorySize);
+		PixelConverter::premultiply_8888(_pixelBuffer, _header.memorySize / 4);
 	}
 	else if (fmt == PixelFormat::RGBA_4444 || fmt == PixelFormat::ARGB_4444)
 	{
-		PremultiplyAlpha<PixelRGBA_4444>(_pixelBuffer, _header.memorySize);
+		PixelConverter::premultiply_4444(_pixelBuffer, _header.memorySize / 2);
 	}
 	else
 	{
@@ -1171,18 +1185,6 @@ bool Image::makePot(bool square, uint16 min)
 	return true;
 }
 
-template <typename TPixel>
-static void _ReorderAsRGBA(uint8* buf, size_t size)
-{
-	TPixel* end = (TPixel*)(buf + size);
-	for (TPixel* pix = (TPixel*)buf; pix < end; ++pix)
-	{
-		int t = pix->r;
-		pix->r = pix->b;
-		pix->b = t;
-	}
-}
-
 void Image::reorderAsRgba()
 {
 	PixelFormat fmt = PixelFormat(_header.pixelFormat);
@@ -1193,11 +1195,11 @@ void Image::reorderAsRgba()
 
 	if (fmt == PixelFormat::ARGB_8888 || fmt == PixelFormat::ARGB_8888_PA)
 	{
-		_ReorderAsRGBA<PixelRGBA_8888>(_pixelBuffer, _header.memorySize);
+		PixelConverter::swapRB_8888(_pixelBuffer, _header.memorySize / 4);
 	}
 	else if (fmt == PixelFormat::ARGB_4444 || fmt == PixelFormat::ARGB_4444_PA)
 	{
-		_ReorderAsRGBA<PixelRGBA_4444>(_pixelBuffer, _header.memorySize);
+		PixelConverter::swapRB_4444(_pixelBuffer, _header.memorySize / 2);
 	}
 	else
 	{
@@ -1207,7 +1209,7 @@ void Image::reorderAsRgba()
 	_header.pixelFormat = (PixelFormat::RGBA_8888 & PixelFormat::FLAG_ID_MASK) | (fmt & !PixelFormat::FLAG_ID_MASK);
 }
 
-void Image::makeRgba_4444()
+void Image::makeRgba_4444(bool dither)
 {
 	PixelFormat fmt = PixelFormat(_header.pixelFormat);
 	ASSERT_THROW(_pixelBuffer, EX_INVALID_STATE);
@@ -1227,6 +1229,56 @@ void Image::makeRgba_4444()
 	default:							NIT_THROW(EX_NOT_SUPPORTED);
 	}
 
+	convert8888To16(newFmt, PixelConverter::convert8888to4444, dither);
+}
+
+void Image::makeRgb_565(bool dither)
+{
+	PixelFormat fmt = PixelFormat(_header.pixelFormat);
+	ASSERT_THROW(_pixelBuffer, EX_INVALID_STATE);
+	ASSERT_THROW(!fmt.isCompressed(), EX_NOT_SUPPORTED);
+	ASSERT_THROW(!fmt.isTiled(), EX_NOT_SUPPORTED);
+
+	switch (fmt)
+	{
+	case PixelFormat::RGB_565:			return;
+
+	case PixelFormat::RGBA_8888:
+	case PixelFormat::RGBA_8888_PA:		break;
+
+	default:							NIT_THROW(EX_NOT_SUPPORTED);
+	}
+
+	convert8888To16(PixelFormat::RGB_565, PixelConverter::convert8888to565, dither);
+}
+
+void Image::makeRgba_5551(bool dither)
+{
+	PixelFormat fmt = PixelFormat(_header.pixelFormat);
+	ASSERT_THROW(_pixelBuffer, EX_INVALID_STATE);
+	ASSERT_THROW(!fmt.isCompressed(), EX_NOT_SUPPORTED);
+	ASSERT_THROW(!fmt.isTiled(), EX_NOT_SUPPORTED);
+
+	PixelFormat newFmt;
+
+	switch (fmt)
+	{
+	case PixelFormat::RGBA_5551:
+	case PixelFormat::RGBA_5551_PA:		return;
+
+	case PixelFormat::RGBA_8888:		newFmt = PixelFormat::RGBA_5551; break;
+	case PixelFormat::RGBA_8888_PA:		newFmt = PixelFormat::RGBA_5551_PA; break;
+
+	default:							NIT_THROW(EX_NOT_SUPPORTED);
+	}
+
+	convert8888To16(newFmt, PixelConverter::convert8888to5551, dither);
+}
+
+void Image::convert8888To16(PixelFormat newFmt, Convert8888Fn fn, bool dither)
+{
+	ASSERT_THROW(_header.mipmapCount == 1, EX_NOT_SUPPORTED);
+
 	uint newPitch = _header.width * 2;
 	size_t newSize = _header.height * newPitch;
 	uint8* newBuffer = Allocate(newSize);
@@ -1234,28 +1286,185 @@ void Image::makeRgba_4444()
 	if (newBuffer == NULL) 
 		NIT_THROW(EX_MEMORY);
 
-	PixelRGBA_8888* end = (PixelRGBA_8888*)(_pixelBuffer + _header.memorySize);
+	fn(_pixelBuffer, _pitch, newBuffer, newPitch, _header.width, _header.height, dither);
 
-	PixelRGBA_4444* dst = (PixelRGBA_4444*)newBuffer;
-	for (PixelRGBA_8888* src = (PixelRGBA_8888*)_pixelBuffer; src < end; ++src, ++dst)
-	{
-		PixelRGBA_8888 s = *src;
-		PixelRGBA_4444 d;
+	Deallocate(_pixelBuffer, _header.memorySize);
+	_pixelBuffer = newBuffer;
+	_header.memorySize = newSize;
+	_header.pixelFormat = newFmt;
+	_pitch = newPitch;
+	_bitsPerPixel = 16;
+}
 
-		d.a = s.a >> 4;
-		d.r = s.r >> 4;
-		d.g = s.g >> 4;
-		d.b = s.b >> 4;
+void Image::flipY()
+{
+	PixelFormat fmt = PixelFormat(_header.pixelFormat);
+	ASSERT_THROW(_pixelBuffer, EX_INVALID_STATE);
+	ASSERT_THROW(!fmt.isCompressed(), EX_NOT_SUPPORTED);
+	ASSERT_THROW(!fmt.isTiled(), EX_NOT_SUPPORTED);
 
-		*dst = d;
+	for (int level = 0; level < _header.mipmapCount; ++level)
+	{
+		PixelConverter::flipY(getMipData(level), getMipPitch(level), getMipHeight(level));
 	}
+}
+
+bool Image::isResamplable()
+{
+	PixelFormat fmt = PixelFormat(_header.pixelFormat);
+	return _pixelBuffer && !fmt.isCompressed() && !fmt.isTiled() && _bitsPerPixel == 32;
+}
+
+bool Image::canGenerateMipmaps()
+{
+	return isResamplable() 
+		&& PixelFormat::calcNextPot(_header.width) == _header.width
+		&& PixelFormat::calcNextPot(_header.height) == _header.height
+		&& _pitch == _header.width * 4;
+}
+
+static void ScaleContentArea(Image::Header& header, uint newWidth, uint newHeight)
+{
+	uint width = header.width;
+	uint height = header.height;
+
+	header.contentLeft		= uint16(header.contentLeft * newWidth / width);
+	header.contentTop		= uint16(header.contentTop * newHeight / height);
+	header.contentRight		= uint16(header.contentRight * newWidth / width);
+	header.contentBottom	= uint16(header.contentBottom * newHeight / height);
+}
+
+void Image::resize(uint16 width, uint16 height, PixelConverter::Filter filter, bool gammaCorrect)
+{
+	ASSERT_THROW(isResamplable(), EX_NOT_SUPPORTED);
+	ASSERT_THROW(width > 0 && height > 0, EX_INVALID_PARAMS);
+
+	if (width == _header.width && height == _header.height)
+		return;
+
+	uint newPitch = width * 4;
+	size_t newSize = height * newPitch;
+	uint8* newBuffer = Allocate(newSize);
+
+	if (newBuffer == NULL)
+		NIT_THROW(EX_MEMORY);
+
+	// Only the top level is resampled - mipmaps are discarded
+	PixelConverter::resample_8888(_pixelBuffer, _pitch, _header.width, _header.height, newBuffer, newPitch, width, height, filter, gammaCorrect);
+
+	ScaleContentArea(_header, width, height);
 
 	Deallocate(_pixelBuffer, _header.memorySize);
 	_pixelBuffer = newBuffer;
-	_header.memorySize = newSize;
-	_header.pixelFormat = newFmt;
 	_pitch = newPitch;
-	_bitsPerPixel = 16;
+	_header.memorySize = newSize;
+	_header.mipmapCount = 1;
+	_header.width = width;
+	_header.height = height;
+}
+
+void Image::generateMipmaps(PixelConverter::Filter filter, bool gammaCorrect)
+{
+	ASSERT_THROW(canGenerateMipmaps(), EX_NOT_SUPPORTED);
+
+	discardMipmaps();
+
+	int mipCount = PixelConverter::calcMipCount(_header.width, _header.height);
+	if (mipCount == 1) return;
+
+	size_t newSize = PixelConverter::calcMipChainSize(_header.width, _header.height, 4, mipCount);
+	uint8* newBuffer = Allocate(newSize);
+
+	if (newBuffer == NULL)
+		NIT_THROW(EX_MEMORY);
+
+	memcpy(newBuffer, _pixelBuffer, _header.memorySize);
+	PixelConverter::buildMipChain_8888(newBuffer, _header.width, _header.height, mipCount, filter, gammaCorrect);
+
+	Deallocate(_pixelBuffer, _header.memorySize);
+	_pixelBuffer = newBuffer;
+	_header.memorySize = newSize;
+	_header.mipmapCount = mipCount;
+}
+
+int Image::calcBudgetReduction(uint width, uint height, int bitsPerPixel, size_t budget, bool mipmaps)
+{
+	int count = 0;
+
+	while (width > 1 || height > 1)
+	{
+		size_t size = size_t(width) * height * bitsPerPixel / 8;
+		if (mipmaps) size = size * 4 / 3;
+
+		if (size <= budget) break;
+
+		width = std::max(1u, width >> 1);
+		height = std::max(1u, height >> 1);
+		++count;
+	}
+
+	return count;
+}
+
+int Image::fitToBudget(size_t budget, PixelConverter::Filter filter, bool gammaCorrect)
+{
+	ASSERT_THROW(_pixelBuffer, EX_INVALID_STATE);
+
+	if (_header.memorySize <= budget)
+		return 0;
+
+	int reduction = calcBudgetReduction(_header.width, _header.height, _bitsPerPixel, budget, _header.mipmapCount > 1);
+	int done = 0;
+
+	if (reduction > 0 && _header.mipmapCount > 1)
+	{
+		// Dropping top levels is cheap and works also for compressed formats
+		int drop = std::min(reduction, _header.mipmapCount - 1);
+
+		uint8* start = getMipData(drop);
+		size_t newSize = _header.memorySize - (start - _pixelBuffer);
+		uint8* newBuffer = Allocate(newSize);
+
+		if (newBuffer == NULL)
+			NIT_THROW(EX_MEMORY);
+
+		memcpy(newBuffer, start, newSize);
+
+		uint newWidth = getMipWidth(drop);
+		uint newHeight = getMipHeight(drop);
+		uint newPitch = getMipPitch(drop);
+
+		ScaleContentArea(_header, newWidth, newHeight);
+
+		Deallocate(_pixelBuffer, _header.memorySize);
+		_pixelBuffer = newBuffer;
+		_pitch = newPitch;
+		_header.memorySize = newSize;
+		_header.mipmapCount -= drop;
+		_header.width = newWidth;
+		_header.height = newHeight;
+
+		done = drop;
+	}
+
+	if (done < reduction)
+	{
+		if (!isResamplable())
+		{
+			LOG(0, "?? '%s': can't fit into %d bytes: %s not resamplable\n", 
+				getSourceUrl().c_str(), (int)budget, PixelFormat(_header.pixelFormat).getName().c_str());
+			return done;
+		}
+
+		int more = reduction - done;
+		resize(std::max(1, _header.width >> more), std::max(1, _header.height >> more), filter, gammaCorrect);
+		done = reduction;
+	}
+
+	if (done > 0)
+		LOG(0, ".. '%s': halved %d times to fit into %d bytes\n", getSourceUrl().c_str(), done, (int)budget);
+
+	return done;
 }
 
 void Image::SaveNtex(StreamWriter* writer, bool flipEndian)
@@ -1534,6 +1743,297 @@ void Image::Header::flipEndian()
 
 ////////////////////////////////////////////////////////////////////////////////
 
+class ImageDecoder::DecodeJob : public AsyncJob
+{
+public:
+	DecodeJob(ImageDecoder* decoder) : _decoder(decoder), _request(NULL) { }
+
+	virtual bool						isPrepared()							{ return true; }
+
+protected:
+	virtual bool						onPrepare()								{ return true; }
+
+	virtual bool						onExecute(bool async)
+	{
+		// Each job decodes the most urgent request at the time, not necessarily the one it was enqueued for
+		if (_decoder->pop(_request))
+			_decoder->decode(_request);
+
+		return true;
+	}
+
+	virtual void						onFinish()
+	{
+		if (_request)
+			_decoder->jobFinished(_request);
+
+		_request = NULL;
+	}
+
+private:
+	ImageDecoder*						_decoder;
+	Request*							_request;						// no Ref: see ImageDecoder::Request
+};
+
+ImageDecoder::ImageDecoder(const String& name, uint numWorkers)
+{
+	_jobs = new AsyncJobManager(name, numWorkers);
+	_nextSeq = 0;
+
+	resetStats();
+}
+
+void ImageDecoder::onDelete()
+{
+	// Requests keep their images' _decoder, so only canceled ones can be in flight here: join them first
+	_jobs->stop();
+	_jobs = NULL;
+
+	_inFlight.clear();
+
+	RefCounted::onDelete();
+}
+
+void ImageDecoder::resetStats()
+{
+	_decodedCount = 0;
+	_failedCount = 0;
+	_decodeTime = 0.0;
+	_stallTime = 0.0;
+}
+
+void ImageDecoder::request(Image* image, int priority)
+{
+	ASSERT_THROW(image && image->getSource(), EX_INVALID_PARAMS);
+
+	if (image->isLoaded())
+		return;
+
+	if (image->_decoder == this)
+		return raise(image, priority);
+
+	if (image->_decoder)
+		NIT_THROW_FMT(EX_INVALID_STATE, "'%s': decode already requested elsewhere", image->getSourceUrl().c_str());
+
+	Ref<Request> req = new Request();
+	req->image			= image;
+	req->priority		= priority;
+	req->seq			= _nextSeq++;
+	req->started		= false;
+	req->done			= false;
+	req->claimed		= false;
+	req->failed			= false;
+
+	// Decode into a private image, handOver() moves the buffer to the requester
+	req->decoded		= new Image(image->getSource(), image->_contentType);
+	req->decoded->_loadBudget = image->_loadBudget;
+	req->decoded->_srgb = image->_srgb;
+
+	_requests.insert(std::make_pair(image, req));
+	image->_decoder = this;
+
+	_mutex.lock();
+	_queue.push_back(req);
+	_mutex.unlock();
+
+	_jobs->enqueue(new DecodeJob(this));
+}
+
+void ImageDecoder::raise(Image* image, int priority)
+{
+	Requests::iterator itr = _requests.find(image);
+	if (itr == _requests.end()) return;
+
+	Mutex::ScopedLock lock(_mutex);
+
+	if (itr->second->priority < priority)
+		itr->second->priority = priority;
+}
+
+void ImageDecoder::cancel(Image* image)
+{
+	Requests::iterator itr = _requests.find(image);
+	if (itr == _requests.end()) return;
+
+	Ref<Request> req = itr->second;
+
+	_mutex.lock();
+	Queue::iterator q = std::find(_queue.begin(), _queue.end(), req.get());
+	bool queued = q != _queue.end();
+	if (queued)
+		_queue.erase(q);
+	_mutex.unlock();
+
+	req->claimed = true;
+	_requests.erase(itr);
+	image->_decoder = NULL;
+
+	// A worker took it already: keep it until its job finishes, jobFinished() drops it
+	if (!queued)
+		_inFlight.push_back(req);
+}
+
+bool ImageDecoder::pop(Request*& outRequest)
+{
+	Mutex::ScopedLock lock(_mutex);
+
+	if (_queue.empty())
+		return false;
+
+	// Highest priority first, then in request order
+	uint best = 0;
+	for (uint i = 1; i < _queue.size(); ++i)
+	{
+		Request* r = _queue[i];
+		if (r->priority > _queue[best]->priority || (r->priority == _queue[best]->priority && r->seq < _queue[best]->seq))
+			best = i;
+	}
+
+	outRequest = _queue[best];
+	_queue.erase(_queue.begin() + best);
+	outRequest->started = true;
+
+	return true;
+}
+
+void ImageDecoder::decode(Request* req)
+{
+	double start = SystemTimer::now();
+
+	// Runs on a worker: touch no refcount, the main thread releases 'decoded' on failure too
+	Image* decoded = req->decoded;
+
+	try
+	{
+		decoded->onLoad(true);
+		decoded->_headerLoaded = true;
+	}
+	catch (Exception& ex)
+	{
+		req->error = ex.getFullDescription();
+		req->failed = true;
+	}
+
+	double elapsed = SystemTimer::now() - start;
+
+	Mutex::ScopedLock lock(_mutex);
+
+	req->done = true;
+	_decodeTime += elapsed;
+
+	_decodeDone.broadcast();
+}
+
+void ImageDecoder::handOver(Request* req)
+{
+	if (req->claimed)
+		return;
+
+	Image* image = req->image;
+
+	req->claimed = true;
+	_requests.erase(image);
+	image->_decoder = NULL;
+
+	if (!req->failed)
+	{
+		if (!image->isLoaded() && !image->isDisposed())
+			image->adoptDecoded(req->decoded);
+
+		++_decodedCount;
+	}
+	else
+	{
+		// Leave it unloaded: a later load() retries and reports the error as usual
+		LOG(0, "*** '%s': can't decode: %s\n", image->getSourceUrl().c_str(), req->error.c_str());
+		++_failedCount;
+	}
+
+	req->decoded = NULL;
+}
+
+void ImageDecoder::jobFinished(Request* req)
+{
+	Ref<Request> safe = req;
+
+	handOver(req);
+
+	InFlight::iterator itr = std::find(_inFlight.begin(), _inFlight.end(), req);
+	if (itr != _inFlight.end())
+		_inFlight.erase(itr);
+}
+
+bool ImageDecoder::finish(Image* image)
+{
+	Requests::iterator itr = _requests.find(image);
+	if (itr == _requests.end()) return false;
+
+	Ref<Request> req = itr->second;
+
+	double start = SystemTimer::now();
+
+	_mutex.lock();
+	bool decodeHere = !req->started;
+	if (decodeHere)
+	{
+		_queue.erase(std::find(_queue.begin(), _queue.end(), req.get()));
+		req->started = true;
+	}
+	_mutex.unlock();
+
+	if (decodeHere)
+	{
+		decode(req);
+	}
+	else
+	{
+		// A worker is on it: wait for the result
+		Mutex::ScopedLock lock(_mutex);
+
+		while (!req->done)
+			_decodeDone.wait(_mutex);
+	}
+
+	bool decoded = !req->failed;
+
+	handOver(req);
+
+	// Its job still points at it until jobFinished()
+	if (!decodeHere)
+		_inFlight.push_back(req);
+
+	_stallTime += SystemTimer::now() - start;
+
+	return decoded;
+}
+
+void ImageDecoder::update()
+{
+	double start = SystemTimer::now();
+
+	// DecodeJob::onFinish() hands over each result
+	_jobs->update();
+
+	_stallTime += SystemTimer::now() - start;
+}
+
+void ImageDecoder::flush()
+{
+	double start = SystemTimer::now();
+
+	while (_jobs->getJobCount() > 0)
+	{
+		_jobs->update();
+
+		if (_jobs->getJobCount() > 0)
+			Thread::sleep(1);
+	}
+
+	_stallTime += SystemTimer::now() - start;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 ImageManager::ImageManager()
 : ContentManager("ImageManager", NULL)
 {
@@ -29,12 +29,16 @@
 
 #include "nit/content/PixelFormat.h"
 
+#include "nit/async/AsyncJob.h"
+#include "nit/async/Condition.h"
+
 NS_NIT_BEGIN;
 
 ////////////////////////////////////////////////////////////////////////////////
 
 class Image;
 class ImageManager;
+class ImageDecoder;
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -65,7 +69,7 @@ public:
 	{
 		uint8							extHeaderSize;		//  1  more bytes to read for extension header
 		uint8							mipmapCount;		//  2  total mipmap count. at least 1.
-		uint16							flags;				//  4  extension flag (ex: bordered)
+		uint16							flags;				//  4  extension flag (ex: bordered, FLAG_SRGB)
 
 		uint32							memorySize;			//  8  total memory occupation size for every surface + mipmap (except header)
 		PixelFormat::ValueType			pixelFormat;		// 12  combination of PixelFormat flags
@@ -117,6 +121,11 @@ public:
 		void							flipEndian();
 	};
 
+	enum HeaderFlag
+	{
+		FLAG_SRGB						= 0x0001,			// color data stored in sRGB: filtered in linear light (set by the bundler unless 'linear')
+	};
+
 public:
 	Image();
 	Image(const Header& header, uint8* pixelBuffer = NULL); // pixelBuffer will be deallocated by Deallocate()
@@ -139,6 +148,11 @@ public:
 
 	uint16								getFlags()								{ return _header.flags; }
 
+	// Color data in sRGB needs gamma-correct filtering, other data (normal maps, masks, ...) is linear by default.
+	// setSrgb() marks decoded color images (png, jpeg) which carry no FLAG_SRGB by themselves.
+	bool								isSrgb()								{ return _srgb || (_header.flags & FLAG_SRGB) != 0; }
+	void								setSrgb(bool flag)						{ _srgb = flag; }
+
 	uint16								getSourceWidth()						{ return _header.sourceWidth; }
 	uint16								getSourceHeight()						{ return _header.sourceHeight; }
 
@@ -148,10 +162,10 @@ public:
 	uint16								getContentBottom()						{ return _header.contentBottom; }
 
 	int									getMipCount()							{ return _header.mipmapCount; }
-	int									getMipWidth(int mipLevel)				{ return _header.width >> mipLevel; }
-	int									getMipHeight(int mipLevel)				{ return _header.height >> mipLevel; }
-	int									getMipPitch(int mipLevel)				{ return _pitch >> mipLevel; }
-	int									getMipByteCount(int mipLevel)			{ return getMipPitch(mipLevel) * _header.height; }
+	int									getMipWidth(int mipLevel)				{ return std::max(1, _header.width >> mipLevel); }
+	int									getMipHeight(int mipLevel)				{ return std::max(1, _header.height >> mipLevel); }
+	int									getMipPitch(int mipLevel)				{ return mipLevel == 0 ? _pitch : std::max(_bitsPerPixel >> 3, _pitch >> mipLevel); }
+	int									getMipByteCount(int mipLevel)			{ return getMipPitch(mipLevel) * getMipHeight(mipLevel); }
 	uint8*								getMipData(int mipLevel);
 
 public:									// Image Utility 
@@ -162,11 +176,32 @@ public:									// Image Utility
 	virtual void						makeAlphaPremultiplied();
 	virtual bool						makePot(bool square, uint16 min=4);
 	virtual void						reorderAsRgba();
-	virtual void						makeRgba_4444();
+	virtual void						makeRgba_4444(bool dither = false);
+	virtual void						makeRgb_565(bool dither = false);
+	virtual void						makeRgba_5551(bool dither = false);
+	virtual void						flipY();
+
+	// Resampling works on non-compressed 32 bpp formats
+	bool								isResamplable();
+	bool								canGenerateMipmaps();					// resamplable, pot and tightly packed
+	virtual void						resize(uint16 width, uint16 height, PixelConverter::Filter filter = PixelConverter::FILTER_CATMULLROM, bool gammaCorrect = false);
+	virtual void						generateMipmaps(PixelConverter::Filter filter = PixelConverter::FILTER_BOX, bool gammaCorrect = false);
+
+	// Halves the image until it fits into the budget (by dropping top mip levels if any, resampling otherwise)
+	// Returns how many times halved.
+	virtual int							fitToBudget(size_t budget, PixelConverter::Filter filter = PixelConverter::FILTER_BOX, bool gammaCorrect = false);
+	static int							calcBudgetReduction(uint width, uint height, int bitsPerPixel, size_t budget, bool mipmaps);
+
+	// When non zero, fitToBudget() is applied right after each load (gamma-correct if isSrgb())
+	size_t								getLoadBudget()							{ return _loadBudget; }
+	void								setLoadBudget(size_t budget)			{ _loadBudget = budget; }
 
 public:
 	virtual void						loadHeader();
 
+	// True while a background decode requested to an ImageDecoder is not handed over yet
+	bool								isDecodePending()						{ return _decoder != NULL; }
+
 public:
 	virtual void						SaveNtex(StreamWriter* writer, bool flipEndian = false);
 	virtual void						SavePng(StreamWriter* writer);
@@ -184,6 +219,16 @@ protected:
 	uint8*								_pixelBuffer;
 	uint16								_pitch;
 	uint8								_bitsPerPixel;
+	size_t								_loadBudget;
+	bool								_srgb;
+
+	friend class ImageDecoder;
+	Ref<ImageDecoder>					_decoder;
+
+	void								adoptDecoded(Image* decoded);
+
+	typedef void (*Convert8888Fn) (const uint8* src, uint srcPitch, uint8* dst, uint dstPitch, uint width, uint height, bool dither);
+	void								convert8888To16(PixelFormat newFmt, Convert8888Fn fn, bool dither);
 
 protected:								// Alloc customization : allocation into direct HWBuffer (dx?)
 	virtual uint8*						Allocate(size_t size);
@@ -199,6 +244,91 @@ protected:
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Decodes images on a pool of worker threads, the most urgent request first.
+// Decoded pixel buffers are moved into the requesting images on update() without copying.
+// Loading a pending image synchronously finishes its request on the spot instead of decoding twice.
+
+class NIT_API ImageDecoder : public RefCounted
+{
+public:
+	ImageDecoder(const String& name, uint numWorkers);
+
+public:
+	enum Priority
+	{
+		PRIORITY_LOW					= -100,
+		PRIORITY_NORMAL					= 0,
+		PRIORITY_URGENT					= 100,
+	};
+
+public:									// Main thread only
+	void								request(Image* image, int priority = PRIORITY_NORMAL);
+	void								raise(Image* image, int priority = PRIORITY_URGENT);
+	void								cancel(Image* image);
+	bool								finish(Image* image);
+
+	void								update();
+	void								flush();
+
+public:
+	uint								getWorkerCount()						{ return _jobs->getWorkerCount(); }
+	uint								getPendingCount()						{ return _requests.size(); }
+
+	uint								getDecodedCount()						{ return _decodedCount; }
+	uint								getFailedCount()						{ return _failedCount; }
+	double								getDecodeTime()							{ return _decodeTime; }		// seconds spent decoding, summed over workers
+	double								getStallTime()							{ return _stallTime; }		// seconds the main thread spent handing over or waiting
+	void								resetStats();
+
+protected:
+	virtual void						onDelete();
+
+private:
+	class DecodeJob;
+
+	// Refcounts are not thread safe: only the main thread holds Refs to a request or its images.
+	// A worker sees a request through a raw pointer, kept alive by _requests or _inFlight until its job finishes.
+	struct Request : public MTRefCounted
+	{
+		Image*							image;			// main thread only
+		int								priority;		// guarded by _mutex
+		uint							seq;
+
+		bool							started;		// guarded by _mutex
+		bool							done;			// guarded by _mutex
+		bool							claimed;		// main thread only
+
+		Ref<Image>						decoded;		// created on the main thread, loaded by the decoding thread
+		bool							failed;
+		String							error;
+	};
+
+	typedef map<Image*, Ref<Request> >::type Requests;
+	typedef vector<Request*>::type		Queue;
+	typedef vector<Ref<Request> >::type	InFlight;
+
+	Ref<AsyncJobManager>				_jobs;
+
+	Requests							_requests;
+	InFlight							_inFlight;		// claimed early while a worker still decodes them
+	Queue								_queue;
+	Mutex								_mutex;
+	Condition							_decodeDone;	// broadcast with _mutex held whenever a request is done
+	uint								_nextSeq;
+
+	uint								_decodedCount;
+	uint								_failedCount;
+	double								_decodeTime;
+	double								_stallTime;
+
+	bool								pop(Request*& outRequest);
+	void								decode(Request* req);
+	void								handOver(Request* req);
+	void								jobFinished(Request* req);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
 class NIT_API ImageManager : public ContentManager
 {
 public:
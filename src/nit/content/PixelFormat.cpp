@@ -24,6 +24,14 @@
 
 #include "nit/content/PixelFormat.h"
 
+#include "nit/platform/CpuFeatures.h"
+
+#if defined(NIT_SIMD_SSE2)
+#	include <emmintrin.h>
+#elif defined(NIT_SIMD_NEON)
+#	include <arm_neon.h>
+#endif
+
 NS_NIT_BEGIN;
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -157,4 +165,1270 @@ uint PixelFormat::calcNextPot(uint x)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+////////////////////////////////////////////////////////////////////////////////
+
+static const uint8 s_Bayer4x4[4][4] =
+{
+	{  0,  8,  2, 10 },
+	{ 12,  4, 14,  6 },
+	{  3, 11,  1,  9 },
+	{ 15,  7, 13,  5 },
+};
+
+// Ordered dither offset for a channel truncated to 'bits' (4 ~ 6 bits) : [0, 256 >> bits)
+static inline uint8 DitherOffset(uint x, uint y, int bits)
+{
+	return s_Bayer4x4[y & 3][x & 3] >> (bits - 4);
+}
+
+static inline uint8 AddSaturate(uint8 c, uint8 d)
+{
+	int v = c + d;
+	return v > 255 ? 255 : v;
+}
+
+struct Pack4444
+{
+	enum { R_BITS = 4, G_BITS = 4, B_BITS = 4 };
+
+	static inline uint16 pack(uint8 r, uint8 g, uint8 b, uint8 a)
+	{
+		PixelRGBA_4444 d;
+		d.a = a >> 4;
+		d.r = r >> 4;
+		d.g = g >> 4;
+		d.b = b >> 4;
+
+		uint16 v;
+		memcpy(&v, &d, sizeof(v));
+		return v;
+	}
+
+#if defined(NIT_SIMD_SSE2)
+	static inline __m128i sse2(__m128i v)
+	{
+		__m128i r = _mm_and_si128(_mm_srli_epi32(v, 4),  _mm_set1_epi32(0x000F));
+		__m128i g = _mm_and_si128(_mm_srli_epi32(v, 8),  _mm_set1_epi32(0x00F0));
+		__m128i b = _mm_and_si128(_mm_srli_epi32(v, 12), _mm_set1_epi32(0x0F00));
+		__m128i a = _mm_and_si128(_mm_srli_epi32(v, 16), _mm_set1_epi32(0xF000));
+		return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+	}
+#elif defined(NIT_SIMD_NEON)
+	static inline uint8x16x2_t neon(uint8x16x4_t px)
+	{
+		uint8x16x2_t d;
+		d.val[0] = vorrq_u8(vshrq_n_u8(px.val[0], 4), vandq_u8(px.val[1], vdupq_n_u8(0xF0)));
+		d.val[1] = vorrq_u8(vshrq_n_u8(px.val[2], 4), vandq_u8(px.val[3], vdupq_n_u8(0xF0)));
+		return d;
+	}
+#endif
+};
+
+struct Pack565
+{
+	enum { R_BITS = 5, G_BITS = 6, B_BITS = 5 };
+
+	static inline uint16 pack(uint8 r, uint8 g, uint8 b, uint8 a)
+	{
+		return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+	}
+
+#if defined(NIT_SIMD_SSE2)
+	static inline __m128i sse2(__m128i v)
+	{
+		__m128i r = _mm_slli_epi32(_mm_and_si128(v, _mm_set1_epi32(0x00F8)), 8);
+		__m128i g = _mm_srli_epi32(_mm_and_si128(v, _mm_set1_epi32(0xFC00)), 5);
+		__m128i b = _mm_and_si128(_mm_srli_epi32(v, 19), _mm_set1_epi32(0x001F));
+		return _mm_or_si128(_mm_or_si128(r, g), b);
+	}
+#elif defined(NIT_SIMD_NEON)
+	static inline uint8x16x2_t neon(uint8x16x4_t px)
+	{
+		uint8x16x2_t d;
+		d.val[0] = vorrq_u8(vandq_u8(vshlq_n_u8(px.val[1], 3), vdupq_n_u8(0xE0)), vshrq_n_u8(px.val[2], 3));
+		d.val[1] = vorrq_u8(vandq_u8(px.val[0], vdupq_n_u8(0xF8)), vshrq_n_u8(px.val[1], 5));
+		return d;
+	}
+#endif
+};
+
+struct Pack5551
+{
+	enum { R_BITS = 5, G_BITS = 5, B_BITS = 5 };
+
+	static inline uint16 pack(uint8 r, uint8 g, uint8 b, uint8 a)
+	{
+		return ((r >> 3) << 11) | ((g >> 3) << 6) | ((b >> 3) << 1) | (a >> 7);
+	}
+
+#if defined(NIT_SIMD_SSE2)
+	static inline __m128i sse2(__m128i v)
+	{
+		__m128i r = _mm_slli_epi32(_mm_and_si128(v, _mm_set1_epi32(0x00F8)), 8);
+		__m128i g = _mm_srli_epi32(_mm_and_si128(v, _mm_set1_epi32(0xF800)), 5);
+		__m128i b = _mm_and_si128(_mm_srli_epi32(v, 18), _mm_set1_epi32(0x003E));
+		__m128i a = _mm_srli_epi32(v, 31);
+		return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+	}
+#elif defined(NIT_SIMD_NEON)
+	static inline uint8x16x2_t neon(uint8x16x4_t px)
+	{
+		uint8x16x2_t d;
+		d.val[0] = vorrq_u8(
+			vorrq_u8(vshrq_n_u8(px.val[3], 7), vandq_u8(vshrq_n_u8(px.val[2], 2), vdupq_n_u8(0x3E))),
+			vandq_u8(vshlq_n_u8(px.val[1], 3), vdupq_n_u8(0xC0)));
+		d.val[1] = vorrq_u8(vandq_u8(px.val[0], vdupq_n_u8(0xF8)), vshrq_n_u8(px.val[1], 5));
+		return d;
+	}
+#endif
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Scalar kernels : reference implementations
+
+template <typename TPixel>
+static void PremultiplyScalar(uint8* buf, size_t count)
+{
+	TPixel* end = (TPixel*)buf + count;
+	for (TPixel* pix = (TPixel*)buf; pix < end; ++pix)
+	{
+		int a = pix->a + 1;
+		pix->r = (pix->r * a) >> TPixel::A_BITS;
+		pix->g = (pix->g * a) >> TPixel::A_BITS;
+		pix->b = (pix->b * a) >> TPixel::A_BITS;
+	}
+}
+
+template <typename TPixel>
+static void SwapRBScalar(uint8* buf, size_t count)
+{
+	TPixel* end = (TPixel*)buf + count;
+	for (TPixel* pix = (TPixel*)buf; pix < end; ++pix)
+	{
+		int t = pix->r;
+		pix->r = pix->b;
+		pix->b = t;
+	}
+}
+
+template <typename TPack>
+static void ConvertSpanScalar(const uint8* src, uint16* dst, uint x0, uint x1, uint y, bool dither)
+{
+	for (uint x = x0; x < x1; ++x)
+	{
+		const uint8* s = src + x * 4;
+		uint8 r = s[0], g = s[1], b = s[2], a = s[3];
+
+		if (dither)
+		{
+			r = AddSaturate(r, DitherOffset(x, y, TPack::R_BITS));
+			g = AddSaturate(g, DitherOffset(x, y, TPack::G_BITS));
+			b = AddSaturate(b, DitherOffset(x, y, TPack::B_BITS));
+		}
+
+		dst[x] = TPack::pack(r, g, b, a);
+	}
+}
+
+template <typename TPack>
+static void ConvertRowScalar(const uint8* src, uint16* dst, uint width, uint y, bool dither)
+{
+	ConvertSpanScalar<TPack>(src, dst, 0, width, y, dither);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Resampler works in 14 bit fixed point per channel and 14 bit weights.
+// Intermediate rows are int16 which leaves enough room for negative lobes.
+
+enum
+{
+	WORK_BITS							= 14,
+	WORK_MAX							= (1 << WORK_BITS) - 1,
+	WEIGHT_BITS							= 14,
+	WEIGHT_ONE							= 1 << WEIGHT_BITS,
+	WEIGHT_ROUND						= 1 << (WEIGHT_BITS - 1),
+};
+
+struct ResampleSpan
+{
+	uint								first;				// first source pixel
+	uint								count;				// number of taps
+	uint								weightIndex;		// into weight table
+};
+
+typedef void (*ResampleRowFn)(const int16* src, int16* dst, const ResampleSpan* spans, const int16* weights, uint dstWidth);
+typedef void (*ResampleColFn)(const int16* const* rows, const int16* weights, uint count, int16* dst, uint n);
+
+class ResampleTables
+{
+public:
+	uint16								toWork[2][256];				// [gammaCorrect][8 bit]
+	uint8								fromWork[2][WORK_MAX + 1];	// [gammaCorrect][work]
+
+	ResampleTables()
+	{
+		for (int c = 0; c < 256; ++c)
+		{
+			double s = c / 255.0;
+			double l = s <= 0.04045 ? s / 12.92 : pow((s + 0.055) / 1.055, 2.4);
+
+			toWork[0][c] = uint16((c * WORK_MAX + 127) / 255);
+			toWork[1][c] = uint16(l * WORK_MAX + 0.5);
+		}
+
+		for (int v = 0; v <= WORK_MAX; ++v)
+		{
+			double l = double(v) / WORK_MAX;
+			double s = l <= 0.0031308 ? l * 12.92 : 1.055 * pow(l, 1.0 / 2.4) - 0.055;
+
+			fromWork[0][v] = uint8((v * 255 + WORK_MAX / 2) / WORK_MAX);
+			fromWork[1][v] = uint8(std::min(255.0, s * 255.0 + 0.5));
+		}
+	}
+};
+
+static const ResampleTables s_ResampleTables;
+
+static inline int16 SaturateInt16(int v)
+{
+	return int16(v < -32768 ? -32768 : v > 32767 ? 32767 : v);
+}
+
+static double BesselI0(double x)
+{
+	double sum = 1.0, term = 1.0, half = x * 0.5;
+
+	for (int k = 1; k < 32; ++k)
+	{
+		term *= (half / k) * (half / k);
+		sum += term;
+		if (term < sum * 1e-12) break;
+	}
+
+	return sum;
+}
+
+static float FilterSupport(PixelConverter::Filter filter)
+{
+	switch (filter)
+	{
+	case PixelConverter::FILTER_BOX:		return 0.5f;
+	case PixelConverter::FILTER_BILINEAR:	return 1.0f;
+	case PixelConverter::FILTER_CATMULLROM:	return 2.0f;
+	case PixelConverter::FILTER_KAISER:		return 3.0f;
+	default:								NIT_THROW(EX_INVALID_PARAMS);
+	}
+}
+
+static float FilterWeight(PixelConverter::Filter filter, float x)
+{
+	float ax = fabsf(x);
+
+	switch (filter)
+	{
+	case PixelConverter::FILTER_BOX:
+		return (x >= -0.5f && x < 0.5f) ? 1.0f : 0.0f;
+
+	case PixelConverter::FILTER_BILINEAR:
+		return ax < 1.0f ? 1.0f - ax : 0.0f;
+
+	case PixelConverter::FILTER_CATMULLROM:
+		if (ax < 1.0f) return 1.5f * ax * ax * ax - 2.5f * ax * ax + 1.0f;
+		if (ax < 2.0f) return -0.5f * ax * ax * ax + 2.5f * ax * ax - 4.0f * ax + 2.0f;
+		return 0.0f;
+
+	case PixelConverter::FILTER_KAISER:
+		{
+			const float radius = 3.0f;
+			const double beta = 4.0;
+			const double pi = 3.14159265358979323846;
+
+			if (ax >= radius) return 0.0f;
+
+			double sinc = ax < 1e-6f ? 1.0 : sin(pi * ax) / (pi * ax);
+			double t = ax / radius;
+			return float(sinc * BesselI0(beta * sqrt(1.0 - t * t)) / BesselI0(beta));
+		}
+
+	default:
+		return 0.0f;
+	}
+}
+
+static void BuildResampleSpans(uint srcSize, uint dstSize, PixelConverter::Filter filter, vector<ResampleSpan>::type& outSpans, vector<int16>::type& outWeights)
+{
+	float scale = float(srcSize) / dstSize;
+	float filterScale = std::max(1.0f, scale);
+	float support = FilterSupport(filter) * filterScale;
+
+	outSpans.resize(dstSize);
+	outWeights.clear();
+
+	vector<float>::type w;
+
+	for (uint i = 0; i < dstSize; ++i)
+	{
+		float center = (i + 0.5f) * scale;
+		int left = int(floorf(center - support));
+		int right = int(ceilf(center + support));
+		int first = std::max(left, 0);
+		int last = std::min(right, int(srcSize) - 1);
+
+		w.assign(last - first + 1, 0.0f);
+		float total = 0.0f;
+
+		for (int j = left; j <= right; ++j)
+		{
+			float wt = FilterWeight(filter, (j + 0.5f - center) / filterScale);
+			if (wt == 0.0f) continue;
+
+			// Clamp to edge
+			w[std::min(std::max(j, first), last) - first] += wt;
+			total += wt;
+		}
+
+		if (total == 0.0f)
+		{
+			// Should not happen, but fallback to the nearest
+			w[std::min(std::max(int(center), first), last) - first] = total = 1.0f;
+		}
+
+		// Trim zero taps on both ends
+		int lo = 0, hi = int(w.size()) - 1;
+		while (lo < hi && w[lo] == 0.0f) ++lo;
+		while (hi > lo && w[hi] == 0.0f) --hi;
+
+		ResampleSpan& span = outSpans[i];
+		span.first = first + lo;
+		span.count = hi - lo + 1;
+		span.weightIndex = outWeights.size();
+
+		// Quantize and give the rounding error to the largest tap so that weights sum to exactly 1.0
+		int sum = 0, largest = 0;
+		for (int k = lo; k <= hi; ++k)
+		{
+			int q = int(floorf(w[k] / total * WEIGHT_ONE + 0.5f));
+			outWeights.push_back(int16(q));
+			sum += q;
+			if (abs(q) > abs(outWeights[span.weightIndex + largest]))
+				largest = k - lo;
+		}
+		outWeights[span.weightIndex + largest] += int16(WEIGHT_ONE - sum);
+	}
+}
+
+static void ResampleRowScalar(const int16* src, int16* dst, const ResampleSpan* spans, const int16* weights, uint dstWidth)
+{
+	for (uint x = 0; x < dstWidth; ++x)
+	{
+		const ResampleSpan& span = spans[x];
+		const int16* p = src + span.first * 4;
+		const int16* w = weights + span.weightIndex;
+
+		int acc[4] = { 0, 0, 0, 0 };
+
+		for (uint k = 0; k < span.count; ++k, p += 4)
+		{
+			acc[0] += w[k] * p[0];
+			acc[1] += w[k] * p[1];
+			acc[2] += w[k] * p[2];
+			acc[3] += w[k] * p[3];
+		}
+
+		for (int c = 0; c < 4; ++c)
+			dst[x * 4 + c] = SaturateInt16((acc[c] + WEIGHT_ROUND) >> WEIGHT_BITS);
+	}
+}
+
+static void ResampleColSpanScalar(const int16* const* rows, const int16* weights, uint count, int16* dst, uint begin, uint end)
+{
+	for (uint i = begin; i < end; ++i)
+	{
+		int acc = 0;
+		for (uint k = 0; k < count; ++k)
+			acc += weights[k] * rows[k][i];
+
+		int v = (acc + WEIGHT_ROUND) >> WEIGHT_BITS;
+		dst[i] = int16(v < 0 ? 0 : v > WORK_MAX ? WORK_MAX : v);
+	}
+}
+
+static void ResampleColScalar(const int16* const* rows, const int16* weights, uint count, int16* dst, uint n)
+{
+	ResampleColSpanScalar(rows, weights, count, dst, 0, n);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+#if defined(NIT_SIMD_SSE2)
+
+static void PremultiplySse2_8888(uint8* buf, size_t count)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi16(1);
+	const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+
+	size_t n = count & ~size_t(3);
+
+	for (size_t i = 0; i < n; i += 4)
+	{
+		__m128i* p = (__m128i*)(buf + i * 4);
+		__m128i px = _mm_loadu_si128(p);
+
+		__m128i lo = _mm_unpacklo_epi8(px, zero);
+		__m128i hi = _mm_unpackhi_epi8(px, zero);
+
+		// broadcast (a + 1) over each pixel's 4 lanes
+		__m128i alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		__m128i ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+		lo = _mm_srli_epi16(_mm_mullo_epi16(lo, _mm_add_epi16(alo, one)), 8);
+		hi = _mm_srli_epi16(_mm_mullo_epi16(hi, _mm_add_epi16(ahi, one)), 8);
+
+		__m128i res = _mm_packus_epi16(lo, hi);
+		res = _mm_or_si128(_mm_andnot_si128(alphaMask, res), _mm_and_si128(alphaMask, px));
+
+		_mm_storeu_si128(p, res);
+	}
+
+	PremultiplyScalar<PixelRGBA_8888>(buf + n * 4, count - n);
+}
+
+static void PremultiplySse2_4444(uint8* buf, size_t count)
+{
+	const __m128i nibble = _mm_set1_epi16(0x000F);
+	const __m128i one = _mm_set1_epi16(1);
+
+	size_t n = count & ~size_t(7);
+
+	for (size_t i = 0; i < n; i += 8)
+	{
+		__m128i* p = (__m128i*)(buf + i * 2);
+		__m128i v = _mm_loadu_si128(p);
+
+		__m128i a = _mm_srli_epi16(v, 12);
+		__m128i a1 = _mm_add_epi16(a, one);
+
+		__m128i r = _mm_srli_epi16(_mm_mullo_epi16(_mm_and_si128(v, nibble), a1), 4);
+		__m128i g = _mm_srli_epi16(_mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(v, 4), nibble), a1), 4);
+		__m128i b = _mm_srli_epi16(_mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(v, 8), nibble), a1), 4);
+
+		__m128i res = _mm_or_si128(
+			_mm_or_si128(r, _mm_slli_epi16(g, 4)),
+			_mm_or_si128(_mm_slli_epi16(b, 8), _mm_slli_epi16(a, 12)));
+
+		_mm_storeu_si128(p, res);
+	}
+
+	PremultiplyScalar<PixelRGBA_4444>(buf + n * 2, count - n);
+}
+
+static void SwapRBSse2_8888(uint8* buf, size_t count)
+{
+	const __m128i keep = _mm_set1_epi32((int)0xFF00FF00);
+	const __m128i low = _mm_set1_epi32(0x000000FF);
+
+	size_t n = count & ~size_t(3);
+
+	for (size_t i = 0; i < n; i += 4)
+	{
+		__m128i* p = (__m128i*)(buf + i * 4);
+		__m128i v = _mm_loadu_si128(p);
+
+		__m128i res = _mm_or_si128(
+			_mm_and_si128(v, keep),
+			_mm_or_si128(_mm_and_si128(_mm_srli_epi32(v, 16), low), _mm_slli_epi32(_mm_and_si128(v, low), 16)));
+
+		_mm_storeu_si128(p, res);
+	}
+
+	SwapRBScalar<PixelRGBA_8888>(buf + n * 4, count - n);
+}
+
+static void SwapRBSse2_4444(uint8* buf, size_t count)
+{
+	const __m128i keep = _mm_set1_epi16((short)0xF0F0);
+	const __m128i nibble = _mm_set1_epi16(0x000F);
+
+	size_t n = count & ~size_t(7);
+
+	for (size_t i = 0; i < n; i += 8)
+	{
+		__m128i* p = (__m128i*)(buf + i * 2);
+		__m128i v = _mm_loadu_si128(p);
+
+		__m128i res = _mm_or_si128(
+			_mm_and_si128(v, keep),
+			_mm_or_si128(_mm_and_si128(_mm_srli_epi16(v, 8), nibble), _mm_slli_epi16(_mm_and_si128(v, nibble), 8)));
+
+		_mm_storeu_si128(p, res);
+	}
+
+	SwapRBScalar<PixelRGBA_4444>(buf + n * 2, count - n);
+}
+
+// Narrows two sets of 4 x uint32 (upper 16 bits zero) into 8 x uint16
+static inline __m128i NarrowSse2(__m128i a, __m128i b)
+{
+	// packs_epi32 saturates as signed, so sign-extend the lower 16 bits first
+	a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+	b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+	return _mm_packs_epi32(a, b);
+}
+
+template <typename TPack>
+static void ConvertRowSse2(const uint8* src, uint16* dst, uint width, uint y, bool dither)
+{
+	// The dither pattern repeats each 4 pixels, which matches a 16 byte register
+	uint8 offsets[16] = { 0 };
+	if (dither)
+	{
+		for (uint x = 0; x < 4; ++x)
+		{
+			offsets[x * 4 + 0] = DitherOffset(x, y, TPack::R_BITS);
+			offsets[x * 4 + 1] = DitherOffset(x, y, TPack::G_BITS);
+			offsets[x * 4 + 2] = DitherOffset(x, y, TPack::B_BITS);
+		}
+	}
+
+	const __m128i ditherVec = _mm_loadu_si128((const __m128i*)offsets);
+
+	uint n = width & ~7u;
+
+	for (uint x = 0; x < n; x += 8)
+	{
+		__m128i a = _mm_adds_epu8(_mm_loadu_si128((const __m128i*)(src + x * 4)), ditherVec);
+		__m128i b = _mm_adds_epu8(_mm_loadu_si128((const __m128i*)(src + x * 4 + 16)), ditherVec);
+
+		_mm_storeu_si128((__m128i*)(dst + x), NarrowSse2(TPack::sse2(a), TPack::sse2(b)));
+	}
+
+	ConvertSpanScalar<TPack>(src, dst, n, width, y, dither);
+}
+
+static void ResampleRowSse2(const int16* src, int16* dst, const ResampleSpan* spans, const int16* weights, uint dstWidth)
+{
+	const __m128i round = _mm_set1_epi32(WEIGHT_ROUND);
+
+	for (uint x = 0; x < dstWidth; ++x)
+	{
+		const ResampleSpan& span = spans[x];
+		const int16* p = src + span.first * 4;
+		const int16* w = weights + span.weightIndex;
+
+		__m128i acc = _mm_setzero_si128();
+
+		for (uint k = 0; k < span.count; ++k, p += 4)
+		{
+			__m128i v = _mm_loadl_epi64((const __m128i*)p);
+			__m128i wv = _mm_set1_epi16(w[k]);
+
+			// exact 16 x 16 -> 32 products of the 4 channels
+			__m128i lo = _mm_mullo_epi16(v, wv);
+			__m128i hi = _mm_mulhi_epi16(v, wv);
+			acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(lo, hi));
+		}
+
+		acc = _mm_srai_epi32(_mm_add_epi32(acc, round), WEIGHT_BITS);
+		_mm_storel_epi64((__m128i*)(dst + x * 4), _mm_packs_epi32(acc, acc));
+	}
+}
+
+static void ResampleColSse2(const int16* const* rows, const int16* weights, uint count, int16* dst, uint n)
+{
+	const __m128i round = _mm_set1_epi32(WEIGHT_ROUND);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i maxValue = _mm_set1_epi16(WORK_MAX);
+
+	uint n8 = n & ~7u;
+
+	for (uint i = 0; i < n8; i += 8)
+	{
+		__m128i acc0 = _mm_setzero_si128();
+		__m128i acc1 = _mm_setzero_si128();
+
+		for (uint k = 0; k < count; ++k)
+		{
+			__m128i v = _mm_loadu_si128((const __m128i*)(rows[k] + i));
+			__m128i wv = _mm_set1_epi16(weights[k]);
+
+			__m128i lo = _mm_mullo_epi16(v, wv);
+			__m128i hi = _mm_mulhi_epi16(v, wv);
+			acc0 = _mm_add_epi32(acc0, _mm_unpacklo_epi16(lo, hi));
+			acc1 = _mm_add_epi32(acc1, _mm_unpackhi_epi16(lo, hi));
+		}
+
+		acc0 = _mm_srai_epi32(_mm_add_epi32(acc0, round), WEIGHT_BITS);
+		acc1 = _mm_srai_epi32(_mm_add_epi32(acc1, round), WEIGHT_BITS);
+
+		__m128i res = _mm_packs_epi32(acc0, acc1);
+		res = _mm_min_epi16(_mm_max_epi16(res, zero), maxValue);
+
+		_mm_storeu_si128((__m128i*)(dst + i), res);
+	}
+
+	ResampleColSpanScalar(rows, weights, count, dst, n8, n);
+}
+
+#endif // #if defined(NIT_SIMD_SSE2)
+
+////////////////////////////////////////////////////////////////////////////////
+
+#if defined(NIT_SIMD_NEON)
+
+static void PremultiplyNeon_8888(uint8* buf, size_t count)
+{
+	const uint16x8_t one = vdupq_n_u16(1);
+
+	size_t n = count & ~size_t(15);
+
+	for (size_t i = 0; i < n; i += 16)
+	{
+		uint8* p = buf + i * 4;
+		uint8x16x4_t px = vld4q_u8(p);
+
+		uint16x8_t alo = vaddw_u8(one, vget_low_u8(px.val[3]));
+		uint16x8_t ahi = vaddw_u8(one, vget_high_u8(px.val[3]));
+
+		for (int c = 0; c < 3; ++c)
+		{
+			uint8x8_t lo = vshrn_n_u16(vmulq_u16(vmovl_u8(vget_low_u8(px.val[c])), alo), 8);
+			uint8x8_t hi = vshrn_n_u16(vmulq_u16(vmovl_u8(vget_high_u8(px.val[c])), ahi), 8);
+			px.val[c] = vcombine_u8(lo, hi);
+		}
+
+		vst4q_u8(p, px);
+	}
+
+	PremultiplyScalar<PixelRGBA_8888>(buf + n * 4, count - n);
+}
+
+static void PremultiplyNeon_4444(uint8* buf, size_t count)
+{
+	const uint16x8_t nibble = vdupq_n_u16(0x000F);
+	const uint16x8_t one = vdupq_n_u16(1);
+
+	size_t n = count & ~size_t(7);
+
+	for (size_t i = 0; i < n; i += 8)
+	{
+		uint16* p = (uint16*)(buf + i * 2);
+		uint16x8_t v = vld1q_u16(p);
+
+		uint16x8_t a = vshrq_n_u16(v, 12);
+		uint16x8_t a1 = vaddq_u16(a, one);
+
+		uint16x8_t r = vshrq_n_u16(vmulq_u16(vandq_u16(v, nibble), a1), 4);
+		uint16x8_t g = vshrq_n_u16(vmulq_u16(vandq_u16(vshrq_n_u16(v, 4), nibble), a1), 4);
+		uint16x8_t b = vshrq_n_u16(vmulq_u16(vandq_u16(vshrq_n_u16(v, 8), nibble), a1), 4);
+
+		v = vorrq_u16(vorrq_u16(r, vshlq_n_u16(g, 4)), vorrq_u16(vshlq_n_u16(b, 8), vshlq_n_u16(a, 12)));
+		vst1q_u16(p, v);
+	}
+
+	PremultiplyScalar<PixelRGBA_4444>(buf + n * 2, count - n);
+}
+
+static void SwapRBNeon_8888(uint8* buf, size_t count)
+{
+	size_t n = count & ~size_t(15);
+
+	for (size_t i = 0; i < n; i += 16)
+	{
+		uint8* p = buf + i * 4;
+		uint8x16x4_t px = vld4q_u8(p);
+
+		uint8x16_t t = px.val[0];
+		px.val[0] = px.val[2];
+		px.val[2] = t;
+
+		vst4q_u8(p, px);
+	}
+
+	SwapRBScalar<PixelRGBA_8888>(buf + n * 4, count - n);
+}
+
+static void SwapRBNeon_4444(uint8* buf, size_t count)
+{
+	const uint16x8_t keep = vdupq_n_u16(0xF0F0);
+	const uint16x8_t nibble = vdupq_n_u16(0x000F);
+
+	size_t n = count & ~size_t(7);
+
+	for (size_t i = 0; i < n; i += 8)
+	{
+		uint16* p = (uint16*)(buf + i * 2);
+		uint16x8_t v = vld1q_u16(p);
+
+		v = vorrq_u16(
+			vandq_u16(v, keep),
+			vorrq_u16(vandq_u16(vshrq_n_u16(v, 8), nibble), vshlq_n_u16(vandq_u16(v, nibble), 8)));
+
+		vst1q_u16(p, v);
+	}
+
+	SwapRBScalar<PixelRGBA_4444>(buf + n * 2, count - n);
+}
+
+template <typename TPack>
+static void ConvertRowNeon(const uint8* src, uint16* dst, uint width, uint y, bool dither)
+{
+	uint8 dr[16] = { 0 }, dg[16] = { 0 }, db[16] = { 0 };
+	if (dither)
+	{
+		for (uint x = 0; x < 16; ++x)
+		{
+			dr[x] = DitherOffset(x, y, TPack::R_BITS);
+			dg[x] = DitherOffset(x, y, TPack::G_BITS);
+			db[x] = DitherOffset(x, y, TPack::B_BITS);
+		}
+	}
+
+	const uint8x16_t vdr = vld1q_u8(dr);
+	const uint8x16_t vdg = vld1q_u8(dg);
+	const uint8x16_t vdb = vld1q_u8(db);
+
+	uint n = width & ~15u;
+
+	for (uint x = 0; x < n; x += 16)
+	{
+		uint8x16x4_t px = vld4q_u8(src + x * 4);
+		px.val[0] = vqaddq_u8(px.val[0], vdr);
+		px.val[1] = vqaddq_u8(px.val[1], vdg);
+		px.val[2] = vqaddq_u8(px.val[2], vdb);
+
+		// interleaving (lo, hi) bytes yields little endian uint16
+		vst2q_u8((uint8*)(dst + x), TPack::neon(px));
+	}
+
+	ConvertSpanScalar<TPack>(src, dst, n, width, y, dither);
+}
+
+static void ResampleRowNeon(const int16* src, int16* dst, const ResampleSpan* spans, const int16* weights, uint dstWidth)
+{
+	for (uint x = 0; x < dstWidth; ++x)
+	{
+		const ResampleSpan& span = spans[x];
+		const int16* p = src + span.first * 4;
+		const int16* w = weights + span.weightIndex;
+
+		int32x4_t acc = vdupq_n_s32(0);
+
+		for (uint k = 0; k < span.count; ++k, p += 4)
+			acc = vmlal_n_s16(acc, vld1_s16(p), w[k]);
+
+		vst1_s16(dst + x * 4, vqmovn_s32(vrshrq_n_s32(acc, WEIGHT_BITS)));
+	}
+}
+
+static void ResampleColNeon(const int16* const* rows, const int16* weights, uint count, int16* dst, uint n)
+{
+	const int16x8_t zero = vdupq_n_s16(0);
+	const int16x8_t maxValue = vdupq_n_s16(WORK_MAX);
+
+	uint n8 = n & ~7u;
+
+	for (uint i = 0; i < n8; i += 8)
+	{
+		int32x4_t acc0 = vdupq_n_s32(0);
+		int32x4_t acc1 = vdupq_n_s32(0);
+
+		for (uint k = 0; k < count; ++k)
+		{
+			int16x8_t v = vld1q_s16(rows[k] + i);
+			acc0 = vmlal_n_s16(acc0, vget_low_s16(v), weights[k]);
+			acc1 = vmlal_n_s16(acc1, vget_high_s16(v), weights[k]);
+		}
+
+		int16x8_t res = vcombine_s16(vqmovn_s32(vrshrq_n_s32(acc0, WEIGHT_BITS)), vqmovn_s32(vrshrq_n_s32(acc1, WEIGHT_BITS)));
+		res = vminq_s16(vmaxq_s16(res, zero), maxValue);
+
+		vst1q_s16(dst + i, res);
+	}
+
+	ResampleColSpanScalar(rows, weights, count, dst, n8, n);
+}
+
+#endif // #if defined(NIT_SIMD_NEON)
+
+////////////////////////////////////////////////////////////////////////////////
+
+typedef void (*PixelSpanFn)(uint8* buf, size_t count);
+typedef void (*ConvertRowFn)(const uint8* src, uint16* dst, uint width, uint y, bool dither);
+
+struct PixelKernels
+{
+	const char*							name;
+
+	PixelSpanFn							premultiply_8888;
+	PixelSpanFn							premultiply_4444;
+	PixelSpanFn							swapRB_8888;
+	PixelSpanFn							swapRB_4444;
+
+	ConvertRowFn						convert4444;
+	ConvertRowFn						convert565;
+	ConvertRowFn						convert5551;
+
+	ResampleRowFn						resampleRow;
+	ResampleColFn						resampleCol;
+};
+
+static const PixelKernels s_ScalarKernels =
+{
+	"scalar",
+	PremultiplyScalar<PixelRGBA_8888>,
+	PremultiplyScalar<PixelRGBA_4444>,
+	SwapRBScalar<PixelRGBA_8888>,
+	SwapRBScalar<PixelRGBA_4444>,
+	ConvertRowScalar<Pack4444>,
+	ConvertRowScalar<Pack565>,
+	ConvertRowScalar<Pack5551>,
+	ResampleRowScalar,
+	ResampleColScalar,
+};
+
+#if defined(NIT_SIMD_SSE2)
+
+static const PixelKernels s_SimdKernels =
+{
+	"sse2",
+	PremultiplySse2_8888,
+	PremultiplySse2_4444,
+	SwapRBSse2_8888,
+	SwapRBSse2_4444,
+	ConvertRowSse2<Pack4444>,
+	ConvertRowSse2<Pack565>,
+	ConvertRowSse2<Pack5551>,
+	ResampleRowSse2,
+	ResampleColSse2,
+};
+
+static bool HasSimd()
+{
+	return CpuFeatures::hasSse2();
+}
+
+#elif defined(NIT_SIMD_NEON)
+
+static const PixelKernels s_SimdKernels =
+{
+	"neon",
+	PremultiplyNeon_8888,
+	PremultiplyNeon_4444,
+	SwapRBNeon_8888,
+	SwapRBNeon_4444,
+	ConvertRowNeon<Pack4444>,
+	ConvertRowNeon<Pack565>,
+	ConvertRowNeon<Pack5551>,
+	ResampleRowNeon,
+	ResampleColNeon,
+};
+
+static bool HasSimd()
+{
+	return CpuFeatures::hasNeon();
+}
+
+#else
+
+static const PixelKernels& s_SimdKernels = s_ScalarKernels;
+
+static bool HasSimd()
+{
+	return false;
+}
+
+#endif
+
+static bool s_SimdEnabled = true;
+
+static inline const PixelKernels& GetKernels()
+{
+	return s_SimdEnabled && HasSimd() ? s_SimdKernels : s_ScalarKernels;
+}
+
+static void ConvertImage(ConvertRowFn fn, const uint8* src, uint srcPitch, uint8* dst, uint dstPitch, uint width, uint height, bool dither)
+{
+	for (uint y = 0; y < height; ++y)
+		fn(src + y * srcPitch, (uint16*)(dst + y * dstPitch), width, y, dither);
+}
+
+static void Resample(const PixelKernels& kernels, const uint8* src, uint srcPitch, uint srcWidth, uint srcHeight, uint8* dst, uint dstPitch, uint dstWidth, uint dstHeight, PixelConverter::Filter filter, bool gammaCorrect)
+{
+	if (srcWidth == 0 || srcHeight == 0 || dstWidth == 0 || dstHeight == 0) return;
+
+	vector<ResampleSpan>::type spansX, spansY;
+	vector<int16>::type weightsX, weightsY;
+
+	BuildResampleSpans(srcWidth, dstWidth, filter, spansX, weightsX);
+	BuildResampleSpans(srcHeight, dstHeight, filter, spansY, weightsY);
+
+	// Horizontally resampled source rows are kept in a ring, as each destination row needs a sliding window of them
+	uint ringSize = 1;
+	for (uint y = 0; y < dstHeight; ++y)
+		ringSize = std::max(ringSize, spansY[y].count);
+
+	uint n = dstWidth * 4;
+
+	vector<int16>::type line(srcWidth * 4);
+	vector<int16>::type ring(ringSize * n);
+	vector<int>::type ringRows(ringSize, -1);
+	vector<const int16*>::type rows(ringSize);
+	vector<int16>::type out(n);
+
+	const uint16* toColor = s_ResampleTables.toWork[gammaCorrect ? 1 : 0];
+	const uint16* toAlpha = s_ResampleTables.toWork[0];
+	const uint8* fromColor = s_ResampleTables.fromWork[gammaCorrect ? 1 : 0];
+	const uint8* fromAlpha = s_ResampleTables.fromWork[0];
+
+	for (uint y = 0; y < dstHeight; ++y)
+	{
+		const ResampleSpan& span = spansY[y];
+
+		for (uint k = 0; k < span.count; ++k)
+		{
+			int row = span.first + k;
+			int16* slot = &ring[(row % ringSize) * n];
+
+			if (ringRows[row % ringSize] != row)
+			{
+				const uint8* s = src + row * srcPitch;
+				for (uint i = 0; i < srcWidth * 4; i += 4)
+				{
+					line[i + 0] = toColor[s[i + 0]];
+					line[i + 1] = toColor[s[i + 1]];
+					line[i + 2] = toColor[s[i + 2]];
+					line[i + 3] = toAlpha[s[i + 3]];
+				}
+
+				kernels.resampleRow(&line[0], slot, &spansX[0], &weightsX[0], dstWidth);
+				ringRows[row % ringSize] = row;
+			}
+
+			rows[k] = slot;
+		}
+
+		kernels.resampleCol(&rows[0], &weightsY[span.weightIndex], span.count, &out[0], n);
+
+		uint8* d = dst + y * dstPitch;
+		for (uint i = 0; i < n; i += 4)
+		{
+			d[i + 0] = fromColor[out[i + 0]];
+			d[i + 1] = fromColor[out[i + 1]];
+			d[i + 2] = fromColor[out[i + 2]];
+			d[i + 3] = fromAlpha[out[i + 3]];
+		}
+	}
+}
+
+static void BuildMipChain(const PixelKernels& kernels, uint8* chain, uint width, uint height, int mipCount, PixelConverter::Filter filter, bool gammaCorrect)
+{
+	uint8* src = chain;
+
+	for (int level = 1; level < mipCount; ++level)
+	{
+		uint8* dst = src + width * height * 4;
+		uint mipWidth = std::max(1u, width >> 1);
+		uint mipHeight = std::max(1u, height >> 1);
+
+		Resample(kernels, src, width * 4, width, height, dst, mipWidth * 4, mipWidth, mipHeight, filter, gammaCorrect);
+
+		src = dst;
+		width = mipWidth;
+		height = mipHeight;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void PixelConverter::premultiply_8888(uint8* buf, size_t count)
+{
+	GetKernels().premultiply_8888(buf, count);
+}
+
+void PixelConverter::premultiply_4444(uint8* buf, size_t count)
+{
+	GetKernels().premultiply_4444(buf, count);
+}
+
+void PixelConverter::swapRB_8888(uint8* buf, size_t count)
+{
+	GetKernels().swapRB_8888(buf, count);
+}
+
+void PixelConverter::swapRB_4444(uint8* buf, size_t count)
+{
+	GetKernels().swapRB_4444(buf, count);
+}
+
+void PixelConverter::convert8888to4444(const uint8* src, uint srcPitch, uint8* dst, uint dstPitch, uint width, uint height, bool dither)
+{
+	ConvertImage(GetKernels().convert4444, src, srcPitch, dst, dstPitch, width, height, dither);
+}
+
+void PixelConverter::convert8888to565(const uint8* src, uint srcPitch, uint8* dst, uint dstPitch, uint width, uint height, bool dither)
+{
+	ConvertImage(GetKernels().convert565, src, srcPitch, dst, dstPitch, width, height, dither);
+}
+
+void PixelConverter::convert8888to5551(const uint8* src, uint srcPitch, uint8* dst, uint dstPitch, uint width, uint height, bool dither)
+{
+	ConvertImage(GetKernels().convert5551, src, srcPitch, dst, dstPitch, width, height, dither);
+}
+
+void PixelConverter::flipY(uint8* buf, uint pitch, uint height)
+{
+	if (height < 2) return;
+
+	// memcpy is already vectorized by the crt, so just swap rows through a small chunk
+	uint8 chunk[1024];
+
+	uint8* top = buf;
+	uint8* bottom = buf + (height - 1) * pitch;
+
+	for (; top < bottom; top += pitch, bottom -= pitch)
+	{
+		for (uint offset = 0; offset < pitch; offset += sizeof(chunk))
+		{
+			size_t len = std::min(sizeof(chunk), size_t(pitch - offset));
+			memcpy(chunk, top + offset, len);
+			memcpy(top + offset, bottom + offset, len);
+			memcpy(bottom + offset, chunk, len);
+		}
+	}
+}
+
+void PixelConverter::resample_8888(const uint8* src, uint srcPitch, uint srcWidth, uint srcHeight, uint8* dst, uint dstPitch, uint dstWidth, uint dstHeight, Filter filter, bool gammaCorrect)
+{
+	Resample(GetKernels(), src, srcPitch, srcWidth, srcHeight, dst, dstPitch, dstWidth, dstHeight, filter, gammaCorrect);
+}
+
+int PixelConverter::calcMipCount(uint width, uint height)
+{
+	uint size = std::max(width, height);
+
+	int count = 1;
+	for (; size > 1; size >>= 1)
+		++count;
+
+	return count;
+}
+
+size_t PixelConverter::calcMipChainSize(uint width, uint height, uint bytesPerPixel, int mipCount)
+{
+	size_t total = 0;
+
+	for (int level = 0; level < mipCount; ++level)
+		total += size_t(std::max(1u, width >> level)) * std::max(1u, height >> level) * bytesPerPixel;
+
+	return total;
+}
+
+void PixelConverter::buildMipChain_8888(uint8* chain, uint width, uint height, int mipCount, Filter filter, bool gammaCorrect)
+{
+	BuildMipChain(GetKernels(), chain, width, height, mipCount, filter, gammaCorrect);
+}
+
+const char* PixelConverter::getSimdName()
+{
+	return isSimdEnabled() ? s_SimdKernels.name : "none";
+}
+
+bool PixelConverter::isSimdEnabled()
+{
+	return s_SimdEnabled && HasSimd();
+}
+
+void PixelConverter::setSimdEnabled(bool flag)
+{
+	s_SimdEnabled = flag;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+#if defined(NIT_TESTS)
+
+static void FillRandom(vector<uint8>::type& buf, uint& seed)
+{
+	for (size_t i = 0; i < buf.size(); ++i)
+	{
+		seed = seed * 1103515245 + 12345;
+		buf[i] = uint8(seed >> 16);
+	}
+}
+
+static bool CheckSame(const char* kernel, const vector<uint8>::type& expected, const vector<uint8>::type& actual)
+{
+	if (expected == actual) return true;
+
+	size_t pos = 0;
+	while (expected[pos] == actual[pos]) ++pos;
+
+	LOG(0, "*** PixelConverter: '%s' mismatch at byte %d: scalar %02X, %s %02X\n",
+		kernel, (int)pos, expected[pos], s_SimdKernels.name, actual[pos]);
+
+	return false;
+}
+
+bool PixelConverter::selfTest(uint seed)
+{
+	if (!HasSimd())
+	{
+		LOG(0, ".. PixelConverter: no simd kernels to test\n");
+		return true;
+	}
+
+	// Odd size to exercise scalar tails after vector loops
+	const uint width = 67;
+	const uint height = 13;
+	const size_t count = width * height;
+
+	vector<uint8>::type src(count * 4);
+	FillRandom(src, seed);
+
+	// Make sure that the edge values are covered
+	for (uint i = 0; i < 16; ++i)
+	{
+		src[i * 4 + 0] = (i & 1) ? 0xFF : 0x00;
+		src[i * 4 + 1] = (i & 2) ? 0xFF : 0x00;
+		src[i * 4 + 2] = (i & 4) ? 0xFF : 0x00;
+		src[i * 4 + 3] = (i & 8) ? 0xFF : 0x00;
+	}
+
+	const PixelKernels& ref = s_ScalarKernels;
+	const PixelKernels& simd = s_SimdKernels;
+
+	bool ok = true;
+	vector<uint8>::type expected, actual;
+
+	expected = actual = src;
+	ref.premultiply_8888(&expected[0], count);
+	simd.premultiply_8888(&actual[0], count);
+	ok = CheckSame("premultiply_8888", expected, actual) && ok;
+
+	expected = actual = src;
+	ref.premultiply_4444(&expected[0], count * 2);
+	simd.premultiply_4444(&actual[0], count * 2);
+	ok = CheckSame("premultiply_4444", expected, actual) && ok;
+
+	expected = actual = src;
+	ref.swapRB_8888(&expected[0], count);
+	simd.swapRB_8888(&actual[0], count);
+	ok = CheckSame("swapRB_8888", expected, actual) && ok;
+
+	expected = actual = src;
+	ref.swapRB_4444(&expected[0], count * 2);
+	simd.swapRB_4444(&actual[0], count * 2);
+	ok = CheckSame("swapRB_4444", expected, actual) && ok;
+
+	struct { const char* name; ConvertRowFn ref, simd; } converts[] =
+	{
+		{ "convert8888to4444", ref.convert4444, simd.convert4444 },
+		{ "convert8888to565",  ref.convert565,  simd.convert565 },
+		{ "convert8888to5551", ref.convert5551, simd.convert5551 },
+	};
+
+	for (uint i = 0; i < COUNT_OF(converts); ++i)
+	{
+		for (int dither = 0; dither < 2; ++dither)
+		{
+			expected.assign(count * 2, 0);
+			actual.assign(count * 2, 0);
+			ConvertImage(converts[i].ref, &src[0], width * 4, &expected[0], width * 2, width, height, dither != 0);
+			ConvertImage(converts[i].simd, &src[0], width * 4, &actual[0], width * 2, width, height, dither != 0);
+			ok = CheckSame(converts[i].name, expected, actual) && ok;
+		}
+	}
+
+	const char* filterNames[] = { "resample_box", "resample_bilinear", "resample_catmullrom", "resample_kaiser" };
+	const uint sizes[][2] = { { 31, 7 }, { 100, 20 } };
+
+	for (uint f = 0; f < COUNT_OF(filterNames); ++f)
+	{
+		for (uint i = 0; i < COUNT_OF(sizes); ++i)
+		{
+			for (int gamma = 0; gamma < 2; ++gamma)
+			{
+				uint dw = sizes[i][0], dh = sizes[i][1];
+				expected.assign(dw * dh * 4, 0);
+				actual.assign(dw * dh * 4, 0);
+				Resample(ref, &src[0], width * 4, width, height, &expected[0], dw * 4, dw, dh, Filter(f), gamma != 0);
+				Resample(simd, &src[0], width * 4, width, height, &actual[0], dw * 4, dw, dh, Filter(f), gamma != 0);
+				ok = CheckSame(filterNames[f], expected, actual) && ok;
+			}
+		}
+	}
+
+	if (ok)
+		LOG(0, ".. PixelConverter: %s kernels ok\n", simd.name);
+
+	return ok;
+}
+
+void PixelConverter::benchmark(BenchResults& outResults, uint width, uint height, int iterations)
+{
+	const size_t count = width * height;
+	if (count == 0 || iterations <= 0) return;
+
+	vector<uint8>::type src(count * 4);
+	vector<uint8>::type dst(count * 2);
+
+	uint seed = 0;
+	FillRandom(src, seed);
+
+	uint halfWidth = std::max(1u, width / 2);
+	uint halfHeight = std::max(1u, height / 2);
+
+	int mipCount = calcMipCount(width, height);
+	vector<uint8>::type chain(calcMipChainSize(width, height, 4, mipCount));
+	memcpy(&chain[0], &src[0], count * 4);
+
+	const PixelKernels* impls[] = { &s_ScalarKernels, HasSimd() ? &s_SimdKernels : NULL };
+
+	for (uint k = 0; k < COUNT_OF(impls); ++k)
+	{
+		const PixelKernels* kernels = impls[k];
+		if (kernels == NULL) continue;
+
+		for (int test = 0; test < 12; ++test)
+		{
+			// flipY has no simd variant
+			if (test == 8 && kernels != &s_ScalarKernels) continue;
+
+			const char* name = NULL;
+			double start = SystemTimer::now();
+
+			for (int i = 0; i < iterations; ++i)
+			{
+				switch (test)
+				{
+				case 0: name = "premultiply_8888";	kernels->premultiply_8888(&src[0], count); break;
+				case 1: name = "premultiply_4444";	kernels->premultiply_4444(&src[0], count); break;
+				case 2: name = "swapRB_8888";		kernels->swapRB_8888(&src[0], count); break;
+				case 3: name = "swapRB_4444";		kernels->swapRB_4444(&src[0], count); break;
+				case 4: name = "convert8888to4444";	ConvertImage(kernels->convert4444, &src[0], width * 4, &dst[0], width * 2, width, height, false); break;
+				case 5: name = "convert8888to4444d";ConvertImage(kernels->convert4444, &src[0], width * 4, &dst[0], width * 2, width, height, true); break;
+				case 6: name = "convert8888to565";	ConvertImage(kernels->convert565, &src[0], width * 4, &dst[0], width * 2, width, height, false); break;
+				case 7: name = "convert8888to5551";	ConvertImage(kernels->convert5551, &src[0], width * 4, &dst[0], width * 2, width, height, false); break;
+				case 8: name = "flipY";				PixelConverter::flipY(&src[0], width * 4, height); break;
+				case 9: name = "resample_catmullrom";Resample(*kernels, &src[0], width * 4, width, height, &dst[0], halfWidth * 4, halfWidth, halfHeight, FILTER_CATMULLROM, true); break;
+				case 10: name = "mipmaps_box";		BuildMipChain(*kernels, &chain[0], width, height, mipCount, FILTER_BOX, true); break;
+				case 11: name = "mipmaps_kaiser";	BuildMipChain(*kernels, &chain[0], width, height, mipCount, FILTER_KAISER, true); break;
+				}
+			}
+
+			double elapsed = SystemTimer::now() - start;
+			float mpps = elapsed > 0.0 ? float(count * iterations / elapsed / 1000000.0) : 0.0f;
+
+			String key = String(name) + "." + kernels->name;
+			LOG(0, ".. PixelConverter: %-24s %8.1f MP/s\n", key.c_str(), mpps);
+			outResults.push_back(std::make_pair(key, mpps));
+		}
+	}
+}
+
+#endif // #if defined(NIT_TESTS)
+
 NS_NIT_END;
@@ -228,4 +228,70 @@ struct PixelRGB_888
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Pixel conversion kernels used by Image utilities.
+// Each kernel has a scalar reference implementation and a vectorized one (SSE2 or NEON)
+// which is chosen at runtime. Both produce bit-exact same results.
+//
+// 16bit outputs are written as native uint16:
+//   4444 : PixelRGBA_4444 layout (r at lowest nibble)
+//   565  : rrrrrggg gggbbbbb (GL_UNSIGNED_SHORT_5_6_5)
+//   5551 : rrrrrggg ggbbbbba (GL_UNSIGNED_SHORT_5_5_5_1)
+//
+// When dither is true, a 4x4 ordered (bayer) dither is applied to color channels before truncation.
+// Alpha is always truncated.
+//
+// The resampler works on 4 channel 8bit pixels (any channel order with alpha at the 4th byte) with separable filters.
+// When gammaCorrect is true, color channels are filtered in linear space (assuming sRGB source).
+
+class NIT_API PixelConverter
+{
+public:
+	enum Filter
+	{
+		FILTER_BOX,						// 2x2 average on mipmaps, nearest when magnifying
+		FILTER_BILINEAR,
+		FILTER_CATMULLROM,
+		FILTER_KAISER,					// kaiser windowed sinc, sharp mipmaps with little aliasing
+	};
+
+public:
+	static void							premultiply_8888(uint8* buf, size_t count);
+	static void							premultiply_4444(uint8* buf, size_t count);
+
+	static void							swapRB_8888(uint8* buf, size_t count);
+	static void							swapRB_4444(uint8* buf, size_t count);
+
+	static void							convert8888to4444(const uint8* src, uint srcPitch, uint8* dst, uint dstPitch, uint width, uint height, bool dither = false);
+	static void							convert8888to565(const uint8* src, uint srcPitch, uint8* dst, uint dstPitch, uint width, uint height, bool dither = false);
+	static void							convert8888to5551(const uint8* src, uint srcPitch, uint8* dst, uint dstPitch, uint width, uint height, bool dither = false);
+
+	static void							flipY(uint8* buf, uint pitch, uint height);
+
+	static void							resample_8888(const uint8* src, uint srcPitch, uint srcWidth, uint srcHeight, uint8* dst, uint dstPitch, uint dstWidth, uint dstHeight, Filter filter = FILTER_CATMULLROM, bool gammaCorrect = true);
+
+public:									// Mipmap chain : levels are tightly packed from the top level down to 1x1
+	static int							calcMipCount(uint width, uint height);
+	static size_t						calcMipChainSize(uint width, uint height, uint bytesPerPixel, int mipCount);
+
+	// Fills level 1 ~ (mipCount-1) from the top level at the beginning of 'chain'
+	static void							buildMipChain_8888(uint8* chain, uint width, uint height, int mipCount, Filter filter = FILTER_BOX, bool gammaCorrect = true);
+
+public:
+	// Name of the vectorized implementation in use ("sse2", "neon" or "none")
+	static const char*					getSimdName();
+	static bool							isSimdEnabled();
+	static void							setSimdEnabled(bool flag);
+
+#if defined(NIT_TESTS)
+	// Compares vectorized kernels against scalar ones with random pixels, returns false on any mismatch
+	static bool							selfTest(uint seed = 0);
+
+	// Runs each kernel on a width x height image and reports throughput in mega-pixels / sec.
+	typedef vector<std::pair<String, float> >::type BenchResults;
+	static void							benchmark(BenchResults& outResults, uint width = 1024, uint height = 1024, int iterations = 10);
+#endif
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
 NS_NIT_END;
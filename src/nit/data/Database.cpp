@@ -33,6 +33,11 @@ NS_NIT_BEGIN;
 
 ////////////////////////////////////////////////////////////////////////////////
 
+NIT_EVENT_DEFINE(DB_QUERY_DONE, DatabaseEvent);
+NIT_EVENT_DEFINE(DB_QUERY_ERROR, DatabaseEvent);
+
+////////////////////////////////////////////////////////////////////////////////
+
 class Database::Initializer
 {
 public:
@@ -458,8 +463,14 @@ Database* Database::open(FileLocator* fl, const String& filename)
 }
 
 Database::Database(const String& uriPath, sqlite3* db)
-: _db(db), _uriPath(uriPath)
+: _db(db), _execDb(NULL), _uriPath(uriPath)
 {
+	_stmtCacheCapacity = 32;
+
+	_batchLimit = 64;
+	_batchDelay = 0.0f;
+
+	resetStats();
 }
 
 Database::Query* Database::prepare(const char* sql)
@@ -469,7 +480,12 @@ Database::Query* Database::prepare(const char* sql)
 
 sqlite3_stmt* Database::prepareStmt(const char* sql)
 {
-	if (_db == NULL)
+	return prepareStmt(_db, sql);
+}
+
+sqlite3_stmt* Database::prepareStmt(sqlite3* db, const char* sql)
+{
+	if (db == NULL)
 	{
 		NIT_THROW_FMT(EX_DATABASE, "can't prepare '%s': db closed");
 	}
@@ -477,10 +493,10 @@ sqlite3_stmt* Database::prepareStmt(const char* sql)
 	sqlite3_stmt* sq3stmt = NULL;
 
 	const char* tail = NULL;
-	int err = sqlite3_prepare_v2(_db, sql, -1, &sq3stmt, &tail);
+	int err = sqlite3_prepare_v2(db, sql, -1, &sq3stmt, &tail);
 	if (err)
 	{
-		NIT_THROW_FMT(EX_DATABASE, "can't prepare '%s': %s", sql, sqlite3_errmsg(_db));
+		NIT_THROW_FMT(EX_DATABASE, "can't prepare '%s': %s", sql, sqlite3_errmsg(db));
 		return NULL;
 	}
 
@@ -530,9 +546,34 @@ void Database::exec(const char* sql, ExecCallback callback, void* context)
 
 void Database::close()
 {
+	if (_executor)
+	{
+		// Drop queries not started yet, then let the executor run dry
+		_mutex.lock();
+		for (AsyncQueue::iterator itr = _asyncQueue.begin(), end = _asyncQueue.end(); itr != end; ++itr)
+		{
+			AsyncQuery* query = *itr;
+			query->_started = true;
+			query->_executed = true;
+			query->_error = "database closed";
+		}
+		_asyncQueue.clear();
+		_mutex.unlock();
+
+		flush();
+
+		_executor = NULL;
+	}
+
+	purgeStmtCache();
+
+	if (_execDb)
+		sqlite3_close(_execDb);
+
 	if (_db)
 		sqlite3_close(_db);
 
+	_execDb = NULL;
 	_db = NULL;
 }
 
@@ -589,15 +630,677 @@ BlobLocator* Database::newLocator(const String& name, const String& path)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-Database::Query::Query(Database* db, sqlite3_stmt* stmt)
-: _db(db), _stmt(stmt), _stepResult(SQLITE_DONE)
+int Database::insertRecords(const char* sql, DataArray* records)
+{
+	if (_db == NULL)
+		NIT_THROW_FMT(EX_DATABASE, "can't exec '%s': db closed", sql);
+
+	Ref<Query> query = prepareCached(sql);
+
+	// The executor never touches _db, so a transaction open here is the caller's own: join it.
+	// Otherwise one commit for all rows instead of one per row.
+	bool transaction = sqlite3_get_autocommit(_db) != 0;
+	if (transaction)
+		exec("BEGIN");
+
+	bool writes = !query->isReadOnly();
+	int changes = 0;
+
+	try
+	{
+		for (DataArray::Iterator itr = records->begin(), end = records->end(); itr != end; ++itr)
+		{
+			DataValue& row = *itr;
+
+			switch (row.getType())
+			{
+			case DataValue::TYPE_RECORD:	query->bindRecord(row.getRef<DataRecord>()); break;
+			case DataValue::TYPE_ARRAY:		query->clearBindings(); query->bindArray(row.getRef<DataArray>()); break;
+
+			default:
+				NIT_THROW_FMT(EX_INVALID_PARAMS, "can't insert '%s': record or array expected, not %s", sql, DataValue::typeToStr(row.getType()));
+			}
+
+			while (query->step())
+			{
+			}
+
+			if (writes)
+				changes += sqlite3_changes(_db);
+		}
+	}
+	catch (...)
+	{
+		if (transaction)
+			sqlite3_exec(_db, "ROLLBACK", NULL, NULL, NULL);
+		throw;
+	}
+
+	if (transaction)
+		exec("COMMIT");
+
+	return changes;
+}
+
+Ref<DataArray> Database::fetchRecords(const char* sql, DataArray* params, DataNamespace* ns)
+{
+	Ref<Query> query = prepareCached(sql);
+
+	query->bindArray(params);
+
+	Ref<DataArray> records = new DataArray();
+	query->fetchRecords(records, ns);
+
+	return records;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Database::Query* Database::prepareCached(const char* sql)
+{
+	return new Query(this, checkoutStmt(_db, sql), true);
+}
+
+sqlite3_stmt* Database::checkoutStmt(sqlite3* db, const char* sql)
+{
+	_stmtCacheMutex.lock();
+
+	StmtCache& cache = stmtCacheOf(db);
+
+	StmtIndex::iterator itr = cache.index.find(sql);
+	if (itr != cache.index.end())
+	{
+		// Checked out statements leave the cache, so no two users share one
+		sqlite3_stmt* stmt = itr->second->stmt;
+		cache.lru.erase(itr->second);
+		cache.index.erase(itr);
+		_stmtCacheMutex.unlock();
+
+		_mutex.lock();
+		++_stats.cacheHits;
+		_mutex.unlock();
+
+		return stmt;
+	}
+
+	_stmtCacheMutex.unlock();
+
+	_mutex.lock();
+	++_stats.cacheMisses;
+	_mutex.unlock();
+
+	return prepareStmt(db, sql);
+}
+
+void Database::checkinStmt(sqlite3_stmt* stmt)
+{
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+
+	Mutex::ScopedLock lock(_stmtCacheMutex);
+
+	const char* sql = sqlite3_sql(stmt);
+	sqlite3* db = sqlite3_db_handle(stmt);
+
+	if (db == NULL || _stmtCacheCapacity == 0 || sql == NULL)
+	{
+		sqlite3_finalize(stmt);
+		return;
+	}
+
+	StmtCache& cache = stmtCacheOf(db);
+
+	if (cache.index.find(sql) != cache.index.end())
+	{
+		sqlite3_finalize(stmt);
+		return;
+	}
+
+	CachedStmt entry;
+	entry.sql = sql;
+	entry.stmt = stmt;
+
+	cache.lru.push_front(entry);
+	cache.index.insert(std::make_pair(entry.sql, cache.lru.begin()));
+
+	trimStmtCache(cache, _stmtCacheCapacity);
+}
+
+void Database::trimStmtCache(StmtCache& cache, uint capacity)
+{
+	while (cache.lru.size() > capacity)
+	{
+		cache.index.erase(cache.lru.back().sql);
+		sqlite3_finalize(cache.lru.back().stmt);
+		cache.lru.pop_back();
+	}
+}
+
+void Database::setStmtCacheCapacity(uint capacity)
+{
+	Mutex::ScopedLock lock(_stmtCacheMutex);
+
+	_stmtCacheCapacity = capacity;
+
+	trimStmtCache(_stmtCache, _stmtCacheCapacity);
+	trimStmtCache(_execStmtCache, _stmtCacheCapacity);
+}
+
+uint Database::getStmtCacheCount()
+{
+	Mutex::ScopedLock lock(_stmtCacheMutex);
+
+	return _stmtCache.lru.size() + _execStmtCache.lru.size();
+}
+
+void Database::purgeStmtCache()
+{
+	Mutex::ScopedLock lock(_stmtCacheMutex);
+
+	trimStmtCache(_stmtCache, 0);
+	trimStmtCache(_execStmtCache, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+String Database::getJournalMode()
+{
+	Ref<Query> query = prepare("PRAGMA journal_mode");
+
+	String mode;
+	if (query->step())
+		query->getText(0, mode);
+	query->reset();
+
+	return mode;
+}
+
+String Database::setJournalMode(const String& mode)
+{
+	// sqlite answers the mode in effect, which differs when the request can't be met (ex: WAL on a memory db)
+	Ref<Query> query = prepare(StringUtil::format("PRAGMA journal_mode = %s", mode.c_str()).c_str());
+
+	String result;
+	if (query->step())
+		query->getText(0, result);
+	query->reset();
+
+	if (_strcmpi(result.c_str(), mode.c_str()) != 0)
+		LOG(0, "*** '%s': journal mode '%s' not available, stays '%s'\n", _uriPath.c_str(), mode.c_str(), result.c_str());
+
+	return result;
+}
+
+int Database::getSynchronous()
+{
+	Ref<Query> query = prepare("PRAGMA synchronous");
+
+	int level = 0;
+	if (query->step())
+		level = query->getInt(0);
+	query->reset();
+
+	return level;
+}
+
+void Database::setSynchronous(int level)
+{
+	exec(StringUtil::format("PRAGMA synchronous = %d", level).c_str());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// How long a writer of one connection waits for the other's transaction before SQLITE_BUSY (ms)
+static const int BUSY_TIMEOUT = 5000;
+
+class Database::ExecJob : public AsyncJob
+{
+public:
+	ExecJob(Database* db) : _db(db) { }
+
+	virtual bool						isPrepared()							{ return true; }
+
+protected:
+	virtual bool						onPrepare()								{ return true; }
+
+	virtual bool						onExecute(bool async)
+	{
+		// Each job takes what's queued at the time, so later jobs may find nothing left
+		_db->runBatch();
+		return true;
+	}
+
+	// Database::update() delivers executed queries in queued order
+	virtual void						onFinish()								{ }
+
+private:
+	Database*							_db;
+};
+
+Database::AsyncQuery::AsyncQuery(Database* db, const char* sql, DataArray* params, bool fetchRows)
+: _db(db), _sql(sql), _params(params), _fetchRows(fetchRows)
+{
+	_started = false;
+	_executed = false;
+	_delivered = false;
+
+	_changes = 0;
+	_lastInsertRowId = 0;
+	_execTime = 0.0;
+}
+
+static DataValue DetachParam(const DataValue& value)
+{
+	// The executor must not touch ref counts owned by the main thread:
+	// anything bindValue() would copy or share is serialized into a private blob here.
+	switch (value.getType())
+	{
+	case DataValue::TYPE_VOID:
+	case DataValue::TYPE_NULL:
+	case DataValue::TYPE_INT:
+	case DataValue::TYPE_INT64:
+	case DataValue::TYPE_FLOAT:
+	case DataValue::TYPE_DOUBLE:
+	case DataValue::TYPE_STRING:
+	case DataValue::TYPE_BLOB:
+	case DataValue::TYPE_TIMESTAMP:		return DataValue(value);
+
+	case DataValue::TYPE_BOOL:			return DataValue(value).toInt();
+
+	case DataValue::TYPE_ARRAY:
+	case DataValue::TYPE_RECORD:
+	case DataValue::TYPE_OBJECT:
+	case DataValue::TYPE_BUFFER:
+		{
+			DataValue copy(value);
+			Ref<MemoryBuffer> buf = value.getType() == DataValue::TYPE_BUFFER ? copy.getRef<MemoryBuffer>() : copy.toBuffer();
+			MemoryBuffer::Access access(buf);
+			return DataValue(access.getMemory(), access.getSize());
+		}
+
+	default:
+		{
+			DataValue copy(value);
+			size_t size;
+			const void* blob = copy.toBlob(&size);
+			return DataValue(blob, size);
+		}
+	}
+}
+
+Database::AsyncQuery* Database::execAsync(const char* sql, DataArray* params, bool fetchRows)
+{
+	if (_db == NULL)
+		NIT_THROW_FMT(EX_DATABASE, "can't exec '%s': db closed", sql);
+
+	if (sqlite3_threadsafe() == 0)
+		NIT_THROW_FMT(EX_NOT_SUPPORTED, "can't exec '%s' async: sqlite built without threading", sql);
+
+	if (_executor == NULL)
+		openExecutor();
+
+	double start = SystemTimer::now();
+
+	Ref<DataArray> detached;
+	if (params && params->getCount() > 0)
+	{
+		detached = new DataArray();
+		for (DataArray::Iterator itr = params->begin(), end = params->end(); itr != end; ++itr)
+			detached->append(DetachParam(*itr));
+	}
+
+	Ref<AsyncQuery> query = new AsyncQuery(this, sql, detached, fetchRows);
+
+	_pending.push_back(query);
+
+	_mutex.lock();
+	_asyncQueue.push_back(query);
+	++_stats.queued;
+	_queryQueued.signal();
+	_mutex.unlock();
+
+	_executor->enqueue(new ExecJob(this));
+
+	_stats.mainTime += SystemTimer::now() - start;
+
+	return query;
+}
+
+void Database::openExecutor()
+{
+	// The executor gets a connection of its own: its batch transactions never mix with
+	// statements of the main thread, and under WAL neither side blocks the other's reads.
+	const char* filename = sqlite3_db_filename(_db, "main");
+	if (filename == NULL || filename[0] == 0)
+		NIT_THROW_FMT(EX_NOT_SUPPORTED, "'%s': async queries need a file database", _uriPath.c_str());
+
+	sqlite3* db = NULL;
+	int err = sqlite3_open_v2(filename, &db, SQLITE_OPEN_READWRITE, NULL);
+
+	if (err)
+	{
+		String errmsg = db ? sqlite3_errmsg(db) : "memory alloc fail";
+		if (db) sqlite3_close(db);
+		NIT_THROW_FMT(EX_DATABASE, "can't open executor of '%s': %s", _uriPath.c_str(), errmsg.c_str());
+	}
+
+	// Writers of both connections queue up instead of failing with SQLITE_BUSY
+	sqlite3_busy_timeout(_db, BUSY_TIMEOUT);
+	sqlite3_busy_timeout(db, BUSY_TIMEOUT);
+
+	_execDb = db;
+
+	// Synchronous level is per connection: the executor starts with ours
+	sqlite3_exec(_execDb, StringUtil::format("PRAGMA synchronous = %d", getSynchronous()).c_str(), NULL, NULL, NULL);
+
+	if (_strcmpi(getJournalMode().c_str(), "wal") != 0)
+		setJournalMode("WAL");
+
+	_executor = new AsyncJobManager("Database", 1);
+}
+
+void Database::setBatchPolicy(uint maxStatements, float maxDelay)
+{
+	Mutex::ScopedLock lock(_mutex);
+
+	_batchLimit = maxStatements;
+	_batchDelay = maxDelay;
+}
+
+void Database::runBatch()
+{
+	_mutex.lock();
+	uint limit = _batchLimit > 1 ? _batchLimit : 1;
+	double delay = _batchDelay;
+	_mutex.unlock();
+
+	double start = SystemTimer::now();
+	bool transaction = false;
+
+	vector<AsyncQuery*>::type batch;
+
+	while (batch.size() < limit)
+	{
+		AsyncQuery* query = NULL;
+
+		_mutex.lock();
+		if (_asyncQueue.empty() && transaction)
+		{
+			// Hold an open transaction a little for queries queued right behind
+			long wait = long((delay - (SystemTimer::now() - start)) * 1000.0);
+			if (wait > 0)
+				_queryQueued.tryWait(_mutex, wait);
+		}
+
+		if (!_asyncQueue.empty())
+		{
+			query = _asyncQueue.front();
+			_asyncQueue.pop_front();
+			query->_started = true;
+		}
+		_mutex.unlock();
+
+		if (query == NULL)
+			break;
+
+		// _execDb is ours alone, so no transaction of someone else can be open on it
+		if (!transaction && limit > 1)
+			transaction = sqlite3_exec(_execDb, "BEGIN", NULL, NULL, NULL) == SQLITE_OK;
+
+		batch.push_back(query);
+		run(query, _execDb);
+	}
+
+	if (transaction && sqlite3_exec(_execDb, "COMMIT", NULL, NULL, NULL) != SQLITE_OK)
+	{
+		String error = sqlite3_errmsg(_execDb);
+		sqlite3_exec(_execDb, "ROLLBACK", NULL, NULL, NULL);
+
+		// Nothing of the batch made it: report it on each query
+		Mutex::ScopedLock lock(_mutex);
+		for (uint i = 0; i < batch.size(); ++i)
+		{
+			if (batch[i]->_error.empty())
+				batch[i]->_error = String("can't commit: ") + error;
+		}
+	}
+
+	if (!batch.empty())
+	{
+		Mutex::ScopedLock lock(_mutex);
+		++_stats.batches;
+	}
+}
+
+void Database::run(AsyncQuery* query, sqlite3* db)
+{
+	double start = SystemTimer::now();
+
+	String error;
+	int changes = 0;
+	int64 lastInsertRowId = 0;
+	Ref<DataArray> rows;
+
+	try
+	{
+		// A detached Query: this may be the executor thread which must not touch our ref count
+		Ref<Query> stmt = new Query(NULL, checkoutStmt(db, query->_sql.c_str()));
+
+		int paramIndex = 1;
+		for (DataArray::Iterator itr = query->_params->begin(), end = query->_params->end(); itr != end; ++itr)
+			stmt->bindValue(paramIndex++, *itr);
+
+		if (query->_fetchRows)
+		{
+			int numColumns = stmt->getNumColumns();
+
+			query->_columnNames.resize(numColumns);
+			for (int c = 0; c < numColumns; ++c)
+			{
+				const char* name = stmt->getColumnName(c);
+				query->_columnNames[c] = name ? name : "";
+			}
+
+			rows = new DataArray();
+
+			while (stmt->step())
+			{
+				Ref<DataArray> row = new DataArray();
+				for (int c = 0; c < numColumns; ++c)
+					row->append(stmt->getValue(c));
+				rows->append(row);
+			}
+		}
+		else
+		{
+			while (stmt->step())
+			{
+			}
+		}
+
+		// sqlite3_changes() keeps the count of the last write, so only trust it for one
+		if (!stmt->isReadOnly())
+		{
+			changes = sqlite3_changes(db);
+			lastInsertRowId = sqlite3_last_insert_rowid(db);
+		}
+
+		sqlite3_stmt* peer = stmt->_stmt;
+		stmt->_stmt = NULL;
+		checkinStmt(peer);
+	}
+	catch (Exception& ex)
+	{
+		error = ex.getDescription();
+		rows = NULL;
+	}
+
+	double elapsed = SystemTimer::now() - start;
+
+	Mutex::ScopedLock lock(_mutex);
+
+	query->_error = error;
+	query->_changes = changes;
+	query->_lastInsertRowId = lastInsertRowId;
+	query->_rows = rows;
+	query->_execTime = elapsed;
+	query->_executed = true;
+
+	_stats.execTime += elapsed;
+
+	_queryExecuted.broadcast();
+}
+
+void Database::deliver(AsyncQuery* query)
+{
+	if (query->_delivered)
+		return;
+
+	Ref<AsyncQuery> safe = query;
+
+	query->_delivered = true;
+	query->_db = NULL;
+
+	PendingQueries::iterator itr = std::find(_pending.begin(), _pending.end(), query);
+	if (itr != _pending.end())
+		_pending.erase(itr);
+
+	bool failed = query->isFailed();
+
+	_mutex.lock();
+	if (failed)
+		++_stats.failed;
+	else
+		++_stats.completed;
+	_mutex.unlock();
+
+	if (failed)
+		LOG(0, "*** '%s': async query '%s' failed: %s\n", _uriPath.c_str(), query->_sql.c_str(), query->_error.c_str());
+
+	if (query->_channel)
+		query->_channel->send(failed ? EVT::DB_QUERY_ERROR : EVT::DB_QUERY_DONE, new DatabaseEvent(query));
+}
+
+bool Database::finish(AsyncQuery* query)
+{
+	if (query == NULL)
+		return false;
+
+	if (query->_delivered)
+		return !query->isFailed();
+
+	ASSERT_THROW(query->_db == this, EX_INVALID_PARAMS);
+
+	double start = SystemTimer::now();
+
+	_mutex.lock();
+	bool runHere = !query->_started;
+	if (runHere)
+	{
+		_asyncQueue.erase(std::find(_asyncQueue.begin(), _asyncQueue.end(), query));
+		query->_started = true;
+	}
+	_mutex.unlock();
+
+	if (runHere)
+	{
+		// On our own connection: may wait on the executor's write transaction for BUSY_TIMEOUT
+		run(query, _db);
+	}
+	else
+	{
+		// The executor is on it: wait for the result
+		Mutex::ScopedLock lock(_mutex);
+		while (!query->_executed)
+			_queryExecuted.wait(_mutex);
+	}
+
+	deliver(query);
+
+	_stats.mainTime += SystemTimer::now() - start;
+
+	return !query->isFailed();
+}
+
+void Database::update()
+{
+	if (_executor == NULL)
+		return;
+
+	double start = SystemTimer::now();
+
+	_executor->update();
+	deliverExecuted();
+
+	_stats.mainTime += SystemTimer::now() - start;
+}
+
+void Database::flush()
+{
+	if (_executor == NULL)
+		return;
+
+	double start = SystemTimer::now();
+
+	// Every pending query is either queued, on the executor or already run by finish()
+	_mutex.lock();
+	for (uint i = 0; i < _pending.size(); ++i)
+	{
+		while (!_pending[i]->_executed)
+			_queryExecuted.wait(_mutex);
+	}
+	_mutex.unlock();
+
+	_executor->update();
+	deliverExecuted();
+
+	_stats.mainTime += SystemTimer::now() - start;
+}
+
+void Database::deliverExecuted()
+{
+	// Pick them up first: deliver() sends events, whose handlers may queue more
+	PendingQueries executed;
+
+	_mutex.lock();
+	for (uint i = 0; i < _pending.size(); ++i)
+	{
+		if (_pending[i]->_executed)
+			executed.push_back(_pending[i]);
+	}
+	_mutex.unlock();
+
+	for (uint i = 0; i < executed.size(); ++i)
+		deliver(executed[i]);
+}
+
+Database::Stats Database::getStats()
+{
+	Mutex::ScopedLock lock(_mutex);
+
+	return _stats;
+}
+
+void Database::resetStats()
+{
+	Mutex::ScopedLock lock(_mutex);
+
+	memset(&_stats, 0, sizeof(_stats));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Database::Query::Query(Database* db, sqlite3_stmt* stmt, bool cached)
+: _db(db), _stmt(stmt), _stepResult(SQLITE_DONE), _cached(cached)
 {
 
 }
 
 void Database::Query::finalize()
 {
-	if (_stmt)
+	if (_stmt && _cached && _db)
+		_db->checkinStmt(_stmt);
+	else if (_stmt)
 		sqlite3_finalize(_stmt);
 
 	_stmt = NULL;
@@ -608,11 +1311,17 @@ void Database::Query::setSql(const char* sql)
 {
 	sqlite3_stmt* newStmt = _db->prepareStmt(sql);
 
-	if (_stmt)
+	if (_stmt && _cached)
+		_db->checkinStmt(_stmt);
+	else if (_stmt)
 		sqlite3_finalize(_stmt);
 
 	_stmt = newStmt;
 	_stepResult = SQLITE_DONE;
+	_cached = false;
+
+	_paramKeys.clear();
+	_paramKeyNamespace = NULL;
 }
 
 void Database::Query::reset()
@@ -767,9 +1476,12 @@ void Database::Query::bindBlob(int paramIndex, const void* blob, int numBytes)
 
 typedef std::map<void*, MemoryAccess*> TempBlobLinks;
 static TempBlobLinks s_TempBlobLinks;
+static Mutex s_TempBlobLinksMutex;
 
 static void DeleteTempBlob(void* mem)
 {
+	Mutex::ScopedLock lock(s_TempBlobLinksMutex);
+
 	TempBlobLinks::iterator itr = s_TempBlobLinks.find(mem);
 	if (itr != s_TempBlobLinks.end())
 	{
@@ -784,7 +1496,9 @@ void Database::Query::bind(int paramIndex, Ref<MemoryBuffer> buf)
 		bindError(paramIndex);
 
 	MemoryBuffer::Access* acc = new MemoryBuffer::Access(buf);
+	s_TempBlobLinksMutex.lock();
 	s_TempBlobLinks.insert(std::make_pair(acc->getMemory(), acc));
+	s_TempBlobLinksMutex.unlock();
 
 	if (sqlite3_bind_blob(_stmt, paramIndex, acc->getMemory(), acc->getSize(), DeleteTempBlob))
 	{
@@ -834,9 +1548,9 @@ void Database::Query::bindValue(int paramIndex, const DataValue& value)
 		} 
 		break;
 
-	case DataValue::TYPE_ARRAY:			bind(paramIndex, DataValue(value).toBuffer());
-	case DataValue::TYPE_RECORD:		bind(paramIndex, DataValue(value).toBuffer());
-	case DataValue::TYPE_OBJECT:		bind(paramIndex, DataValue(value).toBuffer());
+	case DataValue::TYPE_ARRAY:			bind(paramIndex, DataValue(value).toBuffer()); break;
+	case DataValue::TYPE_RECORD:		bind(paramIndex, DataValue(value).toBuffer()); break;
+	case DataValue::TYPE_OBJECT:		bind(paramIndex, DataValue(value).toBuffer()); break;
 	case DataValue::TYPE_BUFFER:		bind(paramIndex, value.getRef<MemoryBuffer>()); break;
 
 	default:							NIT_THROW(EX_NOT_SUPPORTED);
@@ -849,6 +1563,51 @@ void Database::Query::bindZeroBlob(int paramIndex, int numBytes)
 		bindError(paramIndex);
 }
 
+void Database::Query::bindArray(DataArray* values)
+{
+	int paramIndex = 1;
+	for (DataArray::Iterator itr = values->begin(), end = values->end(); itr != end; ++itr)
+		bindValue(paramIndex++, *itr);
+}
+
+void Database::Query::bindRecord(DataRecord* record)
+{
+	if (_stmt == NULL)
+		NIT_THROW_FMT(EX_INVALID_STATE, "can't bind : statement finalized");
+
+	DataNamespace* ns = record ? record->getNamespace() : DataNamespace::getGlobal();
+
+	// Resolve param names into keys once, then each record costs a hash lookup per param
+	if (_paramKeyNamespace != ns)
+	{
+		int numParams = sqlite3_bind_parameter_count(_stmt);
+
+		_paramKeys.clear();
+		_paramKeys.resize(numParams);
+
+		for (int i = 0; i < numParams; ++i)
+		{
+			const char* paramName = sqlite3_bind_parameter_name(_stmt, i + 1);
+
+			// anonymous '?' or '?NNN' params stay unkeyed and bind null
+			if (paramName && paramName[0] != '?')
+				_paramKeys[i] = ns->add(paramName + 1);
+		}
+
+		_paramKeyNamespace = ns;
+	}
+
+	for (uint i = 0; i < _paramKeys.size(); ++i)
+	{
+		DataKey* key = _paramKeys[i];
+
+		if (key)
+			bindValue(i + 1, record->get(key));
+		else
+			bindNull(i + 1);
+	}
+}
+
 int Database::Query::getNumColumns()
 {
 	return _stmt ? sqlite3_column_count(_stmt) : 0;
@@ -982,6 +1741,54 @@ const void* Database::Query::getBlob(int column, int* outNumBytes)
 	return blob;
 }
 
+DataRecord* Database::Query::getRecord(DataNamespace* ns)
+{
+	if (_stmt == NULL || _stepResult != SQLITE_ROW)
+		return NULL;
+
+	DataRecord* record = new DataRecord(ns);
+	ns = record->getNamespace();
+
+	int numColumns = sqlite3_column_count(_stmt);
+	for (int c = 0; c < numColumns; ++c)
+		record->set(ns->add(getColumnName(c)), getValue(c));
+
+	return record;
+}
+
+uint Database::Query::fetchRecords(DataArray* outRecords, DataNamespace* ns)
+{
+	ASSERT_THROW(outRecords, EX_INVALID_PARAMS);
+
+	if (_stmt == NULL)
+		NIT_THROW_FMT(EX_DATABASE, "can't step: finalized");
+
+	if (ns == NULL)
+		ns = DataNamespace::getGlobal();
+
+	// Intern column keys once for the whole result set
+	int numColumns = sqlite3_column_count(_stmt);
+
+	ParamKeys keys(numColumns);
+	for (int c = 0; c < numColumns; ++c)
+		keys[c] = ns->add(getColumnName(c));
+
+	uint count = 0;
+
+	while (step())
+	{
+		Ref<DataRecord> record = new DataRecord(ns);
+
+		for (int c = 0; c < numColumns; ++c)
+			record->set(keys[c], getValue(c));
+
+		outRecords->append(record);
+		++count;
+	}
+
+	return count;
+}
+
 const char* Database::Query::getSql()
 {
 	return _stmt ? sqlite3_sql(_stmt) : "<finalized>";
@@ -25,6 +25,8 @@
 #include "nit/nit.h"
 #include "nit/io/Stream.h"
 #include "nit/data/DataValue.h"
+#include "nit/async/AsyncJob.h"
+#include "nit/async/Condition.h"
 
 #define SQLITE_API NIT_API
 #include "sqlite3/sqlite3.h"
@@ -65,6 +67,64 @@ public:
 	typedef int							(*ExecCallback)(void*,int,char**,char**);
 	void								exec(const char* sql, ExecCallback callback, void* context);
 
+public:									// Bulk transfer
+	// Runs 'sql' once per element of 'records' within one transaction, reusing one cached statement.
+	// A DataRecord binds to named params (':name', '@name', '$name'), a DataArray binds in order.
+	// Returns the number of rows changed.
+	int									insertRecords(const char* sql, DataArray* records);
+
+	// Fetches the whole result set as an array of DataRecords, keyed by column names interned once into 'ns'.
+	Ref<DataArray>						fetchRecords(const char* sql, DataArray* params = NULL, DataNamespace* ns = NULL);
+
+public:									// Statement cache
+	// A cached query hands its statement back to an LRU cache keyed by the sql text when released,
+	// reset and unbound, instead of finalizing it. The next prepareCached() of the same sql skips the parse.
+	Query*								prepareCached(const char* sql);
+
+	uint								getStmtCacheCapacity()					{ return _stmtCacheCapacity; }
+	void								setStmtCacheCapacity(uint capacity);
+	uint								getStmtCacheCount();
+	void								purgeStmtCache();
+
+public:									// Journaling
+	String								getJournalMode();
+	String								setJournalMode(const String& mode);		// DELETE, TRUNCATE, PERSIST, MEMORY, WAL, OFF - returns the mode in effect
+	int									getSynchronous();
+	void								setSynchronous(int level);				// 0: OFF, 1: NORMAL, 2: FULL - set before the first execAsync()
+
+public:									// Async execution (main thread only)
+	class AsyncQuery;
+
+	// Runs the query on the executor thread of this database in queued order, and delivers it on update().
+	// Params bind to '?1'.. in order. With fetchRows, result rows are collected as arrays of column values.
+	// The executor works on a connection of its own (switched to WAL), so it needs a file database.
+	AsyncQuery*							execAsync(const char* sql, DataArray* params = NULL, bool fetchRows = false);
+	bool								finish(AsyncQuery* query);				// runs or waits for it right now, false if failed
+
+	void								update();
+	void								flush();
+
+	// Queries queued back to back run in one transaction, committed after 'maxStatements' queries
+	// or when the queue runs dry, kept open up to 'maxDelay' seconds for late comers. maxStatements <= 1 disables it.
+	uint								getBatchLimit()							{ return _batchLimit; }
+	float								getBatchDelay()							{ return _batchDelay; }
+	void								setBatchPolicy(uint maxStatements, float maxDelay);
+
+	struct NIT_API Stats
+	{
+		uint							queued;
+		uint							completed;
+		uint							failed;
+		uint							batches;
+		uint							cacheHits;
+		uint							cacheMisses;
+		double							execTime;				// seconds spent running async queries
+		double							mainTime;				// seconds the main thread spent queueing, delivering or waiting
+	};
+
+	Stats								getStats();
+	void								resetStats();
+
 public:
 	// path: '[db.]table/blob_column[.id_column]'
 	BlobLocator*						newLocator(const String& name, const String& path); 
@@ -79,10 +139,59 @@ protected:
 
 private:
 	class Initializer;
+	class ExecJob;
 
 	sqlite3*							_db;
+	sqlite3*							_execDb;				// executor thread only
 
 	String								_uriPath;
+
+	struct CachedStmt
+	{
+		String							sql;
+		sqlite3_stmt*					stmt;
+	};
+
+	typedef list<CachedStmt>::type		StmtList;
+	typedef unordered_map<String, StmtList::iterator>::type StmtIndex;
+
+	// Statements belong to their connection, so each connection caches its own
+	struct StmtCache
+	{
+		StmtList						lru;					// most recently used first
+		StmtIndex						index;
+	};
+
+	StmtCache							_stmtCache;				// of _db
+	StmtCache							_execStmtCache;			// of _execDb
+	uint								_stmtCacheCapacity;
+	Mutex								_stmtCacheMutex;
+
+	typedef vector<Ref<AsyncQuery> >::type PendingQueries;
+	typedef deque<AsyncQuery*>::type	AsyncQueue;
+
+	Ref<AsyncJobManager>				_executor;
+	PendingQueries						_pending;				// main thread only
+	AsyncQueue							_asyncQueue;
+	Mutex								_mutex;
+	Condition							_queryQueued;			// on _mutex, signaled by execAsync()
+	Condition							_queryExecuted;			// on _mutex, broadcast by run()
+	uint								_batchLimit;
+	float								_batchDelay;
+
+	Stats								_stats;
+
+	sqlite3_stmt*						prepareStmt(sqlite3* db, const char* sql);
+	sqlite3_stmt*						checkoutStmt(sqlite3* db, const char* sql);
+	void								checkinStmt(sqlite3_stmt* stmt);
+	StmtCache&							stmtCacheOf(sqlite3* db)				{ return db == _execDb ? _execStmtCache : _stmtCache; }
+	void								trimStmtCache(StmtCache& cache, uint capacity);
+
+	void								openExecutor();
+	void								runBatch();
+	void								run(AsyncQuery* query, sqlite3* db);
+	void								deliver(AsyncQuery* query);
+	void								deliverExecuted();
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -90,7 +199,7 @@ private:
 class NIT_API Database::Query : public RefCounted
 {
 public:
-	Query(Database* db, sqlite3_stmt* stmt);
+	Query(Database* db, sqlite3_stmt* stmt, bool cached = false);
 	virtual ~Query()															{ assert(_stmt == NULL); }
 
 public:
@@ -131,9 +240,13 @@ public:									// parameter binding
 	void								bindValue(int paramIndex, const DataValue& value);
 	void								bindZeroBlob(int paramIndex, int numBytes);
 
+	void								bindArray(DataArray* values);			// to '?1', '?2'.. in order
+	void								bindRecord(DataRecord* record);			// to named params by key, missing keys bind null
+
 public:									// meta data
 	int									getNumColumns();
 	bool								isReadOnly();
+	bool								isCached()								{ return _cached; }
 
 	const char*							getDatabaseName(int column);
 	const char*							getTableName(int column);
@@ -164,6 +277,9 @@ public:									// column access
 	const char*							getText(int column, String& outText);
 	const void*							getBlob(int column, int* outNumBytes = NULL);
 
+	DataRecord*							getRecord(DataNamespace* ns = NULL);	// current row keyed by column names
+	uint								fetchRecords(DataArray* outRecords, DataNamespace* ns = NULL);	// steps through all rows, returns the count
+
 //	void								getStatus(int* outNumSteps, int& outNumSorts, int& outNumAutoIndices);
 
 public:
@@ -172,15 +288,80 @@ public:
 	int									_stepResult;
 
 protected:
+	bool								_cached;
+
+	typedef vector<Ref<DataKey> >::type	ParamKeys;
+
+	ParamKeys							_paramKeys;				// bindRecord() keys by param index - 1
+	Ref<DataNamespace>					_paramKeyNamespace;
+
 	void								finalize();
 	virtual void						onDelete()								{ finalize(); }
 
-	sqlite3*							getSqlite3()							{ return _stmt && _db ? _db->getPeer() : NULL; }
+	sqlite3*							getSqlite3()							{ return _stmt ? sqlite3_db_handle(_stmt) : NULL; }
 	void								bindError(int paramIndex);
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 
+class NIT_API Database::AsyncQuery : public RefCounted
+{
+public:
+	const String&						getSql()								{ return _sql; }
+	DataArray*							getParams()								{ return _params; }
+
+	bool								isDone()								{ return _delivered; }
+	bool								isFailed()								{ return !_error.empty(); }
+	const String&						getError()								{ return _error; }
+
+public:									// valid once done
+	int									getChanges()							{ return _changes; }
+	int64								getLastInsertRowId()					{ return _lastInsertRowId; }
+	const StringVector&					getColumnNames()						{ return _columnNames; }
+	DataArray*							getRows()								{ return _rows; }
+	double								getExecTime()							{ return _execTime; }
+
+	EventChannel*						channel()								{ return _channel ? _channel : _channel = new EventChannel(); }
+
+private:
+	friend class Database;
+	AsyncQuery(Database* db, const char* sql, DataArray* params, bool fetchRows);
+
+	Database*							_db;					// NULL once delivered
+	String								_sql;
+	Ref<DataArray>						_params;
+	bool								_fetchRows;
+
+	bool								_started;				// guarded by Database::_mutex
+	bool								_executed;
+	bool								_delivered;				// main thread only
+
+	String								_error;
+	int									_changes;
+	int64								_lastInsertRowId;
+	StringVector						_columnNames;
+	Ref<DataArray>						_rows;
+	double								_execTime;
+
+	Ref<EventChannel>					_channel;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+class NIT_API DatabaseEvent : public Event
+{
+public:
+	DatabaseEvent() { }
+	DatabaseEvent(Database::AsyncQuery* query) : query(query) { }
+
+	Ref<Database::AsyncQuery>			query;
+};
+
+NIT_EVENT_DECLARE(NIT_API, DB_QUERY_DONE, DatabaseEvent);
+NIT_EVENT_DECLARE(NIT_API, DB_QUERY_ERROR, DatabaseEvent);
+
+////////////////////////////////////////////////////////////////////////////////
+
 class NIT_API BlobLocator : public StreamLocator
 {
 public:
@@ -84,6 +84,8 @@ public:
 	// HACK: To match 'new FileLocator("aaa", "bbb")' pattern
 	FileLocator(const String& name, const char* path, bool readOnly = true, bool findRecursive = false); 
 
+	virtual ~FileLocator();
+
 public:
 	const String&						getBaseUrl()							{ return this ? _baseUrl : StringUtil::BLANK(); }
 	virtual String						makeUrl(const String& sourceName);
@@ -119,6 +121,18 @@ public:
 	void								addFiltered(const String& pattern, bool recursive = false);
 	void								removeFiltered(const String& pattern);
 
+public:									// Directory snapshot
+	// When enabled, each directory is listed once into a sorted in-memory index (name, size, mtime)
+	// which locate and find work on instead of the file system. The index is kept current by inotify,
+	// so it is supported on linux & android only (elsewhere or when inotify is unavailable, stays disabled).
+	static bool							isSnapshotSupported();
+	bool								isSnapshotEnabled()						{ return _snapshot != NULL; }
+	void								setSnapshotEnabled(bool flag);
+
+	// Appends names of files created, modified or removed since the last call (inotify only).
+	// An empty name means notifications were lost and anything may have changed.
+	void								pollChanges(StringVector& varChanged);
+
 protected:
 	typedef map<String, RefCache<StreamSource>, StringUtil::LessIgnoreCase>::type FilteredSources;
 	FilteredSources						_filtered;
@@ -131,6 +145,12 @@ protected:
 	void								init(const String& path);
 	StreamSource*						locateFiltered(const String& streamName);
 	void								findFiltered(const String& pattern, StreamSourceMap& varResults);
+
+	class Snapshot;
+	Snapshot*							_snapshot;
+
+	StreamSource*						locateSnapshot(const String& streamName);
+	bool								findSnapshot(const String& pattern, StreamSourceMap* varFiles, StringVector* varDirs, bool recursive);
 };
 
 ////////////////////////////////////////////////////////////////////////////////
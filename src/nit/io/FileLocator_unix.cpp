@@ -66,6 +66,12 @@ static bool is_absolute_path(const char* path);
 #	include <ftw.h>
 #endif
 
+#if defined(__linux__) // linux & android
+#	include <sys/inotify.h>
+#	include <fcntl.h>
+#	define NIT_SNAPSHOT_INOTIFY
+#endif
+
 struct _find_search_t
 {
     char *pattern;
@@ -444,6 +450,302 @@ void FileUtil::readFile(const String &path, StreamWriter *into, size_t bufSize)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Names with '.' or '..' components go through the file system
+static bool toSnapshotName(const String& streamName, String& outName)
+{
+	outName = streamName;
+	std::replace(outName.begin(), outName.end(), FileUtil::getPathAntiSeparator(), FileUtil::getPathSeparator());
+
+	if (outName.find("./") != outName.npos || outName.find("//") != outName.npos)
+		return false;
+
+	return !StringUtil::endsWith(outName, "/.") && !StringUtil::endsWith(outName, "/..") && outName != "." && outName != "..";
+}
+
+class FileLocator::Snapshot
+{
+public:
+	struct Entry
+	{
+		String							name;
+		size_t							size;
+		time_t							mtime;
+		bool							dir;
+		bool							readable;
+
+		static bool						less(const Entry& e, const String& name) { return e.name < name; }
+		static bool						sortLess(const Entry& a, const Entry& b) { return a.name < b.name; }
+	};
+
+	typedef vector<Entry>::type			Entries;
+
+	struct Dir
+	{
+		Entries							entries;								// sorted by name
+		int								watch;									// -1 : not watched, listed again on each lookup
+	};
+
+	typedef map<String, Dir*>::type		Dirs;									// key: directory relative to the base, "" or "sub/dir/"
+	typedef map<int, String>::type		Watches;
+
+public:
+	Snapshot(const String& baseUrl);
+	~Snapshot();
+
+	bool								isWatching()							{ return _inotify >= 0; }
+
+	Dir*								getDir(const String& key);
+	Entries::iterator					lowerBound(Dir* dir, const String& name)	{ return std::lower_bound(dir->entries.begin(), dir->entries.end(), name, Entry::less); }
+	Entry*								find(Dir* dir, const String& name);
+
+	void								update();
+	void								takeChanges(StringVector& varChanged);
+
+private:
+	String								_baseUrl;
+	Dirs								_dirs;
+	Watches								_watches;
+	set<String>::type					_changed;
+	int									_inotify;
+
+	Dir*								load(const String& key);
+	void								drop(const String& key, bool subtree);
+	void								apply(const String& key, Dir* dir, const String& name, uint32 mask);
+	bool								readEntry(const String& path, Entry& e);
+};
+
+FileLocator::Snapshot::Snapshot(const String& baseUrl)
+{
+	_baseUrl = baseUrl;
+	_inotify = -1;
+
+#if defined(NIT_SNAPSHOT_INOTIFY)
+	_inotify = inotify_init();
+
+	if (_inotify >= 0)
+	{
+		fcntl(_inotify, F_SETFL, fcntl(_inotify, F_GETFL) | O_NONBLOCK);
+		fcntl(_inotify, F_SETFD, FD_CLOEXEC);
+	}
+	else
+	{
+		LOG(0, "?? FileLocator '%s': no inotify (%s), snapshot disabled\n", baseUrl.c_str(), strerror(errno));
+	}
+#endif
+}
+
+FileLocator::Snapshot::~Snapshot()
+{
+	for (Dirs::iterator itr = _dirs.begin(), end = _dirs.end(); itr != end; ++itr)
+		delete itr->second;
+
+	// closing the instance removes all of its watches
+	if (_inotify >= 0)
+		close(_inotify);
+}
+
+bool FileLocator::Snapshot::readEntry(const String& path, Entry& e)
+{
+	struct stat tagStat;
+	if (stat(path.c_str(), &tagStat)) return false;
+
+	e.size = (size_t)tagStat.st_size;
+	e.mtime = tagStat.st_mtime;
+	e.dir = S_ISDIR(tagStat.st_mode);
+	e.readable = (tagStat.st_mode & S_IRUSR) != 0;
+	return true;
+}
+
+FileLocator::Snapshot::Dir* FileLocator::Snapshot::getDir(const String& key)
+{
+	update();
+
+	Dirs::iterator itr = _dirs.find(key);
+
+	if (itr != _dirs.end())
+	{
+		Dir* dir = itr->second;
+		if (dir->watch >= 0) return dir;
+
+		// No watch (ex: out of inotify watches): nothing reports its changes, so list it again
+		// (its mtime would miss files modified in place and changes within the mtime resolution)
+		drop(key, false);
+	}
+
+	return load(key);
+}
+
+FileLocator::Snapshot::Entry* FileLocator::Snapshot::find(Dir* dir, const String& name)
+{
+	Entries::iterator itr = lowerBound(dir, name);
+	return itr != dir->entries.end() && itr->name == name ? &*itr : NULL;
+}
+
+FileLocator::Snapshot::Dir* FileLocator::Snapshot::load(const String& key)
+{
+	String path = _baseUrl + key;
+	if (path.empty()) path = "./";
+
+	DIR* dirfd = opendir(path.c_str());
+	if (dirfd == NULL) return NULL;
+
+	Dir* dir = new Dir();
+	dir->watch = -1;
+
+#if defined(NIT_SNAPSHOT_INOTIFY)
+	// watch before listing so nothing slips in between
+	if (_inotify >= 0)
+	{
+		uint32 mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+		dir->watch = inotify_add_watch(_inotify, path.c_str(), mask);
+
+		if (dir->watch >= 0)
+			_watches[dir->watch] = key;
+		else
+			LOG(0, "?? FileLocator: can't watch '%s': %s\n", path.c_str(), strerror(errno));
+	}
+#endif
+
+	dirent* ent;
+	while ((ent = readdir(dirfd)) != NULL)
+	{
+		if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0)
+			continue;
+
+		Entry e;
+		e.name = ent->d_name;
+		if (readEntry(path + e.name, e))
+			dir->entries.push_back(e);
+	}
+
+	closedir(dirfd);
+
+	std::sort(dir->entries.begin(), dir->entries.end(), Entry::sortLess);
+
+	_dirs[key] = dir;
+	return dir;
+}
+
+void FileLocator::Snapshot::drop(const String& key, bool subtree)
+{
+	Dirs::iterator itr = _dirs.lower_bound(key);
+
+	while (itr != _dirs.end() && (itr->first == key || (subtree && StringUtil::startsWith(itr->first, key, false))))
+	{
+		Dir* dir = itr->second;
+
+#if defined(NIT_SNAPSHOT_INOTIFY)
+		if (dir->watch >= 0)
+		{
+			inotify_rm_watch(_inotify, dir->watch);
+			_watches.erase(dir->watch);
+		}
+#endif
+
+		delete dir;
+		_dirs.erase(itr++);
+	}
+}
+
+void FileLocator::Snapshot::apply(const String& key, Dir* dir, const String& name, uint32 mask)
+{
+	Entries::iterator itr = lowerBound(dir, name);
+	bool found = itr != dir->entries.end() && itr->name == name;
+
+#if defined(NIT_SNAPSHOT_INOTIFY)
+	if (mask & (IN_DELETE | IN_MOVED_FROM))
+	{
+		if (!found) return;
+
+		if (itr->dir)
+			drop(key + name + "/", true);
+		else
+			_changed.insert(key + name);
+
+		dir->entries.erase(itr);
+		return;
+	}
+#endif
+
+	// created, moved in, written or attributes changed: read it again
+	Entry e;
+	e.name = name;
+
+	if (!readEntry(_baseUrl + key + name, e))
+	{
+		if (found) dir->entries.erase(itr);
+		return;
+	}
+
+	if (!e.dir)
+		_changed.insert(key + name);
+	else if (found && itr->dir)
+		; // directory attributes only, its listing stays
+	else
+		drop(key + name + "/", true);
+
+	if (found)
+		*itr = e;
+	else
+		dir->entries.insert(itr, e);
+}
+
+void FileLocator::Snapshot::update()
+{
+#if defined(NIT_SNAPSHOT_INOTIFY)
+	if (_inotify < 0) return;
+
+	char buf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+
+	while (true)
+	{
+		ssize_t len = read(_inotify, buf, sizeof(buf));
+		if (len <= 0) break; // EAGAIN: nothing pending
+
+		for (char* p = buf; p < buf + len; )
+		{
+			inotify_event* evt = (inotify_event*)p;
+			p += sizeof(inotify_event) + evt->len;
+
+			if (evt->mask & IN_Q_OVERFLOW)
+			{
+				// events lost: list everything again on demand
+				LOG(0, "?? FileLocator '%s': inotify queue overflow, snapshot dropped\n", _baseUrl.c_str());
+				drop("", true);
+				_changed.insert("");
+				continue;
+			}
+
+			Watches::iterator w = _watches.find(evt->wd);
+			if (w == _watches.end()) continue;
+
+			String key = w->second;
+
+			if (evt->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF))
+			{
+				drop(key, true);
+				continue;
+			}
+
+			Dirs::iterator d = _dirs.find(key);
+			if (d == _dirs.end() || evt->len == 0) continue;
+
+			apply(key, d->second, evt->name, evt->mask);
+		}
+	}
+#endif
+}
+
+void FileLocator::Snapshot::takeChanges(StringVector& varChanged)
+{
+	update();
+
+	varChanged.insert(varChanged.end(), _changed.begin(), _changed.end());
+	_changed.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 FileLocator::FileLocator(const String& name, const String& path, bool readOnly, bool findRecursive)
 : Archive(name), _readOnly(readOnly), _findRecursive(findRecursive)
 {
@@ -464,10 +766,16 @@ FileLocator::FileLocator(const String& path, bool readOnly, bool findRecursive)
 	_name = _baseUrl;
 }
 
+FileLocator::~FileLocator()
+{
+	delete _snapshot;
+}
+
 void FileLocator::init(const String& path)
 {
 	_baseUrl = path;
 	_filteredOnly = false;
+	_snapshot = NULL;
 
 	if (!_baseUrl.empty())
 	{
@@ -525,6 +833,10 @@ StreamSource* FileLocator::locateLocal(const String& streamName)
 	if (FileUtil::isReservedName(streamName))
 		return NULL;
 
+	String snapshotName;
+	if (_snapshot && !FileUtil::isAbsolutePath(streamName) && toSnapshotName(streamName, snapshotName))
+		return locateSnapshot(snapshotName);
+
 	String filepath = normalizePath(streamName);
 
 	struct stat tagStat;
@@ -566,6 +878,9 @@ StreamSource* FileLocator::locateLocal(const String& streamName)
 
 void FileLocator::findFiles(const String& pattern, StreamSourceMap& varResults, bool recursive)
 {
+	if (_snapshot && findSnapshot(pattern, &varResults, NULL, recursive))
+		return;
+
 	long lHandle, res;
 	struct _finddata_t tagData;
 	bool dirs = false;
@@ -646,6 +961,9 @@ void FileLocator::findFiles(const String& pattern, StreamSourceMap& varResults,
 
 void FileLocator::findDirs(const String& pattern, StringVector& varResults)
 {
+	if (_snapshot && findSnapshot(pattern, NULL, &varResults, false))
+		return;
+
 	long lHandle, res;
 	struct _finddata_t tagData;
 	bool dirs = true;
@@ -730,6 +1048,134 @@ void FileLocator::rename(const String& streamName, const String& newName)
 		NIT_THROW_FMT(EX_IO, "Can't rename '%s' to '%s': %s", filepath.c_str(), filepath.c_str(), strerror(errno));
 }
 
+bool FileLocator::isSnapshotSupported()
+{
+#if defined(NIT_SNAPSHOT_INOTIFY)
+	return true;
+#else
+	return false;
+#endif
+}
+
+void FileLocator::setSnapshotEnabled(bool flag)
+{
+	if (flag == (_snapshot != NULL))
+		return;
+
+	if (!flag)
+	{
+		delete _snapshot;
+		_snapshot = NULL;
+		return;
+	}
+
+#if defined(NIT_SNAPSHOT_INOTIFY)
+	// Writes, moves and removes by anyone are seen through inotify - without it the index would go stale
+	Snapshot* snapshot = new Snapshot(_baseUrl);
+
+	if (snapshot->isWatching())
+		_snapshot = snapshot;
+	else
+		delete snapshot;
+#else
+	LOG(0, "?? FileLocator '%s': snapshot not supported without inotify\n", _baseUrl.c_str());
+#endif
+}
+
+void FileLocator::pollChanges(StringVector& varChanged)
+{
+	if (_snapshot)
+		_snapshot->takeChanges(varChanged);
+}
+
+StreamSource* FileLocator::locateSnapshot(const String& name)
+{
+	size_t pos = name.rfind('/');
+	String key = pos != name.npos ? name.substr(0, pos + 1) : String();
+
+	Snapshot::Dir* dir = _snapshot->getDir(key);
+	if (dir == NULL) return NULL;
+
+	Snapshot::Entry* e = _snapshot->find(dir, name.substr(key.length()));
+	if (e == NULL || e->dir) return NULL;
+
+#if defined(NIT_IOS)
+	// ios: We need user read permission to access a file
+	if (!e->readable) return NULL;
+#endif
+
+	File* file = new File(this, name);
+	file->_streamSize = e->size;
+	file->_timestamp = e->mtime;
+
+	return file;
+}
+
+bool FileLocator::findSnapshot(const String& pattern, StreamSourceMap* varFiles, StringVector* varDirs, bool recursive)
+{
+	String name;
+	if (FileUtil::isAbsolutePath(pattern) || !toSnapshotName(pattern, name))
+		return false;
+
+	size_t pos = name.rfind('/');
+	String key = pos != name.npos ? name.substr(0, pos + 1) : String();
+	String mask = name.substr(key.length());
+
+	// Hack for "*.*" -> "*' from DOS/Windows
+	if (mask == "*.*")
+		mask = "*";
+
+	Snapshot::Dir* dir = _snapshot->getDir(key);
+	if (dir == NULL) return true;
+
+	// The sorted index narrows a mask with a literal head (ex: 'hero_*.png') to a range
+	String head = mask.substr(0, mask.find_first_of("*?[\\"));
+	StringVector subDirs;
+
+	Snapshot::Entries::iterator itr = head.empty() ? dir->entries.begin() : _snapshot->lowerBound(dir, head);
+
+	for (Snapshot::Entries::iterator end = dir->entries.end(); itr != end; ++itr)
+	{
+		Snapshot::Entry& e = *itr;
+
+		if (e.name.compare(0, head.length(), head) != 0) break;
+		if (e.name[0] == '.') continue; // hidden
+		if (fnmatch(mask.c_str(), e.name.c_str(), 0) != 0) continue;
+
+		if (e.dir)
+		{
+			if (varDirs) varDirs->push_back(e.name);
+			continue;
+		}
+
+		if (varFiles == NULL) continue;
+
+		String filename = key + e.name;
+		if (varFiles->find(filename) != varFiles->end()) continue;
+
+		File* file = new File(this, filename);
+		file->_streamSize = e.size;
+		file->_timestamp = e.mtime;
+
+		varFiles->insert(std::make_pair(filename, file));
+	}
+
+	if (!recursive || varFiles == NULL)
+		return true;
+
+	// Collect first: recursing updates the snapshot which may drop this directory
+	for (Snapshot::Entries::iterator itr = dir->entries.begin(), end = dir->entries.end(); itr != end; ++itr)
+	{
+		if (itr->dir && itr->name[0] != '.')
+			subDirs.push_back(itr->name);
+	}
+
+	for (uint i = 0; i < subDirs.size(); ++i)
+		findSnapshot(key + subDirs[i] + "/" + mask, varFiles, NULL, true);
+
+	return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 File::File(StreamLocator* locator, const String& name)
@@ -401,10 +401,16 @@ FileLocator::FileLocator(const String& path, bool readOnly, bool findRecursive)
 	_name = _baseUrl;
 }
 
+FileLocator::~FileLocator()
+{
+	// snapshot never enabled on win32
+}
+
 void FileLocator::init(const String& path)
 {
 	_baseUrl = path;
 	_filteredOnly = false;
+	_snapshot = NULL;
 
 	if (!_baseUrl.empty())
 	{
@@ -703,6 +709,22 @@ void FileLocator::rename(const String& streamName, const String& newName)
 	}
 }
 
+bool FileLocator::isSnapshotSupported()
+{
+	return false;
+}
+
+void FileLocator::setSnapshotEnabled(bool flag)
+{
+	// TODO: implement using ReadDirectoryChangesW
+	if (flag)
+		LOG(0, "?? FileLocator '%s': snapshot not supported on win32\n", _baseUrl.c_str());
+}
+
+void FileLocator::pollChanges(StringVector& varChanged)
+{
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 File::File(StreamLocator* locator, const String& name)
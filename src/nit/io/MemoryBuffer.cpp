@@ -44,12 +44,48 @@ MemoryBuffer* StreamReader::buffer()
 // TODO: ifdef
 const size_t MemoryBuffer::s_DefaultBlockSize = 4096;
 
+// Ranges smaller than this are copied rather than shared, to avoid fragmenting into tiny pieces
+static const size_t MIN_SHARE_SIZE = 256;
+
+static void ReleaseAllocated(void* memory, size_t size, void* context)
+{
+	NIT_DEALLOC(memory, size);
+}
+
+MemoryBuffer::Block::Block(size_t capacity)
+{
+	_memory = (uint8*)NIT_ALLOC(capacity);
+	_capacity = capacity;
+	_release = ReleaseAllocated;
+	_context = NULL;
+}
+
+MemoryBuffer::Block::Block(void* memory, size_t capacity, ReleaseFunc release, void* context)
+{
+	_memory = (uint8*)memory;
+	_capacity = capacity;
+	_release = release;
+	_context = context;
+}
+
+void MemoryBuffer::Block::onDelete()
+{
+	if (_release)
+		_release(_memory, _capacity, _context);
+
+	_memory = NULL;
+	_capacity = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 MemoryBuffer::MemoryBuffer(size_t blockSize)
 {
 	if (blockSize == 0) blockSize = s_DefaultBlockSize;
 
 	_blockSize = blockSize;
-	_start = _end = 0;
+	_size = 0;
+	_cursor = 0;
 }
 
 MemoryBuffer::MemoryBuffer(StreamReader* reader, size_t blockSize)
@@ -59,7 +95,8 @@ MemoryBuffer::MemoryBuffer(StreamReader* reader, size_t blockSize)
 	if (blockSize == 0) blockSize = s_DefaultBlockSize;
 
 	_blockSize = blockSize;
-	_start = _end = 0;
+	_size = 0;
+	_cursor = 0;
 	load(reader);
 }
 
@@ -69,7 +106,8 @@ MemoryBuffer::MemoryBuffer(const String& string, size_t blockSize)
 	if (blockSize == 0) blockSize = s_DefaultBlockSize;
 
 	_blockSize = blockSize;
-	_start = _end = 0;
+	_size = 0;
+	_cursor = 0;
 	copyFrom(string.c_str(), 0, string.length());
 }
 
@@ -79,63 +117,206 @@ MemoryBuffer::MemoryBuffer(const void* buf, size_t size, size_t blockSize)
 	if (blockSize == 0) blockSize = s_DefaultBlockSize;
 
 	_blockSize = blockSize;
-	_start = _end = 0;
+	_size = 0;
+	_cursor = 0;
 	copyFrom(buf, 0, size);
 }
 
-void MemoryBuffer::reserve(size_t size)
+MemoryBuffer::Piece MemoryBuffer::newPiece(size_t capacity)
 {
-	if (getSize() > size) return;
+	Piece piece;
+	piece.block = new Block(capacity);
+	piece.data = piece.block->getMemory();
+	piece.size = 0;
+	piece.pos = 0;
+	return piece;
+}
 
-	_end = _start + size;
+size_t MemoryBuffer::findPiece(size_t pos) const
+{
+	size_t count = _pieces.size();
 
-	if (_end == 0) return;
+	if (pos >= _size)
+		return count;
 
-	// if block size set to 32,
-	//  0 ~ 32 : 1 block
-	// 33 ~ 64 : 2 blocks
-	// 65 ~ 96 : 3 blocks
-	// ...
+	// Reads and writes mostly go sequential, so try the cursor and its next one first
+	size_t idx = _cursor;
+	if (idx < count && _pieces[idx].pos <= pos)
+	{
+		if (pos < _pieces[idx].pos + _pieces[idx].size)
+			return idx;
 
-	size_t blockCount = (_end - 1) / _blockSize + 1;
+		if (++idx < count && pos < _pieces[idx].pos + _pieces[idx].size)
+			return _cursor = idx;
+	}
 
-	while (_blocks.size() < blockCount)
+	// binary search for the last piece which starts at or before pos
+	size_t lo = 0;
+	size_t hi = count;
+
+	while (hi - lo > 1)
 	{
-		uint8* block = allocateBlock();
-		_blocks.push_back(block);
+		size_t mid = (lo + hi) / 2;
+		if (_pieces[mid].pos <= pos)
+			lo = mid;
+		else
+			hi = mid;
 	}
+
+	return _cursor = lo;
 }
 
-void MemoryBuffer::resize(size_t size)
+size_t MemoryBuffer::split(size_t pos)
 {
-	if (size == 0)
-	{
-		_end = _start = 0;
+	if (pos >= _size)
+		return _pieces.size();
+
+	size_t idx = findPiece(pos);
+	Piece& piece = _pieces[idx];
+
+	if (piece.pos == pos)
+		return idx;
+
+	size_t offset = pos - piece.pos;
+
+	Piece tail = piece;
+	tail.data += offset;
+	tail.size -= offset;
+	tail.pos = pos;
+
+	piece.size = offset;
+
+	_pieces.insert(_pieces.begin() + idx + 1, tail);
+	return idx + 1;
+}
+
+void MemoryBuffer::unshare(Piece& piece)
+{
+	if (!piece.block->isShared())
 		return;
-	}
 
-	if (size > getSize())
+	Ref<Block> block = new Block(piece.size);
+	memcpy(block->getMemory(), piece.data, piece.size);
+
+	piece.block = block;
+	piece.data = block->getMemory();
+}
+
+void MemoryBuffer::appendRoom(size_t size)
+{
+	while (size > 0)
 	{
-		reserve(size);
+		if (!_pieces.empty())
+		{
+			// Grow the last piece into the rest of its block unless someone else refers to the block
+			Piece& last = _pieces.back();
+			Block* block = last.block;
+
+			if (!block->isShared())
+			{
+				size_t room = (block->getMemory() + block->getCapacity()) - (last.data + last.size);
+				if (room > size) room = size;
+
+				last.size += room;
+				_size += room;
+				size -= room;
+
+				if (size == 0) break;
+			}
+		}
+
+		Piece piece = newPiece(_blockSize);
+		piece.pos = _size;
+		_pieces.push_back(piece);
 	}
+}
+
+void MemoryBuffer::getPieces(size_t pos, size_t size, Pieces& outPieces) const
+{
+	size_t idx = findPiece(pos);
 
-	_end = _start + size;
+	while (size > 0)
+	{
+		Piece piece = _pieces[idx++];
+
+		size_t offset = pos - piece.pos;
+		piece.data += offset;
+		piece.size -= offset;
+		if (piece.size > size) piece.size = size;
+
+		outPieces.push_back(piece);
+
+		pos += piece.size;
+		size -= piece.size;
+	}
 }
 
-uint8* MemoryBuffer::allocateBlock()
+void MemoryBuffer::insertPieces(size_t pos, Pieces& pieces, size_t size)
 {
-	return (uint8*)NIT_ALLOC(_blockSize);
+	if (size == 0) return;
+
+	size_t idx = split(pos);
+
+	for (uint i = 0; i < pieces.size(); ++i)
+	{
+		pieces[i].pos = pos;
+		pos += pieces[i].size;
+	}
+
+	for (size_t i = idx; i < _pieces.size(); ++i)
+		_pieces[i].pos += size;
+
+	_pieces.insert(_pieces.begin() + idx, pieces.begin(), pieces.end());
+	_size += size;
 }
 
-void MemoryBuffer::clear()
+size_t MemoryBuffer::fill(StreamReader* reader, size_t pos, size_t size)
 {
-	for (uint i=0; i<_blocks.size(); ++i)
+	size_t totalRead = 0;
+	size_t idx = findPiece(pos);
+
+	while (size > 0)
 	{
-		uint8* block = _blocks[i];
-		NIT_DEALLOC(block, _blockSize);
+		Piece& piece = _pieces[idx++];
+		unshare(piece);
+
+		size_t offset = pos - piece.pos;
+		size_t readSize = piece.size - offset;
+		if (readSize > size) readSize = size;
+
+		size_t bytesRead = reader->readRaw(piece.data + offset, readSize);
+
+		totalRead += bytesRead;
+		if (bytesRead < readSize) break;
+
+		pos += readSize;
+		size -= readSize;
 	}
-	_blocks.clear();
-	_start = _end = 0;
+
+	return totalRead;
+}
+
+void MemoryBuffer::reserve(size_t size)
+{
+	if (_size < size)
+		appendRoom(size - _size);
+}
+
+void MemoryBuffer::resize(size_t size)
+{
+	if (size == 0)
+		clear();
+	else if (size > _size)
+		appendRoom(size - _size);
+	else if (size < _size)
+		erase(size, _size - size);
+}
+
+void MemoryBuffer::clear()
+{
+	_pieces.clear();
+	_size = 0;
+	_cursor = 0;
 }
 
 void MemoryBuffer::onDelete()
@@ -147,75 +328,42 @@ size_t MemoryBuffer::load(StreamReader* reader, size_t pos, size_t size)
 {
 	Ref<StreamReader> autorel = reader;
 
-	size_t totalRead = 0;
-
 	if (reader->isSized())
 	{
 		if (size == 0) size = reader->getSize();
 
-		totalRead = size;
 		reserve(pos + size);
+		fill(reader, pos, size);
 
-		pos = _start + pos;
-
-		size_t blockIdx = pos / _blockSize;
-		size_t blockPos = pos % _blockSize;
-
-		while (size > 0)
-		{
-			uint8* dst = _blocks[blockIdx] + blockPos;
-
-			if (blockPos + size <= _blockSize)
-			{
-				reader->readRaw(dst, size);
-				break;
-			}
-
-			size_t readSize = _blockSize - blockPos;
-			reader->readRaw(dst, readSize);
-
-			size -= readSize;
-			++blockIdx;
-			blockPos = 0;
-		}
-
-		return totalRead;
+		return size;
 	}
 
-	pos = _start + pos;
+	size_t totalRead = 0;
+	size_t end = _size;
 
 	while (true)
 	{
 		if (reader->isEof())
 			break;
 
-		if (pos >= _blocks.size() * _blockSize)
-		{
-			// It seems that GetAvailable() is more expensive.
-			// So takes some room (+1) for efficiency.
-			_blocks.push_back(allocateBlock());
-		}
-
-		size_t blockIdx = pos / _blockSize;
-		size_t blockPos = pos % _blockSize;
-		uint8* dst = _blocks[blockIdx] + blockPos;
+		size_t readSize = _blockSize;
 
-		size_t bytesRead = _blockSize - blockPos;
+		if (size && totalRead + readSize > size)
+			readSize = size - totalRead;
 
-		if (size && totalRead + bytesRead > size)
-			bytesRead = size - totalRead;
-
-		bytesRead = reader->readRaw(dst, bytesRead);
+		reserve(pos + readSize);
+		size_t bytesRead = fill(reader, pos, readSize);
 
 		pos += bytesRead;
 		totalRead += bytesRead;
 
 		if (size && totalRead >= size) break;
-		if (size == 0 && bytesRead == 0) break;
+		if (bytesRead == 0) break;
 	}
 
-	if (_end < pos)
-		_end = pos;
+	// trim the room which reader couldn't fill
+	if (end < pos) end = pos;
+	if (_size > end) erase(end, _size - end);
 
 	return totalRead;
 }
@@ -228,34 +376,23 @@ size_t MemoryBuffer::save(StreamWriter* writer, size_t pos, size_t size) const
 
 	ASSERT_THROW(pos + size <= getSize(), EX_INVALID_RANGE);
 
-	pos = _start + pos;
-
-	size_t blockIdx = pos / _blockSize;
-	size_t blockPos = pos % _blockSize;
-
 	size_t totalWritten = 0;
+	size_t idx = findPiece(pos);
 
 	while (size > 0)
 	{
-		uint8* src = _blocks[blockIdx] + blockPos;
+		const Piece& piece = _pieces[idx++];
 
-		if (blockPos + size <= _blockSize)
-		{
-			if (writer->writeRaw(src, size) != size)
-				NIT_THROW(EX_WRITE);
-			totalWritten += size;
-			break;
-		}
+		size_t offset = pos - piece.pos;
+		size_t writeSize = piece.size - offset;
+		if (writeSize > size) writeSize = size;
 
-		size_t writeSize = _blockSize - blockPos;
-		if (writer->writeRaw(src, writeSize) != writeSize)
+		if (writer->writeRaw(piece.data + offset, writeSize) != writeSize)
 			NIT_THROW(EX_WRITE);
 
 		totalWritten += writeSize;
+		pos += writeSize;
 		size -= writeSize;
-
-		++blockIdx;
-		blockPos = 0;
 	}
 
 	return totalWritten;
@@ -263,181 +400,251 @@ size_t MemoryBuffer::save(StreamWriter* writer, size_t pos, size_t size) const
 
 void MemoryBuffer::copyFrom(const void* buf, size_t pos, size_t size)
 {
-	reserve(pos + size);
-
-	pos = _start + pos;
+	if (size == 0) return;
 
-	size_t blockIdx = pos / _blockSize;
-	size_t blockPos = pos % _blockSize;
+	reserve(pos + size);
 
 	const uint8* src = (const uint8*)buf;
+	size_t idx = findPiece(pos);
 
 	while (size > 0)
 	{
-		uint8* dst = _blocks[blockIdx] + blockPos;
+		Piece& piece = _pieces[idx++];
+		unshare(piece);
 
-		if (blockPos + size <= _blockSize)
-		{
-			memcpy(dst, src, size);
-			break;
-		}
+		size_t offset = pos - piece.pos;
+		size_t copySize = piece.size - offset;
+		if (copySize > size) copySize = size;
 
-		size_t bytesRead = _blockSize - blockPos;
-		memcpy(dst, src, bytesRead);
-		size -= bytesRead;
-		src += bytesRead;
+		memcpy(piece.data + offset, src, copySize);
 
-		++blockIdx;
-		blockPos = 0;
+		src += copySize;
+		pos += copySize;
+		size -= copySize;
 	}
 }
 
 void MemoryBuffer::copyFrom(MemoryBuffer* src, size_t srcPos, size_t destPos, size_t size)
 {
-	// TODO: optimize this
+	if (size == 0) return;
 
-	MemoryBuffer::Access access(src, srcPos, size);
-	copyFrom(access.getMemory(), destPos, access.getSize());
+	Ref<MemoryBuffer> safe = src;
+
+	ASSERT_THROW(srcPos + size <= src->getSize(), EX_INVALID_RANGE);
+
+	// Take the pieces first: src may be this buffer, and the refs keep overwritten source intact
+	Pieces pieces;
+	src->getPieces(srcPos, size, pieces);
+
+	if (size < MIN_SHARE_SIZE)
+	{
+		for (uint i = 0; i < pieces.size(); ++i)
+		{
+			copyFrom(pieces[i].data, destPos, pieces[i].size);
+			destPos += pieces[i].size;
+		}
+		return;
+	}
+
+	reserve(destPos);
+
+	size_t overwrite = _size - destPos;
+	if (overwrite > size) overwrite = size;
+
+	erase(destPos, overwrite);
+	insertPieces(destPos, pieces, size);
 }
 
 MemoryBuffer* MemoryBuffer::clone(size_t blockSize)
 {
-	if (blockSize == 0)
-		blockSize = _blockSize;
+	if (blockSize == 0 || blockSize == _blockSize)
+		return slice(0, _size);
 
 	MemoryBuffer* cloned = new MemoryBuffer(blockSize);
-	cloned->copyFrom(this, 0, 0, getSize());
+	cloned->reserve(_size);
+
+	for (uint i = 0; i < _pieces.size(); ++i)
+		cloned->copyFrom(_pieces[i].data, _pieces[i].pos, _pieces[i].size);
+
 	return cloned;
 }
 
-void MemoryBuffer::copyTo(void* buf, size_t pos, size_t size) const
+MemoryBuffer* MemoryBuffer::slice(size_t pos, size_t size)
 {
+	if (size == 0) size = getSize() - pos;
+
 	ASSERT_THROW(pos + size <= getSize(), EX_INVALID_RANGE);
 
-	pos = _start + pos;
+	MemoryBuffer* view = new MemoryBuffer(_blockSize);
+
+	Pieces pieces;
+	getPieces(pos, size, pieces);
+	view->insertPieces(0, pieces, size);
+
+	return view;
+}
+
+void MemoryBuffer::adopt(void* memory, size_t size, ReleaseFunc release, void* context)
+{
+	if (size == 0)
+	{
+		if (release) release(memory, size, context);
+		return;
+	}
+
+	Piece piece;
+	piece.block = new Block(memory, size, release, context);
+	piece.data = (uint8*)memory;
+	piece.size = size;
+	piece.pos = 0;
+
+	Pieces pieces(1, piece);
+	insertPieces(_size, pieces, size);
+}
 
-	size_t blockIdx = pos / _blockSize;
-	size_t blockPos = pos % _blockSize;
+void MemoryBuffer::compact()
+{
+	Pieces pieces;
+	pieces.swap(_pieces);
+
+	size_t size = _size;
+	clear();
+	reserve(size);
+
+	for (uint i = 0; i < pieces.size(); ++i)
+		copyFrom(pieces[i].data, pieces[i].pos, pieces[i].size);
+}
+
+void MemoryBuffer::copyTo(void* buf, size_t pos, size_t size) const
+{
+	ASSERT_THROW(pos + size <= getSize(), EX_INVALID_RANGE);
 
 	uint8* dst = (uint8*)buf;
+	size_t idx = findPiece(pos);
 
 	while (size > 0)
 	{
-		uint8* src = _blocks[blockIdx] + blockPos;
+		const Piece& piece = _pieces[idx++];
 
-		if (blockPos + size <= _blockSize)
-		{
-			memcpy(dst, src, size);
-			break;
-		}
+		size_t offset = pos - piece.pos;
+		size_t copySize = piece.size - offset;
+		if (copySize > size) copySize = size;
 
-		size_t bytesWritten = _blockSize - blockPos;
-		memcpy(dst, src, bytesWritten);
-		size -= bytesWritten;
-		dst += bytesWritten;
+		memcpy(dst, piece.data + offset, copySize);
 
-		++blockIdx;
-		blockPos = 0;
+		dst += copySize;
+		pos += copySize;
+		size -= copySize;
 	}
 }
 
 bool MemoryBuffer::getBlock(size_t blockIdx, uint8*& buf, size_t& size) const
 {
-	if (blockIdx >= _blocks.size()) return false;
+	if (blockIdx >= _pieces.size()) return false;
 
-	if (blockIdx == 0)
-	{
-		buf = _blocks[0] + _start;
-		size = _blockSize - _start;
-	}
-	else
-	{
-		buf = _blocks[blockIdx];
-		size = _blockSize;
-	}
-
-	if (blockIdx == _end / _blockSize)
-	{
-		size_t blockEnd = _end % _blockSize;
-		size -= (_blockSize - blockEnd);
-	}
+	buf = _pieces[blockIdx].data;
+	size = _pieces[blockIdx].size;
 
 	return true;
 }
 
 void MemoryBuffer::pushBack(const void* buf, size_t size)
 {
-	copyFrom(buf, getSize(), size);
+	copyFrom(buf, _size, size);
 }
 
-void MemoryBuffer::pushBack(MemoryBuffer* src, size_t srcPos, size_t size)
+void MemoryBuffer::popBack(size_t size)
 {
-	// TODO: optimize this
-	MemoryBuffer::Access access(src, srcPos, size);
-	pushBack(access.getMemory(), access.getSize());
+	if (size > _size)
+		size = _size;
+
+	erase(_size - size, size);
 }
 
-void MemoryBuffer::popBack(size_t size)
+void MemoryBuffer::popFront(size_t size)
 {
-	if (_end >= size)
-		_end = size;
-	else
-		_end = 0;
+	assert(size <= getSize());
 
-	if (_end < _start)
-		_end = _start;
+	erase(0, size);
 }
 
-void MemoryBuffer::pushFront(const void* buf, size_t size)
+void MemoryBuffer::insert(size_t pos, size_t size)
 {
-	if (_start >= size)
-	{
-		_start -= size;
+	ASSERT_THROW(pos <= _size, EX_INVALID_RANGE);
 
-		copyFrom(buf, 0, size);
+	if (pos == _size)
+	{
+		appendRoom(size);
 		return;
 	}
 
-	NIT_THROW(EX_NOT_IMPLEMENTED);
+	Pieces pieces;
+
+	for (size_t left = size; left > 0; )
+	{
+		size_t pieceSize = left < _blockSize ? left : _blockSize;
 
-//	_locks.insert(_blocks.begin(), allocateBlock());
+		Piece piece = newPiece(pieceSize);
+		piece.size = pieceSize;
+		pieces.push_back(piece);
+
+		left -= pieceSize;
+	}
+
+	insertPieces(pos, pieces, size);
 }
 
-void MemoryBuffer::pushFront(MemoryBuffer* src, size_t srcPos, size_t size)
+void MemoryBuffer::insert(size_t pos, const void* buf, size_t size)
 {
-	// TODO: optimize this
-	MemoryBuffer::Access access(src, srcPos, size);
-	pushFront(access.getMemory(), access.getSize());
+	ASSERT_THROW(pos <= _size, EX_INVALID_RANGE);
+
+	insert(pos, size);
+	copyFrom(buf, pos, size);
 }
 
-void MemoryBuffer::popFront(size_t size)
+void MemoryBuffer::insert(size_t pos, MemoryBuffer* src, size_t srcPos, size_t size)
 {
-	assert(size <= getSize());
+	if (size == 0) return;
 
-	if (_start + size < _blockSize)
+	Ref<MemoryBuffer> safe = src;
+
+	ASSERT_THROW(pos <= _size, EX_INVALID_RANGE);
+	ASSERT_THROW(srcPos + size <= src->getSize(), EX_INVALID_RANGE);
+
+	Pieces pieces;
+	src->getPieces(srcPos, size, pieces);
+
+	if (size < MIN_SHARE_SIZE)
 	{
-		_start += size;
+		insert(pos, size);
 
-		if (isEmpty())
-			clear();
+		for (uint i = 0; i < pieces.size(); ++i)
+		{
+			copyFrom(pieces[i].data, pos, pieces[i].size);
+			pos += pieces[i].size;
+		}
 		return;
 	}
 
-	size_t start = _start + size;
-	size_t numBlocks = start / _blockSize;
-	size_t blockPos = start % _blockSize;
+	insertPieces(pos, pieces, size);
+}
 
-	// erase popped blocks
-	for (uint i=0; i<numBlocks; ++i)
-	{
-		uint8* block = _blocks[i];
-		NIT_DEALLOC(block, _blockSize);
-	}
+void MemoryBuffer::erase(size_t pos, size_t size)
+{
+	if (size == 0) return;
+
+	ASSERT_THROW(pos + size <= _size, EX_INVALID_RANGE);
 
-	_blocks.erase(_blocks.begin(), _blocks.begin() + numBlocks);
+	size_t first = split(pos);
+	size_t last = split(pos + size);
 
-	_start = blockPos;
-	_end -= numBlocks * _blockSize;
+	_pieces.erase(_pieces.begin() + first, _pieces.begin() + last);
+
+	for (size_t i = first; i < _pieces.size(); ++i)
+		_pieces[i].pos -= size;
+
+	_size -= size;
+	_cursor = first;
 }
 
 // TODO: Refactor to create a EncodeUtil class and handle utf16 there
@@ -452,11 +659,10 @@ String MemoryBuffer::toString(bool utf16) const
 
 	ret.reserve(getSize());
 
-	for (uint i = 0; i < _blocks.size(); ++i)
+	for (uint i = 0; i < _pieces.size(); ++i)
 	{
-		uint8* buf; size_t size;
-		getBlock(i, buf, size);
-		ret.append(buf, buf + size);
+		const Piece& piece = _pieces[i];
+		ret.append(piece.data, piece.data + piece.size);
 	}
 
 	if (utf16)
@@ -477,27 +683,20 @@ String MemoryBuffer::toString(size_t pos, size_t size, bool utf16) const
 
 	ret.reserve(size);
 
-	pos = _start + pos;
-
-	size_t blockIdx = pos / _blockSize;
-	size_t blockPos = pos % _blockSize;
+	size_t idx = findPiece(pos);
 
 	while (size > 0)
 	{
-		uint8* src = _blocks[blockIdx] + blockPos;
+		const Piece& piece = _pieces[idx++];
 
-		if (blockPos + size <= _blockSize)
-		{
-			ret.append(src, src + size);
-			break;
-		}
+		size_t offset = pos - piece.pos;
+		size_t copySize = piece.size - offset;
+		if (copySize > size) copySize = size;
 
-		size_t bytesWritten = _blockSize - blockPos;
-		ret.append(src, src + bytesWritten);
-		size -= bytesWritten;
+		ret.append(piece.data + offset, piece.data + offset + copySize);
 
-		++blockIdx;
-		blockPos = 0;
+		pos += copySize;
+		size -= copySize;
 	}
 
 	if (utf16)
@@ -510,12 +709,10 @@ void MemoryBuffer::hexDump() const
 {
 	uint columns = _blockSize <= 32 ? _blockSize : 32;
 
-	for (uint i = 0; i < _blocks.size(); ++i)
+	for (uint i = 0; i < _pieces.size(); ++i)
 	{
-		uint begin = i == 0 ? _start : 0;
-		uint end = i == _blocks.size() - 1 ? _end % _blockSize : 0;
-
-		MemoryAccess::hexDump(StringUtil::format("block %d", i), _blocks[i], _blockSize, columns, begin, end);
+		const Piece& piece = _pieces[i];
+		MemoryAccess::hexDump(StringUtil::format("block %d", i), piece.data, piece.size, columns);
 	}
 }
 
@@ -527,22 +724,27 @@ MemoryBuffer::Access::Access(MemoryBuffer* buffer, size_t pos, size_t size)
 	if (size == 0) size = buffer->getSize() - pos;
 
 	_bufferPos = pos;
-	pos += buffer->_start;
+	_flatten = false;
+	_memory = NULL;
 
-	size_t blockSize = buffer->getBlockSize();
-	size_t blockIdx = pos / blockSize;
-	size_t blockPos = pos % blockSize;
+	size_t idx = buffer->findPiece(pos);
 
-	if (blockPos + size > blockSize)
+	if (size == 0)
 	{
-		_flatten = true;
-		_memory = (uint8*)NIT_ALLOC(size);
-		buffer->copyTo(_memory, _bufferPos, size);
+		// nothing to access
+	}
+	else if (idx < buffer->_pieces.size() && pos + size <= buffer->_pieces[idx].pos + buffer->_pieces[idx].size)
+	{
+		// The caller may write through the memory, so detach it from other buffers first
+		Piece& piece = buffer->_pieces[idx];
+		buffer->unshare(piece);
+		_memory = piece.data + (pos - piece.pos);
 	}
 	else
 	{
-		_flatten = false;
-		_memory = buffer->_blocks[blockIdx] + blockPos;
+		_flatten = true;
+		_memory = (uint8*)NIT_ALLOC(size);
+		buffer->copyTo(_memory, _bufferPos, size);
 	}
 
 	_pos = 0;
@@ -75,12 +75,19 @@ protected:
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// MemoryBuffer is a sequence of pieces, each of them a slice of a refcounted Block.
+// Insert, erase and slice() only rearrange pieces so no bytes are moved, and
+// several buffers may share a block - a shared block is copied when written (copy on write).
+
 class NIT_API MemoryBuffer : public RefCounted, public PooledAlloc
 {
 public:
 	class Reader;
 	class Writer;
 	class Access;
+	class Block;
+
+	typedef void (*ReleaseFunc)(void* memory, size_t size, void* context);
 
 	MemoryBuffer(size_t blockSize = 0);
 	MemoryBuffer(StreamReader* reader, size_t blockSize = 0);
@@ -88,13 +95,13 @@ public:
 	MemoryBuffer(const void* buf, size_t size, size_t blockSize = 0);
 
 public:
-	size_t								getSize() const							{ return _end - _start; }
-	bool								isEmpty() const							{ return _start == _end; }
+	size_t								getSize() const							{ return _size; }
+	bool								isEmpty() const							{ return _size == 0; }
 
-public:
-	size_t								getNumBlocks() const					{ return _blocks.size(); }
+public:									// A 'block' here is a piece: a contiguous run of memory which may be shorter than block size
+	size_t								getNumBlocks() const					{ return _pieces.size(); }
 	size_t								getBlockSize() const					{ return _blockSize; }
-	bool								getBlock(size_t blockIdx, uint8*& buf, size_t& size) const;
+	bool								getBlock(size_t blockIdx, uint8*& buf, size_t& size) const; // do not write through buf when the buffer may share blocks
 
 public:
 	size_t								load(StreamReader* reader, size_t pos = 0, size_t size = 0);
@@ -106,6 +113,10 @@ public:
 	void								copyFrom(MemoryBuffer* src, size_t srcPos, size_t destPos, size_t size);
 
 	MemoryBuffer*						clone(size_t blockSize = 0);
+	MemoryBuffer*						slice(size_t pos, size_t size = 0);
+
+	void								adopt(void* memory, size_t size, ReleaseFunc release = NULL, void* context = NULL);
+	void								compact();
 
 public:
 	void								compress(bool moreSpeed = false, uint32* outAdler32 = NULL);
@@ -119,23 +130,23 @@ public:
 	void								clear();
 
 	void								pushFront(const String& str)			{ pushFront(str.c_str(), str.length()); }
-	void								pushFront(const void* buf, size_t size);
-	void								pushFront(MemoryBuffer* src, size_t srcPos, size_t size);
+	void								pushFront(const void* buf, size_t size)	{ insert(0, buf, size); }
+	void								pushFront(MemoryBuffer* src, size_t srcPos, size_t size) { insert(0, src, srcPos, size); }
 
 	void								popFront(size_t size);
 
 	void								pushBack(const String& str)				{ pushBack(str.c_str(), str.length()); }
 	void								pushBack(const void* buf, size_t size);
-	void								pushBack(MemoryBuffer* src, size_t srcPos, size_t size);
+	void								pushBack(MemoryBuffer* src, size_t srcPos, size_t size) { insert(_size, src, srcPos, size); }
 
 	void								popBack(size_t size);
 
-	void								insert(size_t pos, size_t size)			{ NIT_THROW(EX_NOT_IMPLEMENTED); }
-	void								insert(size_t pos, const String& str)	{ NIT_THROW(EX_NOT_IMPLEMENTED); }
-	void								insert(size_t pos, const void* buf, size_t size) { NIT_THROW(EX_NOT_IMPLEMENTED); }
-	void								insert(size_t pos, MemoryBuffer* src, size_t srcPos, size_t size) { NIT_THROW(EX_NOT_IMPLEMENTED); }
+	void								insert(size_t pos, size_t size);
+	void								insert(size_t pos, const String& str)	{ insert(pos, str.c_str(), str.length()); }
+	void								insert(size_t pos, const void* buf, size_t size);
+	void								insert(size_t pos, MemoryBuffer* src, size_t srcPos, size_t size);
 
-	void								erase(size_t pos, size_t size)			{ NIT_THROW(EX_NOT_IMPLEMENTED); }
+	void								erase(size_t pos, size_t size);
 
 public:
 	String								toString(bool utf16 = false) const;
@@ -144,13 +155,51 @@ public:
 public:
 	void								hexDump() const;
 
+public:
+	class NIT_API Block : public RefCounted, public PooledAlloc
+	{
+	public:
+		Block(size_t capacity);
+		Block(void* memory, size_t capacity, ReleaseFunc release, void* context);
+
+	public:
+		uint8*							getMemory() const						{ return _memory; }
+		size_t							getCapacity() const						{ return _capacity; }
+		bool							isShared()								{ return getRefCount() > 1; }
+
+	protected:
+		uint8*							_memory;
+		size_t							_capacity;
+		ReleaseFunc						_release;
+		void*							_context;
+
+		virtual void					onDelete();
+	};
+
 protected:
-	uint8*								allocateBlock();
+	struct Piece
+	{
+		Ref<Block>						block;
+		uint8*							data;
+		size_t							size;
+		size_t							pos;									// offset of data within the buffer
+	};
 
-	vector<uint8*>::type				_blocks;
+	typedef vector<Piece>::type			Pieces;
+
+	Pieces								_pieces;
 	size_t								_blockSize;
-	size_t								_start;
-	size_t								_end;
+	size_t								_size;
+	mutable size_t						_cursor;								// last piece found, as sequential access is the common case
+
+	Piece								newPiece(size_t capacity);
+	size_t								findPiece(size_t pos) const;
+	size_t								split(size_t pos);
+	void								unshare(Piece& piece);
+	void								appendRoom(size_t size);
+	void								getPieces(size_t pos, size_t size, Pieces& outPieces) const;
+	void								insertPieces(size_t pos, Pieces& pieces, size_t size);
+	size_t								fill(StreamReader* reader, size_t pos, size_t size);
 
 	friend class Reader;
 	friend class Writer;
@@ -25,8 +25,11 @@
 #include "nit/io/ZStream.h"
 
 #include "nit/runtime/MemManager.h"
+#include "nit/runtime/NitRuntime.h"
 
 #include "nit/io/MemoryBuffer.h"
+#include "nit/async/Thread.h"
+#include "nit/async/EventSemaphore.h"
 
 #include "zlib.h"
 
@@ -329,6 +332,910 @@ uint32 ZStreamWriter::finish()
 
 ////////////////////////////////////////////////////////////////////////////////
 
+static bool InflateBlock(const uint8* src, size_t srcSize, uint8* dest, size_t destSize)
+{
+	z_stream zs		= { 0 };
+	zs.zalloc		= nit_zalloc;
+	zs.zfree		= nit_zfree;
+
+	if (inflateInit(&zs) != Z_OK)
+		return false;
+
+	zs.next_in		= (Bytef*)src;
+	zs.avail_in		= srcSize;
+	zs.next_out		= dest;
+	zs.avail_out	= destSize;
+
+	int err = inflate(&zs, Z_FINISH);
+	bool ok = err == Z_STREAM_END && zs.avail_out == 0;
+
+	inflateEnd(&zs);
+	return ok;
+}
+
+// Runs a set of block jobs on a shared worker pool.
+// The calling thread works on its own set too, so it never waits on workers busy for someone else.
+// Workers start with the first user and are joined when the runtime finishes:
+// from then on the callers work through their sets alone.
+
+class ZBlockPool : public TRuntimeSingleton<ZBlockPool>, public Runnable
+{
+public:
+	typedef void (*JobFunc)(void* context, uint index);
+
+	// Users take the pool in their constructor, so it starts its workers on the thread that creates them
+	static ZBlockPool* acquire()
+	{
+		return &getSingleton();
+	}
+
+	void runAll(JobFunc func, void* context, uint count)
+	{
+		if (count == 1)
+		{
+			func(context, 0);
+			return;
+		}
+
+		process(func, context, count);
+	}
+
+	uint getWorkerCount()								{ Mutex::ScopedLock lock(_mutex); return _threads.size(); }
+
+public:
+	ZBlockPool()
+	{
+		_terminated = false;
+	}
+
+	~ZBlockPool()
+	{
+		terminate();
+	}
+
+public:									// TRuntimeSingleton impl
+	virtual void onInit()
+	{
+		Mutex::ScopedLock lock(_mutex);
+
+		if (!_threads.empty())
+			return;
+
+		_terminated = false;
+
+		int numWorkers = std::max(Thread::getMaxConcurrency() - 1, 1);
+
+		for (int i = 0; i < numWorkers; ++i)
+		{
+			Thread* thread = new Thread("ZBlockPool");
+			thread->start(*this);
+			_threads.push_back(thread);
+		}
+	}
+
+	virtual void onFinish()
+	{
+		terminate();
+	}
+
+private:
+	struct Batch
+	{
+		JobFunc							func;
+		void*							context;
+		uint							count;
+		uint							next;
+		uint							done;
+		EventSemaphore					finished;
+	};
+
+	typedef list<Batch*>::type			Batches;
+
+	Mutex								_mutex;
+	EventSemaphore						_ready;
+	Batches								_batches;
+	vector<Thread*>::type				_threads;
+	bool								_terminated;
+
+	void terminate()
+	{
+		vector<Thread*>::type threads;
+
+		_mutex.lock();
+		_terminated = true;
+		threads.swap(_threads);
+		_mutex.unlock();
+
+		if (threads.empty())
+			return;
+
+		// Each worker finishes the job at hand and wakes the next one on its way out
+		_ready.set();
+
+		for (uint i = 0; i < threads.size(); ++i)
+		{
+			threads[i]->join();
+			safeDelete(threads[i]);
+		}
+	}
+
+	bool isTerminated()
+	{
+		Mutex::ScopedLock lock(_mutex);
+		return _terminated;
+	}
+
+	// Takes a job of 'batch', or of any batch when NULL
+	bool pop(Batch* batch, Batch*& outBatch, uint& outIndex)
+	{
+		Mutex::ScopedLock lock(_mutex);
+
+		for (Batches::iterator itr = _batches.begin(); itr != _batches.end(); ++itr)
+		{
+			Batch* b = *itr;
+			if (batch && b != batch) continue;
+			if (b->next >= b->count) continue;
+
+			outBatch = b;
+			outIndex = b->next++;
+
+			// Signals are not counted: wake another worker for the rest
+			if (b->next < b->count)
+				_ready.set();
+
+			return true;
+		}
+
+		return false;
+	}
+
+	void finish(Batch* batch)
+	{
+		Mutex::ScopedLock lock(_mutex);
+
+		if (++batch->done == batch->count)
+			batch->finished.set();
+	}
+
+	void process(JobFunc func, void* context, uint count)
+	{
+		Batch batch;
+		batch.func = func;
+		batch.context = context;
+		batch.count = count;
+		batch.next = 0;
+		batch.done = 0;
+
+		_mutex.lock();
+		_batches.push_back(&batch);
+		_mutex.unlock();
+
+		_ready.set();
+
+		Batch* b;
+		uint index;
+		while (pop(&batch, b, index))
+		{
+			func(context, index);
+			finish(&batch);
+		}
+
+		// Wait for the jobs workers took
+		batch.finished.wait();
+
+		_mutex.lock();
+		_batches.remove(&batch);
+		_mutex.unlock();
+	}
+
+	virtual void run()
+	{
+		while (!isTerminated())
+		{
+			_ready.wait();
+
+			Batch* b;
+			uint index;
+			while (pop(NULL, b, index))
+			{
+				b->func(b->context, index);
+				finish(b);
+			}
+		}
+
+		// Wake the next worker to let it terminate also
+		_ready.set();
+	}
+};
+
+struct ZInflateTask
+{
+	const uint8*						src;
+	uint32								srcSize;
+	uint8*								dest;
+	uint32								destSize;
+	bool								stored;
+	bool								ok;
+
+	static void run(void* context, uint index)
+	{
+		ZInflateTask& t = ((ZInflateTask*)context)[index];
+
+		if (t.stored)
+		{
+			t.ok = t.srcSize == t.destSize;
+			if (t.ok) memcpy(t.dest, t.src, t.destSize);
+		}
+		else
+		{
+			t.ok = InflateBlock(t.src, t.srcSize, t.dest, t.destSize);
+		}
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+ZParallelStreamWriter::ZParallelStreamWriter(StreamWriter* to, bool moreSpeed, uint numThreads, size_t blockSize)
+: _to(to)
+, _pool(ZBlockPool::acquire())
+, _input(NULL)
+, _inputFill(0)
+, _dict(NULL)
+, _dictSize(0)
+, _headerWritten(false)
+, _finished(false)
+, _totalIn(0)
+, _totalOut(0)
+, _deflateTime(0.0)
+{
+	if (numThreads == 0)
+		numThreads = _pool->getWorkerCount() + 1;
+
+	if (blockSize == 0)
+		blockSize = DEFAULT_BLOCK_SIZE;
+
+	// A block should cover the dictionary of the next one
+	_blockSize = std::max(blockSize, size_t(DICT_SIZE));
+	_level = moreSpeed ? Z_BEST_SPEED : Z_BEST_COMPRESSION;
+	_adler32 = adler32(0L, Z_NULL, 0);
+
+	_slots.resize(numThreads);
+
+	for (uint i = 0; i < _slots.size(); ++i)
+	{
+		Slot& slot = _slots[i];
+		memset(&slot, 0, sizeof(slot));
+
+		z_stream* zs = (z_stream*)NIT_ALLOC(sizeof(z_stream));
+		memset(zs, 0, sizeof(z_stream));
+		zs->zalloc = nit_zalloc;
+		zs->zfree = nit_zfree;
+
+		// Raw deflate: we write the zlib header and trailer around the blocks
+		if (deflateInit2(zs, _level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		{
+			NIT_DEALLOC(zs, sizeof(z_stream));
+			_finished = true;
+			close();
+			NIT_THROW(EX_IO);
+		}
+
+		slot.zstream = zs;
+
+		// Room for a sync flush marker after the worst case
+		slot.outCapacity = deflateBound(zs, _blockSize) + 16;
+		slot.out = (uint8*)NIT_ALLOC(slot.outCapacity);
+	}
+
+	_input = (uint8*)NIT_ALLOC(_blockSize * _slots.size());
+	_dict = (uint8*)NIT_ALLOC(DICT_SIZE);
+}
+
+void ZParallelStreamWriter::deflateSlot(void* context, uint index)
+{
+	ZParallelStreamWriter* self = (ZParallelStreamWriter*)context;
+	Slot& slot = self->_slots[index];
+	z_stream* zs = (z_stream*)slot.zstream;
+
+	slot.ok = false;
+	slot.outSize = 0;
+	slot.adler32 = adler32(adler32(0L, Z_NULL, 0), slot.in, slot.inSize);
+
+	if (deflateReset(zs) != Z_OK)
+		return;
+
+	if (slot.dictSize && deflateSetDictionary(zs, slot.dict, slot.dictSize) != Z_OK)
+		return;
+
+	zs->next_in = (Bytef*)slot.in;
+	zs->avail_in = slot.inSize;
+	zs->next_out = slot.out;
+	zs->avail_out = slot.outCapacity;
+
+	// Sync flush ends on a byte boundary without marking the last block, so the outputs just concatenate
+	int err = deflate(zs, slot.last ? Z_FINISH : Z_SYNC_FLUSH);
+
+	if (slot.last)
+		slot.ok = err == Z_STREAM_END;
+	else
+		slot.ok = err == Z_OK && zs->avail_in == 0 && zs->avail_out > 0;
+
+	slot.outSize = slot.outCapacity - zs->avail_out;
+}
+
+bool ZParallelStreamWriter::deflateBatch(bool last)
+{
+	if (_inputFill == 0 && !last)
+		return true;
+
+	double start = SystemTimer::now();
+
+	if (!_headerWritten)
+	{
+		// CMF: deflate with 32k window, FLG: level hint with the check bits
+		uint8 header[2] = { 0x78, uint8(_level == Z_BEST_SPEED ? 0x01 : 0xDA) };
+		if (_to->writeRaw(header, sizeof(header)) != sizeof(header))
+			return false;
+
+		_totalOut += sizeof(header);
+		_headerWritten = true;
+	}
+
+	uint count = std::max(uint((_inputFill + _blockSize - 1) / _blockSize), 1U);
+
+	for (uint i = 0; i < count; ++i)
+	{
+		Slot& slot = _slots[i];
+		slot.in = _input + i * _blockSize;
+		slot.inSize = std::min(size_t(_blockSize), _inputFill - std::min(_inputFill, size_t(i * _blockSize)));
+		slot.last = last && i == count - 1;
+
+		// Every block but the first of a batch is full, so its dictionary lies just before it
+		slot.dict = i == 0 ? _dict : slot.in - DICT_SIZE;
+		slot.dictSize = i == 0 ? _dictSize : DICT_SIZE;
+	}
+
+	_pool->runAll(deflateSlot, this, count);
+
+	for (uint i = 0; i < count; ++i)
+	{
+		Slot& slot = _slots[i];
+		if (!slot.ok)
+			return false;
+
+		if (_to->writeRaw(slot.out, slot.outSize) != slot.outSize)
+			return false;
+
+		_adler32 = adler32_combine(_adler32, slot.adler32, slot.inSize);
+		_totalOut += slot.outSize;
+	}
+
+	// Keep the last 32k of history for the next batch
+	uint32 take = std::min(_inputFill, size_t(DICT_SIZE));
+	uint32 keep = std::min(_dictSize, DICT_SIZE - take);
+
+	memmove(_dict, _dict + _dictSize - keep, keep);
+	memcpy(_dict + keep, _input + _inputFill - take, take);
+	_dictSize = keep + take;
+
+	_totalIn += _inputFill;
+	_inputFill = 0;
+
+	if (last)
+	{
+		uint8 trailer[4] = 
+		{
+			uint8(_adler32 >> 24), uint8(_adler32 >> 16), uint8(_adler32 >> 8), uint8(_adler32)
+		};
+
+		if (_to->writeRaw(trailer, sizeof(trailer)) != sizeof(trailer))
+			return false;
+
+		_totalOut += sizeof(trailer);
+	}
+
+	_deflateTime += SystemTimer::now() - start;
+
+	return true;
+}
+
+size_t ZParallelStreamWriter::writeRaw(const void* buf, size_t size)
+{
+	if (_finished)
+		NIT_THROW_FMT(EX_WRITE, "Stream already closed");
+
+	const uint8* src = (const uint8*)buf;
+	size_t capacity = _blockSize * _slots.size();
+	size_t left = size;
+
+	while (left > 0)
+	{
+		size_t len = std::min(capacity - _inputFill, left);
+		memcpy(_input + _inputFill, src, len);
+
+		_inputFill += len;
+		src += len;
+		left -= len;
+
+		if (_inputFill == capacity && !deflateBatch(false))
+		{
+			_finished = true;
+			close();
+			NIT_THROW_FMT(EX_WRITE, "can't write parallel zstream");
+		}
+	}
+
+	return size;
+}
+
+bool ZParallelStreamWriter::flush()
+{
+	if (_finished)
+		return false;
+
+	if (!deflateBatch(false))
+	{
+		_finished = true;
+		close();
+		NIT_THROW_FMT(EX_WRITE, "can't write parallel zstream");
+	}
+
+	return true;
+}
+
+bool ZParallelStreamWriter::close()
+{
+	bool ok = true;
+
+	if (!_finished)
+	{
+		_finished = true;
+		ok = deflateBatch(true);
+	}
+
+	for (uint i = 0; i < _slots.size(); ++i)
+	{
+		Slot& slot = _slots[i];
+
+		if (slot.zstream)
+		{
+			deflateEnd((z_stream*)slot.zstream);
+			NIT_DEALLOC(slot.zstream, sizeof(z_stream));
+			slot.zstream = NULL;
+		}
+
+		if (slot.out)
+		{
+			NIT_DEALLOC(slot.out, slot.outCapacity);
+			slot.out = NULL;
+		}
+	}
+
+	if (_input)
+	{
+		NIT_DEALLOC(_input, _blockSize * _slots.size());
+		_input = NULL;
+	}
+
+	if (_dict)
+	{
+		NIT_DEALLOC(_dict, DICT_SIZE);
+		_dict = NULL;
+	}
+
+	return ok;
+}
+
+void ZParallelStreamWriter::onDelete()
+{
+	// Nowhere to throw from here: report what finish() wasn't called to catch
+	if (!close())
+		LOG(0, "*** can't write parallel zstream: last batch failed\n");
+
+	StreamWriter::onDelete();
+}
+
+uint32 ZParallelStreamWriter::finish()
+{
+	if (!close())
+		NIT_THROW_FMT(EX_WRITE, "can't write parallel zstream");
+
+	return _adler32;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static inline uint32 ReadLE32(const uint8* p)
+{
+	return uint32(p[0]) | (uint32(p[1]) << 8) | (uint32(p[2]) << 16) | (uint32(p[3]) << 24);
+}
+
+static inline void WriteLE32(uint8* p, uint32 value)
+{
+	p[0] = uint8(value);
+	p[1] = uint8(value >> 8);
+	p[2] = uint8(value >> 16);
+	p[3] = uint8(value >> 24);
+}
+
+ZChunkedStreamReader::ZChunkedStreamReader(StreamReader* from)
+: _from(from)
+, _pool(ZBlockPool::acquire())
+, _blockSize(0)
+, _contentSize(0)
+, _adler32(0)
+, _pos(0)
+, _verifiedSize(0)
+, _cachedBlock(-1)
+, _cache(NULL)
+, _inflatedCount(0)
+, _inflateTime(0.0)
+{
+	_verifiedAdler32 = adler32(0L, Z_NULL, 0);
+
+	if (!from->isSeekable() || !from->isSized())
+		NIT_THROW_FMT(EX_NOT_SUPPORTED, "'%s': chunked zstream needs a seekable source", from->getUrl().c_str());
+
+	size_t size = from->getSize();
+
+	uint8 trailer[5 * sizeof(uint32)];
+	if (size < sizeof(trailer))
+		NIT_THROW_FMT(EX_CORRUPTED, "'%s': invalid chunked zstream", from->getUrl().c_str());
+
+	from->seek(size - sizeof(trailer));
+	if (from->readRaw(trailer, sizeof(trailer)) != sizeof(trailer))
+		NIT_THROW_FMT(EX_CORRUPTED, "'%s': invalid chunked zstream", from->getUrl().c_str());
+
+	_blockSize = ReadLE32(trailer + 0);
+	_contentSize = ReadLE32(trailer + 4);
+	uint32 numBlocks = ReadLE32(trailer + 8);
+	_adler32 = ReadLE32(trailer + 12);
+
+	bool ok = ReadLE32(trailer + 16) == NIT_ZCHUNK_SIGNATURE;
+	ok = ok && _blockSize > 0 && _blockSize <= 16 * 1024 * 1024;
+	ok = ok && numBlocks == (_contentSize + _blockSize - 1) / _blockSize;
+	ok = ok && size >= sizeof(trailer) + numBlocks * sizeof(uint32);
+
+	if (!ok)
+		NIT_THROW_FMT(EX_CORRUPTED, "'%s': invalid chunked zstream", from->getUrl().c_str());
+
+	vector<uint8>::type index(numBlocks * sizeof(uint32));
+	size_t indexPos = size - sizeof(trailer) - index.size();
+
+	if (numBlocks > 0)
+	{
+		from->seek(indexPos);
+		if (from->readRaw(&index[0], index.size()) != index.size())
+			NIT_THROW_FMT(EX_CORRUPTED, "'%s': invalid chunked zstream index", from->getUrl().c_str());
+	}
+
+	_blocks.resize(numBlocks);
+
+	uint32 offset = 0;
+	for (uint i = 0; i < numBlocks; ++i)
+	{
+		uint32 entry = ReadLE32(&index[i * sizeof(uint32)]);
+
+		Block& b = _blocks[i];
+		b.offset = offset;
+		b.packedSize = entry & ~NIT_ZCHUNK_STORED;
+		b.stored = (entry & NIT_ZCHUNK_STORED) != 0;
+		offset += b.packedSize;
+	}
+
+	if (offset != indexPos)
+		NIT_THROW_FMT(EX_CORRUPTED, "'%s': invalid chunked zstream index", from->getUrl().c_str());
+}
+
+void ZChunkedStreamReader::onDelete()
+{
+	close();
+
+	StreamReader::onDelete();
+}
+
+void ZChunkedStreamReader::close()
+{
+	if (_cache)
+	{
+		NIT_DEALLOC(_cache, _blockSize);
+		_cache = NULL;
+	}
+
+	_cachedBlock = -1;
+}
+
+void ZChunkedStreamReader::skip(int count)
+{
+	seek(size_t(Math::clamp(int(_pos) + count, 0, int(_contentSize))));
+}
+
+void ZChunkedStreamReader::seek(size_t pos)
+{
+	// Nothing happens until the next read
+	_pos = std::min(pos, size_t(_contentSize));
+}
+
+void ZChunkedStreamReader::inflateBlocks(uint first, uint count, uint8* dest)
+{
+	double start = SystemTimer::now();
+
+	// One read for the packed range of all blocks
+	const Block& last = _blocks[first + count - 1];
+	uint32 begin = _blocks[first].offset;
+	uint32 packedSize = last.offset + last.packedSize - begin;
+
+	_packed.resize(packedSize);
+
+	_from->seek(begin);
+	if (_from->readRaw(&_packed[0], packedSize) != packedSize)
+		NIT_THROW_FMT(EX_READ, "'%s': unexpected EOF in chunked zstream", _from->getUrl().c_str());
+
+	ZInflateTask tasks[MAX_PARALLEL_BLOCKS];
+
+	for (uint i = 0; i < count; ++i)
+	{
+		const Block& b = _blocks[first + i];
+
+		ZInflateTask& t = tasks[i];
+		t.src		= &_packed[b.offset - begin];
+		t.srcSize	= b.packedSize;
+		t.dest		= dest;
+		t.destSize	= getBlockLength(first + i);
+		t.stored	= b.stored;
+		t.ok		= false;
+
+		dest += t.destSize;
+	}
+
+	_pool->runAll(ZInflateTask::run, tasks, count);
+
+	_inflatedCount += count;
+	_inflateTime += SystemTimer::now() - start;
+
+	for (uint i = 0; i < count; ++i)
+	{
+		if (!tasks[i].ok)
+			NIT_THROW_FMT(EX_CORRUPTED, "'%s': can't inflate chunk %d", _from->getUrl().c_str(), first + i);
+	}
+}
+
+size_t ZChunkedStreamReader::readRaw(void* buf, size_t size)
+{
+	if (_pos >= _contentSize)
+		return 0;
+
+	size = std::min(size, _contentSize - _pos);
+
+	size_t start = _pos;
+	uint8* dest = (uint8*)buf;
+	size_t left = size;
+
+	while (left > 0)
+	{
+		uint block = _pos / _blockSize;
+		uint32 blockPos = _pos % _blockSize;
+		uint32 blockLen = getBlockLength(block);
+
+		if (blockPos == 0 && left >= blockLen && int(block) != _cachedBlock)
+		{
+			// Whole blocks go straight into the caller's buffer, inflated in parallel
+			uint count = 0;
+			size_t bytes = 0;
+
+			while (block + count < _blocks.size() && count < MAX_PARALLEL_BLOCKS)
+			{
+				uint32 len = getBlockLength(block + count);
+				if (bytes + len > left) break;
+				bytes += len;
+				++count;
+			}
+
+			inflateBlocks(block, count, dest);
+
+			dest += bytes;
+			left -= bytes;
+			_pos += bytes;
+			continue;
+		}
+
+		if (int(block) != _cachedBlock)
+		{
+			if (_cache == NULL)
+				_cache = (uint8*)NIT_ALLOC(_blockSize);
+
+			_cachedBlock = -1;
+			inflateBlocks(block, 1, _cache);
+			_cachedBlock = block;
+		}
+
+		size_t len = std::min(size_t(blockLen - blockPos), left);
+		memcpy(dest, _cache + blockPos, len);
+
+		dest += len;
+		left -= len;
+		_pos += len;
+	}
+
+	// Content read in order extends the checksum, which must match the trailer once all read.
+	// Random access past the verified part can't be checked without inflating what it skips.
+	if (start <= _verifiedSize && _pos > _verifiedSize)
+	{
+		const uint8* fresh = (const uint8*)buf + (_verifiedSize - start);
+		_verifiedAdler32 = adler32(_verifiedAdler32, fresh, _pos - _verifiedSize);
+		_verifiedSize = _pos;
+
+		if (_verifiedSize == _contentSize && _verifiedAdler32 != _adler32)
+		{
+			_verifiedSize = 0;
+			_verifiedAdler32 = adler32(0L, Z_NULL, 0);
+			NIT_THROW_FMT(EX_CORRUPTED, "'%s': chunked zstream adler32 mismatch", _from->getUrl().c_str());
+		}
+	}
+
+	return size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ZChunkedStreamWriter::ZChunkedStreamWriter(StreamWriter* to, bool moreSpeed, size_t blockSize)
+: _to(to)
+, _zstream(NULL)
+, _block(NULL)
+, _blockFill(0)
+, _contentSize(0)
+{
+	if (blockSize == 0)
+		blockSize = DEFAULT_BLOCK_SIZE;
+
+	_blockSize = blockSize;
+	_adler32 = adler32(0L, Z_NULL, 0);
+
+	_zstream = NIT_ALLOC(sizeof(z_stream));
+	memset(_zstream, 0, sizeof(z_stream));
+
+	z_stream* zs = (z_stream*)_zstream;
+	zs->opaque = this;
+	zs->zalloc = nit_zalloc;
+	zs->zfree = nit_zfree;
+
+	if (deflateInit(zs, moreSpeed ? Z_BEST_SPEED : Z_BEST_COMPRESSION) != Z_OK)
+	{
+		NIT_DEALLOC(_zstream, sizeof(z_stream));
+		NIT_THROW(EX_IO);
+	}
+
+	_block = (uint8*)NIT_ALLOC(_blockSize);
+	_packed.resize(deflateBound(zs, _blockSize));
+}
+
+size_t ZChunkedStreamWriter::writeRaw(const void* buf, size_t size)
+{
+	if (_zstream == NULL)
+		NIT_THROW_FMT(EX_WRITE, "Stream already closed");
+
+	const uint8* src = (const uint8*)buf;
+	size_t left = size;
+
+	while (left > 0)
+	{
+		size_t len = std::min(size_t(_blockSize - _blockFill), left);
+		memcpy(_block + _blockFill, src, len);
+
+		_blockFill += len;
+		src += len;
+		left -= len;
+
+		if (_blockFill == _blockSize)
+			writeBlock();
+	}
+
+	_adler32 = adler32(_adler32, (const Bytef*)buf, size);
+	_contentSize += size;
+
+	return size;
+}
+
+void ZChunkedStreamWriter::writeBlock()
+{
+	if (_blockFill == 0)
+		return;
+
+	z_stream* zs = (z_stream*)_zstream;
+
+	deflateReset(zs);
+	zs->next_in = _block;
+	zs->avail_in = _blockFill;
+	zs->next_out = &_packed[0];
+	zs->avail_out = _packed.size();
+
+	int err = deflate(zs, Z_FINISH);
+	if (err != Z_STREAM_END)
+	{
+		String msg = zs->msg ? zs->msg : "";
+		close();
+		NIT_THROW_FMT(EX_WRITE, "can't write zstream: %s (%d)", msg.c_str(), err);
+	}
+
+	uint32 packedSize = _packed.size() - zs->avail_out;
+
+	// Keep a block which didn't shrink as is
+	bool stored = packedSize >= _blockFill;
+	const void* data = stored ? (const void*)_block : (const void*)&_packed[0];
+	uint32 dataSize = stored ? _blockFill : packedSize;
+
+	if (_to->writeRaw(data, dataSize) != dataSize)
+	{
+		close();
+		NIT_THROW_FMT(EX_WRITE, "can't write to target stream");
+	}
+
+	_index.push_back(stored ? (dataSize | NIT_ZCHUNK_STORED) : dataSize);
+	_blockFill = 0;
+}
+
+void ZChunkedStreamWriter::close()
+{
+	if (_zstream)
+	{
+		deflateEnd((z_stream*)_zstream);
+		NIT_DEALLOC(_zstream, sizeof(z_stream));
+		_zstream = NULL;
+	}
+
+	if (_block)
+	{
+		NIT_DEALLOC(_block, _blockSize);
+		_block = NULL;
+	}
+}
+
+uint32 ZChunkedStreamWriter::finish()
+{
+	if (_zstream == NULL)
+		return _adler32;
+
+	writeBlock();
+
+	vector<uint8>::type tail((_index.size() + 5) * sizeof(uint32));
+	uint8* p = &tail[0];
+
+	for (uint i = 0; i < _index.size(); ++i, p += sizeof(uint32))
+		WriteLE32(p, _index[i]);
+
+	WriteLE32(p + 0, _blockSize);
+	WriteLE32(p + 4, _contentSize);
+	WriteLE32(p + 8, _index.size());
+	WriteLE32(p + 12, _adler32);
+	WriteLE32(p + 16, NIT_ZCHUNK_SIGNATURE);
+
+	bool ok = _to->writeRaw(&tail[0], tail.size()) == tail.size();
+
+	close();
+
+	if (!ok)
+		NIT_THROW_FMT(EX_WRITE, "can't write chunked zstream index to target stream");
+
+	return _adler32;
+}
+
+void ZChunkedStreamWriter::onDelete()
+{
+	// Nowhere to throw from here: report what finish() wasn't called to catch
+	try
+	{
+		finish();
+	}
+	catch (Exception& ex)
+	{
+		LOG(0, "*** %s\n", ex.getFullDescription().c_str());
+	}
+
+	StreamWriter::onDelete();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 // TODO: Refactor to somewhere
 
 void MemoryBuffer::compress(bool moreSpeed, uint32* outAdler32)
@@ -346,36 +1253,27 @@ void MemoryBuffer::compress(bool moreSpeed, uint32* outAdler32)
 	if (deflateInit(&zs, moreSpeed ? Z_BEST_SPEED : Z_BEST_COMPRESSION) != Z_OK)
 		NIT_THROW(EX_IO);
 
-	size_t pos = _start;
-	size_t blockIdx = pos / _blockSize;
-	size_t blockPos = pos % _blockSize;
+	size_t pieceIdx = 0;
 
-	vector<uint8*>::type newBlocks;
+	Pieces newPieces;
 
 	// compress routine
 	bool done = false;
 
 	while (true)
 	{
-		if (size)
+		if (zs.avail_in == 0 && pieceIdx < _pieces.size())
 		{
-			if (zs.avail_in == 0)
-			{
-				zs.next_in = _blocks[blockIdx] + blockPos;
-				zs.avail_in = _blockSize - blockPos;
-				if (zs.avail_in > size)
-					zs.avail_in = size;
-				size -= zs.avail_in;
-				++blockIdx;
-				blockPos = 0;
-			}
+			const Piece& piece = _pieces[pieceIdx++];
+			zs.next_in = piece.data;
+			zs.avail_in = piece.size;
 		}
 
 		if (zs.avail_out == 0)
 		{
-			zs.next_out = allocateBlock();
+			newPieces.push_back(newPiece(_blockSize));
+			zs.next_out = newPieces.back().data;
 			zs.avail_out = _blockSize;
-			newBlocks.push_back(zs.next_out);
 		}
 
 		int err = deflate(&zs, done ? Z_FINISH : Z_NO_FLUSH); 
@@ -389,19 +1287,29 @@ void MemoryBuffer::compress(bool moreSpeed, uint32* outAdler32)
 		{
 			String msg = zs.msg ? zs.msg : "";
 			deflateEnd(&zs);
-			for (uint i=0; i<newBlocks.size(); ++i)
-			{
-				 NIT_DEALLOC(newBlocks[i], _blockSize);
-			}
 			NIT_THROW_FMT(EX_WRITE, "can't compress: %s (%d)", msg.c_str(), err);
 		}
 
-		done = zs.avail_in == 0 && size == 0;
+		done = zs.avail_in == 0 && pieceIdx == _pieces.size();
 	}
 
 	clear();
-	_blocks.swap(newBlocks);
-	_end = zs.total_out;
+	_pieces.swap(newPieces);
+	_size = zs.total_out;
+
+	// every output piece but the last one is full
+	for (uint i = 0; i < _pieces.size(); ++i)
+	{
+		_pieces[i].pos = i * _blockSize;
+		_pieces[i].size = _blockSize;
+	}
+
+	if (!_pieces.empty())
+	{
+		_pieces.back().size = _size - _pieces.back().pos;
+		if (_pieces.back().size == 0)
+			_pieces.pop_back();
+	}
 
 	if (outAdler32)
 		*outAdler32= zs.adler;
@@ -424,34 +1332,25 @@ void MemoryBuffer::uncompress(uint32* outAdler32)
 	if (inflateInit2(&zs, AUTODETECT_ZLIB_GZIP))
 		NIT_THROW(EX_IO);
 
-	size_t pos = _start;
-	size_t blockIdx = pos / _blockSize;
-	size_t blockPos = pos % _blockSize;
+	size_t pieceIdx = 0;
 
-	vector<uint8*>::type newBlocks;
+	Pieces newPieces;
 
 	// uncompress routine
 	while (true)
 	{
-		if (size)
+		if (zs.avail_in == 0 && pieceIdx < _pieces.size())
 		{
-			if (zs.avail_in == 0)
-			{
-				zs.next_in = _blocks[blockIdx] + blockPos;
-				zs.avail_in = _blockSize - blockPos;
-				if (zs.avail_in > size)
-					zs.avail_in = size;
-				size -= zs.avail_in;
-				++blockIdx;
-				blockPos = 0;
-			}
+			const Piece& piece = _pieces[pieceIdx++];
+			zs.next_in = piece.data;
+			zs.avail_in = piece.size;
 		}
 
 		if (zs.avail_out == 0)
 		{
-			zs.next_out = allocateBlock();
+			newPieces.push_back(newPiece(_blockSize));
+			zs.next_out = newPieces.back().data;
 			zs.avail_out = _blockSize;
-			newBlocks.push_back(zs.next_out);
 		}
 
 		int err = inflate(&zs, Z_SYNC_FLUSH);
@@ -463,17 +1362,27 @@ void MemoryBuffer::uncompress(uint32* outAdler32)
 		{
 			String msg = zs.msg ? zs.msg : "";
 			inflateEnd(&zs);
-			for (uint i=0; i<newBlocks.size(); ++i)
-			{
-				NIT_DEALLOC(newBlocks[i], _blockSize);
-			}
 			NIT_THROW_FMT(EX_WRITE, "can't uncompress: %s (%d)", msg.c_str(), err);
 		}
 	}
 
 	clear();
-	_blocks.swap(newBlocks);
-	_end = zs.total_out;
+	_pieces.swap(newPieces);
+	_size = zs.total_out;
+
+	// every output piece but the last one is full
+	for (uint i = 0; i < _pieces.size(); ++i)
+	{
+		_pieces[i].pos = i * _blockSize;
+		_pieces[i].size = _blockSize;
+	}
+
+	if (!_pieces.empty())
+	{
+		_pieces.back().size = _size - _pieces.back().pos;
+		if (_pieces.back().size == 0)
+			_pieces.pop_back();
+	}
 
 	if (outAdler32)
 		*outAdler32 = zs.adler;
@@ -567,7 +1476,7 @@ uint32 MemoryBuffer::calcCrc32()
 {
 	uLong crc = crc32(0L, Z_NULL, 0);
 
-	for (uint i = 0; i < _blocks.size(); ++i)
+	for (uint i = 0; i < getNumBlocks(); ++i)
 	{
 		uint8* buf; size_t size;
 		getBlock(i, buf, size);
@@ -581,7 +1490,7 @@ uint32 MemoryBuffer::calcAdler32()
 {
 	uLong adler = adler32(0L, Z_NULL, 0);
 
-	for (uint i = 0; i < _blocks.size(); ++i)
+	for (uint i = 0; i < getNumBlocks(); ++i)
 	{
 		uint8* buf; size_t size;
 		getBlock(i, buf, size);
@@ -28,6 +28,10 @@ NS_NIT_BEGIN;
 
 ////////////////////////////////////////////////////////////////////////////////
 
+class ZBlockPool;
+
+////////////////////////////////////////////////////////////////////////////////
+
 class NIT_API ZStreamReader : public StreamReader
 {
 public:
@@ -106,4 +110,200 @@ private:
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Writes a standard zlib stream (readable by ZStreamReader) using the shared block worker pool.
+// Input is split into blocks deflated independently, each primed with the last 32k of input before it
+// as a preset dictionary, so the ratio stays close to a single deflate stream.
+// Worth it for large content only: input is held until 'numThreads' blocks are collected.
+
+class NIT_API ZParallelStreamWriter : public StreamWriter
+{
+public:
+	ZParallelStreamWriter(StreamWriter* to, bool moreSpeed = false, uint numThreads = 0, size_t blockSize = 0);	// numThreads = 0: all cores
+
+public:
+	StreamWriter*						getTo()									{ return _to; }
+	uint32								finish();
+
+	uint								getNumThreads()							{ return _slots.size(); }
+	size_t								getTotalIn()							{ return _totalIn; }
+	size_t								getTotalOut()							{ return _totalOut; }
+	double								getDeflateTime()						{ return _deflateTime; }	// seconds spent on deflating batches
+
+	static const uint32					DEFAULT_BLOCK_SIZE = 128 * 1024;
+	static const uint32					DICT_SIZE = 32 * 1024;
+
+public:									// StreamWriter impl
+	virtual StreamSource*				getSource()								{ return _to->getSource(); }
+	virtual bool						isBuffered()							{ return false; }
+	virtual bool						isSized()								{ return false; }
+	virtual bool						isSeekable()							{ return false; }
+	virtual size_t						getSize()								{ NIT_THROW(EX_NOT_SUPPORTED); }
+	virtual void						skip(int count)							{ NIT_THROW(EX_NOT_SUPPORTED); }
+	virtual void						seek(size_t pos)						{ NIT_THROW(EX_NOT_SUPPORTED); }
+	virtual size_t						tell()									{ NIT_THROW(EX_NOT_SUPPORTED); }
+	virtual size_t						writeRaw(const void* buf, size_t size);
+	virtual bool						flush();								// deflates pending input with a sync flush
+
+protected:
+	virtual void						onDelete();
+
+private:
+	struct Slot
+	{
+		void*							zstream;
+		uint8*							out;
+		uint32							outCapacity;
+		uint32							outSize;
+		const uint8*					in;
+		uint32							inSize;
+		const uint8*					dict;
+		uint32							dictSize;
+		uint32							adler32;
+		bool							last;
+		bool							ok;
+	};
+
+	Ref<StreamWriter>					_to;
+	ZBlockPool*							_pool;					// acquired by the constructor, on the creating thread
+	vector<Slot>::type					_slots;
+	int									_level;
+	uint32								_blockSize;
+	uint8*								_input;
+	size_t								_inputFill;
+	uint8*								_dict;
+	uint32								_dictSize;
+	uint32								_adler32;
+	bool								_headerWritten;
+	bool								_finished;
+
+	size_t								_totalIn;
+	size_t								_totalOut;
+	double								_deflateTime;
+
+	bool								deflateBatch(bool last);
+	static void							deflateSlot(void* context, uint index);
+	bool								close();								// false if the last batch failed
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Chunked zstream: the content is split into blocks of equal size (but the last) compressed independently,
+// followed by a block index and a trailer:
+//   { block }* [uint32 packedSize | NIT_ZCHUNK_STORED]* [uint32 blockSize] [uint32 contentSize] [uint32 numBlocks] [uint32 adler32] [uint32 'ZCHK']
+// The index and trailer are little endian on every platform, so packs built for either byte order read the same.
+// A reader seeks to any offset by inflating only the block containing it,
+// and inflates the whole blocks of a large read in parallel.
+
+#define NIT_ZCHUNK_SIGNATURE			NIT_MAKE_CC('Z', 'C', 'H', 'K')
+#define NIT_ZCHUNK_STORED				0x80000000		// block kept as is, as it didn't compress
+
+class NIT_API ZChunkedStreamReader : public StreamReader
+{
+public:
+	ZChunkedStreamReader(StreamReader* from);									// 'from' should be seekable and sized
+
+public:
+	StreamReader*						getFrom()								{ return _from; }
+
+	uint32								getBlockSize()							{ return _blockSize; }
+	uint32								getBlockCount()							{ return _blocks.size(); }
+	uint32								getAdler32()							{ return _adler32; }		// of the whole content, as written
+	bool								isVerified()							{ return _verifiedSize == _contentSize; }	// read through in order, adler32 matched
+
+	uint								getInflatedCount()						{ return _inflatedCount; }	// blocks inflated so far
+	double								getInflateTime()						{ return _inflateTime; }	// seconds spent reading and inflating blocks
+
+public:									// StreamReader impl
+	virtual StreamSource*				getSource()								{ return _from->getSource(); }
+	virtual bool						isBuffered()							{ return false; }
+	virtual bool						isSized()								{ return true; }
+	virtual bool						isSeekable()							{ return true; }
+	virtual bool						isEof()									{ return _pos >= _contentSize; }
+	virtual size_t						getSize()								{ return _contentSize; }
+	virtual void						skip(int count);
+	virtual void						seek(size_t pos);
+	virtual size_t						tell()									{ return _pos; }
+	virtual size_t						readRaw(void* buf, size_t size);
+
+protected:
+	virtual void						onDelete();
+
+private:
+	struct Block
+	{
+		uint32							offset;
+		uint32							packedSize;
+		bool							stored;
+	};
+
+	Ref<StreamReader>					_from;
+	ZBlockPool*							_pool;
+	vector<Block>::type					_blocks;
+	uint32								_blockSize;
+	uint32								_contentSize;
+	uint32								_adler32;
+	size_t								_pos;
+
+	uint32								_verifiedSize;			// content read in order from the start so far
+	uint32								_verifiedAdler32;		// of that content
+
+	int									_cachedBlock;
+	uint8*								_cache;
+	vector<uint8>::type					_packed;
+
+	uint								_inflatedCount;
+	double								_inflateTime;
+
+	static const uint					MAX_PARALLEL_BLOCKS = 32;
+
+	uint32								getBlockLength(uint block)				{ return block + 1 < _blocks.size() ? _blockSize : _contentSize - block * _blockSize; }
+	void								inflateBlocks(uint first, uint count, uint8* dest);
+	void								close();
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+class NIT_API ZChunkedStreamWriter : public StreamWriter
+{
+public:
+	ZChunkedStreamWriter(StreamWriter* to, bool moreSpeed = false, size_t blockSize = 0);
+
+public:
+	StreamWriter*						getTo()									{ return _to; }
+	uint32								finish();								// writes the index and returns adler32 of the content
+
+	static const uint32					DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+public:									// StreamWriter impl
+	virtual StreamSource*				getSource()								{ return _to->getSource(); }
+	virtual bool						isBuffered()							{ return false; }
+	virtual bool						isSized()								{ return false; }
+	virtual bool						isSeekable()							{ return false; }
+	virtual size_t						getSize()								{ return _contentSize; }
+	virtual void						skip(int count)							{ NIT_THROW(EX_NOT_SUPPORTED); }
+	virtual void						seek(size_t pos)						{ NIT_THROW(EX_NOT_SUPPORTED); }
+	virtual size_t						tell()									{ return _contentSize; }
+	virtual size_t						writeRaw(const void* buf, size_t size);
+	virtual bool						flush()									{ return false; }	// only whole blocks go out
+
+protected:
+	virtual void						onDelete();
+
+private:
+	Ref<StreamWriter>					_to;
+	void*								_zstream;
+	uint32								_blockSize;
+	uint8*								_block;
+	uint32								_blockFill;
+	vector<uint8>::type					_packed;
+	vector<uint32>::type				_index;
+	uint32								_contentSize;
+	uint32								_adler32;
+
+	void								writeBlock();
+	void								close();
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
 NS_NIT_END;
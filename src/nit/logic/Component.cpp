@@ -42,6 +42,9 @@ Component::Component()
 	_status.set(GCS_ACTIVE, true);
 
 	_feature = NULL;
+
+	_typeID = 0;
+	_typeSlot = 0;
 }
 
 Component::~Component()
@@ -73,6 +76,15 @@ void Component::setName(const String& name)
 	if (ok) _name = name;
 }
 
+ComponentTypeID Component::getTypeID()
+{
+	// typeid(*this) is not final during construction, so resolve lazily
+	if (_typeID == 0)
+		_typeID = World::getComponentTypeID(typeid(*this));
+
+	return _typeID;
+}
+
 void Component::setActive(bool flag)
 {
 	if (isActive() == flag) return;
@@ -33,6 +33,9 @@ class Object;
 class Component;
 class Feature;
 
+// Runtime id of a concrete component class, assigned on first use (0 = not yet assigned)
+typedef uint ComponentTypeID;
+
 ////////////////////////////////////////////////////////////////////////////////
 
 enum ComponentStatusFlag
@@ -64,6 +67,8 @@ public:
 	const String&						getName()								{ return _name; }
 	void								setName(const String& name);
 
+	ComponentTypeID						getTypeID();
+
 	bool								isActive()								{ return _status.any(GCS_ACTIVE); }
 	void								setActive(bool flag);
 
@@ -95,6 +100,10 @@ protected:
 private:
 	friend class						Object;
 	friend class						Feature;
+	friend class						World;
+
+	ComponentTypeID						_typeID;
+	uint								_typeSlot;						// index into World's packed array of _typeID
 
 	void								_reactivate();
 	void								_deactivate();
@@ -350,6 +350,9 @@ bool Object::_attachComponent(Component* comp)
 	_components.insert(std::make_pair(comp->getName(), comp));
 	comp->_object = this;
 
+	if (_world)
+		_world->_registerComponent(comp);
+
 	endEdit();
 
 	return true;
@@ -380,6 +383,7 @@ bool Object::_detachComponent(Component* comp)
 			_status.set(GOS_REACTIVATING, true);
 			comp->_deactivate();
 			_components.erase(itr);
+			if (_world) _world->_unregisterComponent(comp);
 			_status.set(GOS_REACTIVATING, false);
 			endEdit();
 			return true;
@@ -419,6 +423,7 @@ bool Object::_renameComponent(Component* comp, const String& name)
 			// reattach - erase and insert
 			_components.erase(itr);
 			_components.insert(std::make_pair(name, comp));
+			if (_world) _world->_renameComponent(comp, name);
 			endEdit();
 			return true;
 		}
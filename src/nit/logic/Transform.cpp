@@ -36,7 +36,7 @@ NS_NIT_BEGIN;
 ////////////////////////////////////////////////////////////////////////////////
 
 Transform::Transform() 
-: _transformCount(0)
+: _transformCount(0), _updateStamp(0), _xformSlot(0)
 {
 	_name = "Transform";
 	_position = Vector3::ZERO;
@@ -44,6 +44,18 @@ Transform::Transform()
 	_offset = NULL;
 }
 
+Matrix4 Transform::getWorldMatrix()
+{
+	World* world = getWorld();
+
+	if (world)
+		return world->getWorldMatrix(this);
+
+	Matrix4 m;
+	m.makeTransform(_position, Vector3::UNIT_SCALE, _rotation);
+	return m;
+}
+
 void Transform::move(const Vector3& delta)
 {
 	setPosition(getPosition() + delta);
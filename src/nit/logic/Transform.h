@@ -52,6 +52,9 @@ public:
 	const Vector3&						getPosition()							{ return _position; }
 	const Quat&							getRotation()							{ return _rotation; }
 
+	// Cached by World::updateTransforms() when attached - recomputed here only if changed since
+	Matrix4								getWorldMatrix();
+
 	void								setPosition(const Vector3& pos)			{ beginTransform(); _position = pos; endTransform(); }
 	void								setRotation(const Quat& rot)			{ beginTransform(); _rotation = rot; endTransform(); }
 
@@ -134,6 +137,9 @@ protected:
 private:
 	friend class						TransformAnchor;
 	Ref<SyncGroup>						_syncGroup;
+
+	friend class						World;
+	uint								_xformSlot;						// index into World's transform arrays
 };
 
 ////////////////////////////////////////////////////////////////////////////////
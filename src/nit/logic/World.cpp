@@ -26,6 +26,7 @@
 #include "nit/logic/Object.h"
 #include "nit/logic/Component.h"
 #include "nit/logic/Feature.h"
+#include "nit/logic/Transform.h"
 
 #include "nit/app/Package.h"
 #include "nit/app/Session.h"
@@ -36,6 +37,8 @@
 
 #include "nit/event/Timer.h"
 
+#include "nit/async/AsyncJob.h"
+
 NS_NIT_BEGIN;
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -43,6 +46,8 @@ NS_NIT_BEGIN;
 World::World()
 {
 	_name = "World";
+	_cellSize = 100;
+	_xformJobsPending = 0;
 }
 
 World::~World()
@@ -67,6 +72,22 @@ bool World::dispose()
 	}
 
 	_attached.clear();
+	_objectIndex.clear();
+	_componentIndex.clear();
+	_typeArrays.clear();
+
+	_xforms.clear();
+	_xformStamps.clear();
+	_xformPositions.clear();
+	_xformRotations.clear();
+	_worldMatrices.clear();
+	_dirtyXforms.clear();
+	_grid.clear();
+	_xformCells.clear();
+
+	if (_xformJobs)
+		_xformJobs->stop();
+	_xformJobs = NULL;
 
 	_status = GWS_DISPOSED;
 
@@ -126,6 +147,10 @@ bool World::_attachObject(Object* object)
 	if (isDisposed()) return false;
 
 	_attached.insert(object);
+	_objectIndex.insert(std::make_pair(object->getName(), object));
+
+	for (Object::Components::iterator itr = object->_components.begin(), end = object->_components.end(); itr != end; ++itr)
+		_registerComponent(itr->second);
 
 	return true;
 }
@@ -134,6 +159,19 @@ bool World::_detachObject(Object* object)
 {
 	if (isDisposed()) return false;
 
+	for (Object::Components::iterator itr = object->_components.begin(), end = object->_components.end(); itr != end; ++itr)
+		_unregisterComponent(itr->second);
+
+	std::pair<ObjectNameIndex::iterator, ObjectNameIndex::iterator> r = _objectIndex.equal_range(object->getName());
+	for (ObjectNameIndex::iterator itr = r.first; itr != r.second; ++itr)
+	{
+		if (itr->second == object)
+		{
+			_objectIndex.erase(itr);
+			break;
+		}
+	}
+
 	ObjectSet::iterator itr = _attached.find(object);
 
 	_attached.erase(itr);
@@ -145,13 +183,575 @@ bool World::_renameObject(Object* object, const String& name)
 {
 	if (isDisposed()) return false;
 
-	// Nothing to do yet
+	std::pair<ObjectNameIndex::iterator, ObjectNameIndex::iterator> r = _objectIndex.equal_range(object->getName());
+	for (ObjectNameIndex::iterator itr = r.first; itr != r.second; ++itr)
+	{
+		if (itr->second == object)
+		{
+			_objectIndex.erase(itr);
+			break;
+		}
+	}
+
+	_objectIndex.insert(std::make_pair(name, object));
 
 	return true;
 }
 
+// Keyed by name rather than type_info address: the latter may differ across module boundaries
+typedef map<String, ComponentTypeID>::type ComponentTypeIDs;
+
+static ComponentTypeIDs					s_TypeIDs;
+static Mutex							s_TypeIDMutex;
+
+ComponentTypeID World::getComponentTypeID(const std::type_info& type)
+{
+	// Called lazily by Component::getTypeID(), which may run on worker threads as well
+	Mutex::ScopedLock lock(s_TypeIDMutex);
+
+	ComponentTypeIDs::iterator itr = s_TypeIDs.find(type.name());
+	if (itr != s_TypeIDs.end())
+		return itr->second;
+
+	ComponentTypeID id = s_TypeIDs.size() + 1;
+	s_TypeIDs.insert(std::make_pair(String(type.name()), id));
+	return id;
+}
+
+const World::ComponentArray& World::getComponents(ComponentTypeID typeID)
+{
+	static const ComponentArray s_Empty;
+
+	if (typeID == 0 || typeID > _typeArrays.size())
+		return s_Empty;
+
+	return _typeArrays[typeID - 1];
+}
+
+void World::_registerComponent(Component* comp)
+{
+	ComponentTypeID typeID = comp->getTypeID();
+
+	if (_typeArrays.size() < typeID)
+		_typeArrays.resize(typeID);
+
+	ComponentArray& arr = _typeArrays[typeID - 1];
+	comp->_typeSlot = arr.size();
+	arr.push_back(comp);
+
+	Transform* xform = dynamic_cast<Transform*>(comp);
+	if (xform) _addTransform(xform);
+
+	_componentIndex.insert(std::make_pair(comp->getName(), comp));
+}
+
+void World::_unregisterComponent(Component* comp)
+{
+	ComponentArray& arr = _typeArrays[comp->_typeID - 1];
+
+	// swap-remove keeps the array packed
+	Component* last = arr.back();
+	arr[comp->_typeSlot] = last;
+	last->_typeSlot = comp->_typeSlot;
+	arr.pop_back();
+
+	Transform* xform = dynamic_cast<Transform*>(comp);
+	if (xform) _removeTransform(xform);
+
+	std::pair<ComponentNameIndex::iterator, ComponentNameIndex::iterator> r = _componentIndex.equal_range(comp->getName());
+	for (ComponentNameIndex::iterator itr = r.first; itr != r.second; ++itr)
+	{
+		if (itr->second == comp)
+		{
+			_componentIndex.erase(itr);
+			break;
+		}
+	}
+}
+
+void World::_renameComponent(Component* comp, const String& name)
+{
+	std::pair<ComponentNameIndex::iterator, ComponentNameIndex::iterator> r = _componentIndex.equal_range(comp->getName());
+	for (ComponentNameIndex::iterator itr = r.first; itr != r.second; ++itr)
+	{
+		if (itr->second == comp)
+		{
+			_componentIndex.erase(itr);
+			break;
+		}
+	}
+
+	_componentIndex.insert(std::make_pair(name, comp));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Below this many changed transforms a single thread beats the job round-trip
+static const uint XFORM_PARALLEL_THRESHOLD		= 4096;
+
+static void computeWorldMatrices(const uint* indices, uint count, const Vector3* positions, const Quat* rotations, Matrix4* outMatrices)
+{
+	for (uint i = 0; i < count; ++i)
+	{
+		uint slot = indices[i];
+		outMatrices[slot].makeTransform(positions[slot], Vector3::UNIT_SCALE, rotations[slot]);
+	}
+}
+
+class TransformBatchJob : public AsyncJob
+{
+public:
+	TransformBatchJob(World* world, const uint* indices, uint count, const Vector3* positions, const Quat* rotations, Matrix4* outMatrices)
+		: _world(world), _indices(indices), _count(count), _positions(positions), _rotations(rotations), _outMatrices(outMatrices)
+	{
+	}
+
+	virtual bool						isPrepared()							{ return true; }
+
+protected:
+	virtual bool						onPrepare()								{ return true; }
+	virtual bool onExecute(bool async)
+	{
+		computeWorldMatrices(_indices, _count, _positions, _rotations, _outMatrices);
+		_world->_transformJobDone();
+		return true;
+	}
+
+	virtual void						onFinish()								{ }
+
+private:
+	World*								_world;
+	const uint*							_indices;
+	uint								_count;
+	const Vector3*						_positions;
+	const Quat*							_rotations;
+	Matrix4*							_outMatrices;
+};
+
+void World::_addTransform(Transform* xform)
+{
+	xform->_xformSlot = _xforms.size();
+
+	_xforms.push_back(xform);
+	// Stamp one behind so the first update picks it up
+	_xformStamps.push_back(xform->_updateStamp - 1);
+	_xformPositions.push_back(xform->_position);
+	_xformRotations.push_back(xform->_rotation);
+	_worldMatrices.push_back(Matrix4::IDENTITY);
+
+	CellKey key = _cellKeyOf(xform->_position);
+	_xformCells.push_back(key);
+	_grid[key].push_back(xform);
+}
+
+void World::_removeTransform(Transform* xform)
+{
+	uint slot = xform->_xformSlot;
+	uint last = _xforms.size() - 1;
+
+	_removeFromCell(_xformCells[slot], xform);
+
+	if (slot != last)
+	{
+		Transform* moved = _xforms[last];
+		moved->_xformSlot = slot;
+
+		_xforms[slot]			= moved;
+		_xformStamps[slot]		= _xformStamps[last];
+		_xformPositions[slot]	= _xformPositions[last];
+		_xformRotations[slot]	= _xformRotations[last];
+		_worldMatrices[slot]	= _worldMatrices[last];
+		_xformCells[slot]		= _xformCells[last];
+	}
+
+	_xforms.pop_back();
+	_xformStamps.pop_back();
+	_xformPositions.pop_back();
+	_xformRotations.pop_back();
+	_worldMatrices.pop_back();
+	_xformCells.pop_back();
+}
+
+void World::updateTransforms()
+{
+	// Gather pass: pick up changed poses into the packed arrays
+	_dirtyXforms.clear();
+
+	for (uint i = 0, count = _xforms.size(); i < count; ++i)
+	{
+		Transform* xform = _xforms[i];
+		if (_xformStamps[i] == xform->_updateStamp || xform->isUpdating()) continue;
+
+		_xformStamps[i] = xform->_updateStamp;
+		_xformPositions[i] = xform->_position;
+		_xformRotations[i] = xform->_rotation;
+		_dirtyXforms.push_back(i);
+
+		_updateCell(i);
+	}
+
+	uint numDirty = _dirtyXforms.size();
+	if (numDirty == 0) return;
+
+	const uint* indices = &_dirtyXforms[0];
+	const Vector3* positions = &_xformPositions[0];
+	const Quat* rotations = &_xformRotations[0];
+	Matrix4* matrices = &_worldMatrices[0];
+
+	if (numDirty < XFORM_PARALLEL_THRESHOLD || Thread::getMaxConcurrency() <= 1)
+	{
+		computeWorldMatrices(indices, numDirty, positions, rotations, matrices);
+		return;
+	}
+
+	// Compute pass: each chunk writes disjoint slots, main thread takes the first chunk
+	if (_xformJobs == NULL)
+		_xformJobs = new AsyncJobManager("transform", Thread::getMaxConcurrency() - 1);
+
+	uint numChunks = _xformJobs->getWorkerCount() + 1;
+	uint chunkSize = (numDirty + numChunks - 1) / numChunks;
+
+	uint numJobs = (numDirty - 1) / chunkSize;
+
+	// Count set before any job can run, so no lock is needed here
+	_xformJobsPending = numJobs;
+
+	for (uint begin = chunkSize; begin < numDirty; begin += chunkSize)
+	{
+		uint count = std::min(chunkSize, numDirty - begin);
+		_xformJobs->enqueue(new TransformBatchJob(this, indices + begin, count, positions, rotations, matrices));
+	}
+
+	computeWorldMatrices(indices, std::min(chunkSize, numDirty), positions, rotations, matrices);
+
+	if (numJobs > 0)
+		_xformJobsDone.wait();
+
+	_xformJobs->update();
+}
+
+void World::_transformJobDone()
+{
+	bool last;
+	{
+		Mutex::ScopedLock lock(_xformJobMutex);
+		last = --_xformJobsPending == 0;
+	}
+
+	if (last)
+		_xformJobsDone.set();
+}
+
+Matrix4 World::getWorldMatrix(Transform* xform)
+{
+	uint slot = xform->_xformSlot;
+
+	if (_xformStamps[slot] != xform->_updateStamp && !xform->isUpdating())
+	{
+		_xformStamps[slot] = xform->_updateStamp;
+		_xformPositions[slot] = xform->_position;
+		_xformRotations[slot] = xform->_rotation;
+		_worldMatrices[slot].makeTransform(xform->_position, Vector3::UNIT_SCALE, xform->_rotation);
+
+		_updateCell(slot);
+	}
+
+	return _worldMatrices[slot];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Cell coordinates are packed 21 bits per axis into a CellKey
+static const int CELL_BITS						= 21;
+static const int CELL_BIAS						= 1 << (CELL_BITS - 1);
+
+static inline int cellCoord(Real v, Real cellSize)
+{
+	Real c = floor(v / cellSize);
+	if (c < -CELL_BIAS) return -CELL_BIAS;
+	if (c > CELL_BIAS - 1) return CELL_BIAS - 1;
+	return int(c);
+}
+
+static inline uint64 cellKey(int x, int y, int z)
+{
+	return (uint64(x + CELL_BIAS) << (CELL_BITS * 2)) | (uint64(y + CELL_BIAS) << CELL_BITS) | uint64(z + CELL_BIAS);
+}
+
+World::CellKey World::_cellKeyOf(const Vector3& pos)
+{
+	return cellKey(cellCoord(pos.x, _cellSize), cellCoord(pos.y, _cellSize), cellCoord(pos.z, _cellSize));
+}
+
+void World::_updateCell(uint slot)
+{
+	CellKey key = _cellKeyOf(_xformPositions[slot]);
+	if (key == _xformCells[slot]) return;
+
+	Transform* xform = _xforms[slot];
+	_removeFromCell(_xformCells[slot], xform);
+	_grid[key].push_back(xform);
+	_xformCells[slot] = key;
+}
+
+void World::_removeFromCell(CellKey key, Transform* xform)
+{
+	SpatialGrid::iterator itr = _grid.find(key);
+	if (itr == _grid.end()) return;
+
+	CellEntries& entries = itr->second;
+	for (uint i = 0; i < entries.size(); ++i)
+	{
+		if (entries[i] == xform)
+		{
+			entries[i] = entries.back();
+			entries.pop_back();
+			break;
+		}
+	}
+
+	if (entries.empty())
+		_grid.erase(itr);
+}
+
+void World::setSpatialCellSize(Real size)
+{
+	if (size <= 0 || size == _cellSize) return;
+
+	_cellSize = size;
+	_grid.clear();
+
+	for (uint slot = 0; slot < _xforms.size(); ++slot)
+	{
+		CellKey key = _cellKeyOf(_xformPositions[slot]);
+		_xformCells[slot] = key;
+		_grid[key].push_back(_xforms[slot]);
+	}
+}
+
+bool World::_acceptSpatial(Transform* xform, bool activeOnly)
+{
+	// Only the main transform stands for its object, so each object is reported once
+	Object* obj = xform->getObject();
+	if (obj == NULL || obj->getTransform() != xform) return false;
+
+	return !activeOnly || obj->isActivated();
+}
+
+template <typename TTest>
+void World::_queryCells(const AxisAlignedBox& bounds, TTest& test, ObjectResultSet& outResults, bool activeOnly)
+{
+	if (_grid.empty() || bounds.isNull()) return;
+
+	bool scanAll = bounds.isInfinite();
+
+	int x0, y0, z0, x1, y1, z1;
+
+	if (!scanAll)
+	{
+		const Vector3& mn = bounds.getMinimum();
+		const Vector3& mx = bounds.getMaximum();
+
+		x0 = cellCoord(mn.x, _cellSize); x1 = cellCoord(mx.x, _cellSize);
+		y0 = cellCoord(mn.y, _cellSize); y1 = cellCoord(mx.y, _cellSize);
+		z0 = cellCoord(mn.z, _cellSize); z1 = cellCoord(mx.z, _cellSize);
+
+		// Walking more cells than are occupied is slower than scanning the occupied ones
+		uint64 span = uint64(x1 - x0 + 1) * uint64(y1 - y0 + 1) * uint64(z1 - z0 + 1);
+		scanAll = span > _grid.size();
+	}
+
+	if (scanAll)
+	{
+		for (SpatialGrid::iterator itr = _grid.begin(), end = _grid.end(); itr != end; ++itr)
+		{
+			CellEntries& entries = itr->second;
+			for (uint i = 0; i < entries.size(); ++i)
+			{
+				Transform* xform = entries[i];
+				if (_acceptSpatial(xform, activeOnly) && test(_xformPositions[xform->_xformSlot]))
+					outResults.push_back(xform->getObject());
+			}
+		}
+		return;
+	}
+
+	for (int x = x0; x <= x1; ++x)
+	{
+		for (int y = y0; y <= y1; ++y)
+		{
+			for (int z = z0; z <= z1; ++z)
+			{
+				SpatialGrid::iterator itr = _grid.find(cellKey(x, y, z));
+				if (itr == _grid.end()) continue;
+
+				CellEntries& entries = itr->second;
+				for (uint i = 0; i < entries.size(); ++i)
+				{
+					Transform* xform = entries[i];
+					if (_acceptSpatial(xform, activeOnly) && test(_xformPositions[xform->_xformSlot]))
+						outResults.push_back(xform->getObject());
+				}
+			}
+		}
+	}
+}
+
+struct BoxTest
+{
+	const AxisAlignedBox& box;
+	BoxTest(const AxisAlignedBox& box) : box(box) { }
+	bool operator() (const Vector3& pos) { return box.contains(pos); }
+};
+
+struct SphereTest
+{
+	Vector3 center;
+	Real radiusSq;
+	SphereTest(const Sphere& s) : center(s.getCenter()), radiusSq(s.getRadius() * s.getRadius()) { }
+	bool operator() (const Vector3& pos) { return center.squaredDistance(pos) <= radiusSq; }
+};
+
+struct RayTest
+{
+	const Ray& ray;
+	Real maxDistance;
+	Real radiusSq;
+
+	Real hitDistance;
+
+	RayTest(const Ray& ray, Real maxDistance, Real radius) : ray(ray), maxDistance(maxDistance), radiusSq(radius * radius), hitDistance(0) { }
+
+	bool operator() (const Vector3& pos)
+	{
+		Real t = ray.getDirection().dotProduct(pos - ray.getOrigin());
+		if (t < 0) t = 0;
+		else if (t > maxDistance) t = maxDistance;
+
+		if (ray.getPoint(t).squaredDistance(pos) > radiusSq) return false;
+
+		hitDistance = t;
+		return true;
+	}
+};
+
+static bool nearerHit(const std::pair<Real, Object*>& a, const std::pair<Real, Object*>& b)
+{
+	return a.first < b.first;
+}
+
+void World::query(const AxisAlignedBox& box, ObjectResultSet& outResults, bool activeOnly)
+{
+	BoxTest test(box);
+	_queryCells(box, test, outResults, activeOnly);
+}
+
+void World::query(const Sphere& sphere, ObjectResultSet& outResults, bool activeOnly)
+{
+	Vector3 r(sphere.getRadius(), sphere.getRadius(), sphere.getRadius());
+	AxisAlignedBox bounds(sphere.getCenter() - r, sphere.getCenter() + r);
+
+	SphereTest test(sphere);
+	_queryCells(bounds, test, outResults, activeOnly);
+}
+
+void World::query(const PlaneBoundedVolume& volume, ObjectResultSet& outResults, bool activeOnly)
+{
+	// Volumes (frustums) may be unbounded, so cull occupied cells by their box instead of walking a range
+	for (SpatialGrid::iterator itr = _grid.begin(), end = _grid.end(); itr != end; ++itr)
+	{
+		CellEntries& entries = itr->second;
+		if (entries.empty()) continue;
+
+		const Vector3& p = _xformPositions[entries[0]->_xformSlot];
+		Vector3 mn(floor(p.x / _cellSize) * _cellSize, floor(p.y / _cellSize) * _cellSize, floor(p.z / _cellSize) * _cellSize);
+		Vector3 mx = mn + Vector3(_cellSize, _cellSize, _cellSize);
+
+		if (!volume.intersects(AxisAlignedBox(mn, mx)))
+			continue;
+
+		for (uint i = 0; i < entries.size(); ++i)
+		{
+			Transform* xform = entries[i];
+			if (!_acceptSpatial(xform, activeOnly)) continue;
+
+			const Vector3& pos = _xformPositions[xform->_xformSlot];
+
+			bool inside = true;
+			for (uint j = 0; j < volume.planes.size(); ++j)
+			{
+				if (volume.planes[j].getSide(pos) == volume.outside)
+				{
+					inside = false;
+					break;
+				}
+			}
+
+			if (inside)
+				outResults.push_back(xform->getObject());
+		}
+	}
+}
+
+void World::query(const Ray& ray, Real maxDistance, Real radius, ObjectResultSet& outResults, bool activeOnly)
+{
+	Vector3 dir = ray.getDirection();
+	dir.normalise();
+	Ray unitRay(ray.getOrigin(), dir);
+
+	Vector3 end = unitRay.getPoint(maxDistance);
+	Vector3 r(radius, radius, radius);
+
+	AxisAlignedBox bounds;
+	bounds.merge(unitRay.getOrigin() - r);
+	bounds.merge(unitRay.getOrigin() + r);
+	bounds.merge(end - r);
+	bounds.merge(end + r);
+
+	RayTest test(unitRay, maxDistance, radius);
+
+	ObjectResultSet candidates;
+	_queryCells(bounds, test, candidates, activeOnly);
+
+	// Order by distance along the ray
+	vector<std::pair<Real, Object*> >::type hits;
+	hits.reserve(candidates.size());
+
+	for (uint i = 0; i < candidates.size(); ++i)
+	{
+		Object* obj = candidates[i];
+		test(_xformPositions[obj->getTransform()->_xformSlot]);
+		hits.push_back(std::make_pair(test.hitDistance, obj));
+	}
+
+	std::sort(hits.begin(), hits.end(), nearerHit);
+
+	for (uint i = 0; i < hits.size(); ++i)
+		outResults.push_back(hits[i].second);
+}
+
+void World::query(const vector<AxisAlignedBox>::type& boxes, vector<ObjectResultSet>::type& outResults, bool activeOnly)
+{
+	outResults.resize(boxes.size());
+
+	for (uint i = 0; i < boxes.size(); ++i)
+		query(boxes[i], outResults[i], activeOnly);
+}
+
+void World::query(const vector<Sphere>::type& spheres, vector<ObjectResultSet>::type& outResults, bool activeOnly)
+{
+	outResults.resize(spheres.size());
+
+	for (uint i = 0; i < spheres.size(); ++i)
+		query(spheres[i], outResults[i], activeOnly);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void World::onTick(const TimeEvent* evt)
 {
+	updateTransforms();
+
 	// TODO: integrate with physics
 }
 
@@ -171,6 +771,23 @@ void World::all(ObjectResultSet& outResults)
 
 void World::find(const char* wildcard, ObjectResultSet& outResults, bool activeOnly, bool ignoreCase)
 {
+	if (!Wildcard::has(wildcard))
+	{
+		// Plain name: look up the index instead of scanning every object
+		std::pair<ObjectNameIndex::iterator, ObjectNameIndex::iterator> r = _objectIndex.equal_range(wildcard);
+		for (ObjectNameIndex::iterator itr = r.first; itr != r.second; ++itr)
+		{
+			Object* o = itr->second;
+
+			if (activeOnly && !o->isActivated())
+				continue;
+
+			if (ignoreCase || o->getName() == wildcard)
+				outResults.push_back(o);
+		}
+		return;
+	}
+
 	for (ObjectSet::iterator itr = _attached.begin(), end = _attached.end(); itr != end; ++itr)
 	{
 		Object* o = *itr;
@@ -185,23 +802,31 @@ void World::find(const char* wildcard, ObjectResultSet& outResults, bool activeO
 
 void World::findComponents(const char* wildcard, ComponentResultSet& outResults, bool activeOnly, bool ignoreCase)
 {
-	for (ObjectSet::iterator itr = _attached.begin(), end = _attached.end(); itr != end; ++itr)
+	if (!Wildcard::has(wildcard))
 	{
-		Object* o = *itr;
-
-		if (activeOnly && !o->isActivated())
-			continue;
-
-		for (Object::Components::iterator itr = o->_components.begin(), end = o->_components.end(); itr != end; ++itr)
+		std::pair<ComponentNameIndex::iterator, ComponentNameIndex::iterator> r = _componentIndex.equal_range(wildcard);
+		for (ComponentNameIndex::iterator itr = r.first; itr != r.second; ++itr)
 		{
 			Component* c = itr->second;
 
-			if (activeOnly && !c->isActivated())
+			if (activeOnly && !(c->isActivated() && c->getObject()->isActivated()))
 				continue;
 
-			if (Wildcard::match(wildcard, c->getName(), ignoreCase))
+			if (ignoreCase || c->getName() == wildcard)
 				outResults.push_back(c);
 		}
+		return;
+	}
+
+	for (ComponentNameIndex::iterator itr = _componentIndex.begin(), end = _componentIndex.end(); itr != end; ++itr)
+	{
+		Component* c = itr->second;
+
+		if (activeOnly && !(c->isActivated() && c->getObject()->isActivated()))
+			continue;
+
+		if (Wildcard::match(wildcard, c->getName(), ignoreCase))
+			outResults.push_back(c);
 	}
 }
 
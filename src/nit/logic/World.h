@@ -25,6 +25,12 @@
 #include "nit/nit.h"
 
 #include "nit/event/Timer.h"
+#include "nit/logic/Component.h"
+
+#include "nit/math/Ray.h"
+
+#include "nit/async/Mutex.h"
+#include "nit/async/EventSemaphore.h"
 
 NS_NIT_BEGIN;
 
@@ -33,7 +39,9 @@ NS_NIT_BEGIN;
 class World;
 class Object;
 class Component;
+class Transform;
 class Module;
+class AsyncJobManager;
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -79,12 +87,116 @@ public:
 	void								find(const char* wildcard, ObjectResultSet& outResults, bool activeOnly = false, bool ignoreCase = true);
 	void								findComponents(const char* wildcard, ComponentResultSet& outResults, bool activeOnly = true, bool ignoreCase = true);
 
+public:									// Per-type component storage for systems
+	typedef vector<Component*>::type ComponentArray;
+
+	static ComponentTypeID				getComponentTypeID(const std::type_info& type);
+
+	template <typename TComponent>
+	static ComponentTypeID				getComponentTypeID()					{ return getComponentTypeID(typeid(TComponent)); }
+
+	// Packed array of every attached component whose concrete class is exactly 'typeID'.
+	// Order is not stable: removal swaps the last element into the hole.
+	const ComponentArray&				getComponents(ComponentTypeID typeID);
+
+	template <typename TComponent>
+	const ComponentArray&				getComponents()							{ return getComponents(getComponentTypeID<TComponent>()); }
+
+	// Collects all attached components castable to TComponent (including subclasses), one packed array at a time.
+	template <typename TComponent>
+	void								collectComponents(typename vector<TComponent*>::type& outResults, bool activeOnly = true)
+	{
+		for (uint t = 0; t < _typeArrays.size(); ++t)
+		{
+			ComponentArray& arr = _typeArrays[t];
+			// Every element of an array shares the same concrete class, so testing one suffices
+			if (arr.empty() || dynamic_cast<TComponent*>(arr[0]) == NULL) continue;
+
+			for (uint i = 0; i < arr.size(); ++i)
+			{
+				Component* c = arr[i];
+				if (activeOnly && !c->isActivated()) continue;
+				outResults.push_back(static_cast<TComponent*>(c));
+			}
+		}
+	}
+
+public:									// Transform system
+	// Recomputes world matrices of every Transform changed since the last call, in one linear pass
+	// (split across worker threads when many have changed), and moves them on the spatial grid.
+	// The session's World calls this on each tick after the session script's tick handler, so
+	// poses set by scripts during a tick are reflected by the end of that tick. Poses changed by
+	// scheduled callbacks or outside the tick are picked up on the next tick, or on demand by getWorldMatrix().
+	void								updateTransforms();
+
+	uint								getTransformCount()						{ return _xforms.size(); }
+	Matrix4								getWorldMatrix(Transform* xform);
+
+public:									// Spatial queries
+	// Objects are indexed by the position of their main Transform on a uniform hash grid,
+	// refreshed by updateTransforms() (thus each tick). Results reflect positions as of the last refresh.
+	Real								getSpatialCellSize()					{ return _cellSize; }
+	void								setSpatialCellSize(Real size);
+
+	void								query(const AxisAlignedBox& box, ObjectResultSet& outResults, bool activeOnly = true);
+	void								query(const Sphere& sphere, ObjectResultSet& outResults, bool activeOnly = true);
+	void								query(const PlaneBoundedVolume& volume, ObjectResultSet& outResults, bool activeOnly = true);
+
+	// Objects within 'radius' of the ray segment [0, maxDistance], nearest along the ray first
+	void								query(const Ray& ray, Real maxDistance, Real radius, ObjectResultSet& outResults, bool activeOnly = true);
+
+	// Batch forms: outResults[i] receives the hits of the i-th shape
+	void								query(const vector<AxisAlignedBox>::type& boxes, vector<ObjectResultSet>::type& outResults, bool activeOnly = true);
+	void								query(const vector<Sphere>::type& spheres, vector<ObjectResultSet>::type& outResults, bool activeOnly = true);
+
 private:
+	typedef multimap<String, Object*, StringUtil::LessIgnoreCase>::type ObjectNameIndex;
+	typedef multimap<String, Component*, StringUtil::LessIgnoreCase>::type ComponentNameIndex;
+	typedef vector<ComponentArray>::type ComponentTypeArrays;
+
 	BitSet								_status;
 	String								_name;
 
 	ObjectSet							_attached;
 
+	ObjectNameIndex						_objectIndex;
+	ComponentNameIndex					_componentIndex;
+	ComponentTypeArrays					_typeArrays;						// indexed by ComponentTypeID - 1
+
+	// Transform system: parallel arrays indexed by Transform::_xformSlot
+	vector<Transform*>::type			_xforms;
+	vector<short>::type					_xformStamps;						// Transform::_updateStamp at last recompute
+	vector<Vector3>::type				_xformPositions;
+	vector<Quat>::type					_xformRotations;
+	vector<Matrix4>::type				_worldMatrices;
+	vector<uint>::type					_dirtyXforms;
+	Ref<AsyncJobManager>				_xformJobs;
+	Mutex								_xformJobMutex;
+	uint								_xformJobsPending;					// guarded by _xformJobMutex
+	EventSemaphore						_xformJobsDone;						// set by the last batch job to finish
+
+	friend class						TransformBatchJob;
+	void								_transformJobDone();
+
+	typedef uint64 CellKey;
+	typedef vector<Transform*>::type CellEntries;
+	typedef unordered_map<CellKey, CellEntries>::type SpatialGrid;
+
+	Real								_cellSize;
+	SpatialGrid							_grid;
+	vector<CellKey>::type				_xformCells;						// cell of each transform slot
+
+	CellKey								_cellKeyOf(const Vector3& pos);
+	void								_updateCell(uint slot);
+	void								_removeFromCell(CellKey key, Transform* xform);
+	bool								_acceptSpatial(Transform* xform, bool activeOnly);
+
+	template <typename TTest>
+	void								_queryCells(const AxisAlignedBox& bounds, TTest& test, ObjectResultSet& outResults, bool activeOnly);
+
+	void								_addTransform(Transform* xform);
+	void								_removeTransform(Transform* xform);
+
 private:
 	friend class						Object;
 
@@ -92,7 +204,11 @@ private:
 	bool								_detachObject(Object* object);
 	bool								_renameObject(Object* object, const String& name);
 
-private:
+	void								_registerComponent(Component* comp);
+	void								_unregisterComponent(Component* comp);
+	void								_renameComponent(Component* comp, const String& name);
+
+public:									// Bound to the owning session's TICK
 	void								onTick(const TimeEvent* evt);
 };
 
@@ -63,6 +63,9 @@ Curve2D::Curve2D(Curve3D* c, PlaneAxis axis)
 
 	_totalLength = -1.0f;
 	_partialLength = NULL;
+
+	_tableSamples = 0;
+	_lengthTable = NULL;
 }
 
 Curve2D* Curve2D::ratio(Curve2D* a, Curve2D* b, float r)
@@ -84,6 +87,9 @@ Curve2D* Curve2D::ratio(Curve2D* a, Curve2D* b, float r)
 	c->_totalLength = -1.0f;
 	c->_partialLength = NULL;
 
+	c->_tableSamples = 0;
+	c->_lengthTable = NULL;
+
 	return c;
 }
 
@@ -176,6 +182,9 @@ Curve3D* Curve3D::ratio(Curve3D* a, Curve3D* b, float r)
 	c->_totalLength = -1.0f;
 	c->_partialLength = NULL;
 
+	c->_tableSamples = 0;
+	c->_lengthTable = NULL;
+
 	return c;
 }
 
@@ -511,4 +520,197 @@ void Curve3D::findAllTrackLine(Curve3D* other, const Vector3& P, const Vector3&
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#if defined(NIT_TESTS)
+
+static float RandomFloat(uint& seed, float lo, float hi)
+{
+	seed = seed * 1103515245 + 12345;
+	return lo + (hi - lo) * float((seed >> 8) & 0xFFFF) / 65535.0f;
+}
+
+static Ref<Curve3D> RandomCurve(uint& seed, uint numSections)
+{
+	vector<Vector3>::type points(numSections * 3 + 1);
+
+	Vector3 p = Vector3::ZERO;
+	for (uint i = 0; i < points.size(); ++i)
+	{
+		points[i] = p;
+		p += Vector3(RandomFloat(seed, -30, 30), RandomFloat(seed, -30, 30), RandomFloat(seed, -30, 30));
+	}
+
+	// A handle on its end point gives zero speed there: cusps at both ends of the curve and after the first section
+	points[1] = points[0];
+	points[4] = points[3];
+	points[numSections * 3 - 1] = points[numSections * 3];
+
+	return new Curve3D(&points[0], points.size());
+}
+
+// Cumulative length along CurveTest::REF_SAMPLES chords per section
+static void Polyline(Curve3D* curve, vector<double>::type& outLength)
+{
+	uint n = curve->getNumSections() * CurveTest::REF_SAMPLES;
+
+	outLength.resize(n + 1);
+	outLength[0] = 0.0;
+
+	Vector3 prev = curve->pos(0.0f);
+
+	for (uint i = 1; i <= n; ++i)
+	{
+		Vector3 p = curve->pos(float(double(i) / n));
+		outLength[i] = outLength[i-1] + (p - prev).length();
+		prev = p;
+	}
+}
+
+static double PolylineAt(const vector<double>::type& length, float t)
+{
+	double x = double(t) * (length.size() - 1);
+	size_t i = std::min(size_t(x), length.size() - 2);
+	return length[i] + (length[i+1] - length[i]) * (x - i);
+}
+
+static float WorstError(Curve3D* curve, const vector<double>::type& ref, const vector<float>::type& lengths)
+{
+	double worst = 0.0;
+
+	for (uint i = 0; i < lengths.size(); ++i)
+	{
+		double error = fabs(PolylineAt(ref, curve->fromLength(lengths[i])) - lengths[i]);
+		if (error > worst) worst = error;
+	}
+
+	return float(worst);
+}
+
+bool CurveTest::selfTest(uint seed)
+{
+	bool ok = true;
+
+	const uint samples[] = { 16, 32 };
+	const float tolerances[] = { 1e-3f, 1e-4f };
+
+	for (uint round = 0; round < 4; ++round)
+	{
+		Ref<Curve3D> curve = RandomCurve(seed, 5 + round * 5);
+
+		vector<double>::type ref;
+		Polyline(curve, ref);
+		float total = float(ref.back());
+
+		const uint count = 1000;
+		vector<float>::type lengths(count), t(count);
+		vector<Vector3>::type batch(count);
+
+		for (uint i = 0; i < count; ++i)
+			lengths[i] = RandomFloat(seed, 0, total);
+
+		for (uint k = 0; k < COUNT_OF(samples); ++k)
+		{
+			curve->setLengthTable(samples[k]);
+			float tolerance = total * tolerances[k];
+
+			if (Math::abs(curve->getTotalLength() - total) > tolerance)
+			{
+				LOG(0, "*** CurveTest: %d-sample total length %.4f, polyline %.4f\n", samples[k], curve->getTotalLength(), total);
+				ok = false;
+			}
+
+			float worst = WorstError(curve, ref, lengths);
+			if (worst > tolerance)
+			{
+				LOG(0, "*** CurveTest: %d-sample table off by %.4f of %.1f\n", samples[k], worst, total);
+				ok = false;
+			}
+
+			curve->fromLength(&lengths[0], count, &t[0]);
+			curve->interpolateAtLength(&lengths[0], count, &batch[0], NULL);
+
+			for (uint i = 0; i < count; ++i)
+			{
+				// toLength() and fromLength() each stay within the tolerance of the true length
+				float back = curve->toLength(t[i]);
+				Vector3 p = curve->pos(t[i]);
+
+				if (Math::abs(back - lengths[i]) > 2.0f * tolerance)
+				{
+					LOG(0, "*** CurveTest: %d-sample toLength(fromLength(%.4f)) = %.4f\n", samples[k], lengths[i], back);
+					ok = false;
+					break;
+				}
+
+				if (t[i] != curve->fromLength(lengths[i]) || (batch[i] - p).length() > 1e-4f * std::max(1.0f, p.length()))
+				{
+					LOG(0, "*** CurveTest: %d-sample batch mismatch at length %.4f\n", samples[k], lengths[i]);
+					ok = false;
+					break;
+				}
+			}
+		}
+	}
+
+	return ok;
+}
+
+void CurveTest::benchmark(BenchResults& outResults, uint count)
+{
+	if (count == 0) return;
+
+	uint seed = 0;
+
+	Ref<Curve3D> curve = RandomCurve(seed, 20);
+
+	vector<double>::type ref;
+	Polyline(curve, ref);
+	float total = float(ref.back());
+
+	// ascending, as when walking along a path
+	vector<float>::type lengths(count), t(count);
+	for (uint i = 0; i < count; ++i)
+		lengths[i] = RandomFloat(seed, 0, total);
+	std::sort(lengths.begin(), lengths.end());
+
+	const uint samples[] = { 0, 16, 32 };
+	const char* names[] = { "integrating", "table16", "table32" };
+
+	for (uint k = 0; k < COUNT_OF(samples); ++k)
+	{
+		curve->setLengthTable(samples[k]);
+		curve->getTotalLength(); // build the table out of the timing
+
+		double start = SystemTimer::now();
+		for (uint i = 0; i < count; ++i)
+			t[i] = curve->fromLength(lengths[i]);
+		double elapsed = SystemTimer::now() - start;
+
+		float ns = float(elapsed * 1000000000.0 / count);
+		float worst = WorstError(curve, ref, lengths);
+
+		LOG(0, ".. CurveTest: fromLength.%-12s %8.1f ns, worst error %.4f of %.1f\n", names[k], ns, worst, total);
+		outResults.push_back(std::make_pair(String("fromLength.") + names[k], ns));
+		outResults.push_back(std::make_pair(String("error.") + names[k], worst));
+	}
+
+	vector<Vector3>::type out(count);
+
+	double start = SystemTimer::now();
+	for (uint i = 0; i < count; ++i)
+		out[i] = curve->pos(t[i]);
+	float single = float((SystemTimer::now() - start) * 1000000000.0 / count);
+
+	start = SystemTimer::now();
+	curve->interpolate(&t[0], count, &out[0], NULL);
+	float batch = float((SystemTimer::now() - start) * 1000000000.0 / count);
+
+	LOG(0, ".. CurveTest: pos %.1f ns, batch interpolate %.1f ns\n", single, batch);
+	outResults.push_back(std::make_pair(String("pos.single"), single));
+	outResults.push_back(std::make_pair(String("pos.batch"), batch));
+}
+
+#endif // #if defined(NIT_TESTS)
+
+////////////////////////////////////////////////////////////////////////////////
+
 NS_NIT_END;
\ No newline at end of file
@@ -41,6 +41,9 @@ inline TBezierCurve<TVector>::TBezierCurve(const TVector* points, uint numPoints
 
 	_totalLength = -1.0f;
 	_partialLength = NULL;
+
+	_tableSamples = 0;
+	_lengthTable = NULL;
 }
 
 template <class TVector>
@@ -51,6 +54,9 @@ inline TBezierCurve<TVector>::~TBezierCurve()
 
 	if (_partialLength)
 		delete[] _partialLength;
+
+	if (_lengthTable)
+		delete[] _lengthTable;
 }
 
 template <class TVector>
@@ -124,6 +130,65 @@ inline TVector TBezierCurve<TVector>::pos(float t)
 	return p;
 }
 
+template <class TVector>
+inline void TBezierCurve<TVector>::evaluate(SectionPoly& poly, int section, float normT, TVector* outPos, TVector* outTan)
+{
+	// Same polynomial as Math::bezier(), but coefficients are kept in poly while the section stays
+	if (poly.section != section)
+	{
+		TVector* V = getSection(section);
+
+		poly.section = section;
+		poly.v0 = V[0];
+		poly.a = 3.0f * (V[1] - V[0]);
+		poly.b = 3.0f * (V[2] - V[1]) - poly.a;
+		poly.c = (V[3] - V[0]) + 3.0f * (V[1] - V[2]);
+	}
+
+	if (outPos)
+		*outPos = poly.v0 + (poly.a + (poly.b + poly.c * normT) * normT) * normT;
+
+	if (outTan)
+		*outTan = poly.a + (2.0f * poly.b + 3.0f * poly.c * normT) * normT;
+}
+
+template <class TVector>
+inline void TBezierCurve<TVector>::interpolate(const float* t, uint count, TVector* outPos, TVector* outTan)
+{
+	SectionPoly poly;
+	poly.section = -1;
+
+	for (uint i=0; i<count; ++i)
+	{
+		int section; float normT;
+		toNorm(t[i], section, normT);
+
+		evaluate(poly, section, normT, outPos ? &outPos[i] : NULL, outTan ? &outTan[i] : NULL);
+	}
+}
+
+template <class TVector>
+inline void TBezierCurve<TVector>::interpolateAtLength(const float* lengths, uint count, TVector* outPos, TVector* outTan)
+{
+	SectionPoly poly;
+	poly.section = -1;
+
+	for (uint i=0; i<count; ++i)
+	{
+		int section; float normT;
+		toNorm(fromLength(lengths[i]), section, normT);
+
+		evaluate(poly, section, normT, outPos ? &outPos[i] : NULL, outTan ? &outTan[i] : NULL);
+	}
+}
+
+template <class TVector>
+inline void TBezierCurve<TVector>::fromLength(const float* lengths, uint count, float* outT)
+{
+	for (uint i=0; i<count; ++i)
+		outT[i] = fromLength(lengths[i]);
+}
+
 template <class TVector>
 inline float TBezierCurve<TVector>::speedAt(int section, float normT)
 {
@@ -133,6 +198,12 @@ inline float TBezierCurve<TVector>::speedAt(int section, float normT)
 
 template <class TVector>
 inline float TBezierCurve<TVector>::lengthAt(int section, float normT)
+{
+	return lengthBetween(section, 0.0f, normT);
+}
+
+template <class TVector>
+inline float TBezierCurve<TVector>::lengthBetween(int section, float normT0, float normT1)
 {
 	// Legendre polynomial information for Gaussian quadrature of speed
 	// on domain [0, normT], 0 <= normT <= 1
@@ -155,16 +226,18 @@ inline float TBezierCurve<TVector>::lengthAt(int section, float normT)
 		0.118463442f
 	};
 
-	// Need to transform domain [0,normT] to [-1,1].  
-	// If 0 <= x <= normT and -1 <= t <= 1, then x = normT*(t+1)/2.
+	// Need to transform domain [normT0,normT1] to [-1,1].  
+	// If normT0 <= x <= normT1 and -1 <= t <= 1, then x = normT0 + (normT1-normT0)*(t+1)/2.
+
+	float range = normT1 - normT0;
 
 	float l = 0.0f;
 	for (int i=0; i<5; ++i)
 	{
-		l += modCoeff[i] * speedAt(section, normT * modRoot[i]);
+		l += modCoeff[i] * speedAt(section, normT0 + range * modRoot[i]);
 	}
 
-	return l * normT;
+	return l * range;
 }
 
 template <class TVector>
@@ -188,9 +261,150 @@ inline void TBezierCurve<TVector>::updateLength()
 		}
 
 		_totalLength = tl;
+
+		if (_lengthTable) delete[] _lengthTable;
+		_lengthTable = NULL;
+
+		if (_tableSamples > 0)
+		{
+			uint n = _tableSamples;
+			_lengthTable = new LengthSample[_numSections * (n + 1)];
+
+			// Integrating each sample interval is more precise than lengthAt() over a whole section,
+			// so partial lengths follow the table to stay consistent.
+			tl = 0.0f;
+
+			for (uint i=0; i < _numSections; ++i)
+			{
+				LengthSample* S = &_lengthTable[i * (n + 1)];
+
+				float l = 0.0f;
+
+				for (uint k=0; k <= n; ++k)
+				{
+					float normT = float(k) / n;
+
+					if (k > 0)
+						l += lengthBetween(i, float(k - 1) / n, normT);
+
+					S[k].length = l;
+					S[k].speed = speedAt(i, normT);
+				}
+
+				tl += l;
+				_partialLength[i+1] = tl;
+			}
+
+			_totalLength = tl;
+		}
 	}
 }
 
+template <class TVector>
+inline void TBezierCurve<TVector>::setLengthTable(uint samplesPerSection)
+{
+	if (_tableSamples == samplesPerSection)
+		return;
+
+	_tableSamples = samplesPerSection;
+
+	// reset total length to rebuild the table
+	_totalLength = -1.0f;
+}
+
+template <class TVector>
+inline uint TBezierCurve<TVector>::findSection(float length)
+{
+	// binary search for the first section which ends at or after length
+	uint lo = 0;
+	uint hi = _numSections - 1;
+
+	while (lo < hi)
+	{
+		uint mid = (lo + hi) / 2;
+
+		if (length <= _partialLength[mid + 1])
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	return lo;
+}
+
+// The table keeps length and speed (ds/dt) at uniform samples of normT.
+// Between two samples, a cubic hermite with those derivatives corrects the linear guess:
+// s(t) forward for toLength(), and t(s) with dt/ds = 1/speed for fromLength().
+
+template <class TVector>
+inline float TBezierCurve<TVector>::tableToLength(int section, float normT)
+{
+	uint n = _tableSamples;
+	const LengthSample* S = &_lengthTable[section * (n + 1)];
+
+	float f = normT * n;
+	uint k = (uint)f;
+	if (k >= n) return S[n].length;
+
+	float u = f - k;
+	float dt = 1.0f / n;
+
+	float u2 = u * u;
+	float u3 = u2 * u;
+
+	return 
+		S[k].length					* ( 2.0f * u3 - 3.0f * u2 + 1.0f) +
+		S[k].speed * dt				* (u3 - 2.0f * u2 + u) +
+		S[k+1].length				* (-2.0f * u3 + 3.0f * u2) +
+		S[k+1].speed * dt			* (u3 - u2);
+}
+
+template <class TVector>
+inline float TBezierCurve<TVector>::tableFromLength(int section, float dist)
+{
+	uint n = _tableSamples;
+	const LengthSample* S = &_lengthTable[section * (n + 1)];
+
+	// binary search for the sample interval which contains dist
+	uint lo = 0;
+	uint hi = n;
+
+	while (hi - lo > 1)
+	{
+		uint mid = (lo + hi) / 2;
+
+		if (S[mid].length <= dist)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	float dt = 1.0f / n;
+	float t0 = lo * dt;
+
+	float h = S[hi].length - S[lo].length;
+	if (h <= 0.0f)
+		return t0;
+
+	float u = (dist - S[lo].length) / h;
+	if (u < 0.0f) u = 0.0f;
+	if (u > 1.0f) u = 1.0f;
+
+	// dt/du = h / speed, limited to 3 times the secant to stay monotonic (also covers zero speed at cusps)
+	float maxM = 3.0f * dt;
+	float m0 = S[lo].speed * maxM > h ? h / S[lo].speed : maxM;
+	float m1 = S[hi].speed * maxM > h ? h / S[hi].speed : maxM;
+
+	float u2 = u * u;
+	float u3 = u2 * u;
+
+	return 
+		t0							* ( 2.0f * u3 - 3.0f * u2 + 1.0f) +
+		m0							* (u3 - 2.0f * u2 + u) +
+		(t0 + dt)					* (-2.0f * u3 + 3.0f * u2) +
+		m1							* (u3 - u2);
+}
+
 template <class TVector>
 inline float TBezierCurve<TVector>::getTotalLength()
 {
@@ -206,6 +420,9 @@ inline float TBezierCurve<TVector>::toLength(float t)
 
 	updateLength();
 
+	if (_lengthTable)
+		return _partialLength[section] + tableToLength(section, normT);
+
 	return _partialLength[section] + lengthAt(section, normT);
 }
 
@@ -221,26 +438,19 @@ inline float TBezierCurve<TVector>::fromLength(float length)
 		return 1.0f;
 
 	// Determine which polynomial segment corresponds to length
-	float dist = 0.0f;
-	float normT = 0.0f;
-	uint section;
+	uint section = findSection(length);
 
-	float l0 = 0.0f;
-	for (section = 0; section < _numSections; ++section)
-	{
-		float l = _partialLength[section + 1];
+	float l0 = _partialLength[section];
+	float l = _partialLength[section + 1];
 
-		if (length <= l)
-		{
-			// distance along segment
-			dist = length - l0;
+	// distance along segment
+	float dist = length - l0;
 
-			// initial guess for integral upper limit
-			normT = dist / (l - l0);
-			break;
-		}
-		l0 = l;
-	}
+	if (_lengthTable)
+		return fromNorm(section, tableFromLength(section, dist));
+
+	// initial guess for integral upper limit
+	float normT = dist / (l - l0);
 
 	// Use Newton's method to invert the path length integral
 	const int MAX_ITERATIONS = 32;
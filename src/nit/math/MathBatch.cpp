@@ -0,0 +1,1625 @@
+﻿/// nit - Noriter Framework
+/// A Cross-platform Open Source Integration for Game-oriented Apps
+///
+/// http://www.github.com/ellongrey/nit
+///
+/// Copyright (c) 2013 by Jun-hyeok Jang
+///
+/// (see each file to see the different copyright owners)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// Author: ellongrey
+
+#include "nit_pch.h"
+
+#include "nit/math/MathBatch.h"
+
+#include "nit/math/Matrix4.h"
+#include "nit/math/Quaternion.h"
+#include "nit/math/PlaneBoundedVolume.h"
+
+#include "nit/platform/CpuFeatures.h"
+
+#if defined(NIT_SIMD_SSE2)
+#	include <emmintrin.h>
+#elif defined(NIT_SIMD_NEON)
+#	include <arm_neon.h>
+#endif
+
+NS_NIT_BEGIN;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Kernels access these types as packed float arrays
+typedef char MathBatch_Vector3IsPacked		[sizeof(Vector3) == sizeof(float) * 3 ? 1 : -1];
+typedef char MathBatch_Matrix4IsPacked		[sizeof(Matrix4) == sizeof(float) * 16 ? 1 : -1];
+typedef char MathBatch_QuaternionIsPacked	[sizeof(Quaternion) == sizeof(float) * 4 ? 1 : -1];
+
+typedef void (*TransformPointsFn)(const Matrix4& m, const Vector3* in, Vector3* out, size_t count);
+typedef void (*TransformNormalsFn)(const Matrix4& m, const Vector3* in, Vector3* out, size_t count, bool normalise);
+typedef void (*MultiplyFn)(const Matrix4* a, size_t aStep, const Matrix4* b, Matrix4* out, size_t count);
+typedef void (*NormaliseFn)(Quaternion* q, size_t count);
+typedef void (*SlerpFn)(const Quaternion* p, const Quaternion* q, const float* t, Quaternion* out, size_t count, bool shortestPath);
+typedef void (*TransformBoxesFn)(const Matrix4& m, const AxisAlignedBox* in, AxisAlignedBox* out, size_t count);
+typedef void (*MergeBoxesFn)(AxisAlignedBox& box, const AxisAlignedBox* boxes, size_t count);
+typedef void (*MergePointsFn)(AxisAlignedBox& box, const Vector3* points, size_t count);
+typedef size_t (*CullBoxesFn)(const Plane* planes, uint numPlanes, const AxisAlignedBox* boxes, size_t count, uint8* outVisible, Plane::Side outside);
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Polynomials used by slerp instead of sin() and atan2().
+// Vector kernels evaluate the very same steps lane by lane.
+
+static const float SLERP_PI		= 3.14159265f;
+static const float SLERP_INV_PI	= 0.318309886f;
+static const float SLERP_PI_A	= 3.140625f;			// exact in few bits, so k * PI_A has no rounding error
+static const float SLERP_PI_B	= 9.67653590e-4f;		// PI - PI_A
+
+// acos(x) = sqrt(1 - x) * P(x) for 0 <= x <= 1 (Abramowitz & Stegun 4.4.46, |error| < 2e-8)
+static const float ACOS_C0 =  1.5707963050f;
+static const float ACOS_C1 = -0.2145988016f;
+static const float ACOS_C2 =  0.0889789874f;
+static const float ACOS_C3 = -0.0501743046f;
+static const float ACOS_C4 =  0.0308918810f;
+static const float ACOS_C5 = -0.0170881256f;
+static const float ACOS_C6 =  0.0066700901f;
+static const float ACOS_C7 = -0.0012624911f;
+
+// sin(x) taylor series up to x^11 for |x| <= PI / 2
+static const float SIN_C3  = -1.6666667e-1f;
+static const float SIN_C5  =  8.3333333e-3f;
+static const float SIN_C7  = -1.9841270e-4f;
+static const float SIN_C9  =  2.7557319e-6f;
+static const float SIN_C11 = -2.5052108e-8f;
+
+static inline float ACosPoly(float x)
+{
+	float a = Math::abs(x);
+	float p = ACOS_C7;
+	p = p * a + ACOS_C6;
+	p = p * a + ACOS_C5;
+	p = p * a + ACOS_C4;
+	p = p * a + ACOS_C3;
+	p = p * a + ACOS_C2;
+	p = p * a + ACOS_C1;
+	p = p * a + ACOS_C0;
+	float r = Math::sqrt(1.0f - a) * p;
+	return x < 0.0f ? SLERP_PI - r : r;
+}
+
+static inline float SinPoly(float x)
+{
+	// Reduce to [-PI/2, PI/2] by the nearest multiple of PI: sin(x) = (-1)^k * sin(x - k * PI)
+	float v = x * SLERP_INV_PI + 0.5f;
+	int k = int(v);
+	if (float(k) > v) --k;
+	float kf = float(k);
+
+	float r = (x - kf * SLERP_PI_A) - kf * SLERP_PI_B;
+	float r2 = r * r;
+	float p = SIN_C11;
+	p = p * r2 + SIN_C9;
+	p = p * r2 + SIN_C7;
+	p = p * r2 + SIN_C5;
+	p = p * r2 + SIN_C3;
+	p = p * r2 + 1.0f;
+	float s = r * p;
+	return (k & 1) ? -s : s;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Scalar reference kernels
+
+static void TransformPointsScalar(const Matrix4& m, const Vector3* in, Vector3* out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		Real x = in[i].x, y = in[i].y, z = in[i].z;
+		out[i].x = m[0][0] * x + m[0][1] * y + m[0][2] * z + m[0][3];
+		out[i].y = m[1][0] * x + m[1][1] * y + m[1][2] * z + m[1][3];
+		out[i].z = m[2][0] * x + m[2][1] * y + m[2][2] * z + m[2][3];
+	}
+}
+
+static void TransformNormalsScalar(const Matrix4& m, const Vector3* in, Vector3* out, size_t count, bool normalise)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		Real x = in[i].x, y = in[i].y, z = in[i].z;
+		Vector3 v(
+			m[0][0] * x + m[0][1] * y + m[0][2] * z,
+			m[1][0] * x + m[1][1] * y + m[1][2] * z,
+			m[2][0] * x + m[2][1] * y + m[2][2] * z);
+
+		if (normalise) v.normalise();
+		out[i] = v;
+	}
+}
+
+static void MultiplyScalar(const Matrix4* a, size_t aStep, const Matrix4* b, Matrix4* out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+		out[i] = a[i * aStep].concatenate(b[i]);
+}
+
+static void NormaliseScalar(Quaternion* q, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+		q[i].normalise();
+}
+
+static void SlerpScalar(const Quaternion* p, const Quaternion* q, const float* t, Quaternion* out, size_t count, bool shortestPath)
+{
+	const float threshold = 1.0f - Quaternion::ms_fEpsilon;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		const Quaternion& P = p[i];
+		Quaternion T = q[i];
+		float ti = t[i];
+
+		float c = P.w * T.w + P.x * T.x + P.y * T.y + P.z * T.z;
+
+		if (c < 0.0f && shortestPath)
+		{
+			c = -c;
+			T = -T;
+		}
+
+		Quaternion r;
+
+		if (Math::abs(c) < threshold)
+		{
+			float s = Math::sqrt(1.0f - c * c);
+			float angle = ACosPoly(c);
+			float invSin = 1.0f / s;
+			float c0 = SinPoly((1.0f - ti) * angle) * invSin;
+			float c1 = SinPoly(ti * angle) * invSin;
+			r = c0 * P + c1 * T;
+		}
+		else
+		{
+			r = (1.0f - ti) * P + ti * T;
+			r.normalise();
+		}
+
+		out[i] = r;
+	}
+}
+
+static void TransformBoxesScalar(const Matrix4& m, const AxisAlignedBox* in, AxisAlignedBox* out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (out != in) out[i] = in[i];
+		out[i].transformAffine(m);
+	}
+}
+
+static void MergeBoxesScalar(AxisAlignedBox& box, const AxisAlignedBox* boxes, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+		box.merge(boxes[i]);
+}
+
+static void MergePointsScalar(AxisAlignedBox& box, const Vector3* points, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+		box.merge(points[i]);
+}
+
+static size_t CullBoxesScalar(const Plane* planes, uint numPlanes, const AxisAlignedBox* boxes, size_t count, uint8* outVisible, Plane::Side outside)
+{
+	size_t numVisible = 0;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		const AxisAlignedBox& box = boxes[i];
+		bool visible = !box.isNull();
+
+		if (visible && !box.isInfinite())
+		{
+			Vector3 centre = box.getCenter();
+			Vector3 halfSize = box.getHalfSize();
+
+			for (uint p = 0; visible && p < numPlanes; ++p)
+				visible = planes[p].getSide(centre, halfSize) != outside;
+		}
+
+		outVisible[i] = visible ? 1 : 0;
+		numVisible += outVisible[i];
+	}
+
+	return numVisible;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+#if defined(NIT_SIMD_SSE2)
+
+// Every kernel keeps the scalar evaluation order, and never uses fused multiply-add.
+
+#define NIT_SPLAT_PS(v, i)		_mm_shuffle_ps((v), (v), _MM_SHUFFLE(i, i, i, i))
+
+static inline __m128 SelectSse2(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// 4 packed Vector3 (12 floats) <-> x, y, z of each
+static inline void LoadVector3x4Sse2(const float* src, __m128& x, __m128& y, __m128& z)
+{
+	__m128 a = _mm_loadu_ps(src + 0);		// x0 y0 z0 x1
+	__m128 b = _mm_loadu_ps(src + 4);		// y1 z1 x2 y2
+	__m128 c = _mm_loadu_ps(src + 8);		// z2 x3 y3 z3
+
+	__m128 xx = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));
+	x = _mm_shuffle_ps(a, xx, _MM_SHUFFLE(2, 0, 3, 0));
+	y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+	z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+static inline void StoreVector3x4Sse2(float* dst, __m128 x, __m128 y, __m128 z)
+{
+	_mm_storeu_ps(dst + 0, _mm_shuffle_ps(_mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0)));
+	_mm_storeu_ps(dst + 4, _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0)));
+	_mm_storeu_ps(dst + 8, _mm_shuffle_ps(_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+static void TransformPointsSse2(const Matrix4& m, const Vector3* in, Vector3* out, size_t count)
+{
+	__m128 m00 = _mm_set1_ps(m[0][0]), m01 = _mm_set1_ps(m[0][1]), m02 = _mm_set1_ps(m[0][2]), m03 = _mm_set1_ps(m[0][3]);
+	__m128 m10 = _mm_set1_ps(m[1][0]), m11 = _mm_set1_ps(m[1][1]), m12 = _mm_set1_ps(m[1][2]), m13 = _mm_set1_ps(m[1][3]);
+	__m128 m20 = _mm_set1_ps(m[2][0]), m21 = _mm_set1_ps(m[2][1]), m22 = _mm_set1_ps(m[2][2]), m23 = _mm_set1_ps(m[2][3]);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 x, y, z;
+		LoadVector3x4Sse2(&in[i].x, x, y, z);
+
+		__m128 rx = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m01, y)), _mm_mul_ps(m02, z)), m03);
+		__m128 ry = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m10, x), _mm_mul_ps(m11, y)), _mm_mul_ps(m12, z)), m13);
+		__m128 rz = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m20, x), _mm_mul_ps(m21, y)), _mm_mul_ps(m22, z)), m23);
+
+		StoreVector3x4Sse2(&out[i].x, rx, ry, rz);
+	}
+
+	TransformPointsScalar(m, in + i, out + i, count - i);
+}
+
+static void TransformNormalsSse2(const Matrix4& m, const Vector3* in, Vector3* out, size_t count, bool normalise)
+{
+	__m128 m00 = _mm_set1_ps(m[0][0]), m01 = _mm_set1_ps(m[0][1]), m02 = _mm_set1_ps(m[0][2]);
+	__m128 m10 = _mm_set1_ps(m[1][0]), m11 = _mm_set1_ps(m[1][1]), m12 = _mm_set1_ps(m[1][2]);
+	__m128 m20 = _mm_set1_ps(m[2][0]), m21 = _mm_set1_ps(m[2][1]), m22 = _mm_set1_ps(m[2][2]);
+
+	__m128 one = _mm_set1_ps(1.0f);
+	__m128 tiny = _mm_set1_ps(1e-08f);				// same as comparing against double 1e-08
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 x, y, z;
+		LoadVector3x4Sse2(&in[i].x, x, y, z);
+
+		__m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m01, y)), _mm_mul_ps(m02, z));
+		__m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m10, x), _mm_mul_ps(m11, y)), _mm_mul_ps(m12, z));
+		__m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m20, x), _mm_mul_ps(m21, y)), _mm_mul_ps(m22, z));
+
+		if (normalise)
+		{
+			__m128 len = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)), _mm_mul_ps(rz, rz)));
+			__m128 mask = _mm_cmpgt_ps(len, tiny);
+			__m128 inv = _mm_div_ps(one, len);
+			rx = SelectSse2(mask, _mm_mul_ps(rx, inv), rx);
+			ry = SelectSse2(mask, _mm_mul_ps(ry, inv), ry);
+			rz = SelectSse2(mask, _mm_mul_ps(rz, inv), rz);
+		}
+
+		StoreVector3x4Sse2(&out[i].x, rx, ry, rz);
+	}
+
+	TransformNormalsScalar(m, in + i, out + i, count - i, normalise);
+}
+
+static void MultiplySse2(const Matrix4* a, size_t aStep, const Matrix4* b, Matrix4* out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		const Matrix4& ma = a[i * aStep];
+		const Matrix4& mb = b[i];
+
+		// Load everything first so that out may be either a or b
+		__m128 b0 = _mm_loadu_ps(mb[0]);
+		__m128 b1 = _mm_loadu_ps(mb[1]);
+		__m128 b2 = _mm_loadu_ps(mb[2]);
+		__m128 b3 = _mm_loadu_ps(mb[3]);
+
+		__m128 a0 = _mm_loadu_ps(ma[0]);
+		__m128 a1 = _mm_loadu_ps(ma[1]);
+		__m128 a2 = _mm_loadu_ps(ma[2]);
+		__m128 a3 = _mm_loadu_ps(ma[3]);
+
+		Matrix4& r = out[i];
+
+#define NIT_MULTIPLY_ROW(ROW, A) \
+		_mm_storeu_ps(r[ROW], _mm_add_ps(_mm_add_ps(_mm_add_ps( \
+			_mm_mul_ps(NIT_SPLAT_PS(A, 0), b0), _mm_mul_ps(NIT_SPLAT_PS(A, 1), b1)), \
+			_mm_mul_ps(NIT_SPLAT_PS(A, 2), b2)), _mm_mul_ps(NIT_SPLAT_PS(A, 3), b3)))
+
+		NIT_MULTIPLY_ROW(0, a0);
+		NIT_MULTIPLY_ROW(1, a1);
+		NIT_MULTIPLY_ROW(2, a2);
+		NIT_MULTIPLY_ROW(3, a3);
+
+#undef NIT_MULTIPLY_ROW
+	}
+}
+
+static void NormaliseSse2(Quaternion* q, size_t count)
+{
+	__m128 one = _mm_set1_ps(1.0f);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 q0 = _mm_loadu_ps(&q[i + 0].w);
+		__m128 q1 = _mm_loadu_ps(&q[i + 1].w);
+		__m128 q2 = _mm_loadu_ps(&q[i + 2].w);
+		__m128 q3 = _mm_loadu_ps(&q[i + 3].w);
+
+		__m128 w = q0, x = q1, y = q2, z = q3;
+		_MM_TRANSPOSE4_PS(w, x, y, z);
+
+		__m128 norm = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(w, w), _mm_mul_ps(x, x)), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+		__m128 factor = _mm_div_ps(one, _mm_sqrt_ps(norm));
+
+		_mm_storeu_ps(&q[i + 0].w, _mm_mul_ps(NIT_SPLAT_PS(factor, 0), q0));
+		_mm_storeu_ps(&q[i + 1].w, _mm_mul_ps(NIT_SPLAT_PS(factor, 1), q1));
+		_mm_storeu_ps(&q[i + 2].w, _mm_mul_ps(NIT_SPLAT_PS(factor, 2), q2));
+		_mm_storeu_ps(&q[i + 3].w, _mm_mul_ps(NIT_SPLAT_PS(factor, 3), q3));
+	}
+
+	NormaliseScalar(q + i, count - i);
+}
+
+static inline __m128 ACosSse2(__m128 x)
+{
+	__m128 sign = _mm_set1_ps(-0.0f);
+	__m128 a = _mm_andnot_ps(sign, x);
+
+	__m128 p = _mm_set1_ps(ACOS_C7);
+	p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps(ACOS_C6));
+	p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps(ACOS_C5));
+	p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps(ACOS_C4));
+	p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps(ACOS_C3));
+	p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps(ACOS_C2));
+	p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps(ACOS_C1));
+	p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps(ACOS_C0));
+
+	__m128 r = _mm_mul_ps(_mm_sqrt_ps(_mm_sub_ps(_mm_set1_ps(1.0f), a)), p);
+	return SelectSse2(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(SLERP_PI), r), r);
+}
+
+static inline __m128 SinSse2(__m128 x)
+{
+	__m128 v = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(SLERP_INV_PI)), _mm_set1_ps(0.5f));
+	__m128i k = _mm_cvttps_epi32(v);
+	k = _mm_add_epi32(k, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(k), v))); // floor
+	__m128 kf = _mm_cvtepi32_ps(k);
+
+	__m128 r = _mm_sub_ps(_mm_sub_ps(x, _mm_mul_ps(kf, _mm_set1_ps(SLERP_PI_A))), _mm_mul_ps(kf, _mm_set1_ps(SLERP_PI_B)));
+	__m128 r2 = _mm_mul_ps(r, r);
+
+	__m128 p = _mm_set1_ps(SIN_C11);
+	p = _mm_add_ps(_mm_mul_ps(p, r2), _mm_set1_ps(SIN_C9));
+	p = _mm_add_ps(_mm_mul_ps(p, r2), _mm_set1_ps(SIN_C7));
+	p = _mm_add_ps(_mm_mul_ps(p, r2), _mm_set1_ps(SIN_C5));
+	p = _mm_add_ps(_mm_mul_ps(p, r2), _mm_set1_ps(SIN_C3));
+	p = _mm_add_ps(_mm_mul_ps(p, r2), _mm_set1_ps(1.0f));
+
+	__m128 odd = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(k, _mm_set1_epi32(1)), 31));
+	return _mm_xor_ps(_mm_mul_ps(r, p), odd);
+}
+
+static void SlerpSse2(const Quaternion* p, const Quaternion* q, const float* t, Quaternion* out, size_t count, bool shortestPath)
+{
+	__m128 sign = _mm_set1_ps(-0.0f);
+	__m128 zero = _mm_setzero_ps();
+	__m128 one = _mm_set1_ps(1.0f);
+	__m128 threshold = _mm_set1_ps(1.0f - Quaternion::ms_fEpsilon);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 pw = _mm_loadu_ps(&p[i + 0].w), px = _mm_loadu_ps(&p[i + 1].w), py = _mm_loadu_ps(&p[i + 2].w), pz = _mm_loadu_ps(&p[i + 3].w);
+		__m128 qw = _mm_loadu_ps(&q[i + 0].w), qx = _mm_loadu_ps(&q[i + 1].w), qy = _mm_loadu_ps(&q[i + 2].w), qz = _mm_loadu_ps(&q[i + 3].w);
+		_MM_TRANSPOSE4_PS(pw, px, py, pz);
+		_MM_TRANSPOSE4_PS(qw, qx, qy, qz);
+
+		__m128 ti = _mm_loadu_ps(t + i);
+		__m128 ti1 = _mm_sub_ps(one, ti);
+
+		__m128 c = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(pw, qw), _mm_mul_ps(px, qx)), _mm_mul_ps(py, qy)), _mm_mul_ps(pz, qz));
+
+		if (shortestPath)
+		{
+			__m128 neg = _mm_and_ps(_mm_cmplt_ps(c, zero), sign);
+			c = _mm_xor_ps(c, neg);
+			qw = _mm_xor_ps(qw, neg);
+			qx = _mm_xor_ps(qx, neg);
+			qy = _mm_xor_ps(qy, neg);
+			qz = _mm_xor_ps(qz, neg);
+		}
+
+		__m128 useSlerp = _mm_cmplt_ps(_mm_andnot_ps(sign, c), threshold);
+
+		// Standard case (slerp)
+		__m128 s = _mm_sqrt_ps(_mm_sub_ps(one, _mm_mul_ps(c, c)));
+		__m128 angle = ACosSse2(c);
+		__m128 invSin = _mm_div_ps(one, s);
+		__m128 c0 = _mm_mul_ps(SinSse2(_mm_mul_ps(ti1, angle)), invSin);
+		__m128 c1 = _mm_mul_ps(SinSse2(_mm_mul_ps(ti, angle)), invSin);
+
+		__m128 sw = _mm_add_ps(_mm_mul_ps(c0, pw), _mm_mul_ps(c1, qw));
+		__m128 sx = _mm_add_ps(_mm_mul_ps(c0, px), _mm_mul_ps(c1, qx));
+		__m128 sy = _mm_add_ps(_mm_mul_ps(c0, py), _mm_mul_ps(c1, qy));
+		__m128 sz = _mm_add_ps(_mm_mul_ps(c0, pz), _mm_mul_ps(c1, qz));
+
+		// Nearly parallel: normalised lerp
+		__m128 lw = _mm_add_ps(_mm_mul_ps(ti1, pw), _mm_mul_ps(ti, qw));
+		__m128 lx = _mm_add_ps(_mm_mul_ps(ti1, px), _mm_mul_ps(ti, qx));
+		__m128 ly = _mm_add_ps(_mm_mul_ps(ti1, py), _mm_mul_ps(ti, qy));
+		__m128 lz = _mm_add_ps(_mm_mul_ps(ti1, pz), _mm_mul_ps(ti, qz));
+
+		__m128 norm = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(lw, lw), _mm_mul_ps(lx, lx)), _mm_mul_ps(ly, ly)), _mm_mul_ps(lz, lz));
+		__m128 factor = _mm_div_ps(one, _mm_sqrt_ps(norm));
+
+		__m128 rw = SelectSse2(useSlerp, sw, _mm_mul_ps(factor, lw));
+		__m128 rx = SelectSse2(useSlerp, sx, _mm_mul_ps(factor, lx));
+		__m128 ry = SelectSse2(useSlerp, sy, _mm_mul_ps(factor, ly));
+		__m128 rz = SelectSse2(useSlerp, sz, _mm_mul_ps(factor, lz));
+
+		_MM_TRANSPOSE4_PS(rw, rx, ry, rz);
+		_mm_storeu_ps(&out[i + 0].w, rw);
+		_mm_storeu_ps(&out[i + 1].w, rx);
+		_mm_storeu_ps(&out[i + 2].w, ry);
+		_mm_storeu_ps(&out[i + 3].w, rz);
+	}
+
+	SlerpScalar(p + i, q + i, t + i, out + i, count - i, shortestPath);
+}
+
+static void TransformBoxesSse2(const Matrix4& m, const AxisAlignedBox* in, AxisAlignedBox* out, size_t count)
+{
+	assert(m.isAffine());
+
+	__m128 sign = _mm_set1_ps(-0.0f);
+	__m128 half = _mm_set1_ps(0.5f);
+
+	// Matrix columns, so that lane n of the result is row n
+	__m128 c0 = _mm_setr_ps(m[0][0], m[1][0], m[2][0], 0.0f);
+	__m128 c1 = _mm_setr_ps(m[0][1], m[1][1], m[2][1], 0.0f);
+	__m128 c2 = _mm_setr_ps(m[0][2], m[1][2], m[2][2], 0.0f);
+	__m128 c3 = _mm_setr_ps(m[0][3], m[1][3], m[2][3], 0.0f);
+
+	__m128 a0 = _mm_andnot_ps(sign, c0);
+	__m128 a1 = _mm_andnot_ps(sign, c1);
+	__m128 a2 = _mm_andnot_ps(sign, c2);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		const AxisAlignedBox& box = in[i];
+
+		if (!box.isFinite())
+		{
+			if (out != in) out[i] = box;
+			continue;
+		}
+
+		// The 4th lanes hold whatever follows each vector in the box and are not used
+		__m128 mn = _mm_loadu_ps(&box.getMinimum().x);
+		__m128 mx = _mm_loadu_ps(&box.getMaximum().x);
+
+		__m128 centre = _mm_mul_ps(_mm_add_ps(mx, mn), half);
+		__m128 halfSize = _mm_mul_ps(_mm_sub_ps(mx, mn), half);
+
+		__m128 nc = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(c0, NIT_SPLAT_PS(centre, 0)), _mm_mul_ps(c1, NIT_SPLAT_PS(centre, 1))), _mm_mul_ps(c2, NIT_SPLAT_PS(centre, 2))), c3);
+		__m128 nh = _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(a0, NIT_SPLAT_PS(halfSize, 0)), _mm_mul_ps(a1, NIT_SPLAT_PS(halfSize, 1))), _mm_mul_ps(a2, NIT_SPLAT_PS(halfSize, 2)));
+
+		float r[8];
+		_mm_storeu_ps(r + 0, _mm_sub_ps(nc, nh));
+		_mm_storeu_ps(r + 4, _mm_add_ps(nc, nh));
+
+		out[i].setExtents(r[0], r[1], r[2], r[4], r[5], r[6]);
+	}
+}
+
+static void MergeBoxesSse2(AxisAlignedBox& box, const AxisAlignedBox* boxes, size_t count)
+{
+	if (box.isInfinite()) return;
+
+	__m128 mn = _mm_set1_ps(Math::POS_INFINITY);
+	__m128 mx = _mm_set1_ps(Math::NEG_INFINITY);
+	bool merged = false;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		const AxisAlignedBox& b = boxes[i];
+
+		if (b.isNull()) continue;
+
+		if (b.isInfinite())
+		{
+			box.setInfinite();
+			return;
+		}
+
+		// min(a, b) yields b on ties, which keeps the earlier value just as Vector3::makeFloor() does
+		mn = _mm_min_ps(_mm_loadu_ps(&b.getMinimum().x), mn);
+		mx = _mm_max_ps(_mm_loadu_ps(&b.getMaximum().x), mx);
+		merged = true;
+	}
+
+	if (!merged) return;
+
+	float r[8];
+	_mm_storeu_ps(r + 0, mn);
+	_mm_storeu_ps(r + 4, mx);
+	box.merge(AxisAlignedBox(r[0], r[1], r[2], r[4], r[5], r[6]));
+}
+
+static void MergePointsSse2(AxisAlignedBox& box, const Vector3* points, size_t count)
+{
+	if (box.isInfinite() || count == 0) return;
+
+	__m128 minX = _mm_set1_ps(Math::POS_INFINITY), minY = minX, minZ = minX;
+	__m128 maxX = _mm_set1_ps(Math::NEG_INFINITY), maxY = maxX, maxZ = maxX;
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 x, y, z;
+		LoadVector3x4Sse2(&points[i].x, x, y, z);
+
+		minX = _mm_min_ps(x, minX); minY = _mm_min_ps(y, minY); minZ = _mm_min_ps(z, minZ);
+		maxX = _mm_max_ps(x, maxX); maxY = _mm_max_ps(y, maxY); maxZ = _mm_max_ps(z, maxZ);
+	}
+
+	AxisAlignedBox result;
+
+	if (i > 0)
+	{
+		float lo[12], hi[12];
+		StoreVector3x4Sse2(lo, minX, minY, minZ);
+		StoreVector3x4Sse2(hi, maxX, maxY, maxZ);
+
+		for (int k = 0; k < 4; ++k)
+		{
+			result.merge(*(const Vector3*)(lo + k * 3));
+			result.merge(*(const Vector3*)(hi + k * 3));
+		}
+	}
+
+	MergePointsScalar(result, points + i, count - i);
+	box.merge(result);
+}
+
+static size_t CullBoxesSse2(const Plane* planes, uint numPlanes, const AxisAlignedBox* boxes, size_t count, uint8* outVisible, Plane::Side outside)
+{
+	__m128 sign = _mm_set1_ps(-0.0f);
+	__m128 half = _mm_set1_ps(0.5f);
+
+	size_t numVisible = 0;
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		// Transposed, the 4th rows hold whatever follows each vector and are not used
+		__m128 minX = _mm_loadu_ps(&boxes[i + 0].getMinimum().x), minY = _mm_loadu_ps(&boxes[i + 1].getMinimum().x);
+		__m128 minZ = _mm_loadu_ps(&boxes[i + 2].getMinimum().x), minW = _mm_loadu_ps(&boxes[i + 3].getMinimum().x);
+		__m128 maxX = _mm_loadu_ps(&boxes[i + 0].getMaximum().x), maxY = _mm_loadu_ps(&boxes[i + 1].getMaximum().x);
+		__m128 maxZ = _mm_loadu_ps(&boxes[i + 2].getMaximum().x), maxW = _mm_loadu_ps(&boxes[i + 3].getMaximum().x);
+		_MM_TRANSPOSE4_PS(minX, minY, minZ, minW);
+		_MM_TRANSPOSE4_PS(maxX, maxY, maxZ, maxW);
+
+		__m128 cx = _mm_mul_ps(_mm_add_ps(maxX, minX), half);
+		__m128 cy = _mm_mul_ps(_mm_add_ps(maxY, minY), half);
+		__m128 cz = _mm_mul_ps(_mm_add_ps(maxZ, minZ), half);
+		__m128 hx = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+		__m128 hy = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+		__m128 hz = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+
+		__m128 culled = _mm_setzero_ps();
+
+		for (uint p = 0; p < numPlanes; ++p)
+		{
+			const Plane& plane = planes[p];
+			__m128 nx = _mm_set1_ps(plane.normal.x);
+			__m128 ny = _mm_set1_ps(plane.normal.y);
+			__m128 nz = _mm_set1_ps(plane.normal.z);
+
+			__m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)), _mm_mul_ps(nz, cz)), _mm_set1_ps(plane.d));
+			__m128 maxAbsDist = _mm_add_ps(_mm_add_ps(
+				_mm_andnot_ps(sign, _mm_mul_ps(nx, hx)), _mm_andnot_ps(sign, _mm_mul_ps(ny, hy))), _mm_andnot_ps(sign, _mm_mul_ps(nz, hz)));
+
+			__m128 neg = _mm_cmplt_ps(dist, _mm_xor_ps(maxAbsDist, sign));
+			__m128 pos = _mm_cmpgt_ps(dist, maxAbsDist);
+
+			switch (outside)
+			{
+			case Plane::NEGATIVE_SIDE:	culled = _mm_or_ps(culled, neg); break;
+			case Plane::POSITIVE_SIDE:	culled = _mm_or_ps(culled, pos); break;
+			case Plane::BOTH_SIDE:		culled = _mm_or_ps(culled, _mm_cmpeq_ps(_mm_or_ps(neg, pos), _mm_setzero_ps())); break;
+			default:					break;
+			}
+
+			if (_mm_movemask_ps(culled) == 0xF) break;
+		}
+
+		int culledMask = _mm_movemask_ps(culled);
+
+		for (int k = 0; k < 4; ++k)
+		{
+			const AxisAlignedBox& box = boxes[i + k];
+			bool visible = box.isFinite() ? (culledMask & (1 << k)) == 0 : box.isInfinite();
+			outVisible[i + k] = visible ? 1 : 0;
+			numVisible += outVisible[i + k];
+		}
+	}
+
+	return numVisible + CullBoxesScalar(planes, numPlanes, boxes + i, count - i, outVisible + i, outside);
+}
+
+#undef NIT_SPLAT_PS
+
+#elif defined(NIT_SIMD_NEON)
+
+// Every kernel keeps the scalar evaluation order with separate multiply and add.
+// ARMv7 NEON lacks division and square root, which are done per lane there to stay IEEE exact.
+
+static inline float32x4_t DivNeon(float32x4_t a, float32x4_t b)
+{
+#if defined(__aarch64__)
+	return vdivq_f32(a, b);
+#else
+	float va[4], vb[4];
+	vst1q_f32(va, a);
+	vst1q_f32(vb, b);
+	for (int i = 0; i < 4; ++i) va[i] = va[i] / vb[i];
+	return vld1q_f32(va);
+#endif
+}
+
+static inline float32x4_t SqrtNeon(float32x4_t a)
+{
+#if defined(__aarch64__)
+	return vsqrtq_f32(a);
+#else
+	float va[4];
+	vst1q_f32(va, a);
+	for (int i = 0; i < 4; ++i) va[i] = Math::sqrt(va[i]);
+	return vld1q_f32(va);
+#endif
+}
+
+static inline float32x4_t MulAddNeon(float32x4_t a, float32x4_t b, float32x4_t c)
+{
+	return vaddq_f32(vmulq_f32(a, b), c);
+}
+
+static inline void TransposeNeon(float32x4_t& r0, float32x4_t& r1, float32x4_t& r2, float32x4_t& r3)
+{
+	float32x4x2_t t01 = vtrnq_f32(r0, r1);
+	float32x4x2_t t23 = vtrnq_f32(r2, r3);
+	r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+	r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+	r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+	r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+
+static void TransformPointsNeon(const Matrix4& m, const Vector3* in, Vector3* out, size_t count)
+{
+	float32x4_t m00 = vdupq_n_f32(m[0][0]), m01 = vdupq_n_f32(m[0][1]), m02 = vdupq_n_f32(m[0][2]), m03 = vdupq_n_f32(m[0][3]);
+	float32x4_t m10 = vdupq_n_f32(m[1][0]), m11 = vdupq_n_f32(m[1][1]), m12 = vdupq_n_f32(m[1][2]), m13 = vdupq_n_f32(m[1][3]);
+	float32x4_t m20 = vdupq_n_f32(m[2][0]), m21 = vdupq_n_f32(m[2][1]), m22 = vdupq_n_f32(m[2][2]), m23 = vdupq_n_f32(m[2][3]);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		float32x4x3_t v = vld3q_f32(&in[i].x);
+		float32x4x3_t r;
+
+		r.val[0] = vaddq_f32(MulAddNeon(m02, v.val[2], MulAddNeon(m01, v.val[1], vmulq_f32(m00, v.val[0]))), m03);
+		r.val[1] = vaddq_f32(MulAddNeon(m12, v.val[2], MulAddNeon(m11, v.val[1], vmulq_f32(m10, v.val[0]))), m13);
+		r.val[2] = vaddq_f32(MulAddNeon(m22, v.val[2], MulAddNeon(m21, v.val[1], vmulq_f32(m20, v.val[0]))), m23);
+
+		vst3q_f32(&out[i].x, r);
+	}
+
+	TransformPointsScalar(m, in + i, out + i, count - i);
+}
+
+static void TransformNormalsNeon(const Matrix4& m, const Vector3* in, Vector3* out, size_t count, bool normalise)
+{
+	float32x4_t m00 = vdupq_n_f32(m[0][0]), m01 = vdupq_n_f32(m[0][1]), m02 = vdupq_n_f32(m[0][2]);
+	float32x4_t m10 = vdupq_n_f32(m[1][0]), m11 = vdupq_n_f32(m[1][1]), m12 = vdupq_n_f32(m[1][2]);
+	float32x4_t m20 = vdupq_n_f32(m[2][0]), m21 = vdupq_n_f32(m[2][1]), m22 = vdupq_n_f32(m[2][2]);
+
+	float32x4_t one = vdupq_n_f32(1.0f);
+	float32x4_t tiny = vdupq_n_f32(1e-08f);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		float32x4x3_t v = vld3q_f32(&in[i].x);
+		float32x4x3_t r;
+
+		r.val[0] = MulAddNeon(m02, v.val[2], MulAddNeon(m01, v.val[1], vmulq_f32(m00, v.val[0])));
+		r.val[1] = MulAddNeon(m12, v.val[2], MulAddNeon(m11, v.val[1], vmulq_f32(m10, v.val[0])));
+		r.val[2] = MulAddNeon(m22, v.val[2], MulAddNeon(m21, v.val[1], vmulq_f32(m20, v.val[0])));
+
+		if (normalise)
+		{
+			float32x4_t len = SqrtNeon(MulAddNeon(r.val[2], r.val[2], MulAddNeon(r.val[1], r.val[1], vmulq_f32(r.val[0], r.val[0]))));
+			uint32x4_t mask = vcgtq_f32(len, tiny);
+			float32x4_t inv = DivNeon(one, len);
+			r.val[0] = vbslq_f32(mask, vmulq_f32(r.val[0], inv), r.val[0]);
+			r.val[1] = vbslq_f32(mask, vmulq_f32(r.val[1], inv), r.val[1]);
+			r.val[2] = vbslq_f32(mask, vmulq_f32(r.val[2], inv), r.val[2]);
+		}
+
+		vst3q_f32(&out[i].x, r);
+	}
+
+	TransformNormalsScalar(m, in + i, out + i, count - i, normalise);
+}
+
+static void MultiplyNeon(const Matrix4* a, size_t aStep, const Matrix4* b, Matrix4* out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		const Matrix4& ma = a[i * aStep];
+		const Matrix4& mb = b[i];
+
+		// Load everything first so that out may be either a or b
+		float32x4_t b0 = vld1q_f32(mb[0]);
+		float32x4_t b1 = vld1q_f32(mb[1]);
+		float32x4_t b2 = vld1q_f32(mb[2]);
+		float32x4_t b3 = vld1q_f32(mb[3]);
+
+		float32x4_t a0 = vld1q_f32(ma[0]);
+		float32x4_t a1 = vld1q_f32(ma[1]);
+		float32x4_t a2 = vld1q_f32(ma[2]);
+		float32x4_t a3 = vld1q_f32(ma[3]);
+
+		Matrix4& r = out[i];
+
+#define NIT_MULTIPLY_ROW(ROW, A) \
+		vst1q_f32(r[ROW], MulAddNeon(vdupq_lane_f32(vget_high_f32(A), 1), b3, MulAddNeon(vdupq_lane_f32(vget_high_f32(A), 0), b2, \
+			MulAddNeon(vdupq_lane_f32(vget_low_f32(A), 1), b1, vmulq_f32(vdupq_lane_f32(vget_low_f32(A), 0), b0)))))
+
+		NIT_MULTIPLY_ROW(0, a0);
+		NIT_MULTIPLY_ROW(1, a1);
+		NIT_MULTIPLY_ROW(2, a2);
+		NIT_MULTIPLY_ROW(3, a3);
+
+#undef NIT_MULTIPLY_ROW
+	}
+}
+
+static void NormaliseNeon(Quaternion* q, size_t count)
+{
+	float32x4_t one = vdupq_n_f32(1.0f);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		float32x4x4_t v = vld4q_f32(&q[i].w);
+
+		float32x4_t norm = MulAddNeon(v.val[3], v.val[3], MulAddNeon(v.val[2], v.val[2], MulAddNeon(v.val[1], v.val[1], vmulq_f32(v.val[0], v.val[0]))));
+		float32x4_t factor = DivNeon(one, SqrtNeon(norm));
+
+		for (int k = 0; k < 4; ++k)
+			v.val[k] = vmulq_f32(factor, v.val[k]);
+
+		vst4q_f32(&q[i].w, v);
+	}
+
+	NormaliseScalar(q + i, count - i);
+}
+
+static inline float32x4_t ACosNeon(float32x4_t x)
+{
+	float32x4_t a = vabsq_f32(x);
+
+	float32x4_t p = vdupq_n_f32(ACOS_C7);
+	p = MulAddNeon(p, a, vdupq_n_f32(ACOS_C6));
+	p = MulAddNeon(p, a, vdupq_n_f32(ACOS_C5));
+	p = MulAddNeon(p, a, vdupq_n_f32(ACOS_C4));
+	p = MulAddNeon(p, a, vdupq_n_f32(ACOS_C3));
+	p = MulAddNeon(p, a, vdupq_n_f32(ACOS_C2));
+	p = MulAddNeon(p, a, vdupq_n_f32(ACOS_C1));
+	p = MulAddNeon(p, a, vdupq_n_f32(ACOS_C0));
+
+	float32x4_t r = vmulq_f32(SqrtNeon(vsubq_f32(vdupq_n_f32(1.0f), a)), p);
+	return vbslq_f32(vcltq_f32(x, vdupq_n_f32(0.0f)), vsubq_f32(vdupq_n_f32(SLERP_PI), r), r);
+}
+
+static inline float32x4_t SinNeon(float32x4_t x)
+{
+	float32x4_t v = MulAddNeon(x, vdupq_n_f32(SLERP_INV_PI), vdupq_n_f32(0.5f));
+	int32x4_t k = vcvtq_s32_f32(v);
+	k = vaddq_s32(k, vreinterpretq_s32_u32(vcgtq_f32(vcvtq_f32_s32(k), v))); // floor
+	float32x4_t kf = vcvtq_f32_s32(k);
+
+	float32x4_t r = vsubq_f32(vsubq_f32(x, vmulq_f32(kf, vdupq_n_f32(SLERP_PI_A))), vmulq_f32(kf, vdupq_n_f32(SLERP_PI_B)));
+	float32x4_t r2 = vmulq_f32(r, r);
+
+	float32x4_t p = vdupq_n_f32(SIN_C11);
+	p = MulAddNeon(p, r2, vdupq_n_f32(SIN_C9));
+	p = MulAddNeon(p, r2, vdupq_n_f32(SIN_C7));
+	p = MulAddNeon(p, r2, vdupq_n_f32(SIN_C5));
+	p = MulAddNeon(p, r2, vdupq_n_f32(SIN_C3));
+	p = MulAddNeon(p, r2, vdupq_n_f32(1.0f));
+
+	uint32x4_t odd = vshlq_n_u32(vandq_u32(vreinterpretq_u32_s32(k), vdupq_n_u32(1)), 31);
+	return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vmulq_f32(r, p)), odd));
+}
+
+static void SlerpNeon(const Quaternion* p, const Quaternion* q, const float* t, Quaternion* out, size_t count, bool shortestPath)
+{
+	float32x4_t zero = vdupq_n_f32(0.0f);
+	float32x4_t one = vdupq_n_f32(1.0f);
+	float32x4_t threshold = vdupq_n_f32(1.0f - Quaternion::ms_fEpsilon);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		float32x4x4_t P = vld4q_f32(&p[i].w);
+		float32x4x4_t Q = vld4q_f32(&q[i].w);
+
+		float32x4_t ti = vld1q_f32(t + i);
+		float32x4_t ti1 = vsubq_f32(one, ti);
+
+		float32x4_t c = MulAddNeon(P.val[3], Q.val[3], MulAddNeon(P.val[2], Q.val[2], MulAddNeon(P.val[1], Q.val[1], vmulq_f32(P.val[0], Q.val[0]))));
+
+		if (shortestPath)
+		{
+			uint32x4_t neg = vcltq_f32(c, zero);
+			c = vbslq_f32(neg, vnegq_f32(c), c);
+			for (int k = 0; k < 4; ++k)
+				Q.val[k] = vbslq_f32(neg, vnegq_f32(Q.val[k]), Q.val[k]);
+		}
+
+		uint32x4_t useSlerp = vcltq_f32(vabsq_f32(c), threshold);
+
+		// Standard case (slerp)
+		float32x4_t s = SqrtNeon(vsubq_f32(one, vmulq_f32(c, c)));
+		float32x4_t angle = ACosNeon(c);
+		float32x4_t invSin = DivNeon(one, s);
+		float32x4_t c0 = vmulq_f32(SinNeon(vmulq_f32(ti1, angle)), invSin);
+		float32x4_t c1 = vmulq_f32(SinNeon(vmulq_f32(ti, angle)), invSin);
+
+		// Nearly parallel: normalised lerp
+		float32x4x4_t L;
+		for (int k = 0; k < 4; ++k)
+			L.val[k] = MulAddNeon(ti, Q.val[k], vmulq_f32(ti1, P.val[k]));
+
+		float32x4_t norm = MulAddNeon(L.val[3], L.val[3], MulAddNeon(L.val[2], L.val[2], MulAddNeon(L.val[1], L.val[1], vmulq_f32(L.val[0], L.val[0]))));
+		float32x4_t factor = DivNeon(one, SqrtNeon(norm));
+
+		float32x4x4_t R;
+		for (int k = 0; k < 4; ++k)
+			R.val[k] = vbslq_f32(useSlerp, MulAddNeon(c1, Q.val[k], vmulq_f32(c0, P.val[k])), vmulq_f32(factor, L.val[k]));
+
+		vst4q_f32(&out[i].w, R);
+	}
+
+	SlerpScalar(p + i, q + i, t + i, out + i, count - i, shortestPath);
+}
+
+static void TransformBoxesNeon(const Matrix4& m, const AxisAlignedBox* in, AxisAlignedBox* out, size_t count)
+{
+	assert(m.isAffine());
+
+	float32x4_t half = vdupq_n_f32(0.5f);
+
+	// Matrix columns, so that lane n of the result is row n
+	const float col0[4] = { m[0][0], m[1][0], m[2][0], 0.0f };
+	const float col1[4] = { m[0][1], m[1][1], m[2][1], 0.0f };
+	const float col2[4] = { m[0][2], m[1][2], m[2][2], 0.0f };
+	const float col3[4] = { m[0][3], m[1][3], m[2][3], 0.0f };
+
+	float32x4_t c0 = vld1q_f32(col0), c1 = vld1q_f32(col1), c2 = vld1q_f32(col2), c3 = vld1q_f32(col3);
+	float32x4_t a0 = vabsq_f32(c0), a1 = vabsq_f32(c1), a2 = vabsq_f32(c2);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		const AxisAlignedBox& box = in[i];
+
+		if (!box.isFinite())
+		{
+			if (out != in) out[i] = box;
+			continue;
+		}
+
+		// The 4th lanes hold whatever follows each vector in the box and are not used
+		float32x4_t mn = vld1q_f32(&box.getMinimum().x);
+		float32x4_t mx = vld1q_f32(&box.getMaximum().x);
+
+		float32x4_t centre = vmulq_f32(vaddq_f32(mx, mn), half);
+		float32x4_t halfSize = vmulq_f32(vsubq_f32(mx, mn), half);
+
+		float32x4_t nc = vaddq_f32(MulAddNeon(c2, vdupq_lane_f32(vget_high_f32(centre), 0),
+			MulAddNeon(c1, vdupq_lane_f32(vget_low_f32(centre), 1), vmulq_f32(c0, vdupq_lane_f32(vget_low_f32(centre), 0)))), c3);
+		float32x4_t nh = MulAddNeon(a2, vdupq_lane_f32(vget_high_f32(halfSize), 0),
+			MulAddNeon(a1, vdupq_lane_f32(vget_low_f32(halfSize), 1), vmulq_f32(a0, vdupq_lane_f32(vget_low_f32(halfSize), 0))));
+
+		float r[8];
+		vst1q_f32(r + 0, vsubq_f32(nc, nh));
+		vst1q_f32(r + 4, vaddq_f32(nc, nh));
+
+		out[i].setExtents(r[0], r[1], r[2], r[4], r[5], r[6]);
+	}
+}
+
+static void MergeBoxesNeon(AxisAlignedBox& box, const AxisAlignedBox* boxes, size_t count)
+{
+	if (box.isInfinite()) return;
+
+	float32x4_t mn = vdupq_n_f32(Math::POS_INFINITY);
+	float32x4_t mx = vdupq_n_f32(Math::NEG_INFINITY);
+	bool merged = false;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		const AxisAlignedBox& b = boxes[i];
+
+		if (b.isNull()) continue;
+
+		if (b.isInfinite())
+		{
+			box.setInfinite();
+			return;
+		}
+
+		// vminq_f32() orders -0 below +0, compare and select instead to keep the earlier value on ties like Vector3::makeFloor()
+		float32x4_t bmn = vld1q_f32(&b.getMinimum().x);
+		float32x4_t bmx = vld1q_f32(&b.getMaximum().x);
+		mn = vbslq_f32(vcltq_f32(bmn, mn), bmn, mn);
+		mx = vbslq_f32(vcgtq_f32(bmx, mx), bmx, mx);
+		merged = true;
+	}
+
+	if (!merged) return;
+
+	float r[8];
+	vst1q_f32(r + 0, mn);
+	vst1q_f32(r + 4, mx);
+	box.merge(AxisAlignedBox(r[0], r[1], r[2], r[4], r[5], r[6]));
+}
+
+static void MergePointsNeon(AxisAlignedBox& box, const Vector3* points, size_t count)
+{
+	if (box.isInfinite() || count == 0) return;
+
+	float32x4x3_t lo, hi;
+	for (int k = 0; k < 3; ++k)
+	{
+		lo.val[k] = vdupq_n_f32(Math::POS_INFINITY);
+		hi.val[k] = vdupq_n_f32(Math::NEG_INFINITY);
+	}
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		float32x4x3_t v = vld3q_f32(&points[i].x);
+
+		for (int k = 0; k < 3; ++k)
+		{
+			lo.val[k] = vbslq_f32(vcltq_f32(v.val[k], lo.val[k]), v.val[k], lo.val[k]);
+			hi.val[k] = vbslq_f32(vcgtq_f32(v.val[k], hi.val[k]), v.val[k], hi.val[k]);
+		}
+	}
+
+	AxisAlignedBox result;
+
+	if (i > 0)
+	{
+		float lov[12], hiv[12];
+		vst3q_f32(lov, lo);
+		vst3q_f32(hiv, hi);
+
+		for (int k = 0; k < 4; ++k)
+		{
+			result.merge(*(const Vector3*)(lov + k * 3));
+			result.merge(*(const Vector3*)(hiv + k * 3));
+		}
+	}
+
+	MergePointsScalar(result, points + i, count - i);
+	box.merge(result);
+}
+
+static size_t CullBoxesNeon(const Plane* planes, uint numPlanes, const AxisAlignedBox* boxes, size_t count, uint8* outVisible, Plane::Side outside)
+{
+	float32x4_t half = vdupq_n_f32(0.5f);
+
+	size_t numVisible = 0;
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		// Transposed, the 4th rows hold whatever follows each vector and are not used
+		float32x4_t minX = vld1q_f32(&boxes[i + 0].getMinimum().x), minY = vld1q_f32(&boxes[i + 1].getMinimum().x);
+		float32x4_t minZ = vld1q_f32(&boxes[i + 2].getMinimum().x), minW = vld1q_f32(&boxes[i + 3].getMinimum().x);
+		float32x4_t maxX = vld1q_f32(&boxes[i + 0].getMaximum().x), maxY = vld1q_f32(&boxes[i + 1].getMaximum().x);
+		float32x4_t maxZ = vld1q_f32(&boxes[i + 2].getMaximum().x), maxW = vld1q_f32(&boxes[i + 3].getMaximum().x);
+		TransposeNeon(minX, minY, minZ, minW);
+		TransposeNeon(maxX, maxY, maxZ, maxW);
+
+		float32x4_t cx = vmulq_f32(vaddq_f32(maxX, minX), half);
+		float32x4_t cy = vmulq_f32(vaddq_f32(maxY, minY), half);
+		float32x4_t cz = vmulq_f32(vaddq_f32(maxZ, minZ), half);
+		float32x4_t hx = vmulq_f32(vsubq_f32(maxX, minX), half);
+		float32x4_t hy = vmulq_f32(vsubq_f32(maxY, minY), half);
+		float32x4_t hz = vmulq_f32(vsubq_f32(maxZ, minZ), half);
+
+		uint32x4_t culled = vdupq_n_u32(0);
+		uint32 lanes[4] = { 0, 0, 0, 0 };
+
+		for (uint p = 0; p < numPlanes; ++p)
+		{
+			const Plane& plane = planes[p];
+			float32x4_t nx = vdupq_n_f32(plane.normal.x);
+			float32x4_t ny = vdupq_n_f32(plane.normal.y);
+			float32x4_t nz = vdupq_n_f32(plane.normal.z);
+
+			float32x4_t dist = vaddq_f32(MulAddNeon(nz, cz, MulAddNeon(ny, cy, vmulq_f32(nx, cx))), vdupq_n_f32(plane.d));
+			float32x4_t maxAbsDist = vaddq_f32(vaddq_f32(vabsq_f32(vmulq_f32(nx, hx)), vabsq_f32(vmulq_f32(ny, hy))), vabsq_f32(vmulq_f32(nz, hz)));
+
+			uint32x4_t neg = vcltq_f32(dist, vnegq_f32(maxAbsDist));
+			uint32x4_t pos = vcgtq_f32(dist, maxAbsDist);
+
+			switch (outside)
+			{
+			case Plane::NEGATIVE_SIDE:	culled = vorrq_u32(culled, neg); break;
+			case Plane::POSITIVE_SIDE:	culled = vorrq_u32(culled, pos); break;
+			case Plane::BOTH_SIDE:		culled = vorrq_u32(culled, vmvnq_u32(vorrq_u32(neg, pos))); break;
+			default:					break;
+			}
+
+			vst1q_u32(lanes, culled);
+			if (lanes[0] & lanes[1] & lanes[2] & lanes[3]) break;
+		}
+
+		vst1q_u32(lanes, culled);
+
+		for (int k = 0; k < 4; ++k)
+		{
+			const AxisAlignedBox& box = boxes[i + k];
+			bool visible = box.isFinite() ? lanes[k] == 0 : box.isInfinite();
+			outVisible[i + k] = visible ? 1 : 0;
+			numVisible += outVisible[i + k];
+		}
+	}
+
+	return numVisible + CullBoxesScalar(planes, numPlanes, boxes + i, count - i, outVisible + i, outside);
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct MathKernels
+{
+	const char*							name;
+	TransformPointsFn					transformPoints;
+	TransformNormalsFn					transformNormals;
+	MultiplyFn							multiply;
+	NormaliseFn							normalise;
+	SlerpFn								slerp;
+	TransformBoxesFn					transformBoxes;
+	MergeBoxesFn						mergeBoxes;
+	MergePointsFn						mergePoints;
+	CullBoxesFn							cullBoxes;
+};
+
+static const MathKernels s_ScalarKernels =
+{
+	"scalar",
+	TransformPointsScalar,
+	TransformNormalsScalar,
+	MultiplyScalar,
+	NormaliseScalar,
+	SlerpScalar,
+	TransformBoxesScalar,
+	MergeBoxesScalar,
+	MergePointsScalar,
+	CullBoxesScalar,
+};
+
+#if defined(NIT_SIMD_SSE2)
+
+static const MathKernels s_SimdKernels =
+{
+	"sse2",
+	TransformPointsSse2,
+	TransformNormalsSse2,
+	MultiplySse2,
+	NormaliseSse2,
+	SlerpSse2,
+	TransformBoxesSse2,
+	MergeBoxesSse2,
+	MergePointsSse2,
+	CullBoxesSse2,
+};
+
+static bool HasSimd()
+{
+	return CpuFeatures::hasSse2();
+}
+
+#elif defined(NIT_SIMD_NEON)
+
+static const MathKernels s_SimdKernels =
+{
+	"neon",
+	TransformPointsNeon,
+	TransformNormalsNeon,
+	MultiplyNeon,
+	NormaliseNeon,
+	SlerpNeon,
+	TransformBoxesNeon,
+	MergeBoxesNeon,
+	MergePointsNeon,
+	CullBoxesNeon,
+};
+
+static bool HasSimd()
+{
+	return CpuFeatures::hasNeon();
+}
+
+#else
+
+static const MathKernels& s_SimdKernels = s_ScalarKernels;
+
+static bool HasSimd()
+{
+	return false;
+}
+
+#endif
+
+static bool s_SimdEnabled = true;
+
+static inline const MathKernels& GetKernels()
+{
+	return s_SimdEnabled && HasSimd() ? s_SimdKernels : s_ScalarKernels;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void MathBatch::transformPoints(const Matrix4& m, const Vector3* in, Vector3* out, size_t count)
+{
+	GetKernels().transformPoints(m, in, out, count);
+}
+
+void MathBatch::transformNormals(const Matrix4& m, const Vector3* in, Vector3* out, size_t count, bool normalise)
+{
+	GetKernels().transformNormals(m, in, out, count, normalise);
+}
+
+void MathBatch::multiply(const Matrix4* a, const Matrix4* b, Matrix4* out, size_t count)
+{
+	GetKernels().multiply(a, 1, b, out, count);
+}
+
+void MathBatch::multiply(const Matrix4& a, const Matrix4* b, Matrix4* out, size_t count)
+{
+	// Copy in case a is one of out
+	Matrix4 ma = a;
+	GetKernels().multiply(&ma, 0, b, out, count);
+}
+
+void MathBatch::normalise(Quaternion* q, size_t count)
+{
+	GetKernels().normalise(q, count);
+}
+
+void MathBatch::slerp(const Quaternion* p, const Quaternion* q, const float* t, Quaternion* out, size_t count, bool shortestPath)
+{
+	GetKernels().slerp(p, q, t, out, count, shortestPath);
+}
+
+void MathBatch::transformBoxes(const Matrix4& m, const AxisAlignedBox* in, AxisAlignedBox* out, size_t count)
+{
+	GetKernels().transformBoxes(m, in, out, count);
+}
+
+void MathBatch::mergeBoxes(AxisAlignedBox& box, const AxisAlignedBox* boxes, size_t count)
+{
+	GetKernels().mergeBoxes(box, boxes, count);
+}
+
+void MathBatch::mergePoints(AxisAlignedBox& box, const Vector3* points, size_t count)
+{
+	GetKernels().mergePoints(box, points, count);
+}
+
+size_t MathBatch::cullBoxes(const Plane* planes, uint numPlanes, const AxisAlignedBox* boxes, size_t count, uint8* outVisible, Plane::Side outside)
+{
+	return GetKernels().cullBoxes(planes, numPlanes, boxes, count, outVisible, outside);
+}
+
+const char* MathBatch::getSimdName()
+{
+	return isSimdEnabled() ? s_SimdKernels.name : "none";
+}
+
+bool MathBatch::isSimdEnabled()
+{
+	return s_SimdEnabled && HasSimd();
+}
+
+void MathBatch::setSimdEnabled(bool flag)
+{
+	s_SimdEnabled = flag;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+#if defined(NIT_TESTS)
+
+// SSE2 follows IEEE single precision step by step, so vector kernels match the scalar ones bit-exact
+// as long as the scalar ones are compiled to SSE2 as well. x87 keeps intermediates in extended precision,
+// and compilers are free to fuse scalar multiply-adds on ARM, which allows a few ulps there.
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2_MATH__)
+static const float SIMD_TOLERANCE		= 0.0f;
+#else
+static const float SIMD_TOLERANCE		= 1e-5f;
+#endif
+
+// Against the member functions compiled elsewhere (x87 or fused arithmetic may differ in last bits)
+static const float MEMBER_TOLERANCE		= 1e-5f;
+
+// Against Quaternion::Slerp() which uses sin() and atan2().
+// Near the lerp threshold both lose about 4e-5 to float cancellation, each in its own way.
+static const float SLERP_TOLERANCE		= 2e-5f;
+
+static float RandomFloat(uint& seed, float lo, float hi)
+{
+	seed = seed * 1103515245 + 12345;
+	return lo + (hi - lo) * float((seed >> 8) & 0xFFFF) / 65535.0f;
+}
+
+static Matrix4 RandomAffine(uint& seed)
+{
+	Matrix4 m;
+	for (int r = 0; r < 3; ++r)
+		for (int c = 0; c < 4; ++c)
+			m[r][c] = c < 3 ? RandomFloat(seed, -2.0f, 2.0f) : RandomFloat(seed, -100.0f, 100.0f);
+
+	m[3][0] = m[3][1] = m[3][2] = 0.0f;
+	m[3][3] = 1.0f;
+	return m;
+}
+
+static Quaternion RandomQuaternion(uint& seed)
+{
+	Quaternion q(RandomFloat(seed, -1, 1), RandomFloat(seed, -1, 1), RandomFloat(seed, -1, 1), RandomFloat(seed, -1, 1));
+	q.normalise();
+	return q;
+}
+
+static AxisAlignedBox RandomBox(uint& seed, size_t index)
+{
+	// Mix in some null and infinite boxes
+	if (index % 13 == 5) return AxisAlignedBox(AxisAlignedBox::EXTENT_NULL);
+	if (index % 17 == 9) return AxisAlignedBox(AxisAlignedBox::EXTENT_INFINITE);
+
+	Vector3 min(RandomFloat(seed, -100, 100), RandomFloat(seed, -100, 100), RandomFloat(seed, -100, 100));
+	Vector3 size(RandomFloat(seed, 0, 20), RandomFloat(seed, 0, 20), RandomFloat(seed, 0, 20));
+	return AxisAlignedBox(min, min + size);
+}
+
+static bool CheckClose(const char* kernel, const char* against, const float* expected, const float* actual, size_t count, float tolerance)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		float e = expected[i], a = actual[i];
+		if (e == a) continue;
+
+		float error = Math::abs(e - a) / std::max(1.0f, Math::abs(e));
+		if (error <= tolerance) continue;
+
+		LOG(0, "*** MathBatch: '%s' mismatch at float %d: %s %.9g, actual %.9g\n",
+			kernel, (int)i, against, e, a);
+		return false;
+	}
+
+	return true;
+}
+
+static bool CheckBoxes(const char* kernel, const char* against, const AxisAlignedBox* expected, const AxisAlignedBox* actual, size_t count, float tolerance)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		const AxisAlignedBox& e = expected[i];
+		const AxisAlignedBox& a = actual[i];
+
+		if (e.isFinite() && a.isFinite())
+		{
+			if (!CheckClose(kernel, against, &e.getMinimum().x, &a.getMinimum().x, 3, tolerance)) return false;
+			if (!CheckClose(kernel, against, &e.getMaximum().x, &a.getMaximum().x, 3, tolerance)) return false;
+		}
+		else if (e.isNull() != a.isNull() || e.isInfinite() != a.isInfinite())
+		{
+			LOG(0, "*** MathBatch: '%s' box %d extent mismatch against %s\n", kernel, (int)i, against);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool MathBatch::selfTest(uint seed)
+{
+	// Odd size to exercise scalar tails after vector loops
+	const size_t count = 1027;
+
+	const MathKernels& ref = s_ScalarKernels;
+	const MathKernels& simd = HasSimd() ? s_SimdKernels : s_ScalarKernels;
+
+	bool ok = true;
+
+	Matrix4 m = RandomAffine(seed);
+
+	vector<Vector3>::type points(count), expected(count), actual(count);
+	for (size_t i = 0; i < count; ++i)
+		points[i] = Vector3(RandomFloat(seed, -100, 100), RandomFloat(seed, -100, 100), RandomFloat(seed, -100, 100));
+
+	// Make sure that zero-length normals are covered
+	points[1] = points[6] = Vector3::ZERO;
+
+	// Points
+	for (size_t i = 0; i < count; ++i)
+		actual[i] = m.transformAffine(points[i]);
+	ref.transformPoints(m, &points[0], &expected[0], count);
+	ok = CheckClose("transformPoints", "Matrix4::transformAffine", &actual[0].x, &expected[0].x, count * 3, MEMBER_TOLERANCE) && ok;
+
+	actual = points;
+	simd.transformPoints(m, &actual[0], &actual[0], count);
+	ok = CheckClose("transformPoints", "scalar", &expected[0].x, &actual[0].x, count * 3, SIMD_TOLERANCE) && ok;
+
+	// Normals
+	for (int normalise = 0; normalise < 2; ++normalise)
+	{
+		ref.transformNormals(m, &points[0], &expected[0], count, normalise != 0);
+		simd.transformNormals(m, &points[0], &actual[0], count, normalise != 0);
+		ok = CheckClose(normalise ? "transformNormals(normalise)" : "transformNormals", "scalar", &expected[0].x, &actual[0].x, count * 3, SIMD_TOLERANCE) && ok;
+	}
+
+	// Matrices
+	const size_t numMatrices = 67;
+	vector<Matrix4>::type ma(numMatrices), mb(numMatrices), mExpected(numMatrices), mActual(numMatrices);
+	for (size_t i = 0; i < numMatrices; ++i)
+	{
+		ma[i] = RandomAffine(seed);
+		mb[i] = RandomAffine(seed);
+		for (int c = 0; c < 4; ++c)
+			mb[i][3][c] = RandomFloat(seed, -1, 1);
+	}
+
+	ref.multiply(&ma[0], 1, &mb[0], &mExpected[0], numMatrices);
+	mActual = mb;
+	simd.multiply(&ma[0], 1, &mActual[0], &mActual[0], numMatrices);
+	ok = CheckClose("multiply", "scalar", mExpected[0][0], mActual[0][0], numMatrices * 16, SIMD_TOLERANCE) && ok;
+
+	ref.multiply(&m, 0, &mb[0], &mExpected[0], numMatrices);
+	simd.multiply(&m, 0, &mb[0], &mActual[0], numMatrices);
+	ok = CheckClose("multiply(broadcast)", "scalar", mExpected[0][0], mActual[0][0], numMatrices * 16, SIMD_TOLERANCE) && ok;
+
+	// Quaternions
+	vector<Quaternion>::type qp(count), qq(count), qExpected(count), qActual(count);
+	vector<float>::type t(count);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		qp[i] = RandomQuaternion(seed);
+		t[i] = RandomFloat(seed, 0, 1);
+
+		switch (i % 4)
+		{
+		case 0: qq[i] = RandomQuaternion(seed); break;
+		case 1: qq[i] = qp[i] + Quaternion(RandomFloat(seed, -1, 1), RandomFloat(seed, -1, 1), RandomFloat(seed, -1, 1), RandomFloat(seed, -1, 1)) * 0.01f; qq[i].normalise(); break; // nearly parallel, lerp
+		case 2: qq[i] = -qp[i] + Quaternion(RandomFloat(seed, -1, 1), RandomFloat(seed, -1, 1), RandomFloat(seed, -1, 1), RandomFloat(seed, -1, 1)) * 0.1f; qq[i].normalise(); break; // nearly opposite
+		case 3: qq[i] = -RandomQuaternion(seed); break;
+		}
+	}
+
+	qExpected = qActual = qp;
+	for (size_t i = 0; i < count; ++i)
+		qExpected[i] = qExpected[i] * 3.0f;
+	qActual = qExpected;
+	ref.normalise(&qExpected[0], count);
+	simd.normalise(&qActual[0], count);
+	ok = CheckClose("normalise", "scalar", &qExpected[0].w, &qActual[0].w, count * 4, SIMD_TOLERANCE) && ok;
+
+	for (int shortestPath = 0; shortestPath < 2; ++shortestPath)
+	{
+		const char* name = shortestPath ? "slerp(shortestPath)" : "slerp";
+
+		for (size_t i = 0; i < count; ++i)
+			qActual[i] = Quaternion::Slerp(t[i], qp[i], qq[i], shortestPath != 0);
+		ref.slerp(&qp[0], &qq[0], &t[0], &qExpected[0], count, shortestPath != 0);
+		ok = CheckClose(name, "Quaternion::Slerp", &qActual[0].w, &qExpected[0].w, count * 4, SLERP_TOLERANCE) && ok;
+
+		qActual = qp;
+		simd.slerp(&qActual[0], &qq[0], &t[0], &qActual[0], count, shortestPath != 0);
+		ok = CheckClose(name, "scalar", &qExpected[0].w, &qActual[0].w, count * 4, SIMD_TOLERANCE) && ok;
+	}
+
+	// Boxes
+	vector<AxisAlignedBox>::type boxes(count), bExpected(count), bActual(count);
+	for (size_t i = 0; i < count; ++i)
+		boxes[i] = RandomBox(seed, i);
+
+	ref.transformBoxes(m, &boxes[0], &bExpected[0], count);
+	bActual = boxes;
+	simd.transformBoxes(m, &bActual[0], &bActual[0], count);
+	ok = CheckBoxes("transformBoxes", "scalar", &bExpected[0], &bActual[0], count, SIMD_TOLERANCE) && ok;
+
+	AxisAlignedBox merged[4], mergedRef[4];
+	mergedRef[1] = merged[1] = AxisAlignedBox(-1, -1, -1, 1, 1, 1);
+
+	ref.mergeBoxes(mergedRef[0], &boxes[0], 16);				// includes an infinite box
+	simd.mergeBoxes(merged[0], &boxes[0], 16);
+	ref.mergeBoxes(mergedRef[1], &boxes[27], 16);				// includes a null box
+	simd.mergeBoxes(merged[1], &boxes[27], 16);
+	ref.mergePoints(mergedRef[2], &points[0], count);
+	simd.mergePoints(merged[2], &points[0], count);
+	ref.mergePoints(mergedRef[3], &points[0], 3);
+	simd.mergePoints(merged[3], &points[0], 3);
+	ok = CheckBoxes("mergeBoxes", "scalar", mergedRef, merged, 2, SIMD_TOLERANCE) && ok;
+	ok = CheckBoxes("mergePoints", "scalar", mergedRef + 2, merged + 2, 2, SIMD_TOLERANCE) && ok;
+
+	// Frustum-like volume which culls about half of the boxes
+	PlaneBoundedVolume volume;
+	volume.planes.push_back(Plane(Vector3::UNIT_X, Vector3(-50, 0, 0)));
+	volume.planes.push_back(Plane(Vector3::NEGATIVE_UNIT_X, Vector3(50, 0, 0)));
+	volume.planes.push_back(Plane(Vector3::UNIT_Y, Vector3(0, -50, 0)));
+	volume.planes.push_back(Plane(Vector3::NEGATIVE_UNIT_Y, Vector3(0, 50, 0)));
+	volume.planes.push_back(Plane(Vector3(1, 1, 1).normalisedCopy(), Vector3(0, 0, -60)));
+	volume.planes.push_back(Plane(Vector3(-1, 0, -1).normalisedCopy(), Vector3(0, 0, 60)));
+
+	const Plane::Side sides[] = { Plane::NEGATIVE_SIDE, Plane::POSITIVE_SIDE, Plane::BOTH_SIDE };
+
+	vector<uint8>::type visibleRef(count), visible(count), visibleVolume(count);
+
+	for (uint s = 0; s < COUNT_OF(sides); ++s)
+	{
+		volume.outside = sides[s];
+		for (size_t i = 0; i < count; ++i)
+			visibleVolume[i] = volume.intersects(boxes[i]) ? 1 : 0;
+
+		size_t numRef = ref.cullBoxes(&volume.planes[0], (uint)volume.planes.size(), &boxes[0], count, &visibleRef[0], sides[s]);
+		size_t num = simd.cullBoxes(&volume.planes[0], (uint)volume.planes.size(), &boxes[0], count, &visible[0], sides[s]);
+
+		if (visibleRef != visibleVolume)
+		{
+			LOG(0, "*** MathBatch: 'cullBoxes' mismatch against PlaneBoundedVolume::intersects (side %d)\n", (int)sides[s]);
+			ok = false;
+		}
+
+		if (visibleRef != visible || numRef != num)
+		{
+			LOG(0, "*** MathBatch: 'cullBoxes' mismatch against scalar (side %d)\n", (int)sides[s]);
+			ok = false;
+		}
+	}
+
+	if (ok)
+		LOG(0, ".. MathBatch: %s kernels ok\n", simd.name);
+
+	return ok;
+}
+
+void MathBatch::benchmark(BenchResults& outResults, size_t count, int iterations)
+{
+	if (count == 0 || iterations <= 0) return;
+
+	uint seed = 0;
+
+	Matrix4 m = RandomAffine(seed);
+
+	vector<Vector3>::type points(count), outPoints(count);
+	vector<Matrix4>::type ma(count), mb(count), outMatrices(count);
+	vector<Quaternion>::type qp(count), qq(count), outQuats(count);
+	vector<float>::type t(count);
+	vector<AxisAlignedBox>::type boxes(count), outBoxes(count), finiteBoxes(count);
+	vector<uint8>::type visible(count);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		points[i] = Vector3(RandomFloat(seed, -100, 100), RandomFloat(seed, -100, 100), RandomFloat(seed, -100, 100));
+		ma[i] = RandomAffine(seed);
+		mb[i] = RandomAffine(seed);
+		qp[i] = RandomQuaternion(seed);
+		qq[i] = RandomQuaternion(seed);
+		t[i] = RandomFloat(seed, 0, 1);
+		boxes[i] = RandomBox(seed, i);
+		finiteBoxes[i] = boxes[i].isInfinite() ? AxisAlignedBox() : boxes[i];
+	}
+
+	Plane planes[6] =
+	{
+		Plane(Vector3::UNIT_X, Vector3(-50, 0, 0)),
+		Plane(Vector3::NEGATIVE_UNIT_X, Vector3(50, 0, 0)),
+		Plane(Vector3::UNIT_Y, Vector3(0, -50, 0)),
+		Plane(Vector3::NEGATIVE_UNIT_Y, Vector3(0, 50, 0)),
+		Plane(Vector3::UNIT_Z, Vector3(0, 0, -50)),
+		Plane(Vector3::NEGATIVE_UNIT_Z, Vector3(0, 0, 50)),
+	};
+
+	const MathKernels* impls[] = { &s_ScalarKernels, HasSimd() ? &s_SimdKernels : NULL };
+
+	for (uint k = 0; k < COUNT_OF(impls); ++k)
+	{
+		const MathKernels* kernels = impls[k];
+		if (kernels == NULL) continue;
+
+		for (int test = 0; test < 11; ++test)
+		{
+			const char* name = NULL;
+			double start = SystemTimer::now();
+
+			for (int i = 0; i < iterations; ++i)
+			{
+				switch (test)
+				{
+				case 0: name = "transformPoints";	kernels->transformPoints(m, &points[0], &outPoints[0], count); break;
+				case 1: name = "transformNormals";	kernels->transformNormals(m, &points[0], &outPoints[0], count, false); break;
+				case 2: name = "transformNormals_n";kernels->transformNormals(m, &points[0], &outPoints[0], count, true); break;
+				case 3: name = "multiply";			kernels->multiply(&ma[0], 1, &mb[0], &outMatrices[0], count); break;
+				case 4: name = "multiply_1xN";		kernels->multiply(&m, 0, &mb[0], &outMatrices[0], count); break;
+				case 5: name = "normalise";			kernels->normalise(&qp[0], count); break;
+				case 6: name = "slerp";				kernels->slerp(&qp[0], &qq[0], &t[0], &outQuats[0], count, true); break;
+				case 7: name = "transformBoxes";	kernels->transformBoxes(m, &boxes[0], &outBoxes[0], count); break;
+				case 8: name = "mergeBoxes";		{ AxisAlignedBox box; kernels->mergeBoxes(box, &finiteBoxes[0], count); } break;
+				case 9: name = "mergePoints";		{ AxisAlignedBox box; kernels->mergePoints(box, &points[0], count); } break;
+				case 10: name = "cullBoxes";		kernels->cullBoxes(planes, COUNT_OF(planes), &boxes[0], count, &visible[0], Plane::NEGATIVE_SIDE); break;
+				}
+			}
+
+			double elapsed = SystemTimer::now() - start;
+			float meps = elapsed > 0.0 ? float(count * iterations / elapsed / 1000000.0) : 0.0f;
+
+			String key = String(name) + "." + kernels->name;
+			LOG(0, ".. MathBatch: %-24s %8.1f M/s\n", key.c_str(), meps);
+			outResults.push_back(std::make_pair(key, meps));
+		}
+	}
+}
+
+#endif // #if defined(NIT_TESTS)
+
+////////////////////////////////////////////////////////////////////////////////
+
+NS_NIT_END;
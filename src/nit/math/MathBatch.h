@@ -0,0 +1,100 @@
+﻿/// nit - Noriter Framework
+/// A Cross-platform Open Source Integration for Game-oriented Apps
+///
+/// http://www.github.com/ellongrey/nit
+///
+/// Copyright (c) 2013 by Jun-hyeok Jang
+/// 
+/// (see each file to see the different copyright owners)
+/// 
+/// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// Author: ellongrey
+
+#pragma once
+
+#include "nit/nit.h"
+
+#include "nit/math/NitMath.h"
+#include "nit/math/AxisAlignedBox.h"
+#include "nit/math/Plane.h"
+
+NS_NIT_BEGIN;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Bulk operations over arrays of math types.
+// Each kernel has a scalar reference implementation and a 4-wide SSE2 or NEON one
+// which is chosen at runtime. Both evaluate the same expressions in the same order as
+// the member functions noted below, so SSE2 results are bit-exact with them.
+// (NEON results may differ in last bits where scalar code is compiled to fused multiply-adds,
+// other targets use the scalar kernels only)
+//
+// Input and output arrays may be the same array (in-place), but should not partially overlap.
+
+class NIT_API MathBatch
+{
+public:									// Matrix4
+	// out[i] = m.transformAffine(in[i])
+	static void							transformPoints(const Matrix4& m, const Vector3* in, Vector3* out, size_t count);
+
+	// out[i] = upper 3x3 of m * in[i], normalised if requested (Vector3::normalise())
+	// Pass the inverse transpose of m when it has non-uniform scale.
+	static void							transformNormals(const Matrix4& m, const Vector3* in, Vector3* out, size_t count, bool normalise = false);
+
+	// out[i] = a[i] * b[i] (Matrix4::concatenate())
+	static void							multiply(const Matrix4* a, const Matrix4* b, Matrix4* out, size_t count);
+
+	// out[i] = a * b[i], e.g. a parent transform applied to children
+	static void							multiply(const Matrix4& a, const Matrix4* b, Matrix4* out, size_t count);
+
+public:									// Quaternion
+	// q[i].normalise()
+	static void							normalise(Quaternion* q, size_t count);
+
+	// out[i] = Quaternion::Slerp(t[i], p[i], q[i], shortestPath)
+	// sin and acos are evaluated by polynomials, results stay within 2e-5 of Slerp().
+	static void							slerp(const Quaternion* p, const Quaternion* q, const float* t, Quaternion* out, size_t count, bool shortestPath = false);
+
+public:									// AxisAlignedBox
+	// out[i] = in[i].transformAffine(m), null or infinite boxes are copied as is
+	static void							transformBoxes(const Matrix4& m, const AxisAlignedBox* in, AxisAlignedBox* out, size_t count);
+
+	// box.merge(boxes[i]) for each box
+	static void							mergeBoxes(AxisAlignedBox& box, const AxisAlignedBox* boxes, size_t count);
+
+	// box.merge(points[i]) for each point
+	static void							mergePoints(AxisAlignedBox& box, const Vector3* points, size_t count);
+
+	// outVisible[i] = PlaneBoundedVolume::intersects(boxes[i]) with given planes: 1 if visible, 0 if culled.
+	// Returns number of visible boxes.
+	static size_t						cullBoxes(const Plane* planes, uint numPlanes, const AxisAlignedBox* boxes, size_t count, uint8* outVisible, Plane::Side outside = Plane::NEGATIVE_SIDE);
+
+public:
+	// Name of the vectorized implementation in use ("sse2", "neon" or "none")
+	static const char*					getSimdName();
+	static bool							isSimdEnabled();
+	static void							setSimdEnabled(bool flag);
+
+#if defined(NIT_TESTS)
+	// Compares vectorized kernels against scalar ones and member functions with random input, returns false on any mismatch
+	static bool							selfTest(uint seed = 0);
+
+	// Runs each kernel over count elements and reports throughput in mega-elements / sec.
+	typedef vector<std::pair<String, float> >::type BenchResults;
+	static void							benchmark(BenchResults& outResults, size_t count = 10000, int iterations = 100);
+#endif
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+NS_NIT_END;
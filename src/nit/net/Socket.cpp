@@ -171,23 +171,38 @@ int TcpSocket::RecvBuffer::receive(Handle handle)
 {
 	while (true)
 	{
-		size_t blockIdx = _end / _blockSize;
-		size_t blockPos = _end % _blockSize;
+		// receive into the room left in the last block, or into a new one when it's full or shared
+		uint8* buf = NULL;
+		size_t bufSize = 0;
+
+		if (!_pieces.empty() && !_pieces.back().block->isShared())
+		{
+			Piece& last = _pieces.back();
+			buf = last.data + last.size;
+			bufSize = (last.block->getMemory() + last.block->getCapacity()) - buf;
+		}
 
-		if (blockIdx == _blocks.size())
-			_blocks.push_back(allocateBlock());
+		if (bufSize == 0)
+		{
+			Piece piece = newPiece(_blockSize);
+			piece.pos = _size;
+			_pieces.push_back(piece);
 
-		uint8* buf = _blocks[blockIdx] + blockPos;
-		size_t bufSize = _blockSize - blockPos;
+			buf = piece.data;
+			bufSize = _blockSize;
+		}
 
 		int read = ::recv(handle, (char*)buf, bufSize, NIT_SOCKET_SENDRECV_FLAGS);
 
 		if (read == SOCKET_ERROR || read == 0)
+		{
+			if (_pieces.back().size == 0)
+				_pieces.pop_back();
 			return read;
+		}
 
-		_end += read;
-
-		assert(blockPos <= _blockSize);
+		_pieces.back().size += read;
+		_size += read;
 	}
 }
 
@@ -239,10 +254,13 @@ TcpSocket::TcpSocket(IListener* listener, int socketHandle, const String& addr,
 
 	_handle = socketHandle;
 	_addr = addr;
-	_port = 0;
+	_port = port;
 	_connecting = true;
 	_connected = false;
 
+	// accepted sockets inherit non-blocking from the listening one on win32 only
+	setNonBlocking(true);
+
 	_recvBuf = new RecvBuffer(s_DefaultTcpRecvBlockSize);
 	_sendBuf = new MemoryBuffer(s_DefaultTcpSendBlockSize);
 }
@@ -286,7 +304,8 @@ bool TcpSocket::update()
 	FD_ZERO(&write_flags);	FD_SET(_handle, &write_flags);
 	FD_ZERO(&err_flags);	FD_SET(_handle, &err_flags);
 
-	int r = ::select(NULL, &read_flags, &write_flags, &err_flags, &timeout);
+	// nfds is ignored on win32 but must cover the handle elsewhere
+	int r = ::select(int(_handle) + 1, &read_flags, &write_flags, &err_flags, &timeout);
 
 	if (r == SOCKET_ERROR)
 	{
@@ -565,8 +584,15 @@ bool TcpSocketServer::listen(uint16 port)
 		return error("Listen", getLastError());
 	}
 
+	// port 0 lets the system pick one
+	socklen_t addrLen = sizeof(bindAddr);
+	if (port == 0 && ::getsockname(_handle, (sockaddr*)&bindAddr, &addrLen) == SOCKET_ERROR)
+	{
+		return error("GetSockName", getLastError());
+	}
+
 	_bindAddr = inet_ntoa(bindAddr.sin_addr);
-	_bindPort = port;
+	_bindPort = ntohs(bindAddr.sin_port);
 
 	LOG(0, "++ ServerSocket: Listen to %s:%d\n", _bindAddr.c_str(), (int)_bindPort);
 	_listening = true;
@@ -596,7 +622,7 @@ bool TcpSocketServer::update()
 	if (accepted != INVALID_SOCKET)
 	{
 		String peerAddr = inet_ntoa(clientAddr.sin_addr);
-		uint16 peerPort = clientAddr.sin_port;
+		uint16 peerPort = ntohs(clientAddr.sin_port);
 
 		TcpSocket* client = _listener ? _listener->onAccept(this, accepted, peerAddr, peerPort) : NULL;
 
@@ -815,7 +841,7 @@ bool UdpSocket::update()
 	fd_set read_flags;
 	FD_ZERO(&read_flags); FD_SET(_handle, &read_flags);
 
-	int r = ::select(NULL, &read_flags, NULL, NULL, &timeout);
+	int r = ::select(int(_handle) + 1, &read_flags, NULL, NULL, &timeout);
 
 	if (r == SOCKET_ERROR)
 		return error("Select", getLastError());
@@ -0,0 +1,90 @@
+﻿/// nit - Noriter Framework
+/// A Cross-platform Open Source Integration for Game-oriented Apps
+///
+/// http://www.github.com/ellongrey/nit
+///
+/// Copyright (c) 2013 by Jun-hyeok Jang
+///
+/// (see each file to see the different copyright owners)
+///
+/// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+///
+/// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+///
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// Author: ellongrey
+
+#include "nit_pch.h"
+
+#include "nit/platform/CpuFeatures.h"
+
+#if defined(NIT_SIMD_SSE2)
+#	if defined(_MSC_VER)
+#		include <intrin.h>
+#	else
+#		include <cpuid.h>
+#	endif
+#endif
+
+#if defined(NIT_ANDROID) && defined(__arm__)
+#	include <stdint.h>
+// $(NDK)/sources/cpufeatures/cpu-features.h
+extern "C" uint64_t android_getCpuFeatures(void);
+#	define ANDROID_CPU_ARM_FEATURE_NEON		(1 << 2)
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+NS_NIT_BEGIN;
+
+bool CpuFeatures::hasSse2()
+{
+#if defined(NIT_SIMD_SSE2)
+	static int hasSse2 = -1;
+
+	if (hasSse2 < 0)
+	{
+#	if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 1);
+		hasSse2 = (info[3] & (1 << 26)) ? 1 : 0;
+#	else
+		uint eax, ebx, ecx, edx;
+		hasSse2 = __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (edx & bit_SSE2) ? 1 : 0;
+#	endif
+	}
+
+	return hasSse2 != 0;
+#else
+	return false;
+#endif
+}
+
+bool CpuFeatures::hasNeon()
+{
+#if defined(__aarch64__)
+	return true;
+#elif defined(NIT_ANDROID) && defined(__arm__)
+	// armeabi-v7a doesn't imply NEON (Tegra 2 lacks it)
+	static int hasNeon = -1;
+
+	if (hasNeon < 0)
+		hasNeon = (android_getCpuFeatures() & ANDROID_CPU_ARM_FEATURE_NEON) ? 1 : 0;
+
+	return hasNeon != 0;
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+	return true;
+#else
+	return false;
+#endif
+}
+
+NS_NIT_END;
+
+////////////////////////////////////////////////////////////////////////////////
@@ -664,6 +664,7 @@ public:
 			PROP_ENTRY_R(processing),
 			PROP_ENTRY_R(bundle),
 			PROP_ENTRY_R(asyncLoading),
+			PROP_ENTRY_R(asyncLoaderCount),
 			PROP_ENTRY_R(lookupDB),
 			NULL
 		};
@@ -671,29 +672,55 @@ public:
 		FuncEntry funcs[] = 
 		{
 			FUNC_ENTRY_H(link,			"(name): Package"),
-			FUNC_ENTRY_H(linkCustom,	"(name: string, archive: Archive, settings: Settings): Package"),
+			FUNC_ENTRY_H(linkCustom,	"(name: string, archive: Archive, settings: Settings=null): Package // link(name) again to complete"),
 			FUNC_ENTRY_H(load,			"(name): Package"),
-			FUNC_ENTRY_H(loadAsync,		"(name, hurry=true): Package"), // TODO: The convention is not consistent yet!
+			FUNC_ENTRY_H(loadAsync,		"(name, hurry=true, priority=PRIORITY.NORMAL): Package"), // TODO: The convention is not consistent yet!
 			FUNC_ENTRY_H(allLinked,		"() : { <name> = <Package>, ... }"),
 			FUNC_ENTRY_H(all,			"(): Package[]"),
 			FUNC_ENTRY_H(compact,		"()"),
 			FUNC_ENTRY_H(channel,		"(): EventChannel"),
 			FUNC_ENTRY_H(lookup,		"(type, key: string) : { subtype, pack, entry: string } // null when not found"),
+			FUNC_ENTRY_H(getAsyncStats,	"(): table // { queued, completed, cancelled, promoted, waitTime, prepareTime, readyTime, maxReadyTime }"),
+			FUNC_ENTRY_H(resetAsyncStats, "()"),
 			NULL
 		};
 
 		bind(v, props, funcs);
+
+		addStaticTable(v, "PRIORITY");
+		newSlot(v, -1, "LOW",						(int)PackageService::PRIORITY_LOW);
+		newSlot(v, -1, "NORMAL",					(int)PackageService::PRIORITY_NORMAL);
+		newSlot(v, -1, "URGENT",					(int)PackageService::PRIORITY_URGENT);
+		sq_poptop(v);
 	}
 
 	NB_PROP_GET(processing)				{ return push(v, self(v)->getProcessing()); }
 	NB_PROP_GET(bundle)					{ return push(v, self(v)->getBundle()); }
 	NB_PROP_GET(asyncLoading)			{ return push(v, self(v)->isAsyncLoading()); }
+	NB_PROP_GET(asyncLoaderCount)		{ return push(v, self(v)->getAsyncLoaderCount()); }
 	NB_PROP_GET(lookupDB)				{ return push(v, self(v)->getLookupDB()); }
 
 	NB_FUNC(link)						{ return push(v, self(v)->link(getString(v, 2))); }
-	NB_FUNC(linkCustom)					{ return push(v, self(v)->linkCustom(getString(v, 2), get<Archive>(v, 3), get<Settings>(v, 4))); }
+	NB_FUNC(linkCustom)					{ return push(v, self(v)->linkCustom(getString(v, 2), get<Archive>(v, 3), opt<Settings>(v, 4, NULL))); }
 	NB_FUNC(load)						{ return push(v, self(v)->load(getString(v, 2))); }
-	NB_FUNC(loadAsync)					{ return push(v, self(v)->loadAsync(getString(v, 2), optBool(v, 3, false))); }
+	NB_FUNC(loadAsync)					{ return push(v, self(v)->loadAsync(getString(v, 2), optBool(v, 3, false), optInt(v, 4, PackageService::PRIORITY_NORMAL))); }
+	NB_FUNC(resetAsyncStats)			{ self(v)->resetAsyncStats(); return 0; }
+
+	NB_FUNC(getAsyncStats)
+	{
+		PackageService::AsyncStats stats = self(v)->getAsyncStats();
+
+		sq_newtable(v);
+		newSlot(v, -1, "queued",		stats.queued);
+		newSlot(v, -1, "completed",		stats.completed);
+		newSlot(v, -1, "cancelled",		stats.cancelled);
+		newSlot(v, -1, "promoted",		stats.promoted);
+		newSlot(v, -1, "waitTime",		(float)stats.waitTime);
+		newSlot(v, -1, "prepareTime",	(float)stats.prepareTime);
+		newSlot(v, -1, "readyTime",		(float)stats.readyTime);
+		newSlot(v, -1, "maxReadyTime",	(float)stats.maxReadyTime);
+		return 1;
+	}
 
 	NB_FUNC(lookup)
 	{
@@ -1794,17 +1821,27 @@ public:
 		{
 			PROP_ENTRY	(name),
 			PROP_ENTRY_R(disposed),
+			PROP_ENTRY_R(transformCount),
+			PROP_ENTRY	(spatialCellSize),
 			NULL
 		};
 
 		FuncEntry funcs[] =
 		{
 			FUNC_ENTRY_H(dispose,		"()"),
+			FUNC_ENTRY_H(updateTransforms, "() // refresh cached world matrices of changed transforms"),
 
 			FUNC_ENTRY_H(attach,		"(GameObject): GameObject // returns param itself for simple coding"),
 			FUNC_ENTRY_H(all,			"(): GameObject[]"),
 			FUNC_ENTRY_H(find,			"(wildcard, activeOnly=false, ignoreCase=true): GameObject[]"),
 			FUNC_ENTRY_H(findComponents,"(wildcard, activeOnly=true, ignoreCase=true): GameObject[]"),
+
+			FUNC_ENTRY_H(queryBox,		"(box: AxisAlignedBox, activeOnly=true): GameObject[]"),
+			FUNC_ENTRY_H(querySphere,	"(center: Vector3, radius: float, activeOnly=true): GameObject[]"),
+			FUNC_ENTRY_H(queryRay,		"(origin, dir: Vector3, maxDistance: float, radius=0.0, activeOnly=true): GameObject[] // nearest first"),
+			FUNC_ENTRY_H(queryFrustum,	"(planes: Plane[], activeOnly=true): GameObject[] // objects on the positive side of every plane"),
+			FUNC_ENTRY_H(queryBoxes,	"(boxes: AxisAlignedBox[], activeOnly=true): GameObject[][]"),
+			FUNC_ENTRY_H(querySpheres,	"(centers: Vector3[], radius: float, activeOnly=true): GameObject[][]"),
 			NULL
 		};
 
@@ -1815,10 +1852,14 @@ public:
 
 	NB_PROP_GET(name)					{ return push(v, self(v)->getName()); }
 	NB_PROP_GET(disposed)				{ return push(v, self(v)->isDisposed()); }
+	NB_PROP_GET(transformCount)			{ return push(v, self(v)->getTransformCount()); }
+	NB_PROP_GET(spatialCellSize)		{ return push(v, self(v)->getSpatialCellSize()); }
 
 	NB_PROP_SET(name)					{ self(v)->setName(getString(v, 2)); return 0; }
+	NB_PROP_SET(spatialCellSize)		{ self(v)->setSpatialCellSize(getFloat(v, 2)); return 0; }
 
 	NB_FUNC(dispose)					{ return push(v, self(v)->dispose()); }
+	NB_FUNC(updateTransforms)			{ self(v)->updateTransforms(); return 0; }
 
 	NB_FUNC(attach)
 	{
@@ -1871,6 +1912,85 @@ public:
 
 		return 1;
 	}
+
+	static SQInteger pushResults(HSQUIRRELVM v, const World::ObjectResultSet& r)
+	{
+		sq_newarray(v, 0);
+		for (uint i = 0; i < r.size(); i++)
+		{
+			arrayAppend(v, -1, r[i]);
+		}
+
+		return 1;
+	}
+
+	static SQInteger pushResults(HSQUIRRELVM v, const vector<World::ObjectResultSet>::type& r)
+	{
+		sq_newarray(v, 0);
+		for (uint i = 0; i < r.size(); i++)
+		{
+			pushResults(v, r[i]);
+			sq_arrayappend(v, -2);
+		}
+
+		return 1;
+	}
+
+	NB_FUNC(queryBox)
+	{
+		World::ObjectResultSet r;
+		self(v)->query(*get<AxisAlignedBox>(v, 2), r, optBool(v, 3, true));
+		return pushResults(v, r);
+	}
+
+	NB_FUNC(querySphere)
+	{
+		World::ObjectResultSet r;
+		self(v)->query(Sphere(*get<Vector3>(v, 2), getFloat(v, 3)), r, optBool(v, 4, true));
+		return pushResults(v, r);
+	}
+
+	NB_FUNC(queryRay)
+	{
+		World::ObjectResultSet r;
+		self(v)->query(Ray(*get<Vector3>(v, 2), *get<Vector3>(v, 3)), getFloat(v, 4), optFloat(v, 5, 0.0f), r, optBool(v, 6, true));
+		return pushResults(v, r);
+	}
+
+	NB_FUNC(queryFrustum)
+	{
+		PlaneBoundedVolume volume(Plane::NEGATIVE_SIDE);
+		for (NitIterator itr(v, 2); itr.hasNext(); itr.next())
+			volume.planes.push_back(*get<Plane>(v, itr.valueIndex()));
+
+		World::ObjectResultSet r;
+		self(v)->query(volume, r, optBool(v, 3, true));
+		return pushResults(v, r);
+	}
+
+	NB_FUNC(queryBoxes)
+	{
+		vector<AxisAlignedBox>::type boxes;
+		for (NitIterator itr(v, 2); itr.hasNext(); itr.next())
+			boxes.push_back(*get<AxisAlignedBox>(v, itr.valueIndex()));
+
+		vector<World::ObjectResultSet>::type r;
+		self(v)->query(boxes, r, optBool(v, 3, true));
+		return pushResults(v, r);
+	}
+
+	NB_FUNC(querySpheres)
+	{
+		float radius = getFloat(v, 3);
+
+		vector<Sphere>::type spheres;
+		for (NitIterator itr(v, 2); itr.hasNext(); itr.next())
+			spheres.push_back(Sphere(*get<Vector3>(v, itr.valueIndex()), radius));
+
+		vector<World::ObjectResultSet>::type r;
+		self(v)->query(spheres, r, optBool(v, 4, true));
+		return pushResults(v, r);
+	}
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2122,6 +2242,7 @@ public:
 		FuncEntry funcs[] =
 		{
 			CONS_ENTRY_H(				"(name: string, packFile: StreamSource)"),
+			FUNC_ENTRY_H(decodeDelta,	"[class] (base, ops: MemoryBuffer): MemoryBuffer // ops uncompressed: see PAYLOAD_DELTA"),
 			NULL
 		};
 
@@ -2133,6 +2254,17 @@ public:
 	NB_PROP_GET(endianFlip)				{ return push(v, self(v)->isEndianFlip()); }
 
 	NB_CONS()							{ setSelf(v, new PackArchive(getString(v, 2), get<StreamSource>(v, 3))); return 0; }
+
+	NB_FUNC(decodeDelta)
+	{
+		MemoryBuffer* ops = get<MemoryBuffer>(v, 3);
+
+		vector<uint8>::type bytes(ops->getSize());
+		if (!bytes.empty())
+			ops->copyTo(&bytes[0], 0, bytes.size());
+
+		return push(v, PackArchive::decodeDelta(get<MemoryBuffer>(v, 2), bytes.empty() ? NULL : &bytes[0], bytes.size()).get());
+	}
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2199,7 +2331,8 @@ public:
 
 		FuncEntry funcs[] =
 		{
-			FUNC_ENTRY_H(loadAsync,		"(hurry=false)"),
+			FUNC_ENTRY_H(loadAsync,		"(hurry=false, priority=PackageService.PRIORITY.NORMAL) // again to promote"),
+			FUNC_ENTRY_H(cancelLoadAsync, "(): bool"),
 
 			FUNC_ENTRY_H(channel,		"(): EventChannel"),
 
@@ -2228,7 +2361,8 @@ public:
 	NB_PROP_SET(stayForCurrent)			{ self(v)->setStayForCurrent(getBool(v, 2)); return 0; }
 	NB_PROP_SET(stayForNext)			{ self(v)->setStayForNext(getBool(v, 2)); return 0; }
 
-	NB_FUNC(loadAsync)					{ self(v)->loadAsync(optBool(v, 2, false)); return 0; }
+	NB_FUNC(loadAsync)					{ self(v)->loadAsync(optBool(v, 2, false), optInt(v, 3, PackageService::PRIORITY_NORMAL)); return 0; }
+	NB_FUNC(cancelLoadAsync)			{ return push(v, self(v)->cancelLoadAsync()); }
 	NB_FUNC(channel)					{ return push(v, self(v)->channel()); }
 
 	NB_FUNC(link)						
@@ -2517,6 +2651,64 @@ public:
 
 ////////////////////////////////////////////////////////////////////////////////
 
+NB_TYPE_RAW_PTR(NIT_API, nit::PixelConverter, NULL);
+
+class NB_PixelConverter : TNitClass<PixelConverter>
+{
+public:
+	static void Register(HSQUIRRELVM v)
+	{
+		PropEntry props[] =
+		{
+			NULL
+		};
+
+		FuncEntry funcs[] = 
+		{
+			FUNC_ENTRY_H(getSimdName,	"(): string // 'sse2', 'neon' or 'none'"),
+			FUNC_ENTRY_H(isSimdEnabled,	"(): bool"),
+			FUNC_ENTRY_H(setSimdEnabled, "(flag: bool)"),
+#if defined(NIT_TESTS)
+			FUNC_ENTRY_H(selfTest,		"(seed=0): bool"),
+			FUNC_ENTRY_H(benchmark,		"(width=1024, height=1024, iterations=10): table // { kernel.impl = mega-pixels/sec }"),
+#endif
+			NULL
+		};
+
+		bind(v, props, funcs);
+
+		addStaticTable(v, "FILTER");
+		newSlot(v, -1, "BOX",						(int)PixelConverter::FILTER_BOX);
+		newSlot(v, -1, "BILINEAR",					(int)PixelConverter::FILTER_BILINEAR);
+		newSlot(v, -1, "CATMULLROM",				(int)PixelConverter::FILTER_CATMULLROM);
+		newSlot(v, -1, "KAISER",					(int)PixelConverter::FILTER_KAISER);
+		sq_poptop(v);
+	}
+
+	NB_FUNC(getSimdName)				{ return push(v, PixelConverter::getSimdName()); }
+	NB_FUNC(isSimdEnabled)				{ return push(v, PixelConverter::isSimdEnabled()); }
+	NB_FUNC(setSimdEnabled)				{ PixelConverter::setSimdEnabled(getBool(v, 2)); return 0; }
+
+#if defined(NIT_TESTS)
+	NB_FUNC(selfTest)					{ return push(v, PixelConverter::selfTest(optInt(v, 2, 0))); }
+
+	NB_FUNC(benchmark)
+	{
+		PixelConverter::BenchResults results;
+		PixelConverter::benchmark(results, optInt(v, 2, 1024), optInt(v, 3, 1024), optInt(v, 4, 10));
+
+		sq_newtable(v);
+		for (uint i = 0; i < results.size(); ++i)
+		{
+			newSlot(v, -1, results[i].first, results[i].second);
+		}
+		return 1;
+	}
+#endif
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
 NB_TYPE_REF(NIT_API, nit::Image, Content, incRefCount, decRefCount);
 
 class NB_Image : TNitClass<Image>
@@ -2543,6 +2735,9 @@ public:
 			PROP_ENTRY_R(contentBottom),
 
 			PROP_ENTRY_R(mipCount),
+			PROP_ENTRY_R(decodePending),
+			PROP_ENTRY	(loadBudget),
+			PROP_ENTRY	(srgb),
 			NULL
 		};
 
@@ -2553,11 +2748,18 @@ public:
 			FUNC_ENTRY_H(getMipHeight,	"(mipLevel: int): int"),
 			FUNC_ENTRY_H(getMipPitch,	"(mipLevel: int): int"),
 			FUNC_ENTRY_H(getMipByteCount, "(mipLevel: int): int"),
+			FUNC_ENTRY_H(getPixel,		"(x, y: int, mipLevel=0): int[] // [r, g, b, a] in memory order, 32 bpp only"),
 
 			FUNC_ENTRY_H(discardMipmaps,	"()"),
 			FUNC_ENTRY_H(makePot,		"(square: bool, int min=4)"),
 			FUNC_ENTRY_H(reorderAsRgba,	"()"),
-			FUNC_ENTRY_H(makeRgba_4444,	"()"),
+			FUNC_ENTRY_H(makeRgba_4444,	"(dither=false)"),
+			FUNC_ENTRY_H(makeRgb_565,	"(dither=false)"),
+			FUNC_ENTRY_H(makeRgba_5551,	"(dither=false)"),
+			FUNC_ENTRY_H(flipY,			"()"),
+			FUNC_ENTRY_H(resize,		"(width, height: int, filter=PixelConverter.FILTER.CATMULLROM, gammaCorrect=srgb)"),
+			FUNC_ENTRY_H(generateMipmaps, "(filter=PixelConverter.FILTER.BOX, gammaCorrect=srgb)"),
+			FUNC_ENTRY_H(fitToBudget,	"(budget: int, filter=PixelConverter.FILTER.BOX, gammaCorrect=srgb): int // returns number of halvings"),
 
 			FUNC_ENTRY_H(saveNtex,		"(writer: StreamWriter, flipEndian=false)"),
 			FUNC_ENTRY_H(savePng,		"(writer: StreamWriter)"),
@@ -2566,6 +2768,10 @@ public:
 		};
 
 		bind(v, props, funcs);
+
+		addStaticTable(v, "FLAG");
+		newSlot(v, -1, "SRGB",						(int)Image::FLAG_SRGB);
+		sq_poptop(v);
 	}
 
 	NB_PROP_GET(contentType)			{ return push(v, self(v)->getContentType()); }
@@ -2586,6 +2792,13 @@ public:
 	NB_PROP_GET(contentBottom)			{ return push(v, self(v)->getContentBottom()); }
 
 	NB_PROP_GET(mipCount)				{ return push(v, self(v)->getMipCount()); }
+	NB_PROP_GET(decodePending)			{ return push(v, self(v)->isDecodePending()); }
+	NB_PROP_GET(loadBudget)				{ return push(v, (int)self(v)->getLoadBudget()); }
+
+	NB_PROP_GET(srgb)					{ return push(v, self(v)->isSrgb()); }
+
+	NB_PROP_SET(loadBudget)				{ self(v)->setLoadBudget(getInt(v, 2)); return 0; }
+	NB_PROP_SET(srgb)					{ self(v)->setSrgb(getBool(v, 2)); return 0; }
 
 	NB_CONS()							{ setSelf(v, new Image(get<StreamSource>(v, 2), *opt<ContentType>(v, 3, ContentType::UNKNOWN))); return 0; }
 
@@ -2594,11 +2807,39 @@ public:
 	NB_FUNC(getMipPitch)				{ return push(v, self(v)->getMipPitch(getInt(v, 2))); }
 	NB_FUNC(getMipByteCount)			{ return push(v, self(v)->getMipByteCount(getInt(v, 2))); }
 
+	NB_FUNC(getPixel)
+	{
+		Image* image = self(v);
+		int x = getInt(v, 2);
+		int y = getInt(v, 3);
+		int mipLevel = optInt(v, 4, 0);
+
+		if (!image->isResamplable())
+			return sq_throwerror(v, "32 bpp non-compressed image expected");
+
+		if (mipLevel < 0 || mipLevel >= image->getMipCount() 
+			|| x < 0 || x >= image->getMipWidth(mipLevel) || y < 0 || y >= image->getMipHeight(mipLevel))
+			return sq_throwerror(v, "pixel out of range");
+
+		const uint8* pixel = image->getMipData(mipLevel) + y * image->getMipPitch(mipLevel) + x * 4;
+
+		sq_newarray(v, 0);
+		for (int i = 0; i < 4; ++i)
+			arrayAppend(v, -1, (int)pixel[i]);
+		return 1;
+	}
+
 	NB_FUNC(discardMipmaps)				{ self(v)->discardMipmaps(); return 0; }
 	NB_FUNC(makeAlphaPremultiplied)		{ self(v)->makeAlphaPremultiplied(); return 0; }
 	NB_FUNC(makePot)					{ self(v)->makePot(getBool(v, 2), optInt(v, 3, 4)); return 0; }
 	NB_FUNC(reorderAsRgba)				{ self(v)->reorderAsRgba(); return 0; }
-	NB_FUNC(makeRgba_4444)				{ self(v)->makeRgba_4444(); return 0; }
+	NB_FUNC(makeRgba_4444)				{ self(v)->makeRgba_4444(optBool(v, 2, false)); return 0; }
+	NB_FUNC(makeRgb_565)				{ self(v)->makeRgb_565(optBool(v, 2, false)); return 0; }
+	NB_FUNC(makeRgba_5551)				{ self(v)->makeRgba_5551(optBool(v, 2, false)); return 0; }
+	NB_FUNC(flipY)						{ self(v)->flipY(); return 0; }
+	NB_FUNC(resize)						{ self(v)->resize(getInt(v, 2), getInt(v, 3), (PixelConverter::Filter)optInt(v, 4, PixelConverter::FILTER_CATMULLROM), optBool(v, 5, self(v)->isSrgb())); return 0; }
+	NB_FUNC(generateMipmaps)			{ self(v)->generateMipmaps((PixelConverter::Filter)optInt(v, 2, PixelConverter::FILTER_BOX), optBool(v, 3, self(v)->isSrgb())); return 0; }
+	NB_FUNC(fitToBudget)				{ return push(v, self(v)->fitToBudget(getInt(v, 2), (PixelConverter::Filter)optInt(v, 3, PixelConverter::FILTER_BOX), optBool(v, 4, self(v)->isSrgb()))); }
 
 	NB_FUNC(saveNtex)					{ self(v)->SaveNtex(get<StreamWriter>(v, 2), optBool(v, 3, false)); return 0; }
 	NB_FUNC(savePng)					{ self(v)->SavePng(get<StreamWriter>(v, 2)); return 0; }
@@ -2607,6 +2848,66 @@ public:
 
 ////////////////////////////////////////////////////////////////////////////////
 
+NB_TYPE_REF(NIT_API, nit::ImageDecoder, RefCounted, incRefCount, decRefCount);
+
+class NB_ImageDecoder : TNitClass<ImageDecoder>
+{
+public:
+	static void Register(HSQUIRRELVM v)
+	{
+		PropEntry props[] =
+		{
+			PROP_ENTRY_R(workerCount),
+			PROP_ENTRY_R(pendingCount),
+			PROP_ENTRY_R(decodedCount),
+			PROP_ENTRY_R(failedCount),
+			PROP_ENTRY_R(decodeTime),
+			PROP_ENTRY_R(stallTime),
+			NULL
+		};
+
+		FuncEntry funcs[] =
+		{
+			CONS_ENTRY_H(				"(name: string, numWorkers: int)"),
+			FUNC_ENTRY_H(request,		"(image: Image, priority=PRIORITY.NORMAL)"),
+			FUNC_ENTRY_H(raise,			"(image: Image, priority=PRIORITY.URGENT)"),
+			FUNC_ENTRY_H(cancel,		"(image: Image)"),
+			FUNC_ENTRY_H(finish,		"(image: Image): bool // decodes or waits right now"),
+			FUNC_ENTRY_H(update,		"() // hands decoded buffers over to the images"),
+			FUNC_ENTRY_H(flush,			"() // waits until every request is handed over"),
+			FUNC_ENTRY_H(resetStats,	"()"),
+			NULL
+		};
+
+		bind(v, props, funcs);
+
+		addStaticTable(v, "PRIORITY");
+		newSlot(v, -1, "LOW",						(int)ImageDecoder::PRIORITY_LOW);
+		newSlot(v, -1, "NORMAL",					(int)ImageDecoder::PRIORITY_NORMAL);
+		newSlot(v, -1, "URGENT",					(int)ImageDecoder::PRIORITY_URGENT);
+		sq_poptop(v);
+	}
+
+	NB_PROP_GET(workerCount)			{ return push(v, self(v)->getWorkerCount()); }
+	NB_PROP_GET(pendingCount)			{ return push(v, self(v)->getPendingCount()); }
+	NB_PROP_GET(decodedCount)			{ return push(v, self(v)->getDecodedCount()); }
+	NB_PROP_GET(failedCount)			{ return push(v, self(v)->getFailedCount()); }
+	NB_PROP_GET(decodeTime)				{ return push(v, (float)self(v)->getDecodeTime()); }
+	NB_PROP_GET(stallTime)				{ return push(v, (float)self(v)->getStallTime()); }
+
+	NB_CONS()							{ setSelf(v, new ImageDecoder(getString(v, 2), getInt(v, 3))); return 0; }
+
+	NB_FUNC(request)					{ self(v)->request(get<Image>(v, 2), optInt(v, 3, ImageDecoder::PRIORITY_NORMAL)); return 0; }
+	NB_FUNC(raise)						{ self(v)->raise(get<Image>(v, 2), optInt(v, 3, ImageDecoder::PRIORITY_URGENT)); return 0; }
+	NB_FUNC(cancel)						{ self(v)->cancel(get<Image>(v, 2)); return 0; }
+	NB_FUNC(finish)						{ return push(v, self(v)->finish(get<Image>(v, 2))); }
+	NB_FUNC(update)						{ self(v)->update(); return 0; }
+	NB_FUNC(flush)						{ self(v)->flush(); return 0; }
+	NB_FUNC(resetStats)					{ self(v)->resetStats(); return 0; }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
 NB_TYPE_REF(NIT_API, nit::Texture, Content, incRefCount, decRefCount);
 
 class NB_Texture : TNitClass<Texture>
@@ -2711,6 +3012,7 @@ public:
 			PROP_ENTRY_R(updating),
 			PROP_ENTRY	(position),
 			PROP_ENTRY	(rotation),
+			PROP_ENTRY_R(worldMatrix),
 			PROP_ENTRY_R(front),
 			PROP_ENTRY_R(right),
 			PROP_ENTRY_R(up),
@@ -2758,6 +3060,7 @@ public:
 	NB_PROP_GET(updating)				{ return push(v, self(v)->isUpdating()); }
 	NB_PROP_GET(position)				{ return push(v, self(v)->getPosition()); }
 	NB_PROP_GET(rotation)				{ return push(v, self(v)->getRotation()); }
+	NB_PROP_GET(worldMatrix)			{ return push(v, self(v)->getWorldMatrix()); }
 	NB_PROP_GET(front)					{ return push(v, self(v)->getFront()); }
 	NB_PROP_GET(right)					{ return push(v, self(v)->getRight()); }
 	NB_PROP_GET(up)						{ return push(v, self(v)->getUp()); }
@@ -2950,7 +3253,9 @@ NIT_API SQRESULT NitLibApp_Register(HSQUIRRELVM v)
 	NB_InputAccel::Register(v);
 
 	NB_PixelFormat::Register(v);
+	NB_PixelConverter::Register(v);
 	NB_Image::Register(v);
+	NB_ImageDecoder::Register(v);
 	NB_Texture::Register(v);
 	NB_TextureManager::Register(v);
 
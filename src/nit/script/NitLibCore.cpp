@@ -292,6 +292,7 @@ public:
 			PROP_ENTRY_R(locator),
 			PROP_ENTRY_R(allLoaded),
 			PROP_ENTRY_R(allRequired),
+			PROP_ENTRY_R(precompileCount),
 
 			PROP_ENTRY	(defaultLocator),
 			PROP_ENTRY	(oplimit),
@@ -301,6 +302,7 @@ public:
 		FuncEntry funcs[] =
 		{
 			FUNC_ENTRY_H(getLoaded,		"(id: string): ScriptUnit"),
+			FUNC_ENTRY_H(precompile,	"(unitName: string, locator: StreamLocator=null) // compiles on a worker thread, merged on require"),
 			FUNC_ENTRY_H(getClasses,	"(): class[]"),
 			FUNC_ENTRY_H(command,		"(cmdline: string)"),
 			NULL,
@@ -313,6 +315,7 @@ public:
 	NB_PROP_GET(locator)				{ return push(v, self(v)->getLocator()); }
 	NB_PROP_GET(defaultLocator)			{ return push(v, self(v)->getDefaultLocator()); }
 	NB_PROP_GET(oplimit)				{ return push(v, self(v)->getOpLimit()); }
+	NB_PROP_GET(precompileCount)		{ return push(v, self(v)->getPrecompileCount()); }
 
 	NB_PROP_SET(defaultLocator)			{ self(v)->setDefaultLocator(opt<StreamLocator>(v, 2, NULL)); return 0; }
 	NB_PROP_SET(oplimit)				{ self(v)->setOpLimit(getInt(v, 2)); return 0; }
@@ -354,6 +357,7 @@ public:
 	}
 
 	NB_FUNC(getLoaded)					{ return push(v, self(v)->getLoaded(getString(v, 2))); }
+	NB_FUNC(precompile)					{ self(v)->precompile(getString(v, 2), opt<StreamLocator>(v, 3, NULL)); return 0; }
 
 	NB_FUNC(getClasses)
 	{
@@ -1662,6 +1666,119 @@ public:
 
 ////////////////////////////////////////////////////////////////////////////////
 
+NB_TYPE_REF(NIT_API, nit::ZParallelStreamWriter, StreamWriter, incRefCount, decRefCount);
+
+class NB_ZParallelStreamWriter : TNitClass<ZParallelStreamWriter>
+{
+public:
+	static void Register(HSQUIRRELVM v)
+	{
+		PropEntry props[] =
+		{
+			PROP_ENTRY_R(to),
+			PROP_ENTRY_R(numThreads),
+			PROP_ENTRY_R(totalIn),
+			PROP_ENTRY_R(totalOut),
+			PROP_ENTRY_R(deflateTime),
+			NULL
+		};
+
+		FuncEntry funcs[] =
+		{
+			CONS_ENTRY_H(				"(to: StreamWriter, moreSpeed=false, numThreads=0, blockSize=0)"),
+			FUNC_ENTRY_H(finish,		"(): int // returns adler32, purges instance"),
+			NULL
+		};
+
+		bind(v, props, funcs);
+	}
+
+	NB_PROP_GET(to)						{ return push(v, self(v)->getTo()); }
+	NB_PROP_GET(numThreads)				{ return push(v, self(v)->getNumThreads()); }
+	NB_PROP_GET(totalIn)				{ return push(v, self(v)->getTotalIn()); }
+	NB_PROP_GET(totalOut)				{ return push(v, self(v)->getTotalOut()); }
+	NB_PROP_GET(deflateTime)			{ return push(v, self(v)->getDeflateTime()); }
+
+	NB_CONS()							{ setSelf(v, new ZParallelStreamWriter(get<StreamWriter>(v, 2), optBool(v, 3, false), optInt(v, 4, 0), optInt(v, 5, 0))); return 0; }
+
+	NB_FUNC(finish)						{ uint32 adler = self(v)->finish(); sq_purgeinstance(v, 1); return push(v, adler); }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+NB_TYPE_REF(NIT_API, nit::ZChunkedStreamReader, StreamReader, incRefCount, decRefCount);
+
+class NB_ZChunkedStreamReader : TNitClass<ZChunkedStreamReader>
+{
+public:
+	static void Register(HSQUIRRELVM v)
+	{
+		PropEntry props[] =
+		{
+			PROP_ENTRY_R(from),
+			PROP_ENTRY_R(blockSize),
+			PROP_ENTRY_R(blockCount),
+			PROP_ENTRY_R(adler32),
+			PROP_ENTRY_R(verified),
+			PROP_ENTRY_R(inflatedCount),
+			PROP_ENTRY_R(inflateTime),
+			NULL
+		};
+
+		FuncEntry funcs[] =
+		{
+			CONS_ENTRY_H(				"(from: StreamReader) // from should be seekable"),
+			NULL
+		};
+
+		bind(v, props, funcs);
+	}
+
+	NB_PROP_GET(from)					{ return push(v, self(v)->getFrom()); }
+	NB_PROP_GET(blockSize)				{ return push(v, self(v)->getBlockSize()); }
+	NB_PROP_GET(blockCount)				{ return push(v, self(v)->getBlockCount()); }
+	NB_PROP_GET(adler32)				{ return push(v, self(v)->getAdler32()); }
+	NB_PROP_GET(verified)				{ return push(v, self(v)->isVerified()); }
+	NB_PROP_GET(inflatedCount)			{ return push(v, self(v)->getInflatedCount()); }
+	NB_PROP_GET(inflateTime)			{ return push(v, self(v)->getInflateTime()); }
+
+	NB_CONS()							{ setSelf(v, new ZChunkedStreamReader(get<StreamReader>(v, 2))); return 0; }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+NB_TYPE_REF(NIT_API, nit::ZChunkedStreamWriter, StreamWriter, incRefCount, decRefCount);
+
+class NB_ZChunkedStreamWriter : TNitClass<ZChunkedStreamWriter>
+{
+public:
+	static void Register(HSQUIRRELVM v)
+	{
+		PropEntry props[] =
+		{
+			PROP_ENTRY_R(to),
+			NULL
+		};
+
+		FuncEntry funcs[] =
+		{
+			CONS_ENTRY_H(				"(to: StreamWriter, moreSpeed=false, blockSize=0)"),
+			FUNC_ENTRY_H(finish,		"(): int // writes the block index, returns adler32, purges instance"),
+			NULL
+		};
+
+		bind(v, props, funcs);
+	}
+
+	NB_PROP_GET(to)						{ return push(v, self(v)->getTo()); }
+
+	NB_CONS()							{ setSelf(v, new ZChunkedStreamWriter(get<StreamWriter>(v, 2), optBool(v, 3, false), optInt(v, 4, 0))); return 0; }
+
+	NB_FUNC(finish)						{ uint32 adler = self(v)->finish(); sq_purgeinstance(v, 1); return push(v, adler); }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
 class NB_StreamPrinterArgItr : public StreamPrinter::IArgIterator
 {
 public:
@@ -2033,6 +2150,12 @@ public:
 			"\n"						"(pos: int, size=0, utf16=false): string"),
 			FUNC_ENTRY_H(pushBack,		"(string): this"),
 			FUNC_ENTRY_H(popFront,		"(size: int): this"),
+			FUNC_ENTRY_H(popBack,		"(size: int): this"),
+			FUNC_ENTRY_H(insert,		"(pos: int, string): this"
+			"\n"						"(pos: int, src: MemoryBuffer, srcPos=0, size=0): this // shares memory of src"),
+			FUNC_ENTRY_H(erase,			"(pos: int, size: int): this"),
+			FUNC_ENTRY_H(slice,			"(pos: int, size=0): MemoryBuffer // shares memory, copied when written"),
+			FUNC_ENTRY_H(compact,		"(): this // repacks fragmented blocks"),
 			FUNC_ENTRY_H(hexDump,		"()"),
 			FUNC_ENTRY	(_clone),
 			NULL
@@ -2081,6 +2204,24 @@ public:
 
 	NB_FUNC(pushBack)					{ self(v)->pushBack(getString(v, 2)); sq_push(v, 1); return 1;  }
 	NB_FUNC(popFront)					{ self(v)->popFront(getInt(v, 2)); sq_push(v, 1); return 1;  }
+	NB_FUNC(popBack)					{ self(v)->popBack(getInt(v, 2)); sq_push(v, 1); return 1;  }
+	NB_FUNC(erase)						{ self(v)->erase(getInt(v, 2), getInt(v, 3)); sq_push(v, 1); return 1; }
+	NB_FUNC(slice)						{ return push(v, self(v)->slice(getInt(v, 2), optInt(v, 3, 0))); }
+	NB_FUNC(compact)					{ self(v)->compact(); sq_push(v, 1); return 1; }
+
+	NB_FUNC(insert)
+	{
+		if (isString(v, 3))
+			self(v)->insert(getInt(v, 2), getString(v, 3));
+		else
+		{
+			MemoryBuffer* src = get<MemoryBuffer>(v, 3);
+			size_t srcPos = optInt(v, 4, 0);
+			size_t size = optInt(v, 5, 0);
+			self(v)->insert(getInt(v, 2), src, srcPos, size ? size : src->getSize() - srcPos);
+		}
+		sq_push(v, 1); return 1;
+	}
 	NB_FUNC(hexDump)					{ self(v)->hexDump(); return 0; }
 
 	NB_FUNC(compress)					{ self(v)->compress(optBool(v, 2, false)); sq_push(v, 1); return 1; }
@@ -2396,6 +2537,7 @@ public:
 		PropEntry props[] =
 		{
 			PROP_ENTRY_R(baseUrl),
+			PROP_ENTRY	(snapshotEnabled),
 			NULL
 		};
 
@@ -2406,6 +2548,7 @@ public:
 			FUNC_ENTRY_H(findFiles,		"(pattern, recursive=false): StreamSource[]"),
 			FUNC_ENTRY_H(findDirs,		"(pattern): string[]"),
 			FUNC_ENTRY_H(normalizePath,	"(path): string"),
+			FUNC_ENTRY_H(pollChanges,	"(): string[] // files changed since the last call, needs snapshotEnabled"),
 			NULL
 		};
 
@@ -2413,6 +2556,9 @@ public:
 	}
 
 	NB_PROP_GET(baseUrl)				{ return push(v, self(v)->getBaseUrl()); }
+	NB_PROP_GET(snapshotEnabled)		{ return push(v, self(v)->isSnapshotEnabled()); }
+
+	NB_PROP_SET(snapshotEnabled)		{ self(v)->setSnapshotEnabled(getBool(v, 2)); return 0; }
 
 	NB_CONS()							
 	{ 
@@ -2446,6 +2592,17 @@ public:
 			arrayAppend(v, -1, dirs[i]);
 		return 1;
 	}
+
+	NB_FUNC(pollChanges)
+	{
+		StringVector changed;
+		self(v)->pollChanges(changed);
+
+		sq_newarray(v, 0);
+		for (uint i=0; i<changed.size(); ++i)
+			arrayAppend(v, -1, changed[i]);
+		return 1;
+	}
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -3055,6 +3212,9 @@ SQRESULT NitLibCore(HSQUIRRELVM v)
 
 	NB_ZStreamReader::Register(v);
 	NB_ZStreamWriter::Register(v);
+	NB_ZParallelStreamWriter::Register(v);
+	NB_ZChunkedStreamReader::Register(v);
+	NB_ZChunkedStreamWriter::Register(v);
 
 	NB_StreamPrinter::Register(v);
 	NB_JsonPrinter::Register(v);
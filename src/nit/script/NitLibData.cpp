@@ -2103,6 +2103,12 @@ public:
 	{
 		PropEntry props[] =
 		{
+			PROP_ENTRY	(stmtCacheCapacity),
+			PROP_ENTRY_R(stmtCacheCount),
+			PROP_ENTRY	(journalMode),
+			PROP_ENTRY	(synchronous),
+			PROP_ENTRY_R(batchLimit),
+			PROP_ENTRY_R(batchDelay),
 			NULL
 		};
 
@@ -2112,8 +2118,20 @@ public:
 										"(uriPath: string)"),
 
 			FUNC_ENTRY_H(prepare,		"(sql: string): DBStatement"),
+			FUNC_ENTRY_H(prepareCached,	"(sql: string): DBStatement // statement returns to the cache when released"),
+			FUNC_ENTRY_H(purgeStmtCache, "()"),
 			FUNC_ENTRY_H(exec,			"(sql: string) // results are ignored"),
 			FUNC_ENTRY_H(fetch,			"(sql: string): array<table>"),
+			FUNC_ENTRY_H(insertRecords,	"(sql: string, records: array | DataArray): int // one transaction, returns rows changed"),
+			FUNC_ENTRY_H(fetchRecords,	"(sql: string, params: array = null): DataArray // of DataRecords"),
+
+			FUNC_ENTRY_H(execAsync,		"(sql: string, params: array = null, fetchRows = false): DBAsyncQuery"),
+			FUNC_ENTRY_H(finish,		"(query: DBAsyncQuery): bool // runs or waits for it right now"),
+			FUNC_ENTRY_H(update,		"() // delivers finished async queries"),
+			FUNC_ENTRY_H(flush,			"() // waits for all async queries"),
+			FUNC_ENTRY_H(setBatchPolicy, "(maxStatements: int, maxDelay: float)"),
+			FUNC_ENTRY_H(getStats,		"(): table"),
+			FUNC_ENTRY_H(resetStats,	"()"),
 
 			FUNC_ENTRY_H(newLocator,	"(name: string, path: string): DBBlobLocator // path: '[db.]table/blob_column[.id_column]'"),
 
@@ -2135,9 +2153,92 @@ public:
 		return SQ_OK;
 	}
 
+	NB_PROP_GET(stmtCacheCapacity)		{ return push(v, self(v)->getStmtCacheCapacity()); }
+	NB_PROP_GET(stmtCacheCount)			{ return push(v, self(v)->getStmtCacheCount()); }
+	NB_PROP_GET(journalMode)			{ return push(v, self(v)->getJournalMode()); }
+	NB_PROP_GET(synchronous)			{ return push(v, self(v)->getSynchronous()); }
+	NB_PROP_GET(batchLimit)				{ return push(v, self(v)->getBatchLimit()); }
+	NB_PROP_GET(batchDelay)				{ return push(v, self(v)->getBatchDelay()); }
+
+	NB_PROP_SET(stmtCacheCapacity)		{ self(v)->setStmtCacheCapacity(getInt(v, 2)); return 0; }
+	NB_PROP_SET(journalMode)			{ self(v)->setJournalMode(getString(v, 2)); return 0; }
+	NB_PROP_SET(synchronous)			{ self(v)->setSynchronous(getInt(v, 2)); return 0; }
+
 	NB_FUNC(prepare)					{ return push(v, self(v)->prepare(getString(v, 2))); }
+	NB_FUNC(prepareCached)				{ return push(v, self(v)->prepareCached(getString(v, 2))); }
+	NB_FUNC(purgeStmtCache)				{ self(v)->purgeStmtCache(); return 0; }
 	NB_FUNC(exec)						{ self(v)->exec(getString(v, 2)); return 0; }
 
+	NB_FUNC(finish)						{ return push(v, self(v)->finish(get<Database::AsyncQuery>(v, 2))); }
+	NB_FUNC(update)						{ self(v)->update(); return 0; }
+	NB_FUNC(flush)						{ self(v)->flush(); return 0; }
+	NB_FUNC(setBatchPolicy)				{ self(v)->setBatchPolicy(getInt(v, 2), getFloat(v, 3)); return 0; }
+	NB_FUNC(resetStats)					{ self(v)->resetStats(); return 0; }
+
+	NB_FUNC(insertRecords)
+	{
+		Ref<DataArray> records;
+		if (is<DataArray>(v, 3))
+			records = get<DataArray>(v, 3);
+		else
+		{
+			records = new DataArray();
+			SQRESULT sr = ScriptDataValue::toArray(v, 3, records);
+			if (SQ_FAILED(sr)) return sr;
+		}
+
+		return push(v, self(v)->insertRecords(getString(v, 2), records));
+	}
+
+	NB_FUNC(fetchRecords)
+	{
+		Ref<DataArray> params;
+		if (is<DataArray>(v, 3))
+			params = get<DataArray>(v, 3);
+		else if (!isNone(v, 3) && !isNull(v, 3))
+		{
+			params = new DataArray();
+			SQRESULT sr = ScriptDataValue::toArray(v, 3, params);
+			if (SQ_FAILED(sr)) return sr;
+		}
+
+		return push(v, self(v)->fetchRecords(getString(v, 2), params).get());
+	}
+
+	NB_FUNC(execAsync)
+	{
+		Ref<DataArray> params;
+
+		if (!isNone(v, 3) && !isNull(v, 3))
+		{
+			params = new DataArray();
+			SQRESULT sr = ScriptDataValue::toArray(v, 3, params);
+			if (SQ_FAILED(sr)) return sr;
+		}
+
+		return push(v, self(v)->execAsync(getString(v, 2), params, optBool(v, 4, false)));
+	}
+
+	NB_FUNC(getStats)
+	{
+		type::Stats stats = self(v)->getStats();
+
+		uint done = stats.completed + stats.failed;
+
+		sq_newtable(v);
+		newSlot(v, -1, "queued",		stats.queued);
+		newSlot(v, -1, "completed",		stats.completed);
+		newSlot(v, -1, "failed",		stats.failed);
+		newSlot(v, -1, "batches",		stats.batches);
+		newSlot(v, -1, "cacheHits",		stats.cacheHits);
+		newSlot(v, -1, "cacheMisses",	stats.cacheMisses);
+		newSlot(v, -1, "execTime",		(float)stats.execTime);
+		newSlot(v, -1, "mainTime",		(float)stats.mainTime);
+		newSlot(v, -1, "mainTimePerQuery", done ? (float)(stats.mainTime / done) : 0.0f);
+		newSlot(v, -1, "queriesPerSec",	stats.execTime > 0.0 ? (float)(done / stats.execTime) : 0.0f);
+		return 1;
+	}
+
 	NB_FUNC(newLocator)					{ return push(v, self(v)->newLocator(getString(v, 2), getString(v, 3))); }
 
 	struct PrintContext
@@ -2356,6 +2457,9 @@ public:
 			FUNC_ENTRY_H(bind,			"(paramIndex: int, value)\n"
 										"(paramName: string, value)"),
 
+			FUNC_ENTRY_H(bindArray,		"(values: array | DataArray) // to ?1, ?2.. in order"),
+			FUNC_ENTRY_H(bindRecord,	"(record: table | DataRecord) // to named params, missing keys bind null"),
+
 			FUNC_ENTRY_H(step,			"(): bool // true if you can call Get methods"),
 			FUNC_ENTRY_H(exec,			"(): int // returns total changes by this query"),
 
@@ -2364,6 +2468,8 @@ public:
 			FUNC_ENTRY_H(getOriginName,	"(column: int): string"),
 			FUNC_ENTRY_H(getColumnName,	"(column: int): string"),
 			FUNC_ENTRY_H(getValue,		"(column: int): value"),
+			FUNC_ENTRY_H(getRecord,		"(): DataRecord // current row"),
+			FUNC_ENTRY_H(fetchRecords,	"(): DataArray // of DataRecords, all rows left"),
 
 			NULL
 		};
@@ -2396,6 +2502,46 @@ public:
 	NB_FUNC(getOriginName)				{ return push(v, self(v)->getOriginName(getInt(v, 2))); }
 	NB_FUNC(getColumnName)				{ return push(v, self(v)->getColumnName(getInt(v, 2))); }
 	NB_FUNC(getValue)					{ return PushColumnValue(v, self(v), getInt(v, 2)); }
+	NB_FUNC(getRecord)					{ return push(v, self(v)->getRecord()); }
+
+	NB_FUNC(fetchRecords)
+	{
+		Ref<DataArray> records = new DataArray();
+		self(v)->fetchRecords(records);
+		return push(v, records.get());
+	}
+
+	NB_FUNC(bindArray)
+	{
+		if (is<DataArray>(v, 2))
+		{
+			self(v)->bindArray(get<DataArray>(v, 2));
+			return 0;
+		}
+
+		Ref<DataArray> values = new DataArray();
+		SQRESULT sr = ScriptDataValue::toArray(v, 2, values);
+		if (SQ_FAILED(sr)) return sr;
+
+		self(v)->bindArray(values);
+		return 0;
+	}
+
+	NB_FUNC(bindRecord)
+	{
+		if (is<DataRecord>(v, 2))
+		{
+			self(v)->bindRecord(get<DataRecord>(v, 2));
+			return 0;
+		}
+
+		Ref<DataRecord> record = new DataRecord();
+		SQRESULT sr = ScriptDataValue::toRecord(v, 2, record);
+		if (SQ_FAILED(sr)) return sr;
+
+		self(v)->bindRecord(record);
+		return 0;
+	}
 
 	static SQRESULT SimpleBind(HSQUIRRELVM v)
 	{
@@ -2497,6 +2643,93 @@ public:
 
 ////////////////////////////////////////////////////////////////////////////////
 
+NB_TYPE_REF(NIT_API, nit::Database::AsyncQuery, RefCounted, incRefCount, decRefCount);
+
+class NB_DatabaseAsyncQuery : TNitClass<Database::AsyncQuery>
+{
+public:
+	static void Register(HSQUIRRELVM v)
+	{
+		PropEntry props[] =
+		{
+			PROP_ENTRY_R(sql),
+			PROP_ENTRY_R(done),
+			PROP_ENTRY_R(failed),
+			PROP_ENTRY_R(error),
+			PROP_ENTRY_R(changes),
+			PROP_ENTRY_R(lastInsertRowId),
+			PROP_ENTRY_R(columnNames),
+			PROP_ENTRY_R(rows),
+			PROP_ENTRY_R(execTime),
+			NULL
+		};
+
+		FuncEntry funcs[] =
+		{
+			FUNC_ENTRY_H(channel,		"(): EventChannel // DB_QUERY_DONE, DB_QUERY_ERROR"),
+			NULL
+		};
+
+		bind(v, props, funcs);
+	}
+
+	NB_PROP_GET(sql)					{ return push(v, self(v)->getSql()); }
+	NB_PROP_GET(done)					{ return push(v, self(v)->isDone()); }
+	NB_PROP_GET(failed)					{ return push(v, self(v)->isFailed()); }
+	NB_PROP_GET(error)					{ return push(v, self(v)->getError()); }
+	NB_PROP_GET(changes)				{ return push(v, self(v)->getChanges()); }
+	NB_PROP_GET(lastInsertRowId)		{ return push(v, (int)self(v)->getLastInsertRowId()); }
+	NB_PROP_GET(execTime)				{ return push(v, (float)self(v)->getExecTime()); }
+
+	NB_PROP_GET(columnNames)
+	{
+		const StringVector& names = self(v)->getColumnNames();
+
+		sq_newarray(v, 0);
+		for (uint i = 0; i < names.size(); ++i)
+			arrayAppend(v, -1, names[i]);
+		return 1;
+	}
+
+	NB_PROP_GET(rows)
+	{
+		DataArray* rows = self(v)->getRows();
+		if (rows == NULL) return 0;
+
+		return ScriptDataValue::push(v, rows);
+	}
+
+	NB_FUNC(channel)					{ return push(v, self(v)->channel()); }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+NB_TYPE_REF(NIT_API, nit::DatabaseEvent, Event, incRefCount, decRefCount);
+
+class NB_DatabaseEvent : TNitClass<DatabaseEvent>
+{
+public:
+	static void Register(HSQUIRRELVM v)
+	{
+		PropEntry props[] =
+		{
+			PROP_ENTRY_R(query),
+			NULL
+		};
+
+		FuncEntry funcs[] =
+		{
+			NULL
+		};
+
+		bind(v, props, funcs);
+	}
+
+	NB_PROP_GET(query)					{ return push(v, self(v)->query.get()); }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
 NB_TYPE_REF(NIT_API, nit::BlobLocator, StreamLocator, incRefCount, decRefCount);
 
 class NB_BlobLocator : public TNitClass<BlobLocator>
@@ -3203,6 +3436,8 @@ SQRESULT NitLibData(HSQUIRRELVM v)
 
 	NB_Database::Register(v);
 	NB_DatabaseQuery::Register(v);
+	NB_DatabaseAsyncQuery::Register(v);
+	NB_DatabaseEvent::Register(v);
 	NB_BlobLocator::Register(v);
 	NB_BlobSource::Register(v);
 
@@ -26,6 +26,8 @@
 #include "nit/script/NitBindMacro.h"
 
 #include "nit/math/Solver.h"
+#include "nit/math/MathBatch.h"
+#include "nit/math/Curves.h"
 
 NS_NIT_BEGIN;
 
@@ -1568,6 +1570,101 @@ public:
 
 ////////////////////////////////////////////////////////////////////////////////
 
+NB_TYPE_RAW_PTR(NIT_API, nit::MathBatch, NULL);
+
+class NB_MathBatch : TNitClass<MathBatch>
+{
+public:
+	static void Register(HSQUIRRELVM v)
+	{
+		PropEntry props[] =
+		{
+			NULL
+		};
+
+		FuncEntry funcs[] = 
+		{
+			FUNC_ENTRY_H(getSimdName,	"(): string // 'sse2', 'neon' or 'none'"),
+			FUNC_ENTRY_H(isSimdEnabled,	"(): bool"),
+			FUNC_ENTRY_H(setSimdEnabled, "(flag: bool)"),
+#if defined(NIT_TESTS)
+			FUNC_ENTRY_H(selfTest,		"(seed=0): bool"),
+			FUNC_ENTRY_H(benchmark,		"(count=10000, iterations=100): table // { kernel.impl = mega-elements/sec }"),
+#endif
+			NULL
+		};
+
+		bind(v, props, funcs);
+	}
+
+	NB_FUNC(getSimdName)				{ return push(v, MathBatch::getSimdName()); }
+	NB_FUNC(isSimdEnabled)				{ return push(v, MathBatch::isSimdEnabled()); }
+	NB_FUNC(setSimdEnabled)				{ MathBatch::setSimdEnabled(getBool(v, 2)); return 0; }
+
+#if defined(NIT_TESTS)
+	NB_FUNC(selfTest)					{ return push(v, MathBatch::selfTest(optInt(v, 2, 0))); }
+
+	NB_FUNC(benchmark)
+	{
+		MathBatch::BenchResults results;
+		MathBatch::benchmark(results, optInt(v, 2, 10000), optInt(v, 3, 100));
+
+		sq_newtable(v);
+		for (uint i = 0; i < results.size(); ++i)
+		{
+			newSlot(v, -1, results[i].first, results[i].second);
+		}
+		return 1;
+	}
+#endif
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+#if defined(NIT_TESTS)
+
+NB_TYPE_RAW_PTR(NIT_API, nit::CurveTest, NULL);
+
+class NB_CurveTest : TNitClass<CurveTest>
+{
+public:
+	static void Register(HSQUIRRELVM v)
+	{
+		PropEntry props[] =
+		{
+			NULL
+		};
+
+		FuncEntry funcs[] = 
+		{
+			FUNC_ENTRY_H(selfTest,		"(seed=0): bool"),
+			FUNC_ENTRY_H(benchmark,		"(count=100000): table // { fromLength.impl = ns, error.impl = worst length error, pos.single / pos.batch = ns }"),
+			NULL
+		};
+
+		bind(v, props, funcs);
+	}
+
+	NB_FUNC(selfTest)					{ return push(v, CurveTest::selfTest(optInt(v, 2, 0))); }
+
+	NB_FUNC(benchmark)
+	{
+		CurveTest::BenchResults results;
+		CurveTest::benchmark(results, optInt(v, 2, 100000));
+
+		sq_newtable(v);
+		for (uint i = 0; i < results.size(); ++i)
+		{
+			newSlot(v, -1, results[i].first, results[i].second);
+		}
+		return 1;
+	}
+};
+
+#endif // #if defined(NIT_TESTS)
+
+////////////////////////////////////////////////////////////////////////////////
+
 SQRESULT NitLibMath(HSQUIRRELVM v)
 {
 	NB_Math::Register(v);
@@ -1585,6 +1682,12 @@ SQRESULT NitLibMath(HSQUIRRELVM v)
 	NB_Sphere::Register(v);
 	NB_Plane::Register(v);
 
+	NB_MathBatch::Register(v);
+
+#if defined(NIT_TESTS)
+	NB_CurveTest::Register(v);
+#endif
+
 	return SQ_OK;
 }
 
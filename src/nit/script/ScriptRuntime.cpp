@@ -29,11 +29,13 @@
 #include "nit/event/Event.h"
 #include "nit/runtime/MemManager.h"
 #include "nit/io/MemoryBuffer.h"
+#include "nit/async/AsyncJob.h"
 
 #include "squirrel/sqstate.h"
 #include "squirrel/sqtable.h"
 #include "squirrel/sqvm.h"
 #include "squirrel/sqclass.h"
+#include "squirrel/sqstring.h"
 
 #include "squirrel/sqstdblob.h"
 #include "squirrel/sqstdstream.h"
@@ -1083,21 +1085,20 @@ public:
 
 	static SQInteger Str_Utf8Replace(HSQUIRRELVM v)
 	{
-		const char* str = getString(v, 1);
+		SQString* sstr = sqi_string(stack_get(v, 1));
+		const char* str = sstr->_val;
 		const char* substr = getString(v, 2);
 		const char* replace = getString(v, 3);
 
-		int len = sq_getsize(v, 1);
+		int len = sstr->_len;
 
 		String ret;
 		ret.reserve(len);
 
 		int begin = optInt(v, 4, 0);
-
-		if (begin > 0)
-			begin = Unicode::utf8Next(str, str + len, begin) - str;
-		else if (begin < 0)
-			begin = Unicode::utf8Prev(str + len, str, -begin) - str;
+		if (begin < 0)
+			begin += sstr->Utf8Len();
+		begin = sstr->Utf8Offset(begin);
 
 		int end;
 		if (isNone(v, 5))
@@ -1105,10 +1106,9 @@ public:
 		else
 		{
 			end = getInt(v, 5);
-			if (end > 0)
-				end = Unicode::utf8Next(str, str + len, end) - str;
-			else if (begin < 0)
-				end = Unicode::utf8Prev(str + len, str, -end) - str;
+			if (end < 0)
+				end += sstr->Utf8Len();
+			end = sstr->Utf8Offset(end);
 		}
 
 		if (begin < 0) begin = 0;
@@ -1486,6 +1486,180 @@ public:
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Compiles a unit on an AsyncJobManager worker into a private squirrel state.
+// The private state is seeded with the runtime's constants on the main thread and
+// touched only by the worker until the job is done; the resulting function proto
+// moves to the runtime state as bytecode on merge().
+
+class ScriptCompileJob : public AsyncJob
+{
+public:
+	ScriptCompileJob(HSQUIRRELVM main, const String& id, StreamSource* source)
+		: _id(id), _source(source), _claimed(false), _compiled(false), _executed(false)
+	{
+		_vm = sq_open(256);
+
+		sq_setprintfunc(_vm, ScriptRuntimeLib::printfunc, ScriptRuntimeLib::printfunc);
+		sq_setcompilererrorhandler(_vm, ScriptRuntime::compileErrorHandler);
+		sq_enabledebuginfo(_vm, _ss(main)->_debuginfo);
+
+		sq_pushconsttable(main);
+		sq_pushconsttable(_vm);
+		copyMissingSlots(main, -1, _vm, -1);
+		sq_pop(_vm, 1);
+		sq_pop(main, 1);
+
+		_ss(_vm)->_unresolved = SQTable::Create(_ss(_vm), 0);
+	}
+
+	virtual ~ScriptCompileJob()
+	{
+		close();
+	}
+
+public:
+	const String&						getId()									{ return _id; }
+
+	// Whoever claims first compiles: the worker on execute, or the main thread when it can't wait
+	bool								claim()									{ Mutex::ScopedLock lock(getMutex()); bool ok = !_claimed; _claimed = true; return ok; }
+
+	// Blocks until the worker which claimed the job leaves onExecute(), whatever the outcome
+	void								waitExecuted()							{ _executed.wait(); }
+
+	bool merge(HSQUIRRELVM v)
+	{
+		if (!_compiled) return false;
+
+		// Identifiers compiled as root lookups which became constants meanwhile invalidate the bytecode
+		bool stale = false;
+
+		sq_pushconsttable(v);
+		sq_pushobject(_vm, _ss(_vm)->_unresolved);
+		for (NitIterator itr(_vm, -1); !stale && itr.hasNext(); itr.next())
+		{
+			const SQChar* name = NitBind::getString(_vm, itr.keyIndex());
+			sq_pushstring(v, name, -1);
+			if (SQ_SUCCEEDED(sq_rawget(v, -2)))
+			{
+				LOG(0, "++ '%s': constant '%s' defined after precompile, recompiling\n", _id.c_str(), name);
+				sq_poptop(v);
+				stale = true;
+			}
+		}
+		sq_poptop(_vm);
+
+		if (stale)
+		{
+			sq_poptop(v);
+			return false;
+		}
+
+		// Carry over enums the unit declared
+		sq_pushconsttable(_vm);
+		copyMissingSlots(_vm, -1, v, -1);
+		sq_pop(_vm, 1);
+		sq_pop(v, 1);
+
+		Ref<StreamReader> reader = new MemoryBuffer::Reader(_bytecode, NULL);
+		if (SQ_FAILED(sq_readclosure(v, ScriptIO::bytecode_read, reader)))
+			return false;
+
+		close();
+		return true;
+	}
+
+protected:
+	virtual bool						isPrepared()							{ return true; }
+	virtual bool						onPrepare()								{ return true; }
+
+	virtual bool onExecute(bool async)
+	{
+		if (!claim()) return false;
+
+		// Signal on every exit - the worker may leave through an exception
+		struct ExecutedSignal { EventSemaphore& event; ~ExecutedSignal() { event.set(); } } signal = { _executed };
+
+		Ref<StreamReader> reader = _source->open();
+		if (SQ_FAILED(ScriptIO::loadstream(_vm, reader, _id, true)))
+			return false;
+
+		_bytecode = new MemoryBuffer();
+		Ref<StreamWriter> writer = new MemoryBuffer::Writer(_bytecode, NULL);
+		SQRESULT r = sq_writeclosure(_vm, ScriptIO::bytecode_write, writer, false);
+		sq_poptop(_vm);
+
+		_compiled = SQ_SUCCEEDED(r);
+		return _compiled;
+	}
+
+	virtual void						onFinish()								{ }
+
+private:
+	String								_id;
+	Ref<StreamSource>					_source;
+	HSQUIRRELVM							_vm;
+	Ref<MemoryBuffer>					_bytecode;
+	bool								_claimed;
+	bool								_compiled;
+	EventSemaphore						_executed;
+
+	void close()
+	{
+		if (_vm) sq_close(_vm, NULL);
+		_vm = NULL;
+	}
+
+	// Copies scalar and enum-table slots absent in 'to' - both states must be owned by the calling thread
+	static void copyMissingSlots(HSQUIRRELVM from, SQInteger fromIdx, HSQUIRRELVM to, SQInteger toIdx)
+	{
+		toIdx = NitBindImpl::toAbsIdx(to, toIdx);
+
+		for (NitIterator itr(from, fromIdx); itr.hasNext(); itr.next())
+		{
+			SQInteger top = sq_gettop(to);
+
+			if (!pushValue(from, itr.keyIndex(), to)) continue;
+
+			sq_push(to, -1);
+			if (SQ_SUCCEEDED(sq_rawget(to, toIdx)))
+			{
+				// already present
+				sq_settop(to, top);
+				continue;
+			}
+
+			if (sq_gettype(from, itr.valueIndex()) == OT_TABLE)
+			{
+				sq_newtable(to);
+				copyMissingSlots(from, itr.valueIndex(), to, -1);
+			}
+			else if (!pushValue(from, itr.valueIndex(), to))
+			{
+				sq_settop(to, top);
+				continue;
+			}
+
+			sq_newslot(to, toIdx, false);
+			sq_settop(to, top);
+		}
+	}
+
+	static bool pushValue(HSQUIRRELVM from, SQInteger idx, HSQUIRRELVM to)
+	{
+		switch (sq_gettype(from, idx))
+		{
+		case OT_NULL:					sq_pushnull(to); return true;
+		case OT_BOOL:					sq_pushbool(to, NitBind::getBool(from, idx)); return true;
+		case OT_INTEGER:				sq_pushinteger(to, NitBind::getInt(from, idx)); return true;
+		case OT_FLOAT:					sq_pushfloat(to, NitBind::getFloat(from, idx)); return true;
+		case OT_STRING:					sq_pushstring(to, NitBind::getString(from, idx), sq_getsize(from, idx)); return true;
+		default:						return false;
+		}
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
 ScriptUnit::ScriptUnit(ScriptRuntime* runtime, const String& id, StreamSource* source)
 : _runtime(runtime), _source(source), _id(id), _compiled(false), _required(false)
 {
@@ -1496,12 +1670,18 @@ SQRESULT ScriptUnit::compile(HSQUIRRELVM v)
 {
 	if (_compiled) return SQ_OK;
 
-	LOG_TIMESCOPE(0, ".. compiling '%s'", _id.c_str());
-
 	SQInteger top = sq_gettop(v);
+	SQRESULT r = SQ_OK;
 
-	Ref<StreamReader> reader = _source->open();
-	SQRESULT r = ScriptIO::loadstream(v, reader, _id, true);
+	ScriptRuntime* runtime = _runtime;
+
+	if (runtime == NULL || !runtime->mergePrecompiled(v, _id))
+	{
+		LOG_TIMESCOPE(0, ".. compiling '%s'", _id.c_str());
+
+		Ref<StreamReader> reader = _source->open();
+		r = ScriptIO::loadstream(v, reader, _id, true);
+	}
 
 	sq_getstackobj(v, -1, &_body);
 	sq_addref(v, &_body);
@@ -1824,6 +2004,8 @@ void ScriptRuntime::shutdown()
 
 	if (_root == NULL) return;
 
+	stopPrecompiles();
+
 	if (_debugger) _debugger->disable();
 
 	killAllThreads(true);
@@ -2077,6 +2259,60 @@ ScriptUnit* ScriptRuntime::createUnit(const String& unitName, StreamLocator* loc
 	return new ScriptUnit(this, unitSourceID(source), source);
 }
 
+void ScriptRuntime::precompile(const String& unitName, StreamLocator* locator)
+{
+	// Bytecode doesn't carry help strings
+	if (_ss(_root)->_enablehelp) return;
+
+	Ref<StreamSource> source = locateUnit(unitName, locator);
+	if (source == NULL) return;
+
+	String id = unitSourceID(source);
+
+	if (_units.find(id) != _units.end()) return;
+	if (_precompiles.find(id) != _precompiles.end()) return;
+
+	if (_compileJobs == NULL)
+		_compileJobs = new AsyncJobManager("script", Thread::getMaxConcurrency() - 1);
+
+	Ref<ScriptCompileJob> job = new ScriptCompileJob(_root, id, source);
+	_precompiles.insert(std::make_pair(id, job));
+	_compileJobs->enqueue(job);
+}
+
+bool ScriptRuntime::mergePrecompiled(HSQUIRRELVM v, const String& id)
+{
+	PrecompileMap::iterator itr = _precompiles.find(id);
+	if (itr == _precompiles.end()) return false;
+
+	Ref<ScriptCompileJob> job = itr->second;
+	_precompiles.erase(itr);
+
+	// Not picked up by a worker yet: compile here rather than wait behind other jobs
+	if (job->claim()) return false;
+
+	// The job status is updated only after onExecute() returns, so wait on the job's own signal;
+	// merge() then refuses anything which did not compile.
+	if (!job->isDone())
+	{
+		LOG_TIMESCOPE(0, ".. waiting precompile of '%s'", id.c_str());
+		job->waitExecuted();
+	}
+
+	LOG_TIMESCOPE(0, ".. merging precompiled '%s'", id.c_str());
+	return job->merge(v);
+}
+
+void ScriptRuntime::stopPrecompiles()
+{
+	_precompiles.clear();
+
+	if (_compileJobs)
+		_compileJobs->stop();
+
+	_compileJobs = NULL;
+}
+
 ScriptUnit* ScriptRuntime::getLoaded(const String& id)
 {
 	// First, search from unit map
@@ -2432,6 +2668,10 @@ void ScriptRuntime::onTick(const TimeEvent* evt)
 	_tickTime = evt->getTime();
 	_timeWait->signal(0x02);
 	updateTimeout(_tickTimeoutHeap, evt->getTime());
+
+	// release finished compile jobs
+	if (_compileJobs)
+		_compileJobs->update();
 }
 
 void ScriptRuntime::updateTimeout(TimeoutHeap& heap, float time)
@@ -300,6 +300,8 @@ public:
 ////////////////////////////////////////////////////////////////////////////////
 
 class ScriptDebugger;
+class ScriptCompileJob;
+class AsyncJobManager;
 
 class NIT_API ScriptRuntime : public RefCounted
 {
@@ -368,6 +370,11 @@ public:
 	const UnitMap&						allLoaded()								{ return _units; }
 	void								unloadUnitsFrom(const String& locatorPattern);
 
+public:									// background compilation
+	void								precompile(const String& unitName, StreamLocator* locator = NULL);
+	uint								getPrecompileCount()					{ return _precompiles.size(); }
+	bool								mergePrecompiled(HSQUIRRELVM v, const String& id);
+
 public:
 	void								weakAdd(WeakSupported* object);
 	void								weakRelease(WeakSupported* object);
@@ -400,6 +407,13 @@ public:
 	Ref<StreamLocator>					_locatorOverride;
 	Ref<StreamLocator>					_defaultLocator;
 
+private:
+	typedef map<String, Ref<ScriptCompileJob> >::type PrecompileMap;
+	PrecompileMap						_precompiles;
+	Ref<AsyncJobManager>				_compileJobs;
+
+	void								stopPrecompiles();
+
 public:
 	void								updateEventBindings();
 	void								registerScriptEventInfo(EventInfo* info);
@@ -33,6 +33,7 @@
 #include "CCKeypadDispatcher.h"
 #include "CCIMEDispatcher.h"
 #include "CCFont.h"
+#include "CCSpriteQueue.h"
 
 using namespace cocos2d;
 
@@ -943,6 +944,7 @@ public:
 			PROP_ENTRY	(debugSpriteBatch),
 			PROP_ENTRY	(debugLabel),
 			PROP_ENTRY	(debugClip),
+			PROP_ENTRY	(autoBatch),
 			NULL
 		};
 
@@ -959,6 +961,8 @@ public:
 			FUNC_ENTRY_H(stopAnimation,	"()"),
 			FUNC_ENTRY_H(startAnimation, "()"),
 			FUNC_ENTRY_H(purgeCachedData, "()"),
+			FUNC_ENTRY_H(getBatchStats,	"(): table // { quads, batches, flushes }"),
+			FUNC_ENTRY_H(resetBatchStats, "()"),
 			NULL
 		};
 
@@ -996,6 +1000,7 @@ public:
 	NB_PROP_GET(debugSpriteBatch)		{ return push(v, self(v)->GetDebugSpriteBatch()); }
 	NB_PROP_GET(debugLabel)				{ return push(v, self(v)->GetDebugLabel()); }
 	NB_PROP_GET(debugClip)				{ return push(v, self(v)->GetDebugClip()); }
+	NB_PROP_GET(autoBatch)				{ return push(v, self(v)->getSpriteQueue()->isEnabled()); }
 
 	NB_PROP_SET(displayFPS)				{ self(v)->setDisplayFPS(getBool(v, 2)); return 0; }
 	NB_PROP_SET(nextDeltaTimeZero)		{ self(v)->setNextDeltaTimeZero(getBool(v, 2)); return 0; }
@@ -1007,6 +1012,7 @@ public:
 	NB_PROP_SET(debugSpriteBatch)		{ self(v)->SetDebugSpriteBatch(getBool(v, 2)); return 0; }
 	NB_PROP_SET(debugLabel)				{ self(v)->SetDebugLabel(getBool(v, 2)); return 0; }
 	NB_PROP_SET(debugClip)				{ self(v)->SetDebugClip(getBool(v, 2)); return 0; }
+	NB_PROP_SET(autoBatch)				{ self(v)->getSpriteQueue()->setEnabled(getBool(v, 2)); return 0; }
 
 	NB_FUNC(toGl)						{ return push(v, self(v)->convertToGL(*get<CCPoint>(v, 2)));}
 	NB_FUNC(toUi)						{ return push(v, self(v)->convertToUI(*get<CCPoint>(v, 2))); }
@@ -1019,6 +1025,18 @@ public:
 	NB_FUNC(stopAnimation)				{ self(v)->stopAnimation(); return 0; }
 	NB_FUNC(startAnimation)				{ self(v)->startAnimation(); return 0; }
 	NB_FUNC(purgeCachedData)			{ self(v)->purgeCachedData(); return 0; }
+	NB_FUNC(resetBatchStats)			{ self(v)->getSpriteQueue()->resetStats(); return 0; }
+
+	NB_FUNC(getBatchStats)
+	{
+		const CCSpriteQueue::Stats& stats = self(v)->getSpriteQueue()->getStats();
+
+		sq_newtable(v);
+		newSlot(v, -1, "quads",			stats.quads);
+		newSlot(v, -1, "batches",		stats.batches);
+		newSlot(v, -1, "flushes",		stats.flushes);
+		return 1;
+	}
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,165 @@
+/// nit - Noriter Framework
+/// A Cross-platform Open Source Integration for Game-oriented Apps
+///
+/// http://www.github.com/ellongrey/nit
+///
+/// Copyright (c) 2013 by Jun-hyeok Jang
+/// 
+/// (see each file to see the different copyright owners)
+/// 
+/// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// Author: ellongrey
+
+#include "nitbundler_pch.h"
+
+#include "nitbundler/BuildCache.h"
+
+NS_BUNDLER_BEGIN;
+
+////////////////////////////////////////////////////////////////////////////////
+
+BuildCache::BuildCache(const String& dbPath)
+{
+	_db = Database::open(dbPath);
+
+	_db->exec("CREATE TABLE IF NOT EXISTS entries (key TEXT PRIMARY KEY, entry BLOB, payload BLOB, run INT)");
+	_db->exec("CREATE TABLE IF NOT EXISTS packs (name TEXT, file TEXT, signature TEXT, run INT, PRIMARY KEY (name, file))");
+
+	_select = _db->prepare("SELECT entry, payload FROM entries WHERE key=?");
+	_touch	= _db->prepare("UPDATE entries SET run=? WHERE key=?");
+	_insert	= _db->prepare("INSERT OR REPLACE INTO entries (key, entry, payload, run) VALUES (?, ?, ?, ?)");
+
+	_selectPack = _db->prepare("SELECT signature FROM packs WHERE name=? AND file=?");
+	_insertPack = _db->prepare("INSERT OR REPLACE INTO packs (name, file, signature, run) VALUES (?, ?, ?, ?)");
+
+	_runID		= Timestamp::now().getUnixTime64();
+	_hitCount	= 0;
+	_missCount	= 0;
+
+	// One transaction per build: sqlite would otherwise sync on every store
+	_db->exec("BEGIN");
+}
+
+void BuildCache::onDelete()
+{
+	if (_db)
+		_db->exec("COMMIT");
+
+	_select = NULL;
+	_touch = NULL;
+	_insert = NULL;
+	_selectPack = NULL;
+	_insertPack = NULL;
+	_db = NULL;
+
+	RefCounted::onDelete();
+}
+
+bool BuildCache::load(const String& key, PackArchive::FileEntry& outData, MemoryBuffer* outPayload)
+{
+	_select->reset();
+	_select->bind(1, key);
+
+	if (!_select->step())
+	{
+		++_missCount;
+		return false;
+	}
+
+	int entrySize = 0, payloadSize = 0;
+	const void* entry = _select->getBlob(0, &entrySize);
+	const void* payload = _select->getBlob(1, &payloadSize);
+
+	if (entrySize != sizeof(PackArchive::FileEntry))
+	{
+		// Written by an incompatible bundler: treat as miss
+		_select->reset();
+		++_missCount;
+		return false;
+	}
+
+	memcpy(&outData, entry, sizeof(outData));
+	if (payloadSize > 0)
+		outPayload->pushBack(payload, payloadSize);
+
+	_select->reset();
+
+	touch(key);
+
+	++_hitCount;
+	return true;
+}
+
+void BuildCache::store(const String& key, const PackArchive::FileEntry& data, MemoryBuffer* payload)
+{
+	PackArchive::FileEntry entry = data;
+	entry.offset = 0;
+
+	_insert->reset();
+	_insert->bind(1, key);
+	_insert->bindBlob(2, &entry, sizeof(entry));
+	if (payload->isEmpty())
+		_insert->bindZeroBlob(3, 0);
+	else
+		_insert->bind(3, Ref<MemoryBuffer>(payload));
+	_insert->bind(4, _runID);
+	_insert->exec();
+}
+
+bool BuildCache::touch(const String& key)
+{
+	_touch->reset();
+	_touch->bind(1, _runID);
+	_touch->bind(2, key);
+	return _touch->exec() > 0;
+}
+
+String BuildCache::loadPackSignature(const String& packName, const String& packfile)
+{
+	_selectPack->reset();
+	_selectPack->bind(1, packName);
+	_selectPack->bind(2, packfile);
+
+	String signature;
+	if (_selectPack->step())
+		_selectPack->getText(0, signature);
+
+	_selectPack->reset();
+	return signature;
+}
+
+void BuildCache::storePackSignature(const String& packName, const String& packfile, const String& signature)
+{
+	_insertPack->reset();
+	_insertPack->bind(1, packName);
+	_insertPack->bind(2, packfile);
+	_insertPack->bind(3, signature);
+	_insertPack->bind(4, _runID);
+	_insertPack->exec();
+}
+
+void BuildCache::purgeUntouched()
+{
+	_db->exec(StringUtil::format("DELETE FROM entries WHERE run <> %lld", _runID).c_str());
+	_db->exec(StringUtil::format("DELETE FROM packs WHERE run <> %lld", _runID).c_str());
+}
+
+void BuildCache::commit()
+{
+	_db->exec("COMMIT");
+	_db->exec("BEGIN");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+NS_BUNDLER_END;
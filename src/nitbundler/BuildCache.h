@@ -0,0 +1,77 @@
+/// nit - Noriter Framework
+/// A Cross-platform Open Source Integration for Game-oriented Apps
+///
+/// http://www.github.com/ellongrey/nit
+///
+/// Copyright (c) 2013 by Jun-hyeok Jang
+/// 
+/// (see each file to see the different copyright owners)
+/// 
+/// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// Author: ellongrey
+
+#pragma once
+
+#include "nitbundler/nitbundler.h"
+
+#include "nit/app/PackArchive.h"
+#include "nit/data/Database.h"
+
+NS_BUNDLER_BEGIN;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Persistent record of generated entries, so unchanged sources skip their handler on the next build.
+// Keys must cover everything that may affect the output (see Packer::EntryJob). Accessed from the main thread only.
+class NITBUNDLER_API BuildCache : public RefCounted
+{
+public:
+	BuildCache(const String& dbPath);
+
+public:
+	bool								load(const String& key, PackArchive::FileEntry& outData, MemoryBuffer* outPayload);
+	void								store(const String& key, const PackArchive::FileEntry& data, MemoryBuffer* payload);
+
+	// Marks a record as used by this build without loading it, false if not found
+	bool								touch(const String& key);
+
+	// Signature of the entries a pack file was last built from (see Packer::checkNeedBuild)
+	String								loadPackSignature(const String& packName, const String& packfile);
+	void								storePackSignature(const String& packName, const String& packfile, const String& signature);
+
+	// Drops records not touched since this cache was opened (call only after a full, unfiltered build)
+	void								purgeUntouched();
+
+	void								commit();
+
+	uint								getHitCount()							{ return _hitCount; }
+	uint								getMissCount()							{ return _missCount; }
+
+protected:
+	virtual void						onDelete();
+
+	Ref<Database>						_db;
+	Ref<Database::Query>				_select;
+	Ref<Database::Query>				_touch;
+	Ref<Database::Query>				_insert;
+	Ref<Database::Query>				_selectPack;
+	Ref<Database::Query>				_insertPack;
+
+	int64								_runID;
+	uint								_hitCount;
+	uint								_missCount;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+NS_BUNDLER_END;
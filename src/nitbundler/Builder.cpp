@@ -38,6 +38,7 @@ Builder::Builder(Settings* appCfg, Platform* platform, const String& buildTarget
 {
 	_appCfg		= appCfg;
 	_platform		= platform;
+	_scheduler	= new Scheduler();
 
 	_platformID	= platform->getPlatformID();
 	_buildTarget	= buildTarget;
@@ -71,6 +72,11 @@ Builder::Builder(Settings* appCfg, Platform* platform, const String& buildTarget
 	_outPath = new FileLocator("$out_path", outPath, false, true);
 	_outPath->load();
 
+	// Directory snapshots of pack sources: opt-in, as each pack holds an inotify instance while linked
+	String packSnapshot = _appCfg->get(_sectionName + "/pack_snapshot", "false", false);
+	packSnapshot = _appCfg->get(_platformSectionName + "/pack_snapshot", packSnapshot, false);
+	_packSnapshot = DataValue(packSnapshot).toBool();
+
 	// Setup dump_path
 	String dumpPath = StringUtil::format("%s/%s_dump", outPath.c_str(), buildTarget.c_str());
 
@@ -242,6 +248,21 @@ PackSource* Builder::getPack(const String& packname)
 	return itr != _packs.end() ? itr->second : NULL;
 }
 
+BuildCache* Builder::getBuildCache()
+{
+	if (_buildCache == NULL)
+	{
+		String packsPath = _outPath->makeUrl(StringUtil::format("%s_packs", _buildTarget.c_str()));
+		FileUtil::createDir(packsPath);
+
+		String dbPath = packsPath + "/build_cache.sqlite";
+		FileUtil::normalizeSeparator(dbPath);
+		_buildCache = new BuildCache(dbPath);
+	}
+
+	return _buildCache;
+}
+
 Builder::Job* Builder::newJob(const String& packFilter, const String& fileFilter, bool makeBundle)
 {
 	return new Job(this, packFilter, fileFilter, makeBundle);
@@ -25,6 +25,7 @@
 #include "nitbundler/nitbundler.h"
 
 #include "nitbundler/PackSource.h"
+#include "nitbundler/Scheduler.h"
 
 NS_BUNDLER_BEGIN;
 
@@ -49,6 +50,11 @@ public:
 	FileLocator*						getOutPath()							{ return _outPath; }
 	FileLocator*						getDumpPath()							{ return _dumpPath; }
 
+	BuildCache*							getBuildCache();
+	Scheduler*							getScheduler()							{ return _scheduler; }
+
+	bool								isPackSnapshot()						{ return _packSnapshot; }
+
 public:
 	typedef map<String, Ref<PackSource> >::type PackSources;
 
@@ -79,12 +85,16 @@ private:
 
 	Ref<FileLocator>					_outPath;
 	Ref<FileLocator>					_dumpPath;
+	Ref<BuildCache>						_buildCache;
+	Ref<Scheduler>						_scheduler;
 
 	String								_sectionName;
 	String								_platformSectionName;
 
 	StringVector						_packIgnoreFilters;
 
+	bool								_packSnapshot;
+
 	friend class PackSource;
 
 	void								collectPackLocators(Settings* section);
@@ -62,6 +62,10 @@ void Handler::setPayload(const String& payload)
 	{
 		_payloadType = PackArchive::PAYLOAD_ZLIB_FAST;
 	}
+	else if (payload == "zlib_chunked")
+	{
+		_payloadType = PackArchive::PAYLOAD_ZLIB_CHUNKED;
+	}
 	else
 	{
 		NIT_THROW_FMT(EX_NOT_SUPPORTED, 
@@ -121,7 +125,15 @@ void Handler::generate(StreamSource* source)
 		{
 		case PackArchive::PAYLOAD_ZLIB:
 		case PackArchive::PAYLOAD_ZLIB_FAST:
-			w = new ZStreamWriter(w, _payloadType == PackArchive::PAYLOAD_ZLIB_FAST); 
+			// Large entries deflate in parallel, small ones aren't worth holding a batch
+			if (srcSize >= PARALLEL_DEFLATE_THRESHOLD)
+				w = new ZParallelStreamWriter(w, _payloadType == PackArchive::PAYLOAD_ZLIB_FAST);
+			else
+				w = new ZStreamWriter(w, _payloadType == PackArchive::PAYLOAD_ZLIB_FAST); 
+			break;
+
+		case PackArchive::PAYLOAD_ZLIB_CHUNKED:
+			w = new ZChunkedStreamWriter(w);
 			break;
 		}
 	}
@@ -250,8 +262,236 @@ void DiffEntryHandler::generate()
 {
 	Ref<StreamWriter> w = _entry->getWriter();
 
-	// Copy original payload as is.
+	// Copy original payload as is, and its block hashes if any.
 	w->copy(_original->openPayload());
+
+	_original->loadBlockHashes(_entry->getBlockHashes());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Base blocks are indexed by an rsync-style rolling checksum, then the top is scanned byte by byte
+// and every verified block match is extended in both directions as far as the contents agree.
+static const size_t DELTA_BLOCK_SIZE = 32;
+
+static void CopyDeltaContent(MemoryBuffer* buf, vector<uint8>::type& outData)
+{
+	outData.resize(buf->getSize());
+	if (!outData.empty())
+		buf->copyTo(&outData[0], 0, outData.size());
+}
+
+static void LoadDeltaContent(StreamSource* source, vector<uint8>::type& outData)
+{
+	Ref<MemoryBuffer> buf = new MemoryBuffer(source->open());
+	CopyDeltaContent(buf, outData);
+}
+
+static inline uint32 DeltaChecksum(uint32 s1, uint32 s2)
+{
+	return (s1 & 0xFFFF) | (s2 << 16);
+}
+
+static void WriteDeltaVarint(MemoryBuffer* ops, size_t value)
+{
+	uint8 bytes[10];
+	size_t n = 0;
+
+	while (value >= 0x80)
+	{
+		bytes[n++] = uint8(value | 0x80);
+		value >>= 7;
+	}
+	bytes[n++] = uint8(value);
+
+	ops->pushBack(bytes, n);
+}
+
+static void WriteDeltaInsert(MemoryBuffer* ops, const uint8* data, size_t len)
+{
+	if (len == 0) return;
+
+	WriteDeltaVarint(ops, len << 1);
+	ops->pushBack(data, len);
+}
+
+static void WriteDeltaCopy(MemoryBuffer* ops, size_t offset, size_t len)
+{
+	WriteDeltaVarint(ops, (len << 1) | 1);
+	WriteDeltaVarint(ops, offset);
+}
+
+static size_t MatchForward(const uint8* a, const uint8* b, size_t maxLen)
+{
+	size_t len = 0;
+
+	while (len + DELTA_BLOCK_SIZE <= maxLen && memcmp(a + len, b + len, DELTA_BLOCK_SIZE) == 0)
+		len += DELTA_BLOCK_SIZE;
+
+	while (len < maxLen && a[len] == b[len])
+		++len;
+
+	return len;
+}
+
+static void EncodeDelta(const vector<uint8>::type& base, const vector<uint8>::type& top, MemoryBuffer* ops,
+						const vector<uint32>::type& baseHashes, const vector<uint32>::type& topHashes)
+{
+	// See PackArchive::applyDelta() for the op stream format
+	const size_t bs = DELTA_BLOCK_SIZE;
+	const size_t hbs = PackArchive::HASH_BLOCK_SIZE;
+	const size_t numSameHashes = std::min(baseHashes.size(), topHashes.size());
+
+	WriteDeltaVarint(ops, top.size());
+
+	if (top.empty())
+		return;
+
+	const uint8* t = &top[0];
+	size_t tn = top.size();
+
+	if (base.size() < bs || tn < bs)
+		return WriteDeltaInsert(ops, t, tn);
+
+	const uint8* b = &base[0];
+	size_t bn = base.size();
+
+	// Index the base on block boundaries (first occurrence wins)
+	typedef unordered_map<uint32, uint32>::type BlockIndex;
+	BlockIndex index;
+
+	for (size_t off = 0; off + bs <= bn; off += bs)
+	{
+		uint32 s1 = 0, s2 = 0;
+		for (size_t i = 0; i < bs; ++i) { s1 += b[off + i]; s2 += s1; }
+		index.insert(std::make_pair(DeltaChecksum(s1, s2), uint32(off)));
+	}
+
+	size_t litStart = 0;
+	size_t pos = 0;
+	uint32 s1 = 0, s2 = 0;
+	bool rolling = false;
+
+	while (pos + bs <= tn)
+	{
+		size_t boff = size_t(-1);
+
+		// An aligned block which the block hashes say unchanged is tried in place first
+		size_t hashIdx = pos / hbs;
+		if (pos % hbs == 0 && hashIdx < numSameHashes && baseHashes[hashIdx] == topHashes[hashIdx] && pos + bs <= bn)
+		{
+			if (memcmp(b + pos, t + pos, bs) == 0)
+				boff = pos;
+		}
+
+		if (boff == size_t(-1))
+		{
+			if (!rolling)
+			{
+				s1 = s2 = 0;
+				for (size_t i = 0; i < bs; ++i) { s1 += t[pos + i]; s2 += s1; }
+				rolling = true;
+			}
+
+			BlockIndex::iterator itr = index.find(DeltaChecksum(s1, s2));
+
+			if (itr != index.end() && memcmp(b + itr->second, t + pos, bs) == 0)
+				boff = itr->second;
+		}
+
+		if (boff != size_t(-1))
+		{
+			size_t start = pos;
+
+			// Extend backward over pending literals, then forward
+			while (start > litStart && boff > 0 && b[boff - 1] == t[start - 1]) { --start; --boff; }
+
+			size_t len = pos + bs - start;
+			len += MatchForward(b + boff + len, t + start + len, std::min(bn - boff, tn - start) - len);
+
+			WriteDeltaInsert(ops, t + litStart, start - litStart);
+			WriteDeltaCopy(ops, boff, len);
+
+			pos = litStart = start + len;
+			rolling = false;
+			continue;
+		}
+
+		if (pos + bs < tn)
+		{
+			uint32 out = t[pos];
+			s1 = s1 - out + t[pos + bs];
+			s2 = s2 - uint32(bs) * out + s1;
+		}
+
+		++pos;
+	}
+
+	WriteDeltaInsert(ops, t + litStart, tn - litStart);
+}
+
+Ref<MemoryBuffer> DeltaEntryHandler::encode(MemoryBuffer* base, MemoryBuffer* top)
+{
+	vector<uint8>::type b, t;
+	CopyDeltaContent(base, b);
+	CopyDeltaContent(top, t);
+
+	vector<uint32>::type baseHashes, topHashes;
+	PackArchive::calcBlockHashes(b.empty() ? NULL : &b[0], b.size(), baseHashes);
+	PackArchive::calcBlockHashes(t.empty() ? NULL : &t[0], t.size(), topHashes);
+
+	Ref<MemoryBuffer> ops = new MemoryBuffer();
+	EncodeDelta(b, t, ops, baseHashes, topHashes);
+	return ops;
+}
+
+void DeltaEntryHandler::generate()
+{
+	vector<uint8>::type base, top;
+	LoadDeltaContent(_base, base);
+	LoadDeltaContent(_original, top);
+
+	// Block hashes of both sides (when packed with them) point out the unchanged blocks
+	vector<uint32>::type baseHashes;
+	_base->loadBlockHashes(baseHashes);
+
+	vector<uint32>::type& topHashes = _entry->getBlockHashes();
+	if (!_original->loadBlockHashes(topHashes))
+		_entry->getData()->contentSize = PackArchive::calcBlockHashes(top.empty() ? NULL : &top[0], top.size(), topHashes);
+
+	Ref<MemoryBuffer> ops = new MemoryBuffer();
+	EncodeDelta(base, top, ops, baseHashes, topHashes);
+	ops->compress();
+
+	uint32 originalSize = getOriginalSize();
+
+	if (ops->getSize() >= originalSize)
+	{
+		LOG(0, "++ '%s: %s': delta %d bytes not smaller than %d bytes - copying original\n",
+			_entry->getPacker()->getName().c_str(),
+			_entry->getFilename().c_str(),
+			ops->getSize(), originalSize);
+
+		return DiffEntryHandler::generate();
+	}
+
+	PackArchive::FileEntry* data = _entry->getData();
+
+	data->payloadType	= PackArchive::PAYLOAD_DELTA;
+	data->payloadSize	= ops->getSize();
+	data->payloadCRC32	= 0; // Let the packer calculate
+	data->payloadParam0	= StreamUtil::calcCrc32(base.empty() ? NULL : &base[0], base.size());
+	data->payloadParam1	= StreamUtil::calcCrc32(top.empty() ? NULL : &top[0], top.size());
+
+	Ref<StreamWriter> w = _entry->getWriter();
+	ops->save(w);
+
+	_patchSize = data->payloadSize;
+
+	LOG(0, "++ '%s: %s': delta %d -> %d bytes\n",
+		_entry->getPacker()->getName().c_str(),
+		_entry->getFilename().c_str(),
+		originalSize, _patchSize);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -44,6 +44,16 @@ public:
 	virtual bool						prepare()								{ return true; }
 	virtual void						generate();
 
+public:									// Build cache support
+	// Bump when generate() changes its output for the same input, to invalidate cached results
+	virtual uint						getVersion()							{ return 1; }
+	// Every setting that affects generate() output
+	virtual String						getOptions()							{ return _payloadStr; }
+	virtual bool						isCacheable()							{ return true; }
+
+	// False if generate() may not run concurrently with another instance of the same class
+	virtual bool						isThreadSafe()							{ return true; }
+
 protected:
 	friend class Packer;
 	Weak<Packer::FileEntry>				_entry;
@@ -51,6 +61,9 @@ protected:
 	String								_payloadStr;
 	uint16								_payloadType;
 
+	// Entries from this size on are deflated by ZParallelStreamWriter
+	static const size_t					PARALLEL_DEFLATE_THRESHOLD = 1024 * 1024;
+
 	void								generate(StreamSource* source);
 };
 
@@ -77,6 +90,9 @@ class NITBUNDLER_API NitScriptHandler : public Handler
 public:
 	NitScriptHandler();
 
+public:
+	virtual String						getOptions()							{ return _payloadStr + (_compile ? "|nit" : ""); }
+
 protected:
 	virtual void						setCompile(const String& compile);
 	virtual void						generate();
@@ -91,6 +107,9 @@ class NITBUNDLER_API DiffEntryHandler : public Handler
 public:
 	DiffEntryHandler(PackArchive::File* original) : _original(original) { }
 
+public:
+	virtual bool						isCacheable()							{ return false; }
+
 protected:
 	virtual bool						prepare();
 	virtual void						generate();
@@ -101,8 +120,38 @@ protected:
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Writes a binary delta of a modified entry against its base entry (PAYLOAD_DELTA).
+// Falls back to copying the original payload when the delta isn't smaller.
+class NITBUNDLER_API DeltaEntryHandler : public DiffEntryHandler
+{
+public:
+	DeltaEntryHandler(PackArchive::File* original, PackArchive::File* base) : DiffEntryHandler(original), _base(base), _patchSize(0) { }
+
+public:
+	PackArchive::File*					getBase()								{ return _base; }
+	bool								isPatched()								{ return _patchSize > 0; }
+	uint32								getOriginalSize()						{ return _original->getEntry().payloadSize; }
+	uint32								getPatchSize()							{ return _patchSize; }
+
+public:
+	// Uncompressed op stream which PackArchive::decodeDelta() turns back into the top
+	static Ref<MemoryBuffer>			encode(MemoryBuffer* base, MemoryBuffer* top);
+
+protected:
+	virtual void						generate();
+
+protected:
+	Ref<PackArchive::File>				_base;
+	uint32								_patchSize;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
 class NITBUNDLER_API DeletedEntryHandler : public Handler
 {
+public:
+	virtual bool						isCacheable()							{ return false; }
+
 protected:
 	virtual bool						prepare();
 	virtual void						generate();
@@ -207,6 +207,61 @@ static void SharpenImageRGBA(PixelRGBA_8888* image, uint width, uint height, uin
 	NIT_DEALLOC(tempImage, tempSize);
 }
 
+static const char* ResampleFilterName(int filter)
+{
+	switch (filter)
+	{
+	case PixelConverter::FILTER_BOX:			return "box";
+	case PixelConverter::FILTER_BILINEAR:		return "bilinear";
+	case PixelConverter::FILTER_CATMULLROM:		return "catmullrom";
+	case PixelConverter::FILTER_KAISER:			return "kaiser";
+	default:									return "freeimage";
+	}
+}
+
+static FIBITMAP* ResampleBitmap(FIBITMAP* src, int dstWidth, int dstHeight, int filter, bool gammaCorrect)
+{
+	// filter < 0 : FreeImage catmull-rom (not gamma-correct)
+	if (filter < 0)
+		return FreeImage_Rescale(src, dstWidth, dstHeight, FILTER_CATMULLROM);
+
+	ASSERT_THROW(FreeImage_GetBPP(src) == 32, EX_NOT_SUPPORTED);
+
+	FIBITMAP* dst = FreeImage_Allocate(dstWidth, dstHeight, 32, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK);
+	if (dst == NULL)
+		return NULL;
+
+	// FreeImage is bottom-up with alpha at 4th byte - fine for a separable filter
+	PixelConverter::resample_8888(
+		FreeImage_GetBits(src), FreeImage_GetPitch(src), FreeImage_GetWidth(src), FreeImage_GetHeight(src),
+		FreeImage_GetBits(dst), FreeImage_GetPitch(dst), dstWidth, dstHeight,
+		PixelConverter::Filter(filter), gammaCorrect);
+
+	return dst;
+}
+
+static double CalcPsnr(FIBITMAP* a, FIBITMAP* b)
+{
+	int width = FreeImage_GetWidth(a);
+	int height = FreeImage_GetHeight(a);
+
+	double sum = 0.0;
+	for (int y = 0; y < height; ++y)
+	{
+		const uint8* pa = FreeImage_GetScanLine(a, y);
+		const uint8* pb = FreeImage_GetScanLine(b, y);
+
+		for (int x = 0; x < width * 4; ++x)
+		{
+			int d = int(pa[x]) - int(pb[x]);
+			sum += d * d;
+		}
+	}
+
+	double mse = sum / (double(width) * height * 4);
+	return mse > 0.0 ? 10.0 * log10(255.0 * 255.0 / mse) : 99.0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 class FI_IO
@@ -509,10 +564,18 @@ void ImageZen::process(Options& opt)
 	// Apply resizing
 	if (opt.width != width || opt.height != height)
 	{
-		LOG(0, ".. rescale (%d, %d) -> (%d, %d): '%s'\n", width, height, opt.width, opt.height, _source->getUrl().c_str());
+		LOG(0, ".. rescale (%d, %d) -> (%d, %d) %s: '%s'\n", width, height, opt.width, opt.height, ResampleFilterName(opt.resampleFilter), _source->getUrl().c_str());
+
+		if (opt.benchmark)
+			benchmarkRescale(opt.width, opt.height, opt.gammaCorrect);
+
 		width = opt.width;
 		height = opt.height;
-		rescale(width, height);
+
+		if (opt.resampleFilter >= 0)
+			resample(width, height, PixelConverter::Filter(opt.resampleFilter), opt.gammaCorrect);
+		else
+			rescale(width, height);
 	}
 
 	// Determine texture size by specified option
@@ -588,7 +651,18 @@ uint32 ImageZen::write(StreamWriter* w, Options& opt, StreamWriter* dumpFile)
 		NIT_THROW(EX_NOT_SUPPORTED);
 
 	pvrtexlib::PVRTextureUtilities& util = getPvrTexUtil();
-	pvrtexlib::CPVRTexture orig(width, height);
+
+	// Generate the mip chain by ourselves only for uncompressed formats:
+	// Runtime Image doesn't model minimum block sizes of compressed mip levels.
+	if (opt.makeMipmaps)
+	{
+		if (opt.format.isCompressed())
+			LOG(0, "?? '%s': mipmaps not supported for %s\n", _source->getUrl().c_str(), opt.format.getName().c_str());
+		else
+			mipmapCount = PixelConverter::calcMipCount(width, height);
+	}
+
+	pvrtexlib::CPVRTexture orig(width, height, mipmapCount - 1);
 
 	// Convert FIBITMAP to CPVRTexture
 	uint8* origData = orig.getData().getData();
@@ -604,24 +678,36 @@ uint32 ImageZen::write(StreamWriter* w, Options& opt, StreamWriter* dumpFile)
 		SharpenImageRGBA((PixelRGBA_8888*)origData, width, height, pitch);
 	}
 
-	SwapRGBA(orig.getData().getData(), width, height, pitch);
+	if (mipmapCount > 1)
+	{
+		ASSERT_THROW(pitch == width * 4, EX_INVALID_STATE);
+		ASSERT_THROW(orig.getData().getDataSize() == PixelConverter::calcMipChainSize(width, height, 4, mipmapCount), EX_INVALID_STATE);
+
+		// Filter premultiplied colors so that transparent texels don't bleed into lower levels
+		if (opt.format.isAlphaPremultiplied())
+			PixelConverter::premultiply_8888(origData, width * height);
+
+		LOG(0, ".. mipmaps x%d %s: '%s'\n", mipmapCount, ResampleFilterName(std::max(0, opt.resampleFilter)), _source->getUrl().c_str());
+		PixelConverter::buildMipChain_8888(origData, width, height, mipmapCount, 
+			PixelConverter::Filter(std::max(0, opt.resampleFilter)), opt.gammaCorrect);
+
+		PixelConverter::swapRB_8888(origData, orig.getData().getDataSize() / 4);
+	}
+	else
+	{
+		SwapRGBA(orig.getData().getData(), width, height, pitch);
+	}
 
 	pvrtexlib::CPVRTexture comp(orig.getHeader());
 	comp.setPixelType(pt);
 	comp.setAlpha(opt.format.hasAlpha());
+	comp.setMipMapCount(mipmapCount - 1);
 
 //	comp.setBorder(true); // TODO: We need pixelwise adjustment to Content-Left-Top-Right-Bottom
 
-	if (opt.makeMipmaps)
-	{
-		// TODO: mipmap Count
-		mipmapCount = 1;
-		comp.setMipMapCount(mipmapCount - 1); // TODO: Is this sufficient?
-	}
-
 	try
 	{
-		if (opt.format.isAlphaPremultiplied())
+		if (opt.format.isAlphaPremultiplied() && mipmapCount == 1)
 		{
 			// Apply alpha pre-multiplication
 			bool ok = util.ProcessRawPVR(orig, orig.getHeader(), false, 0, 0, 0, true);
@@ -695,6 +781,7 @@ uint32 ImageZen::write(StreamWriter* w, Options& opt, StreamWriter* dumpFile)
 		hdr.contentRight	= opt.width;
 		hdr.contentBottom	= opt.height;
 		hdr.mipmapCount		= mipmapCount;
+		hdr.flags			= opt.gammaCorrect ? Image::FLAG_SRGB : 0;
 
 		if (opt.flipEndian) hdr.flipEndian();
 
@@ -721,6 +808,44 @@ void ImageZen::rescale(int dstWidth, int dstHeight, FREE_IMAGE_FILTER filter)
 	_bitmap = rescaled;
 }
 
+void ImageZen::resample(int dstWidth, int dstHeight, PixelConverter::Filter filter, bool gammaCorrect)
+{
+	FIBITMAP* resampled = ResampleBitmap(_bitmap, dstWidth, dstHeight, filter, gammaCorrect);
+
+	if (resampled == NULL)
+		NIT_THROW(EX_SYSTEM);
+
+	FreeImage_Unload(_bitmap);
+	_bitmap = resampled;
+}
+
+void ImageZen::benchmarkRescale(int dstWidth, int dstHeight, bool gammaCorrect)
+{
+	// Compares FreeImage against nit resampler : time to rescale, and psnr after scaling back to the original size
+	int width = getWidth();
+	int height = getHeight();
+
+	for (int filter = -1; filter <= PixelConverter::FILTER_KAISER; ++filter)
+	{
+		double start = SystemTimer::now();
+		FIBITMAP* scaled = ResampleBitmap(_bitmap, dstWidth, dstHeight, filter, gammaCorrect);
+		double elapsed = SystemTimer::now() - start;
+
+		if (scaled == NULL) continue;
+
+		FIBITMAP* restored = ResampleBitmap(scaled, width, height, filter, gammaCorrect);
+
+		if (restored)
+		{
+			LOG(0, ".. benchmark %-10s (%d, %d) -> (%d, %d): %.2f ms, round-trip psnr %.2f dB: '%s'\n", 
+				ResampleFilterName(filter), width, height, dstWidth, dstHeight, elapsed * 1000.0, CalcPsnr(_bitmap, restored), _source->getUrl().c_str());
+			FreeImage_Unload(restored);
+		}
+
+		FreeImage_Unload(scaled);
+	}
+}
+
 void ImageZen::enlargeCanvas(int left, int top, int right, int bottom, uint32 color)
 {
 	FIBITMAP* enlarged = FreeImage_EnlargeCanvas(_bitmap, left, top, right, bottom, &color);
@@ -762,6 +887,8 @@ void ImageHandler::setCodec(const String& codec)
 
 	_options.minWidthHeight = 1;
 	_options.alignWidthHeight = 1;
+	_options.resampleFilter = -1;
+	_options.gammaCorrect = true;
 	_options.flipEndian = _entry->getPacker()->isBigEndian();
 
 	if (_codec == "png" || _codec == "jpeg" || _codec == "gif" || _codec == "pvr")
@@ -950,6 +1077,37 @@ void ImageHandler::generate()
 			{
 				_makeDump = true;
 			}
+			else if (token == "benchmark")
+			{
+				_options.benchmark = true;
+			}
+			else if (token == "linear")
+			{
+				// filter without sRGB -> linear conversion
+				_options.gammaCorrect = false;
+			}
+			else if (token == "resample")
+			{
+				// handle like 'resample kaiser'
+				String name = ++i < tokens.size() ? tokens[i] : StringUtil::BLANK();
+
+				if (name == "freeimage")			_options.resampleFilter = -1;
+				else if (name == "box")				_options.resampleFilter = PixelConverter::FILTER_BOX;
+				else if (name == "bilinear")		_options.resampleFilter = PixelConverter::FILTER_BILINEAR;
+				else if (name == "catmullrom")		_options.resampleFilter = PixelConverter::FILTER_CATMULLROM;
+				else if (name == "kaiser")			_options.resampleFilter = PixelConverter::FILTER_KAISER;
+				else bad = true;
+			}
+			else if (token == "budget")
+			{
+				// handle like 'budget 512' : in KB
+				int kb = ++i < tokens.size() ? atoi(tokens[i].c_str()) : 0;
+
+				if (kb <= 0)
+					bad = true;
+				else
+					_options.memoryBudget = kb * 1024;
+			}
 			else if (Wildcard::match("?*/?*", token))
 			{
 				// handle token like '1/2', '2/3'
@@ -1008,6 +1166,20 @@ void ImageHandler::generate()
 		}
 	}
 
+	if (_options.memoryBudget > 0)
+	{
+		// Halve until fits (estimated before pot / align enlargement)
+		int bpp = PixelFormat::calcBitsPerPixel(_options.format);
+		int halves = Image::calcBudgetReduction(_options.width, _options.height, bpp, _options.memoryBudget, _options.makeMipmaps);
+
+		if (halves > 0)
+		{
+			LOG(0, ".. '%s: %s': budget %d KB: halved %d times\n", _entry->getPacker()->getName().c_str(), _entry->getFilename().c_str(), _options.memoryBudget / 1024, halves);
+			_options.width = std::max(1, _options.width >> halves);
+			_options.height = std::max(1, _options.height >> halves);
+		}
+	}
+
 	Ref<MemoryBuffer::Writer> w = new MemoryBuffer::Writer();
 	Ref<StreamWriter> dumpFile;
 
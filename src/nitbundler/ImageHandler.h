@@ -52,6 +52,10 @@ public:
 		uint16							pivotX;
 		uint16							pivotY;
 		bool							flipEndian;
+		int								resampleFilter;		// PixelConverter::Filter, -1 for FreeImage catmull-rom
+		bool							gammaCorrect;
+		uint32							memoryBudget;		// 0 for unlimited
+		bool							benchmark;
 	};
 
 public:
@@ -70,6 +74,8 @@ public:
 	uint32								write(StreamWriter* w, Options& opt, StreamWriter* dumpFile = NULL);
 
 	void								rescale(int dstWidth, int dstHeight, FREE_IMAGE_FILTER filter = FILTER_CATMULLROM);
+	void								resample(int dstWidth, int dstHeight, PixelConverter::Filter filter, bool gammaCorrect = true);
+	void								benchmarkRescale(int dstWidth, int dstHeight, bool gammaCorrect = true);
 	void								enlargeCanvas(int left, int top, int right, int bottom, uint32 color = 0);
 	void								enlargeCanvas(int width, int height, uint32 color = 0);
 
@@ -98,6 +104,10 @@ class NITBUNDLER_API ImageHandler : public Handler
 public:
 	ImageHandler();
 
+public:
+	virtual String						getOptions()							{ return _payloadStr + "|" + _codec + "|" + _resize; }
+	virtual bool						isThreadSafe()							{ return false; } // FreeImage, PVRTexLib
+
 protected:
 	virtual void						setCodec(const String& codec);
 	virtual void						setPayload(const String& payload);
@@ -43,6 +43,8 @@ bool Builder::Job::onPrepare()
 {
 	LOG_TIMESCOPE(0, "++ Building '%s' revision %s", _builder->_appCfg->getName().c_str(), _builder->_revision.c_str());
 
+	_builder->_scheduler->beginBuild(g_Bundler->getJobManager()->getWorkerCount());
+
 	StreamSourceMap packCfgs;
 
 	for (PackSources::iterator itr = _builder->_packs.begin(), end = _builder->_packs.end(); itr != end; ++itr)
@@ -75,6 +77,8 @@ bool Builder::Job::onPrepare()
 
 		pack->executeCommands(packer);
 
+		packer->setBuildCache(_builder->getBuildCache());
+
 		packCfgs.insert(std::make_pair(pack->getName(), pack->getPackCfg()->getSource()));
 
 		enqueueSubJob(packer->newJob(_fileFilter));
@@ -112,6 +116,18 @@ void Builder::Job::onFinish()
 	// Wait if there're remaining pack jobs (by calling retry())
 	if (getSubJobCount() > 0)
 		return retry(true);
+
+	_builder->_scheduler->report();
+
+	BuildCache* cache = _builder->getBuildCache();
+
+	LOG(0, ".. build cache: %d reused, %d generated\n", cache->getHitCount(), cache->getMissCount());
+
+	// A filtered build didn't visit every entry, so only a full build may drop stale records
+	if (_packFilter == "*" && _fileFilter == "*")
+		cache->purgeUntouched();
+
+	cache->commit();
 }
 
 StreamSource* Builder::Job::getOutput()
@@ -254,6 +270,21 @@ Packer::Job::Job(Packer* packer, const String& fileFilter, bool rebuild, Ref<Str
 
 	_entryCount = 0;
 	_writeCount = 0;
+	_nextWrite = 0;
+
+	_skipped = false;
+	_signing = false;
+	_failed = false;
+}
+
+static bool entryNameLess(Packer::FileEntry* a, Packer::FileEntry* b)
+{
+	return a->getFilename() < b->getFilename();
+}
+
+static bool biggerFirst(const std::pair<size_t, Packer::EntryJob*>& a, const std::pair<size_t, Packer::EntryJob*>& b)
+{
+	return a.first > b.first;
 }
 
 bool Packer::Job::onPrepare()
@@ -275,24 +306,53 @@ bool Packer::Job::onPrepare()
 			_entries.push_back(&entry);
 	}
 
-	// TODO: Compare to existing old build and skip if not needed
+	// Fix the layout by name - hash map order may vary
+	std::sort(_entries.begin(), _entries.end(), entryNameLess);
+
+	BuildCache* cache = _rebuild ? NULL : _packer->_buildCache.get();
 
 	if (_packWriter == NULL)
 	{
-		if (_packer->_builder == NULL) NIT_THROW(EX_NULL);
-		_packWriter = _packer->_builder->getOutPath()->create(_packer->_filename);
+		FileLocator* outPath = _packer->getOutPath();
+		if (outPath == NULL) NIT_THROW(EX_NULL);
+
+		// Only a whole pack can be compared against the last build
+		bool whole = _fileFilter == "*";
+
+		if (cache && whole && !_packer->checkNeedBuild(_packer->_filename, _entries))
+		{
+			LOG(0, ".. Up to date: '%s'\n", _packer->getName().c_str());
+			_output = outPath->locate(_packer->_filename);
+			_skipped = true;
+			return true;
+		}
+
+		_packWriter = outPath->create(_packer->_filename);
+		_signing = whole && _packer->_buildCache;
 	}
 
 	// Prepare file generation
 	writeHeader();
 	writeDummyEntries();
 
-	// Enqueue async job for each entry
+	// Create a job for each entry
+	vector<std::pair<size_t, EntryJob*> >::type bySize;
+
 	for (EntryList::iterator itr = _entries.begin(), end = _entries.end(); itr != end; ++itr)
 	{
 		FileEntry* entry = *itr;
 
-		enqueueSubJob(new Packer::EntryJob(entry));
+		EntryJob* job = new Packer::EntryJob(entry, cache);
+		_entryJobs.push_back(job);
+		bySize.push_back(std::make_pair(entry->_source ? entry->_source->getStreamSize() : 0, job));
+	}
+
+	// Enqueue the biggest first so that no long job is left to run alone at the end
+	std::stable_sort(bySize.begin(), bySize.end(), biggerFirst);
+
+	for (uint i = 0; i < bySize.size(); ++i)
+	{
+		enqueueSubJob(bySize[i].second);
 		++_entryCount;
 	}
 
@@ -350,21 +410,43 @@ void Packer::Job::writeFileEntries()
 
 bool Packer::Job::onExecute(bool async)
 {
-	getMutex().lock();
-	list<Ref<EntryJob> >::type queue;
-	_writeQueue.swap(queue);
-	getMutex().unlock();
-
-	while (!queue.empty())
+	// Write finished entries in entry order, stopping at the first one still in progress.
+	// Runs on a worker: stick to raw pointers here, the refs are released on the main thread.
+	while (true)
 	{
-		Ref<EntryJob> job = queue.front();
-		queue.pop_front();
+		getMutex().lock();
+		EntryJob* job = _nextWrite < _entryJobs.size() && _entryJobs[_nextWrite]->_finished ? _entryJobs[_nextWrite].get() : NULL;
+		getMutex().unlock();
+
+		if (job == NULL) break;
+
+		PackArchive::FileEntry& data = job->getEntry()->_data;
 
 		// The position of current pack's writer points the entry's offset.
-		job->getEntry()->_data.offset = _packWriter->tell();
+		data.offset = _packWriter->tell();
 
-		// Write entry's content to the pack writer
-		job->getBuffer()->save(_packWriter);
+		if (job->getStatus() == JOB_SUCCESS)
+		{
+			// Write entry's content to the pack writer
+			job->getBuffer()->save(_packWriter);
+		}
+		else
+		{
+			LOG(0, "*** '%s: %s' failed - left empty\n", _packer->getName().c_str(), job->getEntry()->getFilename().c_str());
+			_failed = true;
+
+			// Whatever the handler filled in before failing doesn't describe anything in the pack
+			data.payloadType = PackArchive::PAYLOAD_VOID;
+			data.payloadSize = 0;
+			data.payloadCRC32 = 0;
+			data.blockHashCount = 0;
+		}
+
+		job->getBuffer()->clear();
+
+		getMutex().lock();
+		++_nextWrite;
+		getMutex().unlock();
 
 		++_writeCount;
 	}
@@ -377,10 +459,10 @@ void Packer::Job::onSubJobFinished(AsyncJob* subJob, Status status)
 {
 	EntryJob* job = dynamic_cast<EntryJob*>(subJob);
 
-	if (job && status == JOB_SUCCESS)
+	if (job)
 	{
 		getMutex().lock();
-		_writeQueue.push_back(job);
+		job->_finished = true;
 		getMutex().unlock();
 	}
 }
@@ -391,12 +473,22 @@ void Packer::Job::onFinish()
 	if (_writeCount < _entryCount)
 		return retry(true);
 
-	writeFileEntries();
+	if (!_skipped)
+	{
+		_entryJobs.clear();
+
+		writeFileEntries();
+
+		_output = _packWriter->getSource();
 
-	_output = _packWriter->getSource();
+		_packWriter->flush();
+		_packWriter = NULL;
+
+		// A pack with a failed entry has to build again next time
+		if (_signing && !_failed)
+			_packer->storeBuildSignature(_packer->_filename, _entries);
+	}
 
-	_packWriter->flush();
-	_packWriter = NULL;
 	_packer->_building = false;
 	_packer->_built = true;
 
@@ -407,34 +499,65 @@ void Packer::Job::onFinish()
 
 ////////////////////////////////////////////////////////////////////////////////
 
-Packer::EntryJob::EntryJob(FileEntry* entry)
+Packer::EntryJob::EntryJob(FileEntry* entry, BuildCache* cache)
 {
 	_entry = entry;
+	_cached = false;
+	_finished = false;
+
+	Packer* packer = entry->_packer;
+	if (packer->_builder)
+		_scheduler = packer->_builder->getScheduler();
+
+	if (cache && entry->_source && entry->_handler->isCacheable())
+		_cache = cache;
 }
 
 bool Packer::EntryJob::onPrepare()
 {
-	if (_entry->_source)
-	{
-		if (_entry->_data.sourceSize == 0)
-			_entry->_data.sourceSize = _entry->_source->getStreamSize();
-		if (_entry->_data.memorySize == 0)
-			_entry->_data.memorySize = _entry->_source->getMemorySize();
-	}
-
 	_writer = new MemoryBuffer::Writer();
 	_buffer = _writer->getBuffer();
 
 	_entry->_writer = _writer;
+	_entry->_blockHashes.clear();
+
+	if (_cache)
+	{
+		_cacheKey = _entry->_packer->makeCacheKey(_entry);
+
+		uint64 timestamp = _entry->_data.timestamp;
+		_cached = _cache->load(_cacheKey, _entry->_data, _buffer);
+		_entry->_data.timestamp = timestamp;
+	}
 
 	return true;
 }
 
 bool Packer::EntryJob::onExecute(bool async)
 {
+	// Payload and entry data restored from the build cache already
+	if (_cached)
+		return true;
+
 	// Tell the handler generate using the buffer
 	LOG(0, "-- Packing '%s: %s'\n", _entry->_packer->getName().c_str(), _entry->getFilename().c_str());
-	_entry->_handler->generate();
+
+	Handler* handler = _entry->_handler;
+	Mutex* lane = _scheduler ? _scheduler->getLane(handler) : NULL;
+
+	if (lane)
+	{
+		Mutex::ScopedLock lock(*lane);
+		double start = SystemTimer::now();
+		handler->generate();
+		_scheduler->entryDone(handler, SystemTimer::now() - start);
+	}
+	else
+	{
+		double start = SystemTimer::now();
+		handler->generate();
+		if (_scheduler) _scheduler->entryDone(handler, SystemTimer::now() - start);
+	}
 
 	// If handler specifies payload size, resize the buffer according to the size (if tried compression in vain)
 	if (_entry->_data.payloadSize != _buffer->getSize())
@@ -446,11 +569,63 @@ bool Packer::EntryJob::onExecute(bool async)
 	if (_entry->_data.payloadCRC32 == 0)
 		_entry->_data.payloadCRC32 = _buffer->calcCrc32();
 
+	appendBlockHashes();
+
 	return true;
 }
 
+void Packer::EntryJob::appendBlockHashes()
+{
+	PackArchive::FileEntry& data = _entry->_data;
+	vector<uint32>::type& hashes = _entry->_blockHashes;
+
+	if (hashes.empty())
+	{
+		Ref<MemoryBuffer> content;
+
+		switch (data.payloadType)
+		{
+		case PackArchive::PAYLOAD_RAW:
+			content = _buffer;
+			break;
+
+		case PackArchive::PAYLOAD_ZLIB:
+		case PackArchive::PAYLOAD_ZLIB_FAST:
+			content = _buffer->clone();
+			content->uncompress();
+			break;
+
+		case PackArchive::PAYLOAD_ZLIB_CHUNKED:
+			content = new MemoryBuffer(new ZChunkedStreamReader(new MemoryBuffer::Reader(_buffer, NULL)));
+			break;
+
+		default:
+			// Can't decode here, the handler should have filled them
+			data.blockHashCount = 0;
+			data.contentSize = 0;
+			return;
+		}
+
+		data.contentSize = PackArchive::calcBlockHashes(new MemoryBuffer::Reader(content, NULL), hashes);
+	}
+
+	// The table follows the payload
+	data.blockHashCount = hashes.size();
+
+	for (uint i = 0; i < hashes.size(); ++i)
+	{
+		uint32 hash = hashes[i];
+		if (_entry->_packer->_bigEndian)
+			StreamUtil::flipEndian(hash);
+		_buffer->pushBack(&hash, sizeof(hash));
+	}
+}
+
 void Packer::EntryJob::onFinish()
 {
+	if (_cache && !_cached && getStatus() == JOB_SUCCESS)
+		_cache->store(_cacheKey, _entry->_data, _buffer);
+
 	_entry->_writer = NULL;
 
 	_writer = NULL;
@@ -520,7 +695,7 @@ bool ZBundleBuildJob::onExecute(bool async)
 	Ref<CalcCRC32Writer> cw = new CalcCRC32Writer();
 	Ref<ShadowWriter> sw = new ShadowWriter(w, cw);
 
-	Ref<ZStreamWriter> zw = new ZStreamWriter(sw);
+	Ref<ZParallelStreamWriter> zw = new ZParallelStreamWriter(sw);
 	zw->copy(_bundle->open());
 
 	zw->finish();
@@ -587,6 +762,27 @@ static bool isDifferent(PackArchive::File* a, PackArchive::File* b, bool checkSt
 		return false;
 	}
 
+	// Identical payloads decode to identical contents: no need to touch them
+	if (a->getStreamSize()		== b->getStreamSize()		&&
+		a->getPayloadType()		== b->getPayloadType()		&&
+		a->getPayloadCRC32()	== b->getPayloadCRC32()		&&
+		a->getPayloadParam0()	== b->getPayloadParam0()	&&
+		a->getPayloadParam1()	== b->getPayloadParam1())
+		return false;
+
+	// Compare the block hashes if both packed with them, stopping at the first different block
+	if (a->getBlockHashCount() && b->getBlockHashCount())
+	{
+		if (a->getContentSize() != b->getContentSize())
+			return true;
+
+		vector<uint32>::type hashes_a, hashes_b;
+		a->loadBlockHashes(hashes_a);
+		b->loadBlockHashes(hashes_b);
+
+		return hashes_a != hashes_b;
+	}
+
 	// Start the file comparison.
 	uint8 buf_a[4096];
 	uint8 buf_b[4096];
@@ -665,7 +861,7 @@ void BundleDiffJob::testDiff(Package* basePack, Package* topPack, DiffResult& re
 
 		if (isDifferent(baseFile, topFile, checkStream))
 		{
-			result.insert(std::make_pair(topPack, DiffEntry(DiffEntry::MODIFIED, topFile)));
+			result.insert(std::make_pair(topPack, DiffEntry(DiffEntry::MODIFIED, topFile, baseFile)));
 			continue;
 		}
 	}
@@ -719,7 +915,7 @@ void BundleDiffJob::testDiff(PackBundle* baseBundle, PackBundle* topBundle, Diff
 
 		if (isDifferent(baseFile, topFile, checkStream))
 		{
-			result.insert(std::make_pair(topBundle, DiffEntry(DiffEntry::MODIFIED, topFile)));
+			result.insert(std::make_pair(topBundle, DiffEntry(DiffEntry::MODIFIED, topFile, baseFile)));
 			continue;
 		}
 	}
@@ -914,6 +1110,12 @@ void DeltaBuildJob::onSubJobFinished(AsyncJob* subJob, Status status)
 
 			if (entry.status == BundleDiffJob::DiffEntry::DELETED)
 				packer->assign(entry.file->getName(), NULL, new bundler::DeletedEntryHandler());
+			else if (entry.status == BundleDiffJob::DiffEntry::MODIFIED && entry.base)
+			{
+				Ref<bundler::DeltaEntryHandler> delta = new bundler::DeltaEntryHandler(entry.file, entry.base);
+				packer->assign(entry.file->getName(), NULL, delta);
+				_deltaHandlers.push_back(delta);
+			}
 			else
 				packer->assign(entry.file->getName(), NULL, new bundler::DiffEntryHandler(entry.file));
 		}
@@ -962,6 +1164,8 @@ void DeltaBuildJob::onSubJobFinished(AsyncJob* subJob, Status status)
 
 	if (subJob == _bundlePackJob)
 	{
+		reportDeltas();
+
 		Settings* topBundleCfg = _bundleDiffJob->getTopBundleCfg();
 		PackBundle::ZBundleInfo* topInfo = _bundleDiffJob->getTopInfo();
 
@@ -985,6 +1189,36 @@ void DeltaBuildJob::onSubJobFinished(AsyncJob* subJob, Status status)
 	}
 }
 
+void DeltaBuildJob::reportDeltas()
+{
+	if (_deltaHandlers.empty())
+		return;
+
+	uint numPatched = 0;
+	uint64 originalTotal = 0;
+	uint64 patchedTotal = 0;
+
+	for (uint i = 0; i < _deltaHandlers.size(); ++i)
+	{
+		bundler::DeltaEntryHandler* delta = _deltaHandlers[i];
+		originalTotal += delta->getOriginalSize();
+
+		if (delta->isPatched())
+		{
+			++numPatched;
+			patchedTotal += delta->getPatchSize();
+		}
+		else
+			patchedTotal += delta->getOriginalSize();
+	}
+
+	LOG(0, "++ delta: %d of %d modified entries patched, %lld -> %lld bytes (%.1f%% saved)\n",
+		numPatched, _deltaHandlers.size(), originalTotal, patchedTotal,
+		originalTotal ? 100.0 * (originalTotal - patchedTotal) / originalTotal : 0.0);
+
+	_deltaHandlers.clear();
+}
+
 void DeltaBuildJob::onFinish()
 {
 	if (getSubJobCount() > 0)
@@ -26,6 +26,7 @@
 
 #include "nitbundler/Builder.h"
 #include "nitbundler/Packer.h"
+#include "nitbundler/Handler.h"
 
 #include "nit/async/AsyncJob.h"
 
@@ -80,8 +81,8 @@ public:
 			DELETED,
 		};
 
-		DiffEntry(DiffStatus status, PackArchive::File* file)
-			: status(status), file(file)
+		DiffEntry(DiffStatus status, PackArchive::File* file, PackArchive::File* base = NULL)
+			: status(status), file(file), base(base)
 		{
 		}
 
@@ -98,6 +99,7 @@ public:
 
 		DiffStatus						status;
 		Ref<PackArchive::File>			file;
+		Ref<PackArchive::File>			base;			// base entry of a MODIFIED entry, if any
 	};
 
 	typedef multimap<Ref<StreamLocator>, DiffEntry>::type DiffResult;
@@ -156,6 +158,8 @@ protected:
 	virtual void						onSubJobFinished(AsyncJob* subJob, Status status);
 	virtual void						onFinish();
 
+	void								reportDeltas();
+
 	Ref<StreamSource>					_topZBundle;
 	Ref<StreamSource>					_baseZBundle;
 	Ref<Archive>						_outPath;
@@ -165,6 +169,7 @@ protected:
 	Ref<bundler::Packer>				_bundlePacker;
 
 	Ref<BundleDiffJob>					_bundleDiffJob;
+	vector<Ref<bundler::DeltaEntryHandler> >::type _deltaHandlers;
 	Ref<AsyncJob>						_bundlePackJob;
 	Ref<ZBundleBuildJob>				_zBundleBuildJob;
 };
@@ -230,6 +235,9 @@ public:
 	uint								getEntryCount()							{ return _entryCount; }
 	uint								getWriteCount()							{ return _writeCount; }
 
+	// True if the pack file was left as is: every entry hit the build cache under the same signature
+	bool								isSkipped()								{ return _skipped; }
+
 	StreamSource*						getOutput()								{ return _output; }
 
 protected:
@@ -244,11 +252,17 @@ protected:
 	bool								_rebuild;
 	EntryList							_entries;
 
-	list<Ref<EntryJob> >::type			_writeQueue;
+	// Indexed as _entries; written strictly in this order for deterministic output
+	vector<Ref<EntryJob> >::type		_entryJobs;
+	uint								_nextWrite;
 
 	uint								_entryCount;
 	uint								_writeCount;
 
+	bool								_skipped;
+	bool								_signing;
+	bool								_failed;
+
 	Ref<StreamSource>					_output;
 
 	void 								writeFileEntries();
@@ -261,21 +275,34 @@ protected:
 class Packer::EntryJob : public AsyncJob
 {
 public:
-	EntryJob(FileEntry* entry);
+	EntryJob(FileEntry* entry, BuildCache* cache);
 
 public:
 	FileEntry*							getEntry()								{ return _entry; }
 	MemoryBuffer*						getBuffer()								{ return _buffer; }
 
+	bool								isFinished()							{ return _finished; }
+
 protected:
 	virtual bool						onPrepare();
 	virtual bool						onExecute(bool async);
 	virtual void						onFinish();
 
+	void								appendBlockHashes();
+
 	Ref<MemoryBuffer::Writer>			_writer;
 	Ref<MemoryBuffer>					_buffer;
 
 	FileEntry*							_entry;
+
+	Ref<BuildCache>						_cache;
+	String								_cacheKey;
+	bool								_cached;
+
+	Ref<Scheduler>						_scheduler;
+	bool								_finished;						// set by Packer::Job under its mutex
+
+	friend class Packer::Job;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -53,6 +53,7 @@ public:
 
 			FUNC_ENTRY_H(Build,			"(appCfgFullPath: string, platformID: string, buildTarget: string): AsyncJob"),
 			FUNC_ENTRY_H(BuildDelta,	"(topZBundle: StreamSource, baseZBundle: StreamSource, outPath: Archive): AsyncJob"),
+			FUNC_ENTRY_H(EncodeDelta,	"[class] (base, top: MemoryBuffer): MemoryBuffer // uncompressed op stream, see PackArchive.decodeDelta()"),
 
 			FUNC_ENTRY_H(SvnRevision,	"[class] (path: string): string"),
 			FUNC_ENTRY_H(ExecuteHack,	"[class] (cmdline: string, timeout = 5000): string"),
@@ -83,6 +84,8 @@ public:
 	NB_FUNC(Build)						{ return push(v, self(v)->build(getString(v, 2), getString(v, 3), getString(v, 4))); }
 	NB_FUNC(BuildDelta)					{ return push(v, self(v)->buildDelta(get<StreamSource>(v, 2), get<StreamSource>(v, 3), get<Archive>(v, 4))); }
 
+	NB_FUNC(EncodeDelta)				{ return push(v, bundler::DeltaEntryHandler::encode(get<MemoryBuffer>(v, 2), get<MemoryBuffer>(v, 3)).get()); }
+
 	NB_FUNC(SvnRevision)				{ return push(v, type::svnRevision(getString(v, 2))); }
 	NB_FUNC(ExecuteHack)				{ return push(v, type::executeHack(getString(v, 2), optInt(v, 3, 5000))); }
 };
@@ -250,6 +253,42 @@ public:
 
 ////////////////////////////////////////////////////////////////////////////////
 
+NB_TYPE_REF(NITBUNDLER_API, nit::bundler::BuildCache, NULL, incRefCount, decRefCount);
+
+class NB_BundlerBuildCache : TNitClass<bundler::BuildCache>
+{
+public:
+	static void Register(HSQUIRRELVM v)
+	{
+		PropEntry props[] =
+		{
+			PROP_ENTRY_R(HitCount),
+			PROP_ENTRY_R(MissCount),
+			NULL
+		};
+
+		FuncEntry funcs[] =
+		{
+			CONS_ENTRY_H(				"(dbPath: string)"),
+			FUNC_ENTRY_H(PurgeUntouched,"() // after a full, unfiltered build only"),
+			FUNC_ENTRY_H(Commit,		"()"),
+			NULL
+		};
+
+		bind(v, props, funcs);
+	}
+
+	NB_PROP_GET(HitCount)				{ return push(v, self(v)->getHitCount()); }
+	NB_PROP_GET(MissCount)				{ return push(v, self(v)->getMissCount()); }
+
+	NB_CONS()							{ setSelf(v, new bundler::BuildCache(getString(v, 2))); return 0; }
+
+	NB_FUNC(PurgeUntouched)				{ self(v)->purgeUntouched(); return 0; }
+	NB_FUNC(Commit)						{ self(v)->commit(); return 0; }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
 NB_TYPE_REF(NITBUNDLER_API, nit::bundler::Packer, NULL, incRefCount, decRefCount);
 
 class NB_BundlerPacker : TNitClass<bundler::Packer>
@@ -259,16 +298,70 @@ public:
 	{
 		PropEntry props[] =
 		{
+			PROP_ENTRY_R(Name),
+			PROP_ENTRY_R(Filename),
+			PROP_ENTRY	(OutPath),
+			PROP_ENTRY	(BuildCache),
 			NULL
 		};
 
 		FuncEntry funcs[] =
 		{
+			CONS_ENTRY_H(				"(packName, filename: string, platformCode=0, bigEndian=false)"),
+			FUNC_ENTRY_H(Assign,		"(filename: string, source: StreamSource) // stored as is without a builder"),
+			FUNC_ENTRY_H(NewJob,		"(fileFilter=\"*\", rebuild=false): bundler.Packer.Job // enqueue to a job manager"),
 			NULL
 		};
 
 		bind(v, props, funcs);
 	}
+
+	NB_PROP_GET(Name)					{ return push(v, self(v)->getName()); }
+	NB_PROP_GET(Filename)				{ return push(v, self(v)->getFilename()); }
+	NB_PROP_GET(OutPath)				{ return push(v, self(v)->getOutPath()); }
+	NB_PROP_GET(BuildCache)				{ return push(v, self(v)->getBuildCache()); }
+
+	NB_PROP_SET(OutPath)				{ self(v)->setOutPath(opt<FileLocator>(v, 2, NULL)); return 0; }
+	NB_PROP_SET(BuildCache)				{ self(v)->setBuildCache(opt<bundler::BuildCache>(v, 2, NULL)); return 0; }
+
+	NB_CONS()							{ setSelf(v, new bundler::Packer(getString(v, 2), getString(v, 3), optInt(v, 4, 0), optBool(v, 5, false))); return 0; }
+
+	NB_FUNC(Assign)						{ self(v)->assign(getString(v, 2), get<StreamSource>(v, 3)); return 0; }
+	NB_FUNC(NewJob)						{ return push(v, self(v)->newJob(optString(v, 2, "*"), optBool(v, 3, false))); }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+NB_TYPE_REF(NITBUNDLER_API, nit::bundler::Packer::Job, AsyncJob, incRefCount, decRefCount);
+
+class NB_BundlerPackerJob : TNitClass<bundler::Packer::Job>
+{
+public:
+	static void Register(HSQUIRRELVM v)
+	{
+		PropEntry props[] =
+		{
+			PROP_ENTRY_R(PackName),
+			PROP_ENTRY_R(EntryCount),
+			PROP_ENTRY_R(WriteCount),
+			PROP_ENTRY_R(Skipped),
+			PROP_ENTRY_R(Output),
+			NULL
+		};
+
+		FuncEntry funcs[] =
+		{
+			NULL
+		};
+
+		bind(v, props, funcs);
+	}
+
+	NB_PROP_GET(PackName)				{ return push(v, self(v)->getPackName()); }
+	NB_PROP_GET(EntryCount)				{ return push(v, self(v)->getEntryCount()); }
+	NB_PROP_GET(WriteCount)				{ return push(v, self(v)->getWriteCount()); }
+	NB_PROP_GET(Skipped)				{ return push(v, self(v)->isSkipped()); }
+	NB_PROP_GET(Output)					{ return push(v, self(v)->getOutput()); }
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -357,7 +450,9 @@ NITBUNDLER_API SQRESULT NitLibBundler(HSQUIRRELVM v)
 	NB_BundlerPlatform::Register(v);
 	NB_BundlerBuilder::Register(v);
 	NB_BundlerPackSource::Register(v);
+	NB_BundlerBuildCache::Register(v);
 	NB_BundlerPacker::Register(v);
+	NB_BundlerPackerJob::Register(v);
 
 	NB_BundlerBuilderJob::Register(v);
 	NB_BundlerDeltaBuildJob::Register(v);
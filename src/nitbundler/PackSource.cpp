@@ -58,6 +58,10 @@ bool PackSource::link()
 		String filename, path;
 		StringUtil::splitFilename(_packCfg->getUrl(), filename, path);
 		_locator = new FileLocator(_name, path);
+
+		// scanned by many wildcard finds during a build (inotify hosts only)
+		if (_builder->isPackSnapshot() && FileLocator::isSnapshotSupported())
+			_locator->setSnapshotEnabled(true);
 	}
 
 	StringVector requires;
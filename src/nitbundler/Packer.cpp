@@ -41,6 +41,7 @@ void Packer::FileEntry::init(const String& filename, Packer* packer, StreamSourc
 	_writer		= NULL;
 
 	memset(&_data, 0, sizeof(_data));
+	_blockHashes.clear();
 
 	_entryOffset	= 0;
 	
@@ -94,6 +95,7 @@ void Packer::init(Builder* builder)
 		_platformCode	= builder->getPlatform()->getPlatformCode();
 		_bigEndian		= builder->getPlatform()->isBigEndian();
 		_dumpPath		= builder->getDumpPath();
+		_outPath		= builder->getOutPath();
 	}
 
 	_preparing		= false;
@@ -115,8 +117,8 @@ Handler* Packer::assign(const String& filename, StreamSource* source)
 	if (itr != _fileEntries.end())
 		NIT_THROW(EX_DUPLICATED);
 
-	if (_builder == NULL) NIT_THROW(EX_NULL);
-	Handler* handler = _builder->getPlatform()->NewHandler(StreamSource::getExtension(filename));
+	// Without a builder there's no platform to pick a handler: store the file as is
+	Handler* handler = _builder ? _builder->getPlatform()->NewHandler(StreamSource::getExtension(filename)) : new CopyHandler();
 
 	if (handler == NULL)
 		NIT_THROW(EX_NOT_SUPPORTED);
@@ -166,6 +168,11 @@ void Packer::prepare()
 
 			if (entry->_source)
 			{
+				if (entry->_data.sourceSize == 0)
+					entry->_data.sourceSize = entry->_source->getStreamSize();
+				if (entry->_data.memorySize == 0)
+					entry->_data.memorySize = entry->_source->getMemorySize();
+
 				if (entry->_data.timestamp == 0)
 					entry->_data.timestamp = entry->_source->getTimestamp().getUnixTime64();
 
@@ -178,9 +185,73 @@ void Packer::prepare()
 	_preparing = false;
 }
 
-bool Packer::checkNeedBuild(const String& packfile)
+String Packer::makeCacheKey(FileEntry* entry)
+{
+	// Key on everything that may affect the output: source content, handler class, version and options,
+	// target platform, the block hash layout and the entry's name (scripts embed it as debug info)
+	Handler* handler = entry->_handler;
+
+	return StringUtil::format("%08X:%08X:%s:%d:%s:%08X:%d:%X:%s:%s",
+		entry->_data.sourceCRC32,
+		entry->_data.sourceSize,
+		typeid(*handler).name(),
+		handler->getVersion(),
+		handler->getOptions().c_str(),
+		_platformCode,
+		_bigEndian ? 1 : 0,
+		PackArchive::HASH_BLOCK_SIZE,
+		_name.c_str(),
+		entry->getFilename().c_str());
+}
+
+String Packer::makeBuildSignature(const EntryList& entries)
+{
+	// The entry list in layout order: an added, removed or renamed entry changes it as well
+	String keys;
+
+	for (EntryList::const_iterator itr = entries.begin(), end = entries.end(); itr != end; ++itr)
+	{
+		keys += makeCacheKey(*itr);
+		keys += '\n';
+	}
+
+	return StringUtil::format("%08X:%d:%d", StreamUtil::calcCrc32(keys.c_str(), keys.size()), entries.size(), keys.size());
+}
+
+bool Packer::checkNeedBuild(const String& packfile, const EntryList& entries)
+{
+	if (_buildCache == NULL || _outPath == NULL)
+		return true;
+
+	if (!FileUtil::exists(_outPath->makeUrl(packfile)))
+		return true;
+
+	for (EntryList::const_iterator itr = entries.begin(), end = entries.end(); itr != end; ++itr)
+	{
+		FileEntry* entry = *itr;
+
+		if (entry->_source == NULL || !entry->_handler->isCacheable())
+			return true;
+
+		// Touch the entry record, so that purgeUntouched() keeps it for the next time the pack builds
+		if (!_buildCache->touch(makeCacheKey(entry)))
+			return true;
+	}
+
+	String signature = makeBuildSignature(entries);
+
+	if (_buildCache->loadPackSignature(_name, packfile) != signature)
+		return true;
+
+	// Rewrite to keep the record through purgeUntouched() as well
+	_buildCache->storePackSignature(_name, packfile, signature);
+	return false;
+}
+
+void Packer::storeBuildSignature(const String& packfile, const EntryList& entries)
 {
-	return true;
+	if (_buildCache)
+		_buildCache->storePackSignature(_name, packfile, makeBuildSignature(entries));
 }
 
 Packer::Job* Packer::newJob(const String& fileFilter, bool rebuild, Ref<StreamWriter> packWriter)
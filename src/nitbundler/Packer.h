@@ -24,6 +24,8 @@
 
 #include "nitbundler/nitbundler.h"
 
+#include "nitbundler/BuildCache.h"
+
 #include "nit/app/PackArchive.h"
 
 NS_BUNDLER_BEGIN;
@@ -45,6 +47,13 @@ public:
 	FileLocator*						getDumpPath()							{ return _dumpPath; }
 	bool								isBigEndian()							{ return _bigEndian; }
 
+	BuildCache*							getBuildCache()							{ return _buildCache; }
+	void								setBuildCache(BuildCache* cache)		{ _buildCache = cache; }
+
+	// Where newJob() creates the pack when no writer given - the builder's out path by default
+	FileLocator*						getOutPath()							{ return _outPath; }
+	void								setOutPath(FileLocator* outPath)		{ _outPath = outPath; }
+
 public:
 	class FileEntry;
 
@@ -74,6 +83,8 @@ protected:
 	Ref<Builder>						_builder;
 
 	Ref<FileLocator>					_dumpPath;
+	Ref<FileLocator>					_outPath;
+	Ref<BuildCache>						_buildCache;
 
 	bool								_preparing;
 	bool								_building;
@@ -86,7 +97,11 @@ protected:
 	void								init(Builder* builder);
 
 	void								prepare();
-	bool								checkNeedBuild(const String& packfile);
+
+	String								makeCacheKey(FileEntry* entry);
+	String								makeBuildSignature(const EntryList& entries);
+	bool								checkNeedBuild(const String& packfile, const EntryList& entries);
+	void								storeBuildSignature(const String& packfile, const EntryList& entries);
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -102,6 +117,9 @@ public:
 
 	PackArchive::FileEntry*				getData()								{ return &_data; }
 
+	// Block hashes of the content - a handler may fill them when it knows better, otherwise the packer computes them
+	vector<uint32>::type&				getBlockHashes()						{ return _blockHashes; }
+
 	bool								isPrepared()							{ return _prepared; }
 	bool								isDeletedMark()							{ return _deletedMark; }
 
@@ -121,6 +139,7 @@ private:
 	uint32								_entryOffset;
 
 	PackArchive::FileEntry				_data;
+	vector<uint32>::type				_blockHashes;
 
 	bool								_prepared;
 	bool								_deletedMark;	// for 'DELETED' marked files
@@ -28,6 +28,77 @@ NS_BUNDLER_BEGIN;
 
 ////////////////////////////////////////////////////////////////////////////////
 
+Scheduler::Scheduler()
+{
+	_numWorkers = 0;
+	_startTime = 0;
+}
+
+void Scheduler::onDelete()
+{
+	for (Lanes::iterator itr = _lanes.begin(), end = _lanes.end(); itr != end; ++itr)
+		delete itr->second;
+
+	_lanes.clear();
+
+	MTRefCounted::onDelete();
+}
+
+void Scheduler::beginBuild(uint numWorkers)
+{
+	Mutex::ScopedLock lock(_mutex);
+
+	_numWorkers = numWorkers;
+	_startTime = SystemTimer::now();
+	_stats.clear();
+}
+
+Mutex* Scheduler::getLane(Handler* handler)
+{
+	if (handler->isThreadSafe()) return NULL;
+
+	Mutex::ScopedLock lock(_mutex);
+
+	String name = typeid(*handler).name();
+
+	Lanes::iterator itr = _lanes.find(name);
+	if (itr != _lanes.end()) return itr->second;
+
+	Mutex* lane = new Mutex();
+	_lanes.insert(std::make_pair(name, lane));
+	return lane;
+}
+
+void Scheduler::entryDone(Handler* handler, double seconds)
+{
+	Mutex::ScopedLock lock(_mutex);
+
+	Stat& stat = _stats[typeid(*handler).name()];
+	++stat.count;
+	stat.seconds += seconds;
+}
+
+void Scheduler::report()
+{
+	Mutex::ScopedLock lock(_mutex);
+
+	double wall = SystemTimer::now() - _startTime;
+	double busy = 0;
+	uint count = 0;
+
+	for (Stats::iterator itr = _stats.begin(), end = _stats.end(); itr != end; ++itr)
+	{
+		const Stat& stat = itr->second;
+		LOG(0, ".. %-32s %6d entries %8.2f sec\n", itr->first.c_str(), stat.count, stat.seconds);
+		busy += stat.seconds;
+		count += stat.count;
+	}
+
+	// busy / wall estimates the gain over generating the same entries on one thread
+	LOG(0, ".. %d entries generated in %.2f sec wall, %.2f sec busy: x%.2f on %d workers\n",
+		count, wall, busy, wall > 0 ? busy / wall : 0.0, _numWorkers);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 NS_BUNDLER_END;
@@ -28,8 +28,42 @@ NS_BUNDLER_BEGIN;
 
 ////////////////////////////////////////////////////////////////////////////////
 
-class NITBUNDLER_API Scheduler : public WeakSupported
+// Coordinates EntryJobs of all packs in a Builder run on the bundler's worker pool.
+// Handlers that aren't thread-safe run one at a time per handler class; the rest run freely.
+// Packer::Job writes results in entry order, so output doesn't depend on the worker count.
+class NITBUNDLER_API Scheduler : public MTRefCounted
 {
+public:
+	Scheduler();
+
+public:
+	void								beginBuild(uint numWorkers);
+
+	// Returns the lock to hold while generating, or NULL if the handler is thread-safe
+	Mutex*								getLane(Handler* handler);
+
+	void								entryDone(Handler* handler, double seconds);
+
+	void								report();
+
+protected:
+	virtual void						onDelete();
+
+	struct Stat
+	{
+		uint							count;
+		double							seconds;
+	};
+
+	typedef map<String, Mutex*>::type	Lanes;
+	typedef map<String, Stat>::type		Stats;
+
+	Mutex								_mutex;
+	Lanes								_lanes;
+	Stats								_stats;
+
+	uint								_numWorkers;
+	double								_startTime;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
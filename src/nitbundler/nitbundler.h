@@ -48,7 +48,6 @@
 NS_NIT_BEGIN;
 
 class BundlerService;
-class Scheduler;
 class Job;
 
 NS_NIT_END;
@@ -63,6 +62,8 @@ class PackSource;
 class Packer;
 class Handler;
 class Command;
+class BuildCache;
+class Scheduler;
 
 NS_BUNDLER_END;
 
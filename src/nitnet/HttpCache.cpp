@@ -0,0 +1,304 @@
+/// nit - Noriter Framework
+/// A Cross-platform Open Source Integration for Game-oriented Apps
+///
+/// http://www.github.com/ellongrey/nit
+///
+/// Copyright (c) 2013 by Jun-hyeok Jang
+/// 
+/// (see each file to see the different copyright owners)
+/// 
+/// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// Author: ellongrey
+
+#include "nitnet_pch.h"
+
+#include "nitnet/HttpCache.h"
+#include "nitnet/HttpRequest.h"
+
+NS_NIT_BEGIN;
+
+////////////////////////////////////////////////////////////////////////////////
+
+HttpCache::HttpCache(const String& dbPath, size_t maxSize)
+{
+	_db = Database::open(dbPath);
+
+	_db->exec("CREATE TABLE IF NOT EXISTS responses ("
+		"url TEXT PRIMARY KEY, etag TEXT, last_modified TEXT, mime_type TEXT, "
+		"stored_at INT, expires_at INT, no_cache INT, size INT, used INT, body BLOB)");
+
+	_select		= _db->prepare("SELECT etag, last_modified, mime_type, stored_at, expires_at, no_cache, size FROM responses WHERE url=?");
+	_selectBody	= _db->prepare("SELECT body FROM responses WHERE url=?");
+	_touch		= _db->prepare("UPDATE responses SET used=? WHERE url=?");
+	_insert		= _db->prepare("INSERT OR REPLACE INTO responses "
+		"(url, etag, last_modified, mime_type, stored_at, expires_at, no_cache, size, used, body) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+	_update		= _db->prepare("UPDATE responses SET etag=?, last_modified=?, stored_at=?, expires_at=?, no_cache=? WHERE url=?");
+	_delete		= _db->prepare("DELETE FROM responses WHERE url=?");
+
+	Ref<Database::Query> sum = _db->prepare("SELECT SUM(size) FROM responses");
+	_totalSize = sum->step() ? size_t(sum->getInt64(0)) : 0;
+	sum->reset();
+
+	_maxSize = maxSize;
+	resetStats();
+}
+
+void HttpCache::onDelete()
+{
+	_select = NULL;
+	_selectBody = NULL;
+	_touch = NULL;
+	_insert = NULL;
+	_update = NULL;
+	_delete = NULL;
+	_db = NULL;
+
+	RefCounted::onDelete();
+}
+
+int64 HttpCache::now()
+{
+	return Timestamp::now().getUnixTime64() / Timestamp::SECOND;
+}
+
+static int64 ParseHttpDate(const String& str, int64 defaultValue)
+{
+	if (str.empty())
+		return defaultValue;
+
+	time_t t = curl_getdate(str.c_str(), NULL);
+	return t == -1 ? defaultValue : int64(t);
+}
+
+bool HttpCache::applyPolicy(Entry* entry, HttpResponse* response)
+{
+	String cc = response->getHeaderField("Cache-Control");
+	StringUtil::toLowerCase(cc);
+
+	if (cc.find("no-store") != cc.npos)
+		return false;
+
+	// Meant for one user only, or varies by request headers which the url key doesn't cover
+	if (cc.find("private") != cc.npos || !response->getHeaderField("Vary").empty())
+		return false;
+
+	String etag = response->getHeaderField("ETag");
+	String lastModified = response->getHeaderField("Last-Modified");
+
+	if (!etag.empty()) entry->etag = etag;
+	if (!lastModified.empty()) entry->lastModified = lastModified;
+
+	int64 now = HttpCache::now();
+	int64 date = ParseHttpDate(response->getHeaderField("Date"), now);
+
+	int64 lifetime = 0;
+	size_t maxAgePos = cc.find("max-age=");
+
+	if (maxAgePos != cc.npos)
+	{
+		lifetime = atol(cc.c_str() + maxAgePos + 8);
+	}
+	else
+	{
+		String expires = response->getHeaderField("Expires");
+
+		if (!expires.empty())
+			lifetime = ParseHttpDate(expires, 0) - date; // an invalid date means already expired
+		else if (!entry->lastModified.empty())
+			lifetime = std::min((date - ParseHttpDate(entry->lastModified, date)) / 10, MAX_HEURISTIC_AGE);
+	}
+
+	entry->noCache = cc.find("no-cache") != cc.npos;
+	entry->storedAt = now;
+	entry->expiresAt = now + std::max(lifetime, int64(0));
+
+	// An entry never fresh is of use only with a validator
+	return lifetime > 0 || entry->hasValidator();
+}
+
+HttpCache::Entry* HttpCache::lookup(const String& url)
+{
+	_select->reset();
+	_select->bind(1, url);
+
+	if (!_select->step())
+	{
+		_select->reset();
+		return NULL;
+	}
+
+	Entry* entry = new Entry();
+	entry->url = url;
+	_select->getText(0, entry->etag);
+	_select->getText(1, entry->lastModified);
+	_select->getText(2, entry->mimeType);
+	entry->storedAt		= _select->getInt64(3);
+	entry->expiresAt	= _select->getInt64(4);
+	entry->noCache		= _select->getInt(5) != 0;
+	entry->size			= size_t(_select->getInt64(6));
+
+	_select->reset();
+
+	_touch->reset();
+	_touch->bind(1, now());
+	_touch->bind(2, url);
+	_touch->exec();
+
+	return entry;
+}
+
+bool HttpCache::loadBody(Entry* entry, MemoryBuffer* outBody)
+{
+	_selectBody->reset();
+	_selectBody->bind(1, entry->url);
+
+	if (!_selectBody->step())
+	{
+		_selectBody->reset();
+		return false;
+	}
+
+	int size = 0;
+	const void* body = _selectBody->getBlob(0, &size);
+	if (size > 0)
+		outBody->pushBack(body, size);
+
+	_selectBody->reset();
+	return size_t(size) == entry->size;
+}
+
+void HttpCache::store(const String& url, HttpResponse* response)
+{
+	MemoryBuffer* body = response->getData();
+	size_t size = body ? body->getSize() : 0;
+
+	Ref<Entry> entry = new Entry();
+	entry->url = url;
+	entry->mimeType = response->getMimeType();
+	entry->size = size;
+
+	if (!applyPolicy(entry, response) || size > _maxSize / 4)
+	{
+		// Drop what we had: it's been replaced by a response we can't keep
+		remove(url);
+		return;
+	}
+
+	remove(url);
+
+	_insert->reset();
+	_insert->bind(1, url);
+	_insert->bind(2, entry->etag);
+	_insert->bind(3, entry->lastModified);
+	_insert->bind(4, entry->mimeType);
+	_insert->bind(5, entry->storedAt);
+	_insert->bind(6, entry->expiresAt);
+	_insert->bind(7, entry->noCache ? 1 : 0);
+	_insert->bind(8, int64(size));
+	_insert->bind(9, entry->storedAt);
+	if (size == 0)
+		_insert->bindZeroBlob(10, 0);
+	else
+		_insert->bind(10, Ref<MemoryBuffer>(body));
+	_insert->exec();
+
+	_totalSize += size;
+	++_stats.stored;
+
+	if (_totalSize > _maxSize)
+		evict();
+}
+
+void HttpCache::refresh(Entry* entry, HttpResponse* response)
+{
+	if (!applyPolicy(entry, response))
+	{
+		remove(entry->url);
+		return;
+	}
+
+	_update->reset();
+	_update->bind(1, entry->etag);
+	_update->bind(2, entry->lastModified);
+	_update->bind(3, entry->storedAt);
+	_update->bind(4, entry->expiresAt);
+	_update->bind(5, entry->noCache ? 1 : 0);
+	_update->bind(6, entry->url);
+	_update->exec();
+}
+
+void HttpCache::remove(const String& url)
+{
+	_select->reset();
+	_select->bind(1, url);
+
+	if (!_select->step())
+	{
+		_select->reset();
+		return;
+	}
+
+	size_t size = size_t(_select->getInt64(6));
+	_select->reset();
+
+	_delete->reset();
+	_delete->bind(1, url);
+	_delete->exec();
+
+	_totalSize -= std::min(size, _totalSize);
+}
+
+void HttpCache::clear()
+{
+	_db->exec("DELETE FROM responses");
+	_totalSize = 0;
+}
+
+void HttpCache::setMaxSize(size_t maxSize)
+{
+	_maxSize = maxSize;
+
+	if (_totalSize > _maxSize)
+		evict();
+}
+
+void HttpCache::evict()
+{
+	// Least recently used first, down to 3/4 of the limit so that evictions don't run on every store
+	size_t target = _maxSize / 4 * 3;
+
+	Ref<Database::Query> lru = _db->prepare("SELECT url, size FROM responses ORDER BY used ASC");
+	StringVector victims;
+
+	while (_totalSize > target && lru->step())
+	{
+		String url;
+		lru->getText(0, url);
+		victims.push_back(url);
+
+		_totalSize -= std::min(size_t(lru->getInt64(1)), _totalSize);
+	}
+
+	lru->reset();
+
+	for (uint i = 0; i < victims.size(); ++i)
+	{
+		_delete->reset();
+		_delete->bind(1, victims[i]);
+		_delete->exec();
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+NS_NIT_END;
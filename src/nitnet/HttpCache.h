@@ -0,0 +1,116 @@
+/// nit - Noriter Framework
+/// A Cross-platform Open Source Integration for Game-oriented Apps
+///
+/// http://www.github.com/ellongrey/nit
+///
+/// Copyright (c) 2013 by Jun-hyeok Jang
+/// 
+/// (see each file to see the different copyright owners)
+/// 
+/// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// Author: ellongrey
+
+#pragma once
+
+#include "nitnet/nitnet.h"
+
+#include "nit/data/Database.h"
+
+NS_NIT_BEGIN;
+
+////////////////////////////////////////////////////////////////////////////////
+
+class HttpResponse;
+
+// On-disk cache of GET responses which honors Cache-Control, Expires, ETag and Last-Modified.
+// Fresh entries are served without touching the network, stale ones with a validator get a conditional request.
+// Only responses received into memory are stored. Accessed from the main thread only.
+class NITNET_API HttpCache : public RefCounted
+{
+public:
+	HttpCache(const String& dbPath, size_t maxSize = DEFAULT_MAX_SIZE);
+
+	static const size_t					DEFAULT_MAX_SIZE = 16 * 1024 * 1024;
+	static const int64					MAX_HEURISTIC_AGE = 24 * 60 * 60;		// for responses with Last-Modified only
+
+public:
+	class Entry : public RefCounted
+	{
+	public:
+		String							url;
+		String							etag;
+		String							lastModified;
+		String							mimeType;
+		int64							storedAt;
+		int64							expiresAt;
+		bool							noCache;								// revalidate on every use
+		size_t							size;
+
+		bool							isFresh(int64 now)						{ return !noCache && now < expiresAt; }
+		bool							hasValidator()							{ return !etag.empty() || !lastModified.empty(); }
+	};
+
+	Entry*								lookup(const String& url);				// NULL if not cached
+	bool								loadBody(Entry* entry, MemoryBuffer* outBody);
+
+	void								store(const String& url, HttpResponse* response);	// ignored unless the response may be stored
+	void								refresh(Entry* entry, HttpResponse* response);		// updates freshness from a 304 response
+	void								remove(const String& url);
+	void								clear();
+
+	size_t								getTotalSize()							{ return _totalSize; }
+	size_t								getMaxSize()							{ return _maxSize; }
+	void								setMaxSize(size_t maxSize);
+
+	static int64						now();
+
+public:
+	struct Stats
+	{
+		uint							hits;									// served without network
+		uint							revalidated;							// served after a 304
+		uint							misses;									// transferred in full
+		uint							stored;
+		size_t							bytesFromCache;
+		size_t							bytesTransferred;						// bodies received by requests through this cache
+	};
+
+	const Stats&						getStats()								{ return _stats; }
+	void								resetStats()							{ memset(&_stats, 0, sizeof(_stats)); }
+
+protected:
+	virtual void						onDelete();
+
+	Ref<Database>						_db;
+	Ref<Database::Query>				_select;
+	Ref<Database::Query>				_selectBody;
+	Ref<Database::Query>				_touch;
+	Ref<Database::Query>				_insert;
+	Ref<Database::Query>				_update;
+	Ref<Database::Query>				_delete;
+
+	size_t								_totalSize;
+	size_t								_maxSize;
+	Stats								_stats;
+
+	friend class HttpRequest;
+
+	// Fills freshness and validators of 'entry' from the headers, false if the response must not be stored
+	static bool							applyPolicy(Entry* entry, HttpResponse* response);
+
+	void								evict();
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+NS_NIT_END;
@@ -0,0 +1,999 @@
+/// nit - Noriter Framework
+/// A Cross-platform Open Source Integration for Game-oriented Apps
+///
+/// http://www.github.com/ellongrey/nit
+///
+/// Copyright (c) 2013 by Jun-hyeok Jang
+/// 
+/// (see each file to see the different copyright owners)
+/// 
+/// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// Author: ellongrey
+
+#include "nitnet_pch.h"
+
+#include "nitnet/HttpDownload.h"
+#include "nitnet/NetService.h"
+
+#include "nit/app/AppBase.h"
+#include "nit/app/PackArchive.h"
+#include "nit/event/Timer.h"
+#include "nit/io/FileLocator.h"
+#include "nit/io/MemoryBuffer.h"
+
+NS_NIT_BEGIN;
+
+////////////////////////////////////////////////////////////////////////////////
+
+NIT_EVENT_DEFINE(NET_DOWNLOAD_DONE, HttpDownloadEvent);
+NIT_EVENT_DEFINE(NET_DOWNLOAD_ERROR, HttpDownloadEvent);
+
+////////////////////////////////////////////////////////////////////////////////
+
+// One ranged GET of a download. Reports back to the owner which decides what to fetch next.
+class HttpDownload::Segment : public URLRequest
+{
+public:
+	Segment(HttpDownload* owner, int rangeIndex, size_t from, size_t to, bool ranged)
+		: _owner(owner), _rangeIndex(rangeIndex), _from(from), _to(to), _ranged(ranged)
+	{
+		_url = owner->_url;
+		_headers = NULL;
+
+		_status = 0;
+		_contentStart = UNKNOWN_SIZE;
+		_contentTotal = UNKNOWN_SIZE;
+		_contentLength = UNKNOWN_SIZE;
+
+		_accepted = false;
+		_written = 0;
+	}
+
+	virtual const char*					getTypeName()							{ return "HttpDownload"; }
+
+	bool								fetch()									{ return doRequest(); }
+
+	String								getValidator()
+	{
+		// weak etags can't be used with If-Range
+		if (!_etag.empty() && !StringUtil::startsWith(_etag, "w/"))
+			return _etag;
+		return _lastModified;
+	}
+
+	Ref<HttpDownload>					_owner;									// released when the owner drops this segment
+	int									_rangeIndex;							// -1 while probing for the size
+	size_t								_from;
+	size_t								_to;									// inclusive, UNKNOWN_SIZE for open end
+	bool								_ranged;
+
+	long								_status;
+	size_t								_contentStart;
+	size_t								_contentTotal;
+	size_t								_contentLength;
+	String								_etag;
+	String								_lastModified;
+
+	bool								_accepted;
+	size_t								_written;
+
+protected:
+	String								_range;
+	curl_slist*							_headers;
+
+	virtual bool onStart(CURL* handle)
+	{
+		curl_easy_setopt(handle, CURLOPT_URL, _url.c_str());
+		curl_easy_setopt(handle, CURLOPT_HTTPGET, 1);
+		curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1);
+		curl_easy_setopt(handle, CURLOPT_FAILONERROR, 1);
+
+		// A stalled connection is dropped and the range retried from where it stopped
+		curl_easy_setopt(handle, CURLOPT_LOW_SPEED_LIMIT, 1);
+		curl_easy_setopt(handle, CURLOPT_LOW_SPEED_TIME, STALL_TIMEOUT);
+
+		if (!_ranged)
+			return true;
+
+		if (_to == UNKNOWN_SIZE)
+			_range = StringUtil::format("%lld-", int64(_from));
+		else
+			_range = StringUtil::format("%lld-%lld", int64(_from), int64(_to));
+
+		curl_easy_setopt(handle, CURLOPT_RANGE, _range.c_str());
+
+		// If the file changed since the validator, the server answers 200 with the whole new file
+		if (!_owner->_validator.empty())
+		{
+			_headers = curl_slist_append(_headers, (String("If-Range: ") + _owner->_validator).c_str());
+			curl_easy_setopt(handle, CURLOPT_HTTPHEADER, _headers);
+		}
+
+		return true;
+	}
+
+	virtual void onDone()
+	{
+		cleanup();
+		_owner->segmentDone(this, CURLE_OK);
+	}
+
+	virtual void onError(CURLcode err)
+	{
+		cleanup();
+		_owner->segmentDone(this, err);
+	}
+
+	virtual size_t onReceiveHeader(char* ptr, size_t size)
+	{
+		String line(ptr, size);
+		StringUtil::trim(line);
+
+		if (StringUtil::startsWith(line, "http/"))
+		{
+			// A new status line (after a redirect or 100-continue) discards what we had
+			size_t sp = line.find(' ');
+			_status = sp != line.npos ? atol(line.c_str() + sp + 1) : 0;
+			_contentStart = _contentTotal = _contentLength = UNKNOWN_SIZE;
+			_etag.clear();
+			_lastModified.clear();
+			return size;
+		}
+
+		size_t colon = line.find(':');
+		if (colon == line.npos)
+			return size;
+
+		String name = line.substr(0, colon);
+		String value = line.substr(colon + 1);
+		StringUtil::trim(name);
+		StringUtil::trim(value);
+		StringUtil::toLowerCase(name);
+
+		if (name == "content-range")
+		{
+			int64 first = 0, last = 0, total = 0;
+			int n = sscanf(value.c_str(), "bytes %lld-%lld/%lld", &first, &last, &total);
+			if (n >= 2) _contentStart = size_t(first);
+			if (n == 3) _contentTotal = size_t(total);
+		}
+		else if (name == "content-length")
+		{
+			int64 length = 0;
+			if (sscanf(value.c_str(), "%lld", &length) == 1)
+				_contentLength = size_t(length);
+		}
+		else if (name == "etag")
+			_etag = value;
+		else if (name == "last-modified")
+			_lastModified = value;
+
+		return size;
+	}
+
+	virtual size_t onReceiveData(char* ptr, size_t size)
+	{
+		if (!_accepted)
+		{
+			if (!_owner->acceptResponse(this))
+				return 0; // abort the transfer
+			_accepted = true;
+		}
+
+		return _owner->writeData(this, ptr, size);
+	}
+
+	void cleanup()
+	{
+		if (_headers)
+			curl_slist_free_all(_headers);
+		_headers = NULL;
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+HttpDownload::HttpDownload(const String& url, const String& path)
+{
+	_url = url;
+	_path = path;
+
+	String dir;
+	StringUtil::splitFilename(path, _partName, dir);
+	_stateName = _partName + ".dlstate";
+	_partName += ".part";
+
+	_locator = new FileLocator(dir.empty() ? "." : dir, false);
+
+	_segmentSize = DEFAULT_SEGMENT_SIZE;
+	_maxConnections = DEFAULT_MAX_CONNECTIONS;
+	_maxRetries = DEFAULT_MAX_RETRIES;
+	_packVerify = false;
+	_packParsed = false;
+
+	_totalSize = 0;
+	_rangeSupported = false;
+	_probeRetries = 0;
+	_restarts = 0;
+
+	_error = CURLE_OK;
+	_done = false;
+	_canceling = false;
+	_restartPending = false;
+	_verifyPending = false;
+	_stateDirty = false;
+	_startTime = 0.0;
+	_lastSaveTime = 0.0;
+
+	_tickHandler = createEventHandler(this, &HttpDownload::onTick);
+
+	resetStats();
+}
+
+void HttpDownload::setSegmentSize(size_t size)
+{
+	// keep segments to whole hash blocks, so a verify failure never drags in a neighbor needlessly
+	size_t block = PackArchive::HASH_BLOCK_SIZE;
+	_segmentSize = size < block ? block : size / block * block;
+}
+
+void HttpDownload::addCheck(size_t offset, size_t size, uint32 crc32)
+{
+	if (size == 0) return;
+
+	Check c = { offset, size, crc32, false };
+	_checks.push_back(c);
+}
+
+size_t HttpDownload::getReceivedSize()
+{
+	size_t received = 0;
+	for (uint i = 0; i < _ranges.size(); ++i)
+		received += _ranges[i].received;
+	return received;
+}
+
+float HttpDownload::getProgress()
+{
+	if (_done) return 1.0f;
+	if (_totalSize == 0) return 0.0f;
+	return float(double(getReceivedSize()) / _totalSize);
+}
+
+bool HttpDownload::start()
+{
+	if (isBusy()) return false;
+
+	_error = CURLE_OK;
+	_done = false;
+	_restartPending = false;
+	_probeRetries = 0;
+	_restarts = 0;
+	_packParsed = false;
+
+	for (uint i = 0; i < _checks.size(); ++i)
+		_checks[i].verified = false;
+
+	resetStats();
+
+	bool resumed = loadState();
+
+	if (!resumed)
+	{
+		_ranges.clear();
+		_totalSize = 0;
+		_validator.clear();
+		_rangeSupported = false;
+
+		if (exists(_partName))
+			_locator->remove(_partName);
+	}
+
+	openPart();
+
+	if (resumed)
+	{
+		_stats.bytesResumed = getReceivedSize();
+		_verifyPending = true;
+
+		LOG(0, ".. %s '%s' resuming: %d / %d bytes\n", "HttpDownload", _url.c_str(), _stats.bytesResumed, _totalSize);
+	}
+
+	_startTime = SystemTimer::now();
+	_lastSaveTime = _startTime;
+
+	_self = this;
+	g_App->getTimer()->channel()->bind(EVT::TICK, _tickHandler);
+
+	pump();
+
+	return true;
+}
+
+void HttpDownload::cancel()
+{
+	if (!isBusy()) return;
+
+	Ref<HttpDownload> safe = this;
+
+	cancelSegments();
+	saveState();
+	_writer = NULL;
+
+	g_App->getTimer()->channel()->unbind(0, _tickHandler);
+	_self = NULL;
+
+	LOG(0, "*** %s '%s' canceled at %d / %d bytes\n", "HttpDownload", _url.c_str(), getReceivedSize(), _totalSize);
+
+	_error = CURLE_ABORTED_BY_CALLBACK;
+
+	if (_scriptWaitBlock)
+		_scriptWaitBlock->signal(0x00);
+}
+
+void HttpDownload::discard()
+{
+	cancel();
+
+	if (exists(_partName))
+		_locator->remove(_partName);
+
+	if (exists(_stateName))
+		_locator->remove(_stateName);
+
+	_ranges.clear();
+	_totalSize = 0;
+	_validator.clear();
+}
+
+SQRESULT HttpDownload::wait(HSQUIRRELVM v)
+{
+	if (!isBusy() && !_done)
+		start();
+
+	if (!isBusy())
+		return NitBind::push(v, _done ? 1 : 0);
+
+	if (_scriptWaitBlock == NULL)
+		_scriptWaitBlock = new ScriptWaitBlock(ScriptRuntime::getRuntime(v));
+
+	return _scriptWaitBlock->wait(v, 0x01);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool HttpDownload::exists(const String& name)
+{
+	return FileUtil::exists(_locator->normalizePath(name));
+}
+
+void HttpDownload::openPart()
+{
+	if (!exists(_partName))
+		Ref<StreamWriter> created = _locator->create(_partName);
+
+	_writer = _locator->modify(_partName);
+}
+
+bool HttpDownload::loadState()
+{
+	if (!exists(_stateName) || !exists(_partName))
+		return false;
+
+	Ref<StreamSource> source = _locator->locateLocal(_stateName);
+	if (source == NULL)
+		return false;
+
+	Ref<StreamReader> reader = source->open();
+	Ref<MemoryBuffer> buf = new MemoryBuffer(reader);
+
+	StringVector lines = StringUtil::split(buf->toString(), "\r\n");
+
+	String url, validator;
+	int64 totalSize = -1;
+	int ranged = 0;
+	vector<Range>::type ranges;
+
+	for (uint i = 0; i < lines.size(); ++i)
+	{
+		const String& line = lines[i];
+		size_t sp = line.find(' ');
+		String key = line.substr(0, sp);
+		String value = sp != line.npos ? line.substr(sp + 1) : String();
+
+		if (key == "url")
+			url = value;
+		else if (key == "validator")
+			validator = value;
+		else if (key == "size")
+			sscanf(value.c_str(), "%lld", &totalSize);
+		else if (key == "ranged")
+			ranged = atoi(value.c_str());
+		else if (key == "range")
+		{
+			int64 begin = 0, end = 0, received = 0;
+			if (sscanf(value.c_str(), "%lld %lld %lld", &begin, &end, &received) != 3)
+				return false;
+
+			Range r = { size_t(begin), end < 0 ? UNKNOWN_SIZE : size_t(end), size_t(received), 0, false };
+			if (r.end != UNKNOWN_SIZE && (r.end < r.begin || r.received > r.getSize()))
+				return false;
+
+			ranges.push_back(r);
+		}
+	}
+
+	if (url != _url || totalSize < 0 || ranges.empty())
+	{
+		LOG(0, "*** %s '%s': state '%s' ignored\n", "HttpDownload", _url.c_str(), _stateName.c_str());
+		return false;
+	}
+
+	_totalSize = size_t(totalSize);
+	_validator = validator;
+	_rangeSupported = ranged != 0;
+	_ranges.swap(ranges);
+
+	return true;
+}
+
+void HttpDownload::saveState()
+{
+	if (_ranges.empty())
+		return;
+
+	// data must reach the file before the state claims it
+	if (_writer)
+		_writer->flush();
+
+	String text;
+	text += String("url ") + _url + "\n";
+	text += StringUtil::format("size %lld\n", int64(_totalSize));
+	text += StringUtil::format("ranged %d\n", _rangeSupported ? 1 : 0);
+	text += String("validator ") + _validator + "\n";
+
+	for (uint i = 0; i < _ranges.size(); ++i)
+	{
+		Range& r = _ranges[i];
+		int64 end = r.end == UNKNOWN_SIZE ? -1 : int64(r.end);
+		text += StringUtil::format("range %lld %lld %lld\n", int64(r.begin), end, int64(r.received));
+	}
+
+	// write aside and swap, so an interrupted save leaves the previous state
+	String tempName = _stateName + ".tmp";
+	Ref<StreamWriter> w = _locator->create(tempName);
+	w->write(text.c_str(), text.length());
+	w = NULL;
+
+	if (exists(_stateName))
+		_locator->remove(_stateName);
+	_locator->rename(tempName, _stateName);
+
+	_stateDirty = false;
+	_lastSaveTime = SystemTimer::now();
+}
+
+void HttpDownload::buildRanges(size_t totalSize)
+{
+	_ranges.clear();
+
+	for (size_t begin = 0; begin < totalSize; begin += _segmentSize)
+	{
+		size_t end = totalSize - begin > _segmentSize ? begin + _segmentSize : totalSize;
+		Range r = { begin, end, 0, 0, false };
+		_ranges.push_back(r);
+	}
+
+	if (_ranges.empty())
+	{
+		Range r = { 0, 0, 0, 0, false };
+		_ranges.push_back(r);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void HttpDownload::onTick(const TimeEvent* evt)
+{
+	Ref<HttpDownload> safe = this;
+
+	_stats.elapsed = float(SystemTimer::now() - _startTime);
+
+	// Segments only flag what happened: handles are added and removed here, outside of curl callbacks
+
+	if (_restartPending && _error == CURLE_OK)
+		restart();
+
+	if (_packVerify && !_packParsed && _error == CURLE_OK)
+		parsePack();
+
+	if (_verifyPending && _error == CURLE_OK)
+		verifyChecks();
+
+	if (_error != CURLE_OK)
+	{
+		finish(_error);
+		return;
+	}
+
+	bool complete = !_ranges.empty();
+	for (uint i = 0; complete && i < _ranges.size(); ++i)
+		complete = _ranges[i].isComplete();
+
+	if (complete && _segments.empty())
+	{
+		for (uint i = 0; i < _checks.size(); ++i)
+		{
+			if (_checks[i].verified) continue;
+
+			LOG(0, "*** %s '%s': check at %d (%d bytes) beyond the file size %d\n", "HttpDownload",
+				_url.c_str(), _checks[i].offset, _checks[i].size, _totalSize);
+			finish(CURLE_BAD_CONTENT_ENCODING);
+			return;
+		}
+
+		finish(CURLE_OK);
+		return;
+	}
+
+	pump();
+
+	if (_stateDirty && SystemTimer::now() - _lastSaveTime >= 1.0)
+		saveState();
+}
+
+void HttpDownload::pump()
+{
+	if (_ranges.empty())
+	{
+		// Ask for the first segment to learn the size, the validator and whether ranges work
+		if (_segments.empty())
+			launch(-1);
+		return;
+	}
+
+	for (uint i = 0; i < _ranges.size() && _segments.size() < _maxConnections; ++i)
+	{
+		Range& r = _ranges[i];
+		if (r.active || r.isComplete()) continue;
+
+		if (!_rangeSupported && !_segments.empty()) break;
+
+		launch(i);
+	}
+}
+
+bool HttpDownload::launch(int rangeIndex)
+{
+	size_t from = 0;
+	size_t to = _segmentSize - 1;
+
+	if (rangeIndex >= 0)
+	{
+		Range& r = _ranges[rangeIndex];
+
+		// Without range support we can only start over
+		if (!_rangeSupported && r.received > 0)
+		{
+			_stats.bytesDiscarded += r.received;
+			r.received = 0;
+		}
+
+		from = r.begin + r.received;
+		to = r.end == UNKNOWN_SIZE ? UNKNOWN_SIZE : r.end - 1;
+		r.active = true;
+	}
+
+	Ref<Segment> seg = new Segment(this, rangeIndex, from, to, rangeIndex < 0 || _rangeSupported);
+	_segments.push_back(seg);
+	++_stats.requests;
+
+	return seg->fetch();
+}
+
+void HttpDownload::cancelSegments()
+{
+	// cancel() reports back through segmentDone(): ignore while canceling
+	list<Ref<Segment> >::type segments;
+	segments.swap(_segments);
+
+	_canceling = true;
+	for (list<Ref<Segment> >::type::iterator itr = segments.begin(); itr != segments.end(); ++itr)
+		(*itr)->cancel(true);
+	_canceling = false;
+
+	for (uint i = 0; i < _ranges.size(); ++i)
+		_ranges[i].active = false;
+}
+
+void HttpDownload::restart()
+{
+	_restartPending = false;
+
+	cancelSegments();
+
+	if (_restarts >= MAX_RESTARTS)
+	{
+		LOG(0, "*** %s '%s': remote file keeps changing\n", "HttpDownload", _url.c_str());
+		_error = CURLE_RANGE_ERROR;
+		return;
+	}
+
+	LOG(0, "*** %s '%s': remote file changed, restarting\n", "HttpDownload", _url.c_str());
+
+	++_restarts;
+	++_stats.restarts;
+	_stats.bytesDiscarded += getReceivedSize();
+
+	_ranges.clear();
+	_totalSize = 0;
+	_validator.clear();
+	_rangeSupported = false;
+	_probeRetries = 0;
+	_packParsed = false;
+
+	for (uint i = 0; i < _checks.size(); ++i)
+		_checks[i].verified = false;
+
+	// truncate: the new file may be shorter
+	_writer = NULL;
+	_locator->remove(_partName);
+
+	if (exists(_stateName))
+		_locator->remove(_stateName);
+
+	openPart();
+}
+
+void HttpDownload::verifyChecks()
+{
+	_verifyPending = false;
+
+	Ref<File> file;
+
+	for (uint i = 0; i < _checks.size(); ++i)
+	{
+		Check& c = _checks[i];
+		if (c.verified) continue;
+
+		bool covered = false;
+		bool complete = true;
+
+		for (uint j = 0; complete && j < _ranges.size(); ++j)
+		{
+			Range& r = _ranges[j];
+			if (r.end <= c.offset || c.offset + c.size <= r.begin) continue;
+			covered = covered || r.end >= c.offset + c.size;
+			complete = r.isComplete();
+		}
+
+		if (!covered || !complete) continue;
+
+		if (file == NULL)
+		{
+			_writer->flush();
+			file = dynamic_cast<File*>(_locator->locateLocal(_partName));
+			if (file == NULL) return;
+		}
+
+		Ref<StreamReader> reader = file->openRange(c.offset, c.size);
+		uint32 crc32 = StreamUtil::calcCrc32(reader);
+
+		if (crc32 == c.crc32)
+		{
+			c.verified = true;
+			continue;
+		}
+
+		++_stats.verifyFailures;
+		LOG(0, "*** %s '%s': crc mismatch at %d (%d bytes), fetching again\n", "HttpDownload", _url.c_str(), c.offset, c.size);
+
+		for (uint j = 0; j < _ranges.size(); ++j)
+		{
+			Range& r = _ranges[j];
+			if (r.end <= c.offset || c.offset + c.size <= r.begin) continue;
+
+			_stats.bytesDiscarded += r.received;
+			r.received = 0;
+
+			if (++r.retries > _maxRetries)
+				_error = CURLE_BAD_CONTENT_ENCODING;
+		}
+
+		_stateDirty = true;
+	}
+}
+
+size_t HttpDownload::getCompletedPrefix()
+{
+	size_t prefix = 0;
+
+	for (uint i = 0; i < _ranges.size(); ++i)
+	{
+		Range& r = _ranges[i];
+		prefix = r.begin + r.received;
+		if (!r.isComplete()) break;
+	}
+
+	return prefix;
+}
+
+void HttpDownload::parsePack()
+{
+	// Entries are read from the contiguous prefix received so far: wait until the table arrives
+	size_t prefix = getCompletedPrefix();
+
+	if (prefix < sizeof(PackArchive::Header))
+		return;
+
+	_writer->flush();
+	Ref<File> file = dynamic_cast<File*>(_locator->locateLocal(_partName));
+	if (file == NULL) return;
+
+	Ref<StreamReader> reader = file->openRange(0, prefix);
+
+	PackArchive::Header header;
+	reader->read(&header, sizeof(header));
+
+	bool flip = header.signature == NIT_PACK_SIGNATURE_FLIP;
+	if (flip)
+		header.flipEndian();
+
+	if (header.signature != NIT_PACK_SIGNATURE)
+	{
+		LOG(0, "*** %s '%s': not a pack, pack verify skipped\n", "HttpDownload", _url.c_str());
+		_packParsed = true;
+		return;
+	}
+
+	size_t pos = sizeof(header) + header.extHeaderSize;
+	if (pos > prefix) return;
+	reader->skip(header.extHeaderSize);
+
+	vector<Check>::type checks;
+
+	for (uint i = 0; i < header.numFiles; ++i)
+	{
+		uint32 filenameLen = 0;
+		if (pos + sizeof(filenameLen) > prefix) return;
+		reader->read(&filenameLen, sizeof(filenameLen));
+		if (flip)
+			StreamUtil::flipEndian(filenameLen);
+
+		if (filenameLen >= MAX_PATH)
+		{
+			LOG(0, "*** %s '%s': corrupted pack entry table, pack verify skipped\n", "HttpDownload", _url.c_str());
+			_packParsed = true;
+			return;
+		}
+
+		pos += sizeof(filenameLen) + filenameLen;
+		if (pos + sizeof(PackArchive::FileEntry) > prefix) return;
+		reader->skip(filenameLen);
+
+		PackArchive::FileEntry entry;
+		reader->read(&entry, sizeof(entry));
+		if (flip)
+			entry.flipEndian();
+		pos += sizeof(entry);
+
+		if (entry.payloadSize == 0) continue;
+
+		Check c = { size_t(entry.offset), entry.payloadSize, entry.payloadCRC32, false };
+		checks.push_back(c);
+	}
+
+	_checks.insert(_checks.end(), checks.begin(), checks.end());
+	_packParsed = true;
+	_verifyPending = true;
+
+	LOG(0, ".. %s '%s': %d pack entries to verify\n", "HttpDownload", _url.c_str(), checks.size());
+}
+
+void HttpDownload::finish(CURLcode err)
+{
+	Ref<HttpDownload> safe = this;
+
+	cancelSegments();
+
+	if (err == CURLE_OK)
+	{
+		_writer = NULL;
+
+		String name;
+		String dir;
+		StringUtil::splitFilename(_path, name, dir);
+
+		if (exists(name))
+			_locator->remove(name);
+		_locator->rename(_partName, name);
+
+		if (exists(_stateName))
+			_locator->remove(_stateName);
+
+		_done = true;
+
+		LOG(0, ".. %s '%s' done: %d bytes in %.3f sec, %d requests, %d retries, %d verify failures\n", "HttpDownload",
+			_url.c_str(), _totalSize, _stats.elapsed, _stats.requests, _stats.retries, _stats.verifyFailures);
+	}
+	else
+	{
+		saveState();
+		_writer = NULL;
+
+		LOG(0, "*** %s '%s' failed: %s\n", "HttpDownload", _url.c_str(), curl_easy_strerror(err));
+	}
+
+	_error = err;
+
+	g_App->getTimer()->channel()->unbind(0, _tickHandler);
+	_self = NULL;
+
+	if (_channel)
+		_channel->send(err == CURLE_OK ? EVT::NET_DOWNLOAD_DONE : EVT::NET_DOWNLOAD_ERROR, new HttpDownloadEvent(this));
+
+	if (_scriptWaitBlock)
+		_scriptWaitBlock->signal(err == CURLE_OK ? 0x01 : 0x00);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool HttpDownload::acceptResponse(Segment* seg)
+{
+	bool partial = seg->_status == 206;
+
+	if (seg->_rangeIndex < 0)
+	{
+		if (partial && seg->_contentStart == 0 && seg->_contentTotal != UNKNOWN_SIZE)
+		{
+			_rangeSupported = true;
+			_totalSize = seg->_contentTotal;
+			buildRanges(_totalSize);
+		}
+		else if (seg->_status == 200)
+		{
+			// The whole file in one go
+			_rangeSupported = false;
+			_totalSize = seg->_contentLength != UNKNOWN_SIZE ? seg->_contentLength : 0;
+
+			Range r = { 0, seg->_contentLength, 0, 0, false };
+			_ranges.clear();
+			_ranges.push_back(r);
+		}
+		else
+		{
+			return false;
+		}
+
+		_validator = seg->getValidator();
+		seg->_rangeIndex = 0;
+		_ranges[0].active = true;
+		_stateDirty = true;
+		return true;
+	}
+
+	if (partial)
+	{
+		// A different total means a different file even when the validator didn't tell
+		if (seg->_contentTotal != UNKNOWN_SIZE && seg->_contentTotal != _totalSize)
+		{
+			_restartPending = true;
+			return false;
+		}
+
+		return seg->_contentStart == seg->_from;
+	}
+
+	if (seg->_status == 200)
+	{
+		if (!_rangeSupported)
+			return true;
+
+		// If-Range didn't match: the remote file changed since the state was saved
+		_restartPending = true;
+		return false;
+	}
+
+	return false;
+}
+
+size_t HttpDownload::writeData(Segment* seg, const char* data, size_t size)
+{
+	Range& r = _ranges[seg->_rangeIndex];
+
+	size_t pos = r.begin + r.received;
+	size_t len = size;
+
+	if (r.end != UNKNOWN_SIZE && len > r.end - pos)
+		len = r.end - pos;
+
+	if (len > 0)
+	{
+		_writer->seek(pos);
+		if (_writer->writeRaw(data, len) != len)
+			return 0;
+
+		r.received += len;
+		seg->_written += len;
+		_stats.bytesTransferred += len;
+		_stateDirty = true;
+	}
+
+	// More than asked for aborts the transfer, the range counts as complete anyway
+	return len == size ? size : 0;
+}
+
+void HttpDownload::segmentDone(Segment* seg, CURLcode err)
+{
+	Ref<Segment> safe = seg;
+
+	for (list<Ref<Segment> >::type::iterator itr = _segments.begin(); itr != _segments.end(); ++itr)
+	{
+		if (*itr == seg)
+		{
+			_segments.erase(itr);
+			break;
+		}
+	}
+
+	if (_canceling || _error != CURLE_OK)
+		return;
+
+	// An empty body never reaches onReceiveData()
+	if (err == CURLE_OK && !seg->_accepted)
+	{
+		seg->_accepted = acceptResponse(seg);
+		if (!seg->_accepted)
+			err = CURLE_RANGE_ERROR;
+	}
+
+	if (seg->_rangeIndex < 0)
+	{
+		++_stats.retries;
+		if (!_restartPending && ++_probeRetries > _maxRetries)
+			_error = err;
+		return;
+	}
+
+	Range& r = _ranges[seg->_rangeIndex];
+	r.active = false;
+
+	if (r.end == UNKNOWN_SIZE && err == CURLE_OK)
+	{
+		// No Content-Length: the size is known at the end
+		r.end = r.begin + r.received;
+		_totalSize = r.end;
+	}
+
+	if (r.isComplete())
+	{
+		_verifyPending = true;
+		saveState();
+		return;
+	}
+
+	if (_restartPending)
+		return;
+
+	if (seg->_written > 0)
+		r.retries = 0;
+
+	++_stats.retries;
+
+	if (++r.retries > _maxRetries)
+		_error = err != CURLE_OK ? err : CURLE_PARTIAL_FILE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+NS_NIT_END;
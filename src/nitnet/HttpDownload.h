@@ -0,0 +1,206 @@
+/// nit - Noriter Framework
+/// A Cross-platform Open Source Integration for Game-oriented Apps
+///
+/// http://www.github.com/ellongrey/nit
+///
+/// Copyright (c) 2013 by Jun-hyeok Jang
+/// 
+/// (see each file to see the different copyright owners)
+/// 
+/// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// Author: ellongrey
+
+#pragma once
+
+#include "nitnet/URLRequest.h"
+
+NS_NIT_BEGIN;
+
+////////////////////////////////////////////////////////////////////////////////
+
+class TimeEvent;
+class FileLocator;
+
+// Downloads a large file into 'path' as concurrent HTTP Range requests over NetService.
+// Data goes to '<path>.part' and progress to '<path>.dlstate' so start() resumes after cancel() or an app restart.
+// Each range is verified against crc32 checks (explicit or taken from the PackArchive entries of a pack file)
+// and fetched again on mismatch. Servers without range support fall back to a single restartable transfer.
+class NITNET_API HttpDownload : public RefCounted
+{
+public:
+	HttpDownload(const String& url, const String& path);
+
+	static const size_t					DEFAULT_SEGMENT_SIZE = 4 * 1024 * 1024;
+	static const uint					DEFAULT_MAX_CONNECTIONS = 4;
+	static const uint					DEFAULT_MAX_RETRIES = 5;				// per range, reset when a try made progress
+	static const uint					MAX_RESTARTS = 1;						// when the remote file changed while resuming
+	static const uint					STALL_TIMEOUT = 30;						// seconds without a byte before a range is retried
+
+public:
+	const String&						getUrl()								{ return _url; }
+	const String&						getPath()								{ return _path; }
+
+	size_t								getSegmentSize()						{ return _segmentSize; }
+	void								setSegmentSize(size_t size);			// applies to a fresh download only
+
+	uint								getMaxConnections()						{ return _maxConnections; }
+	void								setMaxConnections(uint count)			{ _maxConnections = count > 0 ? count : 1; }
+
+	uint								getMaxRetries()							{ return _maxRetries; }
+	void								setMaxRetries(uint count)				{ _maxRetries = count; }
+
+	void								addCheck(size_t offset, size_t size, uint32 crc32);
+	bool								isPackVerify()							{ return _packVerify; }
+	void								setPackVerify(bool flag)				{ _packVerify = flag; }	// verify payload crcs of each entry when 'path' is a pack
+
+public:
+	bool								start();								// resumes from the saved state if any
+	void								cancel();								// keeps the partial file and the state for resuming
+	void								discard();								// cancels and removes the partial file and the state
+
+	bool								isBusy()								{ return _self != NULL; }
+	bool								isDone()								{ return _done; }
+	bool								hasFailed()								{ return _error != CURLE_OK; }
+	int									getError()								{ return _error; }
+	const char*							getErrorString()						{ return curl_easy_strerror(_error); }
+
+	size_t								getTotalSize()							{ return _totalSize; }
+	size_t								getReceivedSize();
+	float								getProgress();
+	bool								isRangeSupported()						{ return _rangeSupported; }
+	uint								getNumActiveSegments()					{ return _segments.size(); }
+
+	EventChannel*						channel()								{ return _channel ? _channel : _channel = new EventChannel(); }
+	SQRESULT							wait(HSQUIRRELVM v);
+
+public:
+	struct Stats
+	{
+		size_t							bytesTransferred;						// written into the part file during this session
+		size_t							bytesResumed;							// already on disk when start() was called
+		size_t							bytesDiscarded;							// received then thrown away by a verify failure or restart
+		uint							requests;
+		uint							retries;
+		uint							restarts;
+		uint							verifyFailures;
+		float							elapsed;								// seconds since start()
+	};
+
+	const Stats&						getStats()								{ return _stats; }
+	void								resetStats()							{ memset(&_stats, 0, sizeof(_stats)); }
+
+private:
+	class Segment;
+	friend class Segment;
+
+	static const size_t					UNKNOWN_SIZE = size_t(-1);
+
+	struct Range
+	{
+		size_t							begin;
+		size_t							end;									// exclusive, UNKNOWN_SIZE when the server didn't tell
+		size_t							received;
+		uint							retries;
+		bool							active;
+
+		size_t							getSize()								{ return end - begin; }
+		bool							isComplete()							{ return end != UNKNOWN_SIZE && received == end - begin; }
+	};
+
+	struct Check
+	{
+		size_t							offset;
+		size_t							size;
+		uint32							crc32;
+		bool							verified;
+	};
+
+	String								_url;
+	String								_path;
+	String								_partName;
+	String								_stateName;
+	Ref<FileLocator>					_locator;
+	Ref<StreamWriter>					_writer;
+
+	size_t								_segmentSize;
+	uint								_maxConnections;
+	uint								_maxRetries;
+	bool								_packVerify;
+	bool								_packParsed;
+
+	size_t								_totalSize;
+	String								_validator;								// strong ETag or Last-Modified, sent as If-Range
+	bool								_rangeSupported;
+	uint								_probeRetries;
+	uint								_restarts;
+
+	vector<Range>::type					_ranges;
+	vector<Check>::type					_checks;
+	list<Ref<Segment> >::type			_segments;
+
+	Ref<HttpDownload>					_self;									// keeps alive while the tick handler is bound
+	Ref<EventHandler>					_tickHandler;
+	Ref<EventChannel>					_channel;
+	Ref<ScriptWaitBlock>				_scriptWaitBlock;
+
+	CURLcode							_error;
+	bool								_done;
+	bool								_canceling;
+	bool								_restartPending;
+	bool								_verifyPending;
+	bool								_stateDirty;
+	double								_startTime;
+	double								_lastSaveTime;
+
+	Stats								_stats;
+
+	bool								exists(const String& name);
+	void								openPart();
+	bool								loadState();
+	void								saveState();
+	void								buildRanges(size_t totalSize);
+
+	void								onTick(const TimeEvent* evt);
+	void								pump();
+	bool								launch(int rangeIndex);
+	void								cancelSegments();
+	void								restart();
+	void								verifyChecks();
+	void								parsePack();
+	size_t								getCompletedPrefix();
+	void								finish(CURLcode err);
+
+	bool								acceptResponse(Segment* seg);
+	size_t								writeData(Segment* seg, const char* data, size_t size);
+	void								segmentDone(Segment* seg, CURLcode err);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+class NITNET_API HttpDownloadEvent : public Event
+{
+public:
+	HttpDownloadEvent() { }
+	HttpDownloadEvent(HttpDownload* download) : download(download) { }
+
+	Ref<HttpDownload>					download;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+NIT_EVENT_DECLARE(NITNET_API, NET_DOWNLOAD_DONE, HttpDownloadEvent);
+NIT_EVENT_DECLARE(NITNET_API, NET_DOWNLOAD_ERROR, HttpDownloadEvent);
+
+////////////////////////////////////////////////////////////////////////////////
+
+NS_NIT_END;
@@ -23,6 +23,7 @@
 #include "nitnet_pch.h"
 
 #include "nitnet/HttpRequest.h"
+#include "nitnet/NetService.h"
 
 NS_NIT_BEGIN;
 
@@ -108,6 +109,7 @@ HttpRequest::HttpRequest(const String& url, bool encoded, bool setFields)
 	_requestType = HTTP_GET;
 	_multipartForm = NULL;
 	_headerSList = NULL;
+	_cacheEnabled = true;
 
 	_downloadProgress = 0.0f;
 	_uploadProgress = 0.0f;
@@ -249,6 +251,14 @@ void HttpRequest::setUserPassword(const String& pw)
 	_userPassword = pw;
 }
 
+void HttpRequest::setCacheEnabled(bool flag)
+{
+	if (_handle != NULL)
+		NIT_THROW_FMT(EX_INVALID_STATE, "%s '%s' already started", getTypeName(), _url.c_str());
+
+	_cacheEnabled = flag;
+}
+
 bool HttpRequest::onStart(CURL* handle)
 {
 	curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1);
@@ -265,18 +275,17 @@ bool HttpRequest::onStart(CURL* handle)
 		curl_easy_setopt(handle, CURLOPT_USERPWD, userIDPassword.c_str());
 	}
 
-	if (_header.length() > 0)
+	if (_headerSList)
 	{
-		if (_headerSList)
-		{
-			curl_slist_free_all(_headerSList);
-			_headerSList = NULL;
-		}
+		curl_slist_free_all(_headerSList);
+		_headerSList = NULL;
+	}
 
+	if (_header.length() > 0)
 		_headerSList = curl_slist_append( _headerSList, _header.c_str() );
-		if (_headerSList)
-			curl_easy_setopt(handle, CURLOPT_HTTPHEADER, _headerSList);
-	}
+
+	_cache = NULL;
+	_cacheEntry = NULL;
 
 	// TODO: Will a POST changed to a GET automatically when we reuse the handle?
 	if (_requestType == HTTP_GET)
@@ -290,6 +299,9 @@ bool HttpRequest::onStart(CURL* handle)
 			_url.append(_fields);
 		}
 		curl_easy_setopt(handle, CURLOPT_URL, _url.c_str());
+
+		if (serveFromCache())
+			return true;
 	}
 	else if (_requestType == HTTP_POST)
 	{
@@ -319,6 +331,9 @@ bool HttpRequest::onStart(CURL* handle)
 			curl_easy_setopt(handle, CURLOPT_READFUNCTION, multipartReadCallback);
 	}
 
+	if (_headerSList)
+		curl_easy_setopt(handle, CURLOPT_HTTPHEADER, _headerSList);
+
 	_downloadProgress = 0.0f;
 	_uploadProgress = 0.0f;
 
@@ -349,11 +364,94 @@ int HttpRequest::onProgress(double dltotal, double dlnow, double ultotal, double
 	return 0;
 }
 
+bool HttpRequest::serveFromCache()
+{
+	// Entries are keyed by url alone: a response which may depend on our credentials or
+	// custom header is neither served from the cache nor stored to it
+	bool anonymous = _userID.empty() && _userPassword.empty() && _header.empty();
+
+	_cache = _cacheEnabled && anonymous ? g_Net->getHttpCache() : NULL;
+	_cacheEntry = _cache ? _cache->lookup(_url) : NULL;
+
+	if (_cacheEntry == NULL)
+		return false;
+
+	if (_cacheEntry->isFresh(HttpCache::now()))
+	{
+		Ref<MemoryBuffer> body = new MemoryBuffer();
+
+		if (_cache->loadBody(_cacheEntry, body))
+		{
+			if (_response == NULL)
+				_response = new HttpResponse();
+
+			_response->cacheComplete(_cacheEntry, body, HttpResponse::CACHE_HIT);
+
+			++_cache->_stats.hits;
+			_cache->_stats.bytesFromCache += _cacheEntry->size;
+
+			// NetService completes us on the next tick without a transfer
+			_local = true;
+			return true;
+		}
+
+		_cache->remove(_url);
+		_cacheEntry = NULL;
+		return false;
+	}
+
+	// Stale: let the server tell whether our copy is still good
+	if (!_cacheEntry->etag.empty())
+		_headerSList = curl_slist_append(_headerSList, (String("If-None-Match: ") + _cacheEntry->etag).c_str());
+
+	if (!_cacheEntry->lastModified.empty())
+		_headerSList = curl_slist_append(_headerSList, (String("If-Modified-Since: ") + _cacheEntry->lastModified).c_str());
+
+	return false;
+}
+
+void HttpRequest::completeWithCache()
+{
+	long code = 0;
+	curl_easy_getinfo(_handle, CURLINFO_RESPONSE_CODE, &code);
+
+	double bytesReceived = 0;
+	curl_easy_getinfo(_handle, CURLINFO_SIZE_DOWNLOAD, &bytesReceived);
+	_cache->_stats.bytesTransferred += size_t(bytesReceived);
+
+	Ref<MemoryBuffer> body = new MemoryBuffer();
+
+	if (code == 304 && _cacheEntry && _cache->loadBody(_cacheEntry, body))
+	{
+		_cache->refresh(_cacheEntry, _response);
+		_response->cacheComplete(_cacheEntry, body, HttpResponse::CACHE_REVALIDATED);
+
+		++_cache->_stats.revalidated;
+		_cache->_stats.bytesFromCache += _cacheEntry->size;
+		return;
+	}
+
+	_response->requestComplete(_handle);
+	++_cache->_stats.misses;
+
+	if (code == 200 && _response->getData())
+		_cache->store(_url, _response);
+	else if (code == 304)
+		LOG(0, "*** %s '%s': 304 without a cached body\n", getTypeName(), _url.c_str());
+}
+
 void HttpRequest::onDone()
 {
-	if (_response)
+	if (_local)
+		; // completed at onStart()
+	else if (_response && _cache)
+		completeWithCache();
+	else if (_response)
 		_response->requestComplete(_handle);
 
+	_cache = NULL;
+	_cacheEntry = NULL;
+
 	if (_headerSList)
 	{
 		curl_slist_free_all(_headerSList);
@@ -364,6 +462,8 @@ void HttpRequest::onDone()
 void HttpRequest::onError(CURLcode err)
 {
 	_response = NULL;
+	_cache = NULL;
+	_cacheEntry = NULL;
 
 	if (_headerSList)
 	{
@@ -453,7 +553,49 @@ void HttpRequest::addMultipart(const String& name, StreamReader* reader, const S
 HttpResponse::HttpResponse()
 : StreamSource(NULL, "", ContentType::UNKNOWN)
 {
+	_code = 0;
+	_cacheResult = CACHE_NONE;
+}
 
+String HttpResponse::getHeaderField(const String& name)
+{
+	if (_header == NULL)
+		return StringUtil::BLANK();
+
+	String text = _header->toString();
+	String value;
+
+	size_t pos = 0;
+	while (pos < text.length())
+	{
+		size_t end = text.find('\n', pos);
+		if (end == text.npos) end = text.length();
+
+		String line = text.substr(pos, end - pos);
+		pos = end + 1;
+
+		StringUtil::trim(line);
+
+		// Redirects and '100 Continue' leave more than one header block: the last one counts
+		if (StringUtil::startsWith(line, "http/"))
+		{
+			value.clear();
+			continue;
+		}
+
+		size_t colon = line.find(':');
+		if (colon == line.npos || _strcmpi(line.substr(0, colon).c_str(), name.c_str()) != 0)
+			continue;
+
+		String fieldValue = line.substr(colon + 1);
+		StringUtil::trim(fieldValue);
+
+		if (!value.empty())
+			value.append(", ");
+		value.append(fieldValue);
+	}
+
+	return value;
 }
 
 size_t HttpResponse::receiveHeader(char* ptr, size_t size)
@@ -495,39 +637,8 @@ void HttpResponse::requestComplete(CURL* handle)
 		int urlLen = 0;
 		ptr = curl_easy_unescape(handle, ptr, 0, &urlLen);
 
-		String baseurl(ptr, urlLen);
-		_url = baseurl;
+		setEffectiveUrl(String(ptr, urlLen));
 		curl_free(ptr);
-
-		size_t qPos = baseurl.find_last_of('?');
-		if (qPos != baseurl.npos)
-		{
-			size_t split = baseurl.find_last_of('/', qPos);
-			if (split != baseurl.npos)
-			{
-				_name = baseurl.substr(split+1, qPos);
-				baseurl.resize(split);
-			}
-			else
-			{
-				_name = baseurl;
-				baseurl.clear();
-			}
-		}
-		else
-		{
-			size_t split = baseurl.find_last_of('/');
-			if (split != baseurl.npos)
-			{
-				_name = baseurl.substr(split+1);
-				baseurl.resize(split);
-			}
-			else
-			{
-				_name = baseurl;
-				baseurl.clear();
-			}
-		}
 	}
 
 	_timestamp = Timestamp::now();
@@ -550,6 +661,66 @@ void HttpResponse::requestComplete(CURL* handle)
 	}
 }
 
+void HttpResponse::cacheComplete(HttpCache::Entry* entry, MemoryBuffer* body, CacheResult result)
+{
+	if (_downloadWriter)
+	{
+		_downloadWriter->copy(new MemoryBuffer::Reader(body, NULL));
+		_downloadWriter = NULL; // release and may flush
+	}
+	else
+	{
+		_data = body;
+	}
+
+	setEffectiveUrl(entry->url);
+
+	_timestamp = Timestamp(entry->storedAt);
+	_code = 200;
+	_cacheResult = result;
+
+	if (!entry->mimeType.empty())
+		setMimeType(entry->mimeType);
+	else
+		setContentType(ContentType::fromStreamName(_name));
+}
+
+void HttpResponse::setEffectiveUrl(const String& url)
+{
+	String baseurl = url;
+	_url = baseurl;
+
+	size_t qPos = baseurl.find_last_of('?');
+	if (qPos != baseurl.npos)
+	{
+		size_t split = baseurl.find_last_of('/', qPos);
+		if (split != baseurl.npos)
+		{
+			_name = baseurl.substr(split+1, qPos);
+			baseurl.resize(split);
+		}
+		else
+		{
+			_name = baseurl;
+			baseurl.clear();
+		}
+	}
+	else
+	{
+		size_t split = baseurl.find_last_of('/');
+		if (split != baseurl.npos)
+		{
+			_name = baseurl.substr(split+1);
+			baseurl.resize(split);
+		}
+		else
+		{
+			_name = baseurl;
+			baseurl.clear();
+		}
+	}
+}
+
 StreamReader* HttpResponse::open()
 {
 	if (_data)
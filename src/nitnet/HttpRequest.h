@@ -23,6 +23,7 @@
 #pragma once
 
 #include "nitnet/URLRequest.h"
+#include "nitnet/HttpCache.h"
 
 NS_NIT_BEGIN;
 
@@ -58,6 +59,9 @@ public:
 	const String&						getUserPassword()						{ return _userPassword; }
 	void								setUserPassword(const String& pw);
 
+	bool								isCacheEnabled()						{ return _cacheEnabled; }
+	void								setCacheEnabled(bool flag);				// uses NetService's HttpCache for GET if any (default: true)
+
 	void								addFields(const String& fieldsStr, bool encoded = false);
 	void								addFields(const StringTable& fields, bool encoded = false);
 	void								addFields(HSQUIRRELVM v, SQInteger tableIdx, bool encoded = false);
@@ -107,6 +111,13 @@ protected:
 
 	struct curl_slist*					_headerSList;
 
+	bool								_cacheEnabled;
+	Ref<HttpCache>						_cache;
+	Ref<HttpCache::Entry>				_cacheEntry;
+
+	bool								serveFromCache();
+	void								completeWithCache();
+
 private:
 	static size_t						multipartReadCallback(char* buffer, size_t size, size_t nitems, void* entry);
 };
@@ -120,6 +131,13 @@ public:
 	MemoryBuffer*						getHeader()								{ return _header; }
 	MemoryBuffer*						getData()								{ return _data; }
 
+	String								getHeaderField(const String& name);		// of the final response when redirected, multiple fields joined by ','
+
+	enum CacheResult					{ CACHE_NONE, CACHE_HIT, CACHE_REVALIDATED };
+
+	CacheResult							getCacheResult()						{ return _cacheResult; }
+	bool								isFromCache()							{ return _cacheResult != CACHE_NONE; }
+
 public:									// StreamSource implementation
 	virtual size_t						getStreamSize()							{ return _data ? _data->getSize() : 0; }
 	virtual size_t						getMemorySize()							{ return _data ? _data->getSize() : 0; }
@@ -143,6 +161,7 @@ protected:
 	String								_url;
 	Timestamp							_timestamp;
 	String								_mimeType;
+	CacheResult							_cacheResult;
 
 private:
 	friend class HttpRequest;
@@ -150,6 +169,8 @@ private:
 	size_t								receiveHeader(char* ptr, size_t size);
 	size_t								receiveData(char* ptr, size_t size);
 	void								requestComplete(CURL* handle);
+	void								cacheComplete(HttpCache::Entry* entry, MemoryBuffer* body, CacheResult result);
+	void								setEffectiveUrl(const String& url);
 };
 
 ////////////////////////////////////////////////////////////////////////////////
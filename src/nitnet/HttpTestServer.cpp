@@ -0,0 +1,408 @@
+/// nit - Noriter Framework
+/// A Cross-platform Open Source Integration for Game-oriented Apps
+///
+/// http://www.github.com/ellongrey/nit
+///
+/// Copyright (c) 2013 by Jun-hyeok Jang
+/// 
+/// (see each file to see the different copyright owners)
+/// 
+/// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// Author: ellongrey
+
+#include "nitnet_pch.h"
+
+#include "nitnet/HttpTestServer.h"
+
+#if defined(NIT_TESTS)
+
+#include "nit/app/AppBase.h"
+#include "nit/event/Timer.h"
+#include "nit/io/MemoryBuffer.h"
+
+NS_NIT_BEGIN;
+
+////////////////////////////////////////////////////////////////////////////////
+
+HttpTestServer::HttpTestServer()
+{
+	_server = new TcpSocketServer(this);
+
+	_throttle = 0;
+	_budget = 0.0;
+	_dropAfter = 0;
+	_dropsLeft = 0;
+
+	_tickHandler = createEventHandler(this, &HttpTestServer::onTick);
+
+	resetStats();
+}
+
+void HttpTestServer::onDelete()
+{
+	shutdown();
+}
+
+bool HttpTestServer::listen(uint16 port)
+{
+	if (!_server->listen(port))
+		return false;
+
+	if (_self == NULL)
+	{
+		_self = this;
+		g_App->getTimer()->channel()->bind(EVT::TICK, _tickHandler);
+	}
+
+	return true;
+}
+
+void HttpTestServer::shutdown()
+{
+	_server->shutdown();
+	_connections.clear();
+
+	if (_self)
+	{
+		Ref<HttpTestServer> safe = this;
+
+		g_App->getTimer()->channel()->unbind(0, _tickHandler);
+		_self = NULL;
+	}
+}
+
+String HttpTestServer::getUrl(const String& path)
+{
+	return StringUtil::format("http://127.0.0.1:%d%s", (int)getPort(), path.c_str());
+}
+
+void HttpTestServer::setResource(const String& path, MemoryBuffer* body, const String& etag, const String& lastModified, const String& cacheControl)
+{
+	Resource& res = _resources[path];
+
+	res.body = body ? body : new MemoryBuffer();
+	res.etag = etag;
+	res.lastModified = lastModified;
+	res.cacheControl = cacheControl;
+	res.fields.clear();
+}
+
+void HttpTestServer::removeResource(const String& path)
+{
+	_resources.erase(path);
+}
+
+void HttpTestServer::addResourceField(const String& path, const String& field)
+{
+	Resources::iterator itr = _resources.find(path);
+
+	if (itr == _resources.end())
+		NIT_THROW_FMT(EX_NOT_FOUND, "no resource '%s'", path.c_str());
+
+	itr->second.fields.push_back(field);
+}
+
+void HttpTestServer::setDropAfter(size_t bodyBytes, uint times)
+{
+	_dropAfter = bodyBytes;
+	_dropsLeft = times;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TcpSocket* HttpTestServer::onAccept(TcpSocketServer* server, int socketHandle, const String& peerAddr, uint16 peerPort)
+{
+	TcpSocket* socket = new TcpSocket(this, socketHandle, peerAddr, peerPort);
+
+	_connections[socket].closing = false;
+
+	return socket;
+}
+
+void HttpTestServer::onDisconnected(TcpSocketServer* server, TcpSocket* client)
+{
+	_connections.erase(client);
+}
+
+bool HttpTestServer::onRecv(TcpSocket* socket)
+{
+	Connections::iterator itr = _connections.find(socket);
+	if (itr == _connections.end()) return false;
+
+	Connection& conn = itr->second;
+	MemoryBuffer* buf = socket->getRecvBuf();
+
+	if (!buf->isEmpty())
+	{
+		conn.request += buf->toString(0, buf->getSize());
+		buf->popFront(buf->getSize());
+	}
+
+	// GET and HEAD only: a request ends with its header
+	size_t end;
+	while ((end = conn.request.find("\r\n\r\n")) != conn.request.npos)
+	{
+		String head = conn.request.substr(0, end);
+		conn.request.erase(0, end + 4);
+
+		handle(conn, head);
+	}
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void HttpTestServer::handle(Connection& conn, const String& head)
+{
+	++_stats.requests;
+
+	StringVector lines = StringUtil::split(head, "\r\n");
+	StringVector requestLine = lines.empty() ? StringVector() : StringUtil::split(lines[0], " ");
+
+	typedef map<String, String>::type Fields;
+	Fields fields;
+
+	for (uint i = 1; i < lines.size(); ++i)
+	{
+		size_t colon = lines[i].find(':');
+		if (colon == lines[i].npos) continue;
+
+		String name = lines[i].substr(0, colon);
+		String value = lines[i].substr(colon + 1);
+		StringUtil::toLowerCase(name);
+		StringUtil::trim(value);
+		fields[name] = value;
+	}
+
+	String connection = fields["connection"];
+	StringUtil::toLowerCase(connection);
+	if (connection == "close")
+		conn.closing = true;
+
+	StringVector out;
+
+	if (requestLine.size() < 2 || (requestLine[0] != "GET" && requestLine[0] != "HEAD"))
+	{
+		respond(conn, 501, "Not Implemented", out, NULL, 0, 0);
+		return;
+	}
+
+	bool headOnly = requestLine[0] == "HEAD";
+
+	Resources::iterator itr = _resources.find(requestLine[1]);
+
+	if (itr == _resources.end())
+	{
+		++_stats.notFound;
+		respond(conn, 404, "Not Found", out, NULL, 0, 0);
+		return;
+	}
+
+	Resource& res = itr->second;
+	size_t total = res.body->getSize();
+
+	if (!res.etag.empty())			out.push_back(String("ETag: ") + res.etag);
+	if (!res.lastModified.empty())	out.push_back(String("Last-Modified: ") + res.lastModified);
+	if (!res.cacheControl.empty())	out.push_back(String("Cache-Control: ") + res.cacheControl);
+
+	out.insert(out.end(), res.fields.begin(), res.fields.end());
+
+	// Conditional GET: If-None-Match wins over If-Modified-Since
+	bool notModified = false;
+
+	if (fields.find("if-none-match") != fields.end())
+		notModified = !res.etag.empty() && fields["if-none-match"] == res.etag;
+	else if (fields.find("if-modified-since") != fields.end())
+		notModified = !res.lastModified.empty() && fields["if-modified-since"] == res.lastModified;
+
+	if (notModified)
+	{
+		++_stats.notModified;
+		respond(conn, 304, "Not Modified", out, NULL, 0, 0);
+		return;
+	}
+
+	out.push_back("Accept-Ranges: bytes");
+
+	String range = fields["range"];
+
+	// A range whose If-Range doesn't match the current validator gets the whole new content
+	if (fields.find("if-range") != fields.end())
+	{
+		const String& ifRange = fields["if-range"];
+		if (ifRange != res.etag && ifRange != res.lastModified)
+			range.clear();
+	}
+
+	if (!StringUtil::startsWith(range, "bytes=") || range.find(',') != range.npos)
+	{
+		++_stats.full;
+		respond(conn, 200, "OK", out, headOnly ? NULL : res.body.get(), 0, total);
+		return;
+	}
+
+	String spec = range.substr(6);
+	size_t dash = spec.find('-');
+	String first = dash != spec.npos ? spec.substr(0, dash) : spec;
+	String last = dash != spec.npos ? spec.substr(dash + 1) : String();
+
+	int64 from, to;
+
+	if (first.empty())
+	{
+		// suffix range: the last n bytes
+		int64 n = atol(last.c_str());
+		from = std::max(int64(total) - n, int64(0));
+		to = int64(total) - 1;
+	}
+	else
+	{
+		from = atol(first.c_str());
+		to = last.empty() ? int64(total) - 1 : std::min(int64(atol(last.c_str())), int64(total) - 1);
+	}
+
+	if (dash == spec.npos || from >= int64(total) || to < from)
+	{
+		out.push_back(StringUtil::format("Content-Range: bytes */%lld", int64(total)));
+		respond(conn, 416, "Requested Range Not Satisfiable", out, NULL, 0, 0);
+		return;
+	}
+
+	++_stats.partial;
+	out.push_back(StringUtil::format("Content-Range: bytes %lld-%lld/%lld", from, to, int64(total)));
+	respond(conn, 206, "Partial Content", out, headOnly ? NULL : res.body.get(), size_t(from), size_t(to - from + 1));
+}
+
+void HttpTestServer::respond(Connection& conn, int code, const char* status, const StringVector& fields, MemoryBuffer* body, size_t from, size_t size)
+{
+	String head = StringUtil::format("HTTP/1.1 %d %s\r\n", code, status);
+
+	for (uint i = 0; i < fields.size(); ++i)
+		head += fields[i] + "\r\n";
+
+	if (code != 304)
+		head += StringUtil::format("Content-Length: %lld\r\n", int64(body ? size : 0));
+
+	if (conn.closing)
+		head += "Connection: close\r\n";
+
+	head += "\r\n";
+
+	Response r;
+	r.data = new MemoryBuffer();
+	r.data->pushBack(head);
+	r.bodyPos = r.data->getSize();
+	r.sent = 0;
+
+	if (body && size > 0)
+		r.data->pushBack(body, from, size);
+
+	conn.responses.push_back(r);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void HttpTestServer::onTick(const TimeEvent* evt)
+{
+	Ref<HttpTestServer> safe = this;
+
+	// accepts, receives requests (queuing responses) and removes closed connections
+	_server->update();
+
+	size_t budget = size_t(-1);
+
+	if (_throttle > 0)
+	{
+		_budget = std::min(_budget + double(_throttle) * evt->getDelta(), double(_throttle));
+		budget = size_t(_budget);
+	}
+
+	size_t spent = 0;
+
+	for (Connections::iterator itr = _connections.begin(), end = _connections.end(); itr != end; ++itr)
+	{
+		TcpSocket* socket = itr->first;
+		Connection& conn = itr->second;
+
+		if (!socket->isValid()) continue;
+
+		spent += transmit(socket, conn, budget - spent);
+
+		if (conn.closing && conn.responses.empty() && socket->getSendBuf()->isEmpty())
+			socket->disconnect();
+	}
+
+	if (_throttle > 0)
+		_budget -= spent;
+}
+
+size_t HttpTestServer::transmit(TcpSocket* socket, Connection& conn, size_t budget)
+{
+	size_t spent = 0;
+
+	while (!conn.responses.empty() && spent < budget)
+	{
+		Response& r = conn.responses.front();
+
+		size_t size = std::min(r.data->getSize() - r.sent, budget - spent);
+		bool drop = false;
+
+		if (_dropsLeft > 0 && r.data->getSize() - r.bodyPos > _dropAfter)
+		{
+			size_t dropPos = r.bodyPos + _dropAfter;
+
+			if (r.sent + size >= dropPos)
+			{
+				size = dropPos - r.sent;
+				drop = true;
+			}
+		}
+
+		if (size > 0)
+		{
+			String chunk = r.data->toString(r.sent, size);
+
+			if (!socket->send(chunk.data(), size))
+				return spent;
+
+			r.sent += size;
+			spent += size;
+			_stats.bytesSent += size;
+		}
+
+		if (drop)
+		{
+			--_dropsLeft;
+			++_stats.dropped;
+
+			LOG(0, "?? HttpTestServer: dropping a response after %d body bytes\n", _dropAfter);
+
+			socket->flushSendBuffer();
+			socket->disconnect();
+			conn.responses.clear();
+			return spent;
+		}
+
+		if (r.sent == r.data->getSize())
+			conn.responses.pop_front();
+	}
+
+	return spent;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+NS_NIT_END;
+
+#endif // #if defined(NIT_TESTS)
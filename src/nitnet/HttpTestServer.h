@@ -0,0 +1,140 @@
+/// nit - Noriter Framework
+/// A Cross-platform Open Source Integration for Game-oriented Apps
+///
+/// http://www.github.com/ellongrey/nit
+///
+/// Copyright (c) 2013 by Jun-hyeok Jang
+/// 
+/// (see each file to see the different copyright owners)
+/// 
+/// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// Author: ellongrey
+
+#pragma once
+
+#include "nitnet/nitnet.h"
+
+#include "nit/net/Socket.h"
+
+#if defined(NIT_TESTS)
+
+NS_NIT_BEGIN;
+
+////////////////////////////////////////////////////////////////////////////////
+
+class TimeEvent;
+
+// Minimal HTTP/1.1 server on the main thread tick, for exercising HttpRequest, HttpCache and HttpDownload without a network.
+// Serves in-memory resources with ETag / Last-Modified / Cache-Control, answers conditional GETs with 304,
+// honors single 'bytes=' ranges and If-Range, and can throttle its output or drop connections in the middle of a body.
+class NITNET_API HttpTestServer : public RefCounted, public TcpSocketServer::IListener, public TcpSocket::IListener
+{
+public:
+	HttpTestServer();
+
+public:
+	bool								listen(uint16 port);
+	void								shutdown();
+
+	bool								isListening()							{ return _server->isListening(); }
+	uint16								getPort()								{ return _server->getBindPort(); }
+	String								getUrl(const String& path);				// 'http://127.0.0.1:<port><path>'
+
+public:
+	void								setResource(const String& path, MemoryBuffer* body, const String& etag = "", const String& lastModified = "", const String& cacheControl = "");
+	void								removeResource(const String& path);
+	void								addResourceField(const String& path, const String& field);	// 'Name: value' sent with the resource
+
+	size_t								getThrottle()							{ return _throttle; }
+	void								setThrottle(size_t bytesPerSec)			{ _throttle = bytesPerSec; }	// 0: unlimited
+
+	void								setDropAfter(size_t bodyBytes, uint times);	// closes the next 'times' responses after 'bodyBytes' of their body
+	uint								getDropsLeft()							{ return _dropsLeft; }
+
+public:
+	struct Stats
+	{
+		uint							requests;
+		uint							full;									// 200
+		uint							partial;								// 206
+		uint							notModified;							// 304
+		uint							notFound;								// 404
+		uint							dropped;
+		size_t							bytesSent;								// headers included
+	};
+
+	const Stats&						getStats()								{ return _stats; }
+	void								resetStats()							{ memset(&_stats, 0, sizeof(_stats)); }
+
+protected:									// TcpSocketServer::IListener
+	virtual TcpSocket*					onAccept(TcpSocketServer* server, int socketHandle, const String& peerAddr, uint16 peerPort);
+	virtual void						onDisconnected(TcpSocketServer* server, TcpSocket* client);
+
+protected:									// TcpSocket::IListener
+	virtual bool						onRecv(TcpSocket* socket);
+
+protected:
+	virtual void						onDelete();
+
+private:
+	struct Resource
+	{
+		Ref<MemoryBuffer>				body;
+		String							etag;
+		String							lastModified;
+		String							cacheControl;
+		StringVector					fields;
+	};
+
+	struct Response
+	{
+		Ref<MemoryBuffer>				data;									// header followed by the body
+		size_t							bodyPos;
+		size_t							sent;
+	};
+
+	struct Connection
+	{
+		String							request;								// received but not yet handled
+		list<Response>::type			responses;
+		bool							closing;								// 'Connection: close' was asked
+	};
+
+	typedef map<String, Resource>::type			Resources;
+	typedef map<TcpSocket*, Connection>::type	Connections;
+
+	Ref<TcpSocketServer>				_server;
+	Resources							_resources;
+	Connections							_connections;
+
+	size_t								_throttle;
+	double								_budget;								// bytes we may send this tick when throttled
+	size_t								_dropAfter;
+	uint								_dropsLeft;
+
+	Stats								_stats;
+
+	Ref<HttpTestServer>					_self;									// keeps alive while the tick handler is bound
+	Ref<EventHandler>					_tickHandler;
+
+	void								onTick(const TimeEvent* evt);
+	void								handle(Connection& conn, const String& head);
+	void								respond(Connection& conn, int code, const char* status, const StringVector& fields, MemoryBuffer* body, size_t from, size_t size);
+	size_t								transmit(TcpSocket* socket, Connection& conn, size_t budget);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+NS_NIT_END;
+
+#endif // #if defined(NIT_TESTS)
@@ -25,6 +25,7 @@
 #include "nitnet/URLRequest.h"
 #include "nitnet/HttpRequest.h"
 #include "nitnet/NetService.h"
+#include "nitnet/HttpCache.h"
 
 #include "nit/runtime/MemManager.h"
 #include "nit/event/Timer.h"
@@ -38,6 +39,10 @@ NS_NIT_BEGIN;
 
 NetService::NetService(Package* package) : Service("NetService", package, SVC_NET)
 {
+	_multiHandle = NULL;
+	_share = NULL;
+
+	resetStats();
 }
 
 NetService::~NetService()
@@ -110,6 +115,16 @@ void NetService::onInit()
 	if (_multiHandle == NULL)
 		NIT_THROW_FMT(EX_NET, "can't init cURL multi handle");
 
+	// Easy handles in the multi handle already share its connection cache.
+	// Share DNS and SSL sessions as well so pooled handles skip lookups and full handshakes.
+	_share = curl_share_init();
+
+	if (_share)
+	{
+		curl_share_setopt(_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+		curl_share_setopt(_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+	}
+
 	// register to app's timer channel
 	_time = g_App->getTimer()->getTime();
 	g_App->getTimer()->channel()->bind(EVT::TICK, this, &NetService::onTick);
@@ -123,6 +138,11 @@ void NetService::onFinish()
 	// remove and cleanup all handles
 	cancelAllRequests(true);
 
+	for (uint i = 0; i < _idleHandles.size(); ++i)
+		curl_easy_cleanup(_idleHandles[i]);
+
+	_idleHandles.clear();
+
 	// cleanup multi handle
 	if (_multiHandle)
 	{
@@ -130,6 +150,15 @@ void NetService::onFinish()
 		_multiHandle = NULL;
 	}
 
+	// share handle goes after all easy handles using it
+	if (_share)
+	{
+		curl_share_cleanup(_share);
+		_share = NULL;
+	}
+
+	_httpCache = NULL;
+
 	// Finish cURL
 	curl_global_cleanup();
 }
@@ -143,6 +172,9 @@ void NetService::onTick(const TimeEvent* evt)
 {
 	_time = evt->getTime();
 
+	if (!_local.empty())
+		finishLocalRequests();
+
 	if (_active.empty()) return;
 
 	int numRunning = 0;
@@ -168,6 +200,16 @@ void NetService::onTick(const TimeEvent* evt)
 				CURL* handle = msg->easy_handle;
 				CURLcode err = msg->data.result;
 
+				long connects = 0;
+				double headerSize = 0, bodySize = 0;
+				curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connects);
+				curl_easy_getinfo(handle, CURLINFO_HEADER_SIZE, &headerSize);
+				curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD, &bodySize);
+
+				++_stats.transfers;
+				_stats.connects += connects;
+				_stats.bytesReceived += size_t(headerSize + bodySize);
+
 				Requests::iterator itr = _active.find(handle);
 				if (itr != _active.end())
 				{
@@ -178,9 +220,8 @@ void NetService::onTick(const TimeEvent* evt)
 					else
 						req->done();
 
-					// TODO: handle pooling & reusing
 					curl_multi_remove_handle(_multiHandle, handle);
-					curl_easy_cleanup(handle);
+					releaseHandle(handle);
 					_active.erase(itr);
 				}
 				else
@@ -198,22 +239,86 @@ void NetService::onTick(const TimeEvent* evt)
 	}
 }
 
+CURL* NetService::acquireHandle()
+{
+	CURL* handle = NULL;
+
+	if (!_idleHandles.empty())
+	{
+		handle = _idleHandles.back();
+		_idleHandles.pop_back();
+		++_stats.handlesReused;
+	}
+	else
+	{
+		handle = curl_easy_init();
+		++_stats.handlesCreated;
+	}
+
+	if (handle && _share)
+		curl_easy_setopt(handle, CURLOPT_SHARE, _share);
+
+	return handle;
+}
+
+void NetService::releaseHandle(CURL* handle)
+{
+	if (_idleHandles.size() >= MAX_IDLE_HANDLES)
+	{
+		curl_easy_cleanup(handle);
+		return;
+	}
+
+	// Reset clears options only: live connections, dns and session caches are kept
+	curl_easy_reset(handle);
+	_idleHandles.push_back(handle);
+}
+
+void NetService::finishLocalRequests()
+{
+	// done() may start other requests: swap first
+	Requests local;
+	local.swap(_local);
+
+	for (Requests::iterator itr = local.begin(), end = local.end(); itr != end; ++itr)
+	{
+		itr->second->done();
+		releaseHandle(itr->first);
+	}
+}
+
 bool NetService::startRequest(URLRequest* req)
 {
-	CURL* handle = curl_easy_init();
+	CURL* handle = acquireHandle();
+
+	if (handle == NULL)
+	{
+		req->onError(CURLE_FAILED_INIT);
+		NIT_THROW_FMT(EX_NET, "can't init cURL easy handle");
+		return false;
+	}
+
 	bool ok = req->start(handle);
 
 	if (!ok)
 	{
 		req->onError(CURLE_ABORTED_BY_CALLBACK);
+		releaseHandle(handle);
 		return false;
 	}
 
+	if (req->_local)
+	{
+		++_stats.localRequests;
+		_local.insert(std::make_pair(handle, req));
+		return true;
+	}
+
 	CURLMcode err = curl_multi_add_handle(_multiHandle, handle);
 	if (err)
 	{
 		req->onError(CURLE_FAILED_INIT);
-		curl_easy_cleanup(handle);
+		releaseHandle(handle);
 		NIT_THROW_FMT(EX_NET, "cURL add handle failed: %s", curl_multi_strerror(err));
 		return false;
 	}
@@ -239,6 +344,13 @@ void NetService::cancelRequest(URLRequest* req, bool cleanup)
 	 		curl_easy_cleanup(handle);
 			_active.erase(itr);
 		}
+
+		itr = _local.find(handle);
+		if (itr != _local.end())
+		{
+			releaseHandle(handle);
+			_local.erase(itr);
+		}
 	}
 }
 
@@ -259,6 +371,13 @@ void NetService::cancelAllRequests(bool cleanup)
 			curl_multi_remove_handle(_multiHandle, handle);
 			curl_easy_cleanup(handle);
 		}
+
+		for (Requests::iterator itr = _local.begin(), end = _local.end(); itr != end; ++itr)
+		{
+			itr->second->_handle = NULL;
+			itr->second->cancel(false);
+			curl_easy_cleanup(itr->first);
+		}
 	}
 	else
 	{
@@ -269,6 +388,7 @@ void NetService::cancelAllRequests(bool cleanup)
 		}
 	}
 	_active.clear();
+	_local.clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
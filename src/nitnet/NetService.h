@@ -23,6 +23,7 @@
 #pragma once
 
 #include "nitnet/nitnet.h"
+#include "nitnet/HttpCache.h"
 
 NS_NIT_BEGIN;
 
@@ -43,10 +44,30 @@ public:
 	virtual ~NetService();
 
 public:
-	size_t								getNumActiveRequests()					{ return _active.size(); }
-	bool								isBusy()								{ return !_active.empty(); }
+	size_t								getNumActiveRequests()					{ return _active.size() + _local.size(); }
+	bool								isBusy()								{ return !_active.empty() || !_local.empty(); }
 	void								cancelAllRequests(bool cleanup);
 
+public:
+	HttpCache*							getHttpCache()							{ return _httpCache; }
+	void								setHttpCache(HttpCache* cache)			{ _httpCache = cache; }
+
+public:
+	struct Stats
+	{
+		uint							transfers;								// requests which went to the network
+		uint							localRequests;							// requests served without a transfer
+		uint							connects;								// new connections made by transfers
+		uint							handlesCreated;
+		uint							handlesReused;
+		size_t							bytesReceived;							// headers and bodies
+	};
+
+	const Stats&						getStats()								{ return _stats; }
+	void								resetStats()							{ memset(&_stats, 0, sizeof(_stats)); }
+
+	static const uint					MAX_IDLE_HANDLES = 8;
+
 public:
 	float								getTime()								{ return _time; }
 	EventChannel*						channel()								{ return _channel ? _channel : _channel = new EventChannel(); }
@@ -73,8 +94,18 @@ private:
 	friend class NB_NetService;
 	typedef map<CURL*, Ref<URLRequest> >::type Requests;
 	Requests							_active;
+	Requests							_local;									// served at onStart(), completed on next tick
 
 	CURLM*								_multiHandle;
+	CURLSH*								_share;
+	vector<CURL*>::type					_idleHandles;
+
+	Ref<HttpCache>						_httpCache;
+	Stats								_stats;
+
+	CURL*								acquireHandle();
+	void								releaseHandle(CURL* handle);
+	void								finishLocalRequests();
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -25,6 +25,9 @@
 #include "nitnet/URLRequest.h"
 #include "nitnet/HttpRequest.h"
 #include "nitnet/NetService.h"
+#include "nitnet/HttpCache.h"
+#include "nitnet/HttpDownload.h"
+#include "nitnet/HttpTestServer.h"
 
 #include "nit/script/NitBind.h"
 #include "nit/script/NitBindMacro.h"
@@ -45,6 +48,7 @@ public:
 			PROP_ENTRY_R(numActiveRequests),
 			PROP_ENTRY_R(busy),
 			PROP_ENTRY_R(time),
+			PROP_ENTRY	(httpCache),
 			NULL
 		};
 
@@ -53,6 +57,8 @@ public:
 			FUNC_ENTRY_H(channel,		"(): EventChannel"),
 			FUNC_ENTRY_H(cancelAllRequests, "(cleanup: bool)"),
 			FUNC_ENTRY_H(debugAllRequests, "(): NetRequest[]"),
+			FUNC_ENTRY_H(getStats,		"(): table"),
+			FUNC_ENTRY_H(resetStats,	"()"),
 			NULL
 		};
 
@@ -62,10 +68,28 @@ public:
 	NB_PROP_GET(numActiveRequests)		{ return push(v, self(v)->getNumActiveRequests()); }
 	NB_PROP_GET(busy)					{ return push(v, self(v)->isBusy()); }
 	NB_PROP_GET(time)					{ return push(v, self(v)->getTime()); }
+	NB_PROP_GET(httpCache)				{ return push(v, self(v)->getHttpCache()); }
+
+	NB_PROP_SET(httpCache)				{ self(v)->setHttpCache(opt<HttpCache>(v, 2, NULL)); return 0; }
 
 	NB_FUNC(channel)					{ return push(v, self(v)->channel()); }
 
 	NB_FUNC(cancelAllRequests)			{ self(v)->cancelAllRequests(getBool(v, 2)); return 0; }
+	NB_FUNC(resetStats)					{ self(v)->resetStats(); return 0; }
+
+	NB_FUNC(getStats)
+	{
+		type::Stats stats = self(v)->getStats();
+
+		sq_newtable(v);
+		newSlot(v, -1, "transfers",		stats.transfers);
+		newSlot(v, -1, "localRequests",	stats.localRequests);
+		newSlot(v, -1, "connects",		stats.connects);
+		newSlot(v, -1, "handlesCreated", stats.handlesCreated);
+		newSlot(v, -1, "handlesReused",	stats.handlesReused);
+		newSlot(v, -1, "bytesReceived",	stats.bytesReceived);
+		return 1;
+	}
 
 	NB_FUNC(debugAllRequests)
 	{
@@ -150,6 +174,7 @@ public:
 
 			PROP_ENTRY	(userId),
 			PROP_ENTRY	(userPassword),
+			PROP_ENTRY	(cacheEnabled),
 			NULL
 		};
 
@@ -181,10 +206,12 @@ public:
 	NB_PROP_GET(header)					{ return push(v, self(v)->getHeader()); }
 	NB_PROP_GET(userId)					{ return push(v, self(v)->getUserId()); }
 	NB_PROP_GET(userPassword)				{ return push(v, self(v)->getUserPassword()); }
+	NB_PROP_GET(cacheEnabled)			{ return push(v, self(v)->isCacheEnabled()); }
 
 	NB_PROP_SET(header)					{ self(v)->setHeader(getString(v, 2)); return 0; }
 	NB_PROP_SET(userId)					{ self(v)->setUserId(getString(v, 2)); return 0; }
 	NB_PROP_SET(userPassword)			{ self(v)->setUserPassword(getString(v, 2)); return 0; }
+	NB_PROP_SET(cacheEnabled)			{ self(v)->setCacheEnabled(getBool(v, 2)); return 0; }
 
 	NB_CONS()							{ setSelf(v, new HttpRequest(getString(v, 2), optBool(v, 3, false), optBool(v, 4, true))); return 0; }
 
@@ -231,15 +258,24 @@ public:
 			PROP_ENTRY	(name),
 			PROP_ENTRY	(contentType),
 			PROP_ENTRY	(mimeType),
+			PROP_ENTRY_R(cacheResult),
+			PROP_ENTRY_R(fromCache),
 			NULL
 		};
 
 		FuncEntry funcs[] = 
 		{
+			FUNC_ENTRY_H(headerField,	"(name: string): string // \"\" if not found"),
 			NULL
 		};
 
 		bind(v, props, funcs);
+
+		addStaticTable(v, "CACHE");
+		newSlot(v, -1, "NONE",			(int)type::CACHE_NONE);
+		newSlot(v, -1, "HIT",			(int)type::CACHE_HIT);
+		newSlot(v, -1, "REVALIDATED",	(int)type::CACHE_REVALIDATED);
+		sq_poptop(v);
 	}
 
 	NB_PROP_GET(code)					{ return push(v, self(v)->getCode()); }
@@ -248,14 +284,265 @@ public:
 	NB_PROP_GET(name)					{ return push(v, self(v)->getName()); }
 	NB_PROP_GET(contentType)			{ return push(v, self(v)->getContentType()); }
 	NB_PROP_GET(mimeType)				{ return push(v, self(v)->getMimeType()); }
+	NB_PROP_GET(cacheResult)			{ return push(v, (int)self(v)->getCacheResult()); }
+	NB_PROP_GET(fromCache)				{ return push(v, self(v)->isFromCache()); }
 
 	NB_PROP_SET(name)					{ self(v)->setName(getString(v, 2)); return 0; }
 	NB_PROP_SET(contentType)			{ self(v)->setContentType(*get<ContentType>(v, 2)); return 0; }
 	NB_PROP_SET(mimeType)				{ self(v)->setMimeType(getString(v, 2)); return 0; }
+
+	NB_FUNC(headerField)				{ return push(v, self(v)->getHeaderField(getString(v, 2))); }
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 
+NB_TYPE_REF(NITNET_API, nit::HttpCache, RefCounted, incRefCount, decRefCount);
+
+class NB_HttpCache : TNitClass<HttpCache>
+{
+public:
+	static void Register(HSQUIRRELVM v)
+	{
+		PropEntry props[] =
+		{
+			PROP_ENTRY_R(totalSize),
+			PROP_ENTRY	(maxSize),
+			NULL
+		};
+
+		FuncEntry funcs[] = 
+		{
+			CONS_ENTRY_H(				"(dbPath: string, maxSize=0) // 0: default"),
+			FUNC_ENTRY_H(remove,		"(url: string)"),
+			FUNC_ENTRY_H(clear,			"()"),
+			FUNC_ENTRY_H(getStats,		"(): table"),
+			FUNC_ENTRY_H(resetStats,	"()"),
+			NULL
+		};
+
+		bind(v, props, funcs);
+	}
+
+	NB_PROP_GET(totalSize)				{ return push(v, self(v)->getTotalSize()); }
+	NB_PROP_GET(maxSize)				{ return push(v, self(v)->getMaxSize()); }
+
+	NB_PROP_SET(maxSize)				{ self(v)->setMaxSize(getInt(v, 2)); return 0; }
+
+	NB_CONS()
+	{
+		int maxSize = optInt(v, 3, 0);
+		setSelf(v, new HttpCache(getString(v, 2), maxSize > 0 ? maxSize : HttpCache::DEFAULT_MAX_SIZE));
+		return 0;
+	}
+
+	NB_FUNC(remove)						{ self(v)->remove(getString(v, 2)); return 0; }
+	NB_FUNC(clear)						{ self(v)->clear(); return 0; }
+	NB_FUNC(resetStats)					{ self(v)->resetStats(); return 0; }
+
+	NB_FUNC(getStats)
+	{
+		const type::Stats& stats = self(v)->getStats();
+
+		sq_newtable(v);
+		newSlot(v, -1, "hits",			stats.hits);
+		newSlot(v, -1, "revalidated",	stats.revalidated);
+		newSlot(v, -1, "misses",		stats.misses);
+		newSlot(v, -1, "stored",		stats.stored);
+		newSlot(v, -1, "bytesFromCache", stats.bytesFromCache);
+		newSlot(v, -1, "bytesTransferred", stats.bytesTransferred);
+		return 1;
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+NB_TYPE_REF(NITNET_API, nit::HttpDownload, RefCounted, incRefCount, decRefCount);
+
+class NB_HttpDownload : TNitClass<HttpDownload>
+{
+public:
+	static void Register(HSQUIRRELVM v)
+	{
+		PropEntry props[] =
+		{
+			PROP_ENTRY_R(url),
+			PROP_ENTRY_R(path),
+			PROP_ENTRY	(segmentSize),
+			PROP_ENTRY	(maxConnections),
+			PROP_ENTRY	(maxRetries),
+			PROP_ENTRY	(packVerify),
+			PROP_ENTRY_R(busy),
+			PROP_ENTRY_R(done),
+			PROP_ENTRY_R(failed),
+			PROP_ENTRY_R(error),
+			PROP_ENTRY_R(errorString),
+			PROP_ENTRY_R(totalSize),
+			PROP_ENTRY_R(receivedSize),
+			PROP_ENTRY_R(progress),
+			PROP_ENTRY_R(rangeSupported),
+			PROP_ENTRY_R(numActiveSegments),
+			NULL
+		};
+
+		FuncEntry funcs[] = 
+		{
+			CONS_ENTRY_H(				"(url: string, path: string)"),
+			FUNC_ENTRY_H(addCheck,		"(offset: int, size: int, crc32: int)"),
+			FUNC_ENTRY_H(start,			"(): bool // resumes from the saved state if any"),
+			FUNC_ENTRY_H(cancel,		"() // keeps the partial file for resuming"),
+			FUNC_ENTRY_H(discard,		"()"),
+			FUNC_ENTRY_H(channel,		"(): EventChannel"),
+			FUNC_ENTRY_H(wait,			"(): int // 0 : fail, 1 : success"),
+			FUNC_ENTRY_H(getStats,		"(): table"),
+			FUNC_ENTRY_H(resetStats,	"()"),
+			NULL
+		};
+
+		bind(v, props, funcs);
+	}
+
+	NB_PROP_GET(url)					{ return push(v, self(v)->getUrl()); }
+	NB_PROP_GET(path)					{ return push(v, self(v)->getPath()); }
+	NB_PROP_GET(segmentSize)			{ return push(v, self(v)->getSegmentSize()); }
+	NB_PROP_GET(maxConnections)			{ return push(v, self(v)->getMaxConnections()); }
+	NB_PROP_GET(maxRetries)				{ return push(v, self(v)->getMaxRetries()); }
+	NB_PROP_GET(packVerify)				{ return push(v, self(v)->isPackVerify()); }
+	NB_PROP_GET(busy)					{ return push(v, self(v)->isBusy()); }
+	NB_PROP_GET(done)					{ return push(v, self(v)->isDone()); }
+	NB_PROP_GET(failed)					{ return push(v, self(v)->hasFailed()); }
+	NB_PROP_GET(error)					{ return push(v, self(v)->getError()); }
+	NB_PROP_GET(errorString)			{ return push(v, self(v)->getErrorString()); }
+	NB_PROP_GET(totalSize)				{ return push(v, self(v)->getTotalSize()); }
+	NB_PROP_GET(receivedSize)			{ return push(v, self(v)->getReceivedSize()); }
+	NB_PROP_GET(progress)				{ return push(v, self(v)->getProgress()); }
+	NB_PROP_GET(rangeSupported)			{ return push(v, self(v)->isRangeSupported()); }
+	NB_PROP_GET(numActiveSegments)		{ return push(v, self(v)->getNumActiveSegments()); }
+
+	NB_PROP_SET(segmentSize)			{ self(v)->setSegmentSize(getInt(v, 2)); return 0; }
+	NB_PROP_SET(maxConnections)			{ self(v)->setMaxConnections(getInt(v, 2)); return 0; }
+	NB_PROP_SET(maxRetries)				{ self(v)->setMaxRetries(getInt(v, 2)); return 0; }
+	NB_PROP_SET(packVerify)				{ self(v)->setPackVerify(getBool(v, 2)); return 0; }
+
+	NB_CONS()							{ setSelf(v, new HttpDownload(getString(v, 2), getString(v, 3))); return 0; }
+
+	NB_FUNC(addCheck)					{ self(v)->addCheck(getInt(v, 2), getInt(v, 3), (uint32)getInt(v, 4)); return 0; }
+	NB_FUNC(start)						{ return push(v, self(v)->start()); }
+	NB_FUNC(cancel)						{ self(v)->cancel(); return 0; }
+	NB_FUNC(discard)					{ self(v)->discard(); return 0; }
+	NB_FUNC(channel)					{ return push(v, self(v)->channel()); }
+	NB_FUNC(wait)						{ return self(v)->wait(v); } // HACK: We can't use push the return value (as it is special value for suspended state)
+	NB_FUNC(resetStats)					{ self(v)->resetStats(); return 0; }
+
+	NB_FUNC(getStats)
+	{
+		const type::Stats& stats = self(v)->getStats();
+
+		sq_newtable(v);
+		newSlot(v, -1, "bytesTransferred", stats.bytesTransferred);
+		newSlot(v, -1, "bytesResumed",	stats.bytesResumed);
+		newSlot(v, -1, "bytesDiscarded", stats.bytesDiscarded);
+		newSlot(v, -1, "requests",		stats.requests);
+		newSlot(v, -1, "retries",		stats.retries);
+		newSlot(v, -1, "restarts",		stats.restarts);
+		newSlot(v, -1, "verifyFailures", stats.verifyFailures);
+		newSlot(v, -1, "elapsed",		stats.elapsed);
+		return 1;
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+#if defined(NIT_TESTS)
+
+NB_TYPE_REF(NITNET_API, nit::HttpTestServer, RefCounted, incRefCount, decRefCount);
+
+class NB_HttpTestServer : TNitClass<HttpTestServer>
+{
+public:
+	static void Register(HSQUIRRELVM v)
+	{
+		PropEntry props[] =
+		{
+			PROP_ENTRY_R(listening),
+			PROP_ENTRY_R(port),
+			PROP_ENTRY	(throttle),
+			PROP_ENTRY_R(dropsLeft),
+			NULL
+		};
+
+		FuncEntry funcs[] = 
+		{
+			CONS_ENTRY_H(				"()"),
+			FUNC_ENTRY_H(listen,		"(port=0): bool // 0: any free port"),
+			FUNC_ENTRY_H(shutdown,		"()"),
+			FUNC_ENTRY_H(url,			"(path: string): string"),
+			FUNC_ENTRY_H(setResource,	"(path: string, body: string|MemoryBuffer, etag=\"\", lastModified=\"\", cacheControl=\"\")"),
+			FUNC_ENTRY_H(removeResource, "(path: string)"),
+			FUNC_ENTRY_H(addResourceField, "(path: string, field: string) // 'Name: value'"),
+			FUNC_ENTRY_H(setDropAfter,	"(bodyBytes: int, times=1)"),
+			FUNC_ENTRY_H(getStats,		"(): table"),
+			FUNC_ENTRY_H(resetStats,	"()"),
+			NULL
+		};
+
+		bind(v, props, funcs);
+	}
+
+	NB_PROP_GET(listening)				{ return push(v, self(v)->isListening()); }
+	NB_PROP_GET(port)					{ return push(v, self(v)->getPort()); }
+	NB_PROP_GET(throttle)				{ return push(v, self(v)->getThrottle()); }
+	NB_PROP_GET(dropsLeft)				{ return push(v, self(v)->getDropsLeft()); }
+
+	NB_PROP_SET(throttle)				{ self(v)->setThrottle(getInt(v, 2)); return 0; }
+
+	NB_CONS()							{ setSelf(v, new HttpTestServer()); return 0; }
+
+	NB_FUNC(listen)						{ return push(v, self(v)->listen(optInt(v, 2, 0))); }
+	NB_FUNC(shutdown)					{ self(v)->shutdown(); return 0; }
+	NB_FUNC(url)						{ return push(v, self(v)->getUrl(getString(v, 2))); }
+	NB_FUNC(removeResource)				{ self(v)->removeResource(getString(v, 2)); return 0; }
+	NB_FUNC(addResourceField)			{ self(v)->addResourceField(getString(v, 2), getString(v, 3)); return 0; }
+	NB_FUNC(setDropAfter)				{ self(v)->setDropAfter(getInt(v, 2), optInt(v, 3, 1)); return 0; }
+	NB_FUNC(resetStats)					{ self(v)->resetStats(); return 0; }
+
+	NB_FUNC(setResource)
+	{
+		Ref<MemoryBuffer> body;
+
+		if (isString(v, 3))
+		{
+			body = new MemoryBuffer();
+			body->pushBack(getString(v, 3));
+		}
+		else
+		{
+			body = get<MemoryBuffer>(v, 3);
+		}
+
+		self(v)->setResource(getString(v, 2), body, optString(v, 4, ""), optString(v, 5, ""), optString(v, 6, ""));
+		return 0;
+	}
+
+	NB_FUNC(getStats)
+	{
+		const type::Stats& stats = self(v)->getStats();
+
+		sq_newtable(v);
+		newSlot(v, -1, "requests",		stats.requests);
+		newSlot(v, -1, "full",			stats.full);
+		newSlot(v, -1, "partial",		stats.partial);
+		newSlot(v, -1, "notModified",	stats.notModified);
+		newSlot(v, -1, "notFound",		stats.notFound);
+		newSlot(v, -1, "dropped",		stats.dropped);
+		newSlot(v, -1, "bytesSent",		stats.bytesSent);
+		return 1;
+	}
+};
+
+#endif // #if defined(NIT_TESTS)
+
+////////////////////////////////////////////////////////////////////////////////
+
 NITNET_API SQRESULT NitLibNet(HSQUIRRELVM v)
 {
 	NB_NetService::Register(v);
@@ -263,6 +550,12 @@ NITNET_API SQRESULT NitLibNet(HSQUIRRELVM v)
 	NB_URLRequest::Register(v);
 	NB_HttpRequest::Register(v);
 	NB_HttpResponse::Register(v);
+	NB_HttpCache::Register(v);
+	NB_HttpDownload::Register(v);
+
+#if defined(NIT_TESTS)
+	NB_HttpTestServer::Register(v);
+#endif
 
 	////////////////////////////////////
 
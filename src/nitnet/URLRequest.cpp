@@ -41,6 +41,7 @@ URLRequest::URLRequest()
 	_error = CURLE_OK;
 
 	_canceled = false;
+	_local = false;
 
 	_startTime = 0.0f;
 }
@@ -100,6 +101,7 @@ bool URLRequest::doRequest()
 bool URLRequest::start(CURL* handle)
 {
 	_handle = handle;
+	_local = false;
 
 	curl_easy_setopt(handle, CURLOPT_NOPROGRESS, 0);
 	curl_easy_setopt(handle, CURLOPT_PROGRESSFUNCTION, progressCallback);
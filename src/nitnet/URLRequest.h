@@ -80,6 +80,7 @@ protected:
 	CURLcode							_error;
 
 	bool								_canceled : 1;
+	bool								_local : 1;								// set by onStart() when served without a transfer
 
 private:
 	friend class NetService;
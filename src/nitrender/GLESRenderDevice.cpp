@@ -203,6 +203,151 @@ void GLESRenderDevice::onSwapBuffers()
 		eglSwapBuffers(_display, _surface);
 }
 
+void GLESRenderDevice::onSetViewport(int left, int top, int width, int height)
+{
+	glViewport(left, top, width, height);
+}
+
+void GLESRenderDevice::onMultMatrix(const float m[16])
+{
+	glMultMatrixf(m);
+}
+
+uint32 GLESRenderDevice::onCaptureState()
+{
+	uint32 state = 0;
+
+	if (glIsEnabled(GL_TEXTURE_2D))				state |= RenderState::TEXTURE_2D;
+	if (glIsEnabled(GL_COLOR_ARRAY))			state |= RenderState::COLOR_ARRAY;
+	if (glIsEnabled(GL_TEXTURE_COORD_ARRAY))	state |= RenderState::TEXTURE_COORD_ARRAY;
+	if (glIsEnabled(GL_BLEND))					state |= RenderState::ALPHA_BLENDING;
+	if (glIsEnabled(GL_DEPTH_TEST))				state |= RenderState::DEPTH_TEST;
+
+	return state;
+}
+
+void GLESRenderDevice::onCaptureTransform(float outClip[16])
+{
+	GLfloat proj[16], model[16];
+
+	glGetFloatv(GL_PROJECTION_MATRIX, proj);
+	glGetFloatv(GL_MODELVIEW_MATRIX, model);
+
+	for (int col=0; col<4; ++col)
+	{
+		for (int row=0; row<4; ++row)
+		{
+			outClip[col*4+row] = 
+				proj[0*4+row] * model[col*4+0] + 
+				proj[1*4+row] * model[col*4+1] + 
+				proj[2*4+row] * model[col*4+2] + 
+				proj[3*4+row] * model[col*4+3];
+		}
+	}
+}
+
+uint32 GLESRenderDevice::onCaptureColor()
+{
+	GLfloat c[4];
+	glGetFloatv(GL_CURRENT_COLOR, c);
+
+	uint8 rgba[4];
+	for (int i=0; i<4; ++i)
+		rgba[i] = (uint8)Math::clamp(int(c[i] * 255.0f + 0.5f), 0, 255);
+
+	uint32 color;
+	memcpy(&color, rgba, sizeof(color));
+	return color;
+}
+
+#define NIT_PA_BLEND_SRC	GL_ONE
+#define NIT_PA_BLEND_DST	GL_ONE_MINUS_SRC_ALPHA
+
+void GLESRenderDevice::onBeginBatches()
+{
+	// Recorded vertices are in clip space already
+	glGetFloatv(GL_PROJECTION_MATRIX, _savedProjection);
+	glGetFloatv(GL_MODELVIEW_MATRIX, _savedModelView);
+
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+}
+
+void GLESRenderDevice::onApplyState(uint32 state, uint32 changed)
+{
+	if (changed & RenderState::TEXTURE_2D)
+	{
+		if (state & RenderState::TEXTURE_2D)
+			glEnable(GL_TEXTURE_2D);
+		else
+			glDisable(GL_TEXTURE_2D);
+	}
+
+	if (changed & RenderState::COLOR_ARRAY)
+	{
+		if (state & RenderState::COLOR_ARRAY)
+			glEnableClientState(GL_COLOR_ARRAY);
+		else
+			glDisableClientState(GL_COLOR_ARRAY);
+	}
+
+	if (changed & RenderState::TEXTURE_COORD_ARRAY)
+	{
+		if (state & RenderState::TEXTURE_COORD_ARRAY)
+			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		else
+			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	}
+
+	if (changed & RenderState::ALPHA_BLENDING)
+	{
+		if (state & RenderState::ALPHA_BLENDING)
+		{
+			glEnable(GL_BLEND);
+			glBlendFunc(NIT_PA_BLEND_SRC, NIT_PA_BLEND_DST);
+		}
+		else
+		{
+			glDisable(GL_BLEND);
+		}
+	}
+
+	if (changed & RenderState::DEPTH_TEST)
+	{
+		if (state & RenderState::DEPTH_TEST)
+		{
+			glClearDepthf(1.0f);
+			glEnable(GL_DEPTH_TEST);
+			glDepthFunc(GL_LEQUAL);
+		}
+		else
+		{
+			glDisable(GL_DEPTH_TEST);
+		}
+	}
+}
+
+void GLESRenderDevice::onDrawBatch(RenderCommandBuffer::PrimitiveType type, const RenderVertex* vertices, uint count)
+{
+	static const GLenum modes[] = { GL_POINTS, GL_LINES, GL_TRIANGLES };
+
+	glVertexPointer(4, GL_FLOAT, sizeof(RenderVertex), &vertices->x);
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(RenderVertex), &vertices->color);
+	glDrawArrays(modes[type], 0, (GLsizei)count);
+}
+
+void GLESRenderDevice::onEndBatches()
+{
+	glMatrixMode(GL_PROJECTION);
+	glLoadMatrixf(_savedProjection);
+
+	glMatrixMode(GL_MODELVIEW);
+	glLoadMatrixf(_savedModelView);
+}
+
 void GLESRenderDevice::onClearCache()
 {
 	// nothing to do yet
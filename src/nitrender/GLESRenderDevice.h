@@ -78,6 +78,15 @@ protected:								// RenderDevice impl
 	virtual void						onEndContext(RenderContext* ctx);
 	virtual void						onEndFrame();
 	virtual void						onSwapBuffers();
+	virtual void						onSetViewport(int left, int top, int width, int height);
+	virtual void						onMultMatrix(const float m[16]);
+	virtual uint32						onCaptureState();
+	virtual void						onCaptureTransform(float outClip[16]);
+	virtual uint32						onCaptureColor();
+	virtual void						onBeginBatches();
+	virtual void						onApplyState(uint32 state, uint32 changed);
+	virtual void						onDrawBatch(RenderCommandBuffer::PrimitiveType type, const RenderVertex* vertices, uint count);
+	virtual void						onEndBatches();
 	virtual void						onClearCache();
 	virtual void						onInvalidateHandles();
 	virtual void						onInvalidate();
@@ -97,6 +106,10 @@ protected:
 	virtual EGLint						chooseConfig() = 0;
 
 	CacheManager*						_cache;
+
+	// Saved by onBeginBatches() instead of glPushMatrix(): GL_PROJECTION stack may hold only 2 entries
+	GLfloat								_savedProjection[16];
+	GLfloat								_savedModelView[16];
 };
 
 ////////////////////////////////////////////////////////////////////////////////
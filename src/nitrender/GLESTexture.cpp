@@ -143,6 +143,13 @@ GLESTexture::ActivateResult GLESTexture::onActivate(RenderContext* ctx)
 		bool needPOT = !g_Render->isTextureNPOTSupported();
 		if (needPOT && _sourceImage->makePot(false))
 			_header = _sourceImage->getHeader();
+
+		// Prefer mipmaps on cpu over glGenerateMipmap when the image allows: gamma-correct for sRGB color, linear for the rest
+		if (_autoGenMipmap && _sourceImage->getMipCount() == 1 && _sourceImage->canGenerateMipmaps())
+		{
+			_sourceImage->generateMipmaps(PixelConverter::FILTER_BOX, _sourceImage->isSrgb());
+			_header = _sourceImage->getHeader();
+		}
 	}
 
 	_handle->generate(ctx);
@@ -195,8 +202,8 @@ bool GLESTexture::createGLTex(RenderContext* ctx, int level)
 {
 	// TODO: mipmap only works when it's POT!
 
-	GLsizei width = _header.width >> level;
-	GLsizei height = _header.height >> level;
+	GLsizei width = std::max(1, _header.width >> level);
+	GLsizei height = std::max(1, _header.height >> level);
 	GLint border = 0;
 
 	// glTexImage2D allows pixels to be NULL.
@@ -259,8 +266,8 @@ bool GLESTexture::createGLCompTex(RenderContext* ctx, int level)
 	// TODO: mipmap only works when its POT!
 
 	GLenum glFormat;
-	GLsizei width = _header.width >> (level);
-	GLsizei height = _header.height >> (level);
+	GLsizei width = std::max(1, _header.width >> level);
+	GLsizei height = std::max(1, _header.height >> level);
 	GLsizei size = width * height * bpp >> 3;
 	GLint border = 0;
 	GLvoid* data = _sourceImage->getMipData(level);
@@ -410,7 +417,7 @@ bool GLESTexture::applyTexParams(RenderContext* ctx)
 		return false;
 	}
 
-	if (_autoGenMipmap)
+	if (_autoGenMipmap && _header.mipmapCount == 1)
 	{
 		glGenerateMipmapOES(GL_TEXTURE_2D);
 	}
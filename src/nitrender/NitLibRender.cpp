@@ -25,6 +25,7 @@
 #include "nitrender/RenderSpec.h"
 #include "nitrender/RenderService.h"
 #include "nitrender/RenderContext.h"
+#include "nitrender/NullRenderDevice.h"
 #include "nitrender/RenderView.h"
 #include "nitrender/GLESTexture.h"
 
@@ -134,11 +135,20 @@ public:
 			PROP_ENTRY_R(view),
 			PROP_ENTRY_R(device),
 			PROP_ENTRY_R(service),
+			PROP_ENTRY_R(pendingCount),
+			PROP_ENTRY_R(pendingBatchCount),
+			PROP_ENTRY_R(state),
 			NULL
 		};
 
 		FuncEntry funcs[] = 
 		{
+			FUNC_ENTRY_H(flush,			"() // submits recorded draw*2d primitives"),
+			FUNC_ENTRY_H(setAlphaBlending, "(flag: bool)"),
+			FUNC_ENTRY_H(setDepthTest,	"(flag: bool)"),
+			FUNC_ENTRY_H(drawPoint2d,	"(point: Vector2)"),
+			FUNC_ENTRY_H(drawLine2d,	"(from, to: Vector2)"),
+			FUNC_ENTRY_H(drawPoly2d,	"(points: Vector2[], filled=true, closed=true)"),
 			NULL
 		};
 
@@ -149,6 +159,31 @@ public:
 	NB_PROP_GET(view)					{ return push(v, self(v)->getView()); }
 	NB_PROP_GET(device)					{ return push(v, self(v)->getDevice()); }
 	NB_PROP_GET(service)				{ return push(v, self(v)->getService()); }
+	NB_PROP_GET(pendingCount)			{ return push(v, self(v)->getPendingCount()); }
+	NB_PROP_GET(pendingBatchCount)		{ return push(v, self(v)->getPendingBatchCount()); }
+	NB_PROP_GET(state)					{ return push(v, self(v)->getState()); }
+
+	NB_FUNC(flush)						{ self(v)->flush(); return 0; }
+	NB_FUNC(setAlphaBlending)			{ self(v)->setAlphaBlending(getBool(v, 2)); return 0; }
+	NB_FUNC(setDepthTest)				{ self(v)->setDepthTest(getBool(v, 2)); return 0; }
+	NB_FUNC(drawPoint2d)				{ self(v)->drawPoint2d(*get<Vector2>(v, 2)); return 0; }
+	NB_FUNC(drawLine2d)					{ self(v)->drawLine2d(*get<Vector2>(v, 2), *get<Vector2>(v, 3)); return 0; }
+
+	NB_FUNC(drawPoly2d)
+	{
+		vector<Vector2>::type points(sq_getsize(v, 2));
+		for (uint i=0; i<points.size(); ++i)
+		{
+			sq_pushinteger(v, i);
+			sq_get(v, 2);
+			points[i] = *get<Vector2>(v, -1);
+			sq_poptop(v);
+		}
+
+		if (!points.empty())
+			self(v)->drawPoly2d(&points[0], points.size(), optBool(v, 3, true), optBool(v, 4, true));
+		return 0;
+	}
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -180,6 +215,8 @@ public:
  			FUNC_ENTRY_H(clearCaches,	"()"),
 			FUNC_ENTRY_H(allCaches,		"()"),
 			FUNC_ENTRY_H(getCache,		"(name: string): CacheManager"),
+			FUNC_ENTRY_H(getStats,		"(): table // { flushes, primitives, drawCalls, vertices, stateChanges }"),
+			FUNC_ENTRY_H(resetStats,	"()"),
 			NULL
 		};
 
@@ -199,6 +236,20 @@ public:
 	NB_FUNC(invalidate)					{ self(v)->invalidate(); return 0; }
  	NB_FUNC(clearCaches)				{ self(v)->clearCaches(); return 0; }
 	NB_FUNC(getCache)					{ return push(v, self(v)->getCache(getString(v, 2))); }
+	NB_FUNC(resetStats)					{ self(v)->resetStats(); return 0; }
+
+	NB_FUNC(getStats)
+	{
+		const RenderStats& stats = self(v)->getStats();
+
+		sq_newtable(v);
+		newSlot(v, -1, "flushes",		stats.flushes);
+		newSlot(v, -1, "primitives",	stats.primitives);
+		newSlot(v, -1, "drawCalls",		stats.drawCalls);
+		newSlot(v, -1, "vertices",		stats.vertices);
+		newSlot(v, -1, "stateChanges",	stats.stateChanges);
+		return 1;
+	}
 
 	NB_FUNC(allCaches)
 	{
@@ -214,6 +265,48 @@ public:
 
 ////////////////////////////////////////////////////////////////////////////////
 
+NB_TYPE_AUTODELETE(NITRENDER_API, nit::NullRenderDevice, RenderDevice, delete);
+
+class NB_NullRenderDevice : TNitClass<NullRenderDevice>
+{
+public:
+	static void Register(HSQUIRRELVM v)
+	{
+		PropEntry props[] =
+		{
+			PROP_ENTRY_R(context),
+			PROP_ENTRY_R(state),
+			PROP_ENTRY	(color),
+			PROP_ENTRY_R(viewportWidth),
+			PROP_ENTRY_R(viewportHeight),
+			NULL
+		};
+
+		FuncEntry funcs[] = 
+		{
+			CONS_ENTRY_H(				"() // renders nothing, counts into getStats()"),
+			FUNC_ENTRY_H(loadIdentity,	"()"),
+			NULL
+		};
+
+		bind(v, props, funcs);
+	}
+
+	NB_PROP_GET(context)				{ return push(v, self(v)->getContext()); }
+	NB_PROP_GET(state)					{ return push(v, self(v)->getState()); }
+	NB_PROP_GET(color)					{ return push(v, self(v)->getColor()); }
+	NB_PROP_GET(viewportWidth)			{ return push(v, self(v)->getViewportWidth()); }
+	NB_PROP_GET(viewportHeight)			{ return push(v, self(v)->getViewportHeight()); }
+
+	NB_PROP_SET(color)					{ self(v)->setColor(getInt(v, 2)); return 0; }
+
+	NB_CONS()							{ setSelf(v, new NullRenderDevice()); return 0; }
+
+	NB_FUNC(loadIdentity)				{ self(v)->loadIdentity(); return 0; }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
 NB_TYPE_WEAK(NITRENDER_API, nit::RenderView, NULL);
 
 class NB_RenderView : TNitClass<RenderView>
@@ -384,6 +477,7 @@ NITRENDER_API SQRESULT NitLibRender(HSQUIRRELVM v)
 	NB_RenderSpec::Register(v);
 	NB_RenderContext::Register(v);
 	NB_RenderDevice::Register(v);
+	NB_NullRenderDevice::Register(v);
 	NB_RenderView::Register(v);
 	NB_RenderService::Register(v);
 
@@ -0,0 +1,119 @@
+﻿/// nit - Noriter Framework
+/// A Cross-platform Open Source Integration for Game-oriented Apps
+///
+/// http://www.github.com/ellongrey/nit
+///
+/// Copyright (c) 2013 by Jun-hyeok Jang
+/// 
+/// (see each file to see the different copyright owners)
+/// 
+/// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// Author: ellongrey
+
+
+#include "NITRENDER_pch.h"
+
+#include "nitrender/NullRenderDevice.h"
+
+#include "nitrender/RenderContext.h"
+
+NS_NIT_BEGIN;
+
+////////////////////////////////////////////////////////////////////////////////
+
+NullRenderDevice::NullRenderDevice()
+{
+	_state		= RenderState::DEFAULT_2D;
+	_color		= 0xFFFFFFFF;
+
+	memset(_viewport, 0, sizeof(_viewport));
+	loadIdentity();
+
+	_context	= NULL;
+
+	_valid		= true;
+}
+
+NullRenderDevice::~NullRenderDevice()
+{
+	safeDelete(_context);
+}
+
+RenderContext* NullRenderDevice::getContext()
+{
+	if (_context == NULL)
+		_context = new RenderContext(this);
+
+	return _context;
+}
+
+void NullRenderDevice::setTransform(const float clip[16])
+{
+	memcpy(_transform, clip, sizeof(_transform));
+}
+
+void NullRenderDevice::loadIdentity()
+{
+	for (int i=0; i<16; ++i)
+		_transform[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+}
+
+bool NullRenderDevice::onReset()
+{
+	_state = RenderState::DEFAULT_2D;
+	loadIdentity();
+
+	_valid = true;
+	return true;
+}
+
+void NullRenderDevice::onSetViewport(int left, int top, int width, int height)
+{
+	_viewport[0] = left;
+	_viewport[1] = top;
+	_viewport[2] = width;
+	_viewport[3] = height;
+}
+
+void NullRenderDevice::onMultMatrix(const float m[16])
+{
+	float r[16];
+
+	for (int col=0; col<4; ++col)
+	{
+		for (int row=0; row<4; ++row)
+		{
+			r[col*4+row] = 
+				_transform[0*4+row] * m[col*4+0] + 
+				_transform[1*4+row] * m[col*4+1] + 
+				_transform[2*4+row] * m[col*4+2] + 
+				_transform[3*4+row] * m[col*4+3];
+		}
+	}
+
+	memcpy(_transform, r, sizeof(_transform));
+}
+
+void NullRenderDevice::onCaptureTransform(float outClip[16])
+{
+	memcpy(outClip, _transform, sizeof(_transform));
+}
+
+void NullRenderDevice::onApplyState(uint32 state, uint32 changed)
+{
+	_state = (_state & ~changed) | (state & changed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+NS_NIT_END;
@@ -0,0 +1,87 @@
+﻿/// nit - Noriter Framework
+/// A Cross-platform Open Source Integration for Game-oriented Apps
+///
+/// http://www.github.com/ellongrey/nit
+///
+/// Copyright (c) 2013 by Jun-hyeok Jang
+/// 
+/// (see each file to see the different copyright owners)
+/// 
+/// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// Author: ellongrey
+
+
+#pragma once
+
+#include "nitrender/nitrender.h"
+
+#include "nitrender/RenderDevice.h"
+
+NS_NIT_BEGIN;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// A device which renders nothing but keeps the fixed-function state and counts what it would submit.
+// Lets RenderContext batching be measured without a GPU : new RenderContext(nullDevice), draw, flush, getStats().
+
+class RenderContext;
+
+class NITRENDER_API NullRenderDevice : public RenderDevice
+{
+public:
+	NullRenderDevice();
+	virtual ~NullRenderDevice();
+
+public:
+	RenderContext*						getContext();							// created on first use, owned by the device
+
+	uint32								getState()								{ return _state; }
+	uint32								getColor()								{ return _color; }
+	void								setColor(uint32 rgba)					{ _color = rgba; }
+	void								setTransform(const float clip[16]);
+	void								loadIdentity();
+
+	int									getViewportWidth()						{ return _viewport[2]; }
+	int									getViewportHeight()						{ return _viewport[3]; }
+
+protected:								// RenderDevice impl
+	virtual bool						onReset();
+	virtual void						onBeginFrame()							{ }
+	virtual void						onBeginContext(RenderContext* ctx)		{ }
+	virtual void						onEndContext(RenderContext* ctx)		{ }
+	virtual void						onEndFrame()							{ }
+	virtual void						onSwapBuffers()							{ }
+	virtual void						onSetViewport(int left, int top, int width, int height);
+	virtual void						onMultMatrix(const float m[16]);
+	virtual uint32						onCaptureState()						{ return _state; }
+	virtual void						onCaptureTransform(float outClip[16]);
+	virtual uint32						onCaptureColor()						{ return _color; }
+	virtual void						onBeginBatches()						{ }
+	virtual void						onApplyState(uint32 state, uint32 changed);
+	virtual void						onDrawBatch(RenderCommandBuffer::PrimitiveType type, const RenderVertex* vertices, uint count) { }
+	virtual void						onEndBatches()							{ }
+	virtual void						onClearCache()							{ }
+	virtual void						onInvalidateHandles()					{ }
+	virtual void						onInvalidate()							{ }
+
+protected:
+	uint32								_state;
+	uint32								_color;
+	float								_transform[16];
+	int									_viewport[4];
+	RenderContext*						_context;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+NS_NIT_END;
@@ -0,0 +1,77 @@
+﻿/// nit - Noriter Framework
+/// A Cross-platform Open Source Integration for Game-oriented Apps
+///
+/// http://www.github.com/ellongrey/nit
+///
+/// Copyright (c) 2013 by Jun-hyeok Jang
+/// 
+/// (see each file to see the different copyright owners)
+/// 
+/// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// Author: ellongrey
+
+
+#include "NITRENDER_pch.h"
+
+#include "nitrender/RenderCommand.h"
+
+NS_NIT_BEGIN;
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint RenderState::countChanges(uint32 changed)
+{
+	uint count = 0;
+	for (changed &= ALL; changed; changed &= changed - 1)
+		++count;
+	return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+RenderCommandBuffer::RenderCommandBuffer()
+{
+	_recordCount = 0;
+}
+
+RenderVertex* RenderCommandBuffer::record(PrimitiveType type, uint32 state, uint count)
+{
+	uint first = _vertices.size();
+
+	if (!_batches.empty() && _batches.back().type == type && _batches.back().state == state)
+	{
+		_batches.back().count += count;
+	}
+	else
+	{
+		Batch batch = { type, state, first, count };
+		_batches.push_back(batch);
+	}
+
+	_vertices.resize(first + count);
+	++_recordCount;
+
+	return &_vertices[first];
+}
+
+void RenderCommandBuffer::clear()
+{
+	// Keep capacities - buffers get reused every frame
+	_vertices.resize(0);
+	_batches.resize(0);
+	_recordCount = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+NS_NIT_END;
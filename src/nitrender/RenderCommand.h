@@ -0,0 +1,124 @@
+﻿/// nit - Noriter Framework
+/// A Cross-platform Open Source Integration for Game-oriented Apps
+///
+/// http://www.github.com/ellongrey/nit
+///
+/// Copyright (c) 2013 by Jun-hyeok Jang
+/// 
+/// (see each file to see the different copyright owners)
+/// 
+/// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal
+/// in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+/// copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+/// 
+/// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+/// 
+/// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+/// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+/// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+/// THE SOFTWARE.
+///
+/// Author: ellongrey
+
+
+#pragma once
+
+#include "nitrender/nitrender.h"
+
+NS_NIT_BEGIN;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Fixed-function states tracked by RenderContext.
+// Everything outside these is assumed to be at the nit2d default :
+// GL_TEXTURE_2D, GL_VERTEX_ARRAY, GL_COLOR_ARRAY, GL_TEXTURE_COORD_ARRAY enabled.
+
+struct NITRENDER_API RenderState
+{
+	enum Flag
+	{
+		TEXTURE_2D						= 0x0001,
+		COLOR_ARRAY						= 0x0002,
+		TEXTURE_COORD_ARRAY				= 0x0004,
+		ALPHA_BLENDING					= 0x0008,	// premultiplied : ONE, ONE_MINUS_SRC_ALPHA
+		DEPTH_TEST						= 0x0010,
+
+		ALL								= 0x001F,
+		DEFAULT_2D						= TEXTURE_2D | COLOR_ARRAY | TEXTURE_COORD_ARRAY,
+	};
+
+	static uint							countChanges(uint32 changed);
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Vertices are recorded already transformed to clip space and carry their own color,
+// so primitives recorded under different matrices or colors can share a draw call.
+
+struct RenderVertex
+{
+	float								x, y, z, w;
+	uint32								color;		// RGBA in memory order
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Counters updated by RenderDevice while it executes command buffers
+
+struct RenderStats
+{
+	uint								flushes;
+	uint								primitives;		// primitives recorded by contexts
+	uint								drawCalls;		// batches actually submitted
+	uint								vertices;
+	uint								stateChanges;	// per flag, redundant ones not counted
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+class NITRENDER_API RenderCommandBuffer
+{
+public:
+	enum PrimitiveType
+	{
+		PRIM_POINTS,
+		PRIM_LINES,
+		PRIM_TRIANGLES,
+	};
+
+	struct Batch
+	{
+		PrimitiveType					type;
+		uint32							state;
+		uint							first;
+		uint							count;
+	};
+
+	typedef vector<RenderVertex>::type	Vertices;
+	typedef vector<Batch>::type			Batches;
+
+public:
+	RenderCommandBuffer();
+
+public:
+	// Returns space for 'count' vertices, appended to the last batch when it has same type and state.
+	// The pointer is valid until the next call.
+	RenderVertex*						record(PrimitiveType type, uint32 state, uint count);
+
+	void								clear();
+
+	bool								isEmpty()								{ return _batches.empty(); }
+	uint								getRecordCount()						{ return _recordCount; }
+
+	const Vertices&						getVertices()							{ return _vertices; }
+	const Batches&						getBatches()							{ return _batches; }
+
+private:
+	Vertices							_vertices;
+	Batches								_batches;
+	uint								_recordCount;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+NS_NIT_END;
@@ -20,6 +20,7 @@
 ///
 /// Author: ellongrey
 
+
 #include "NITRENDER_pch.h"
 
 #include "nitrender/RenderContext.h"
@@ -44,6 +45,19 @@ RenderContext::RenderContext(RenderView* view)
 	_spec			= _device->getSpec();
 	_service		= NULL;
 	_beginCount	= 0;
+	_state			= _device->captureState();
+	_renderQueue	= NULL;
+}
+
+RenderContext::RenderContext(RenderDevice* device)
+{
+	_view			= NULL;
+	_device		= device;
+	_spec			= _device->getSpec();
+	_service		= NULL;
+	_beginCount	= 0;
+	_state			= _device->captureState();
+	_renderQueue	= NULL;
 }
 
 RenderContext::~RenderContext()
@@ -52,23 +66,32 @@ RenderContext::~RenderContext()
 
 void RenderContext::perspective(float fovy, float aspect, float zNear, float zFar)
 {
-	GLfloat xmin, xmax, ymin, ymax;
+	float xmin, xmax, ymin, ymax;
 
-	ymax = zNear * (GLfloat)tanf(fovy * (float)M_PI / 360);
+	ymax = zNear * tanf(fovy * (float)M_PI / 360);
 	ymin = -ymax;
 	xmin = ymin * aspect;
 	xmax = ymax * aspect;
 
-	glFrustumf(xmin, xmax,
-		ymin, ymax,
-		zNear, zFar);	
+	// Same as glFrustumf(xmin, xmax, ymin, ymax, zNear, zFar)
+	float m[16] = { 0 };
+
+	m[0]  = 2.0f * zNear / (xmax - xmin);
+	m[5]  = 2.0f * zNear / (ymax - ymin);
+	m[8]  = (xmax + xmin) / (xmax - xmin);
+	m[9]  = (ymax + ymin) / (ymax - ymin);
+	m[10] = -(zFar + zNear) / (zFar - zNear);
+	m[11] = -1.0f;
+	m[14] = -2.0f * zFar * zNear / (zFar - zNear);
+
+	_device->multMatrix(m);
 }
 
 void RenderContext::lookAt(float eyeX, float eyeY, float eyeZ, float centerX, float centerY, float centerZ, float upX, float upY, float upZ)
 {
-    GLfloat m[16];
-    GLfloat x[3], y[3], z[3];
-    GLfloat mag;
+    float m[16];
+    float x[3], y[3], z[3];
+    float mag;
 
     /* Make rotation matrix */
 
@@ -120,99 +143,161 @@ void RenderContext::lookAt(float eyeX, float eyeY, float eyeZ, float centerX, fl
     M(0, 0) = x[0];
     M(0, 1) = x[1];
     M(0, 2) = x[2];
-    M(0, 3) = 0.0f;
     M(1, 0) = y[0];
     M(1, 1) = y[1];
     M(1, 2) = y[2];
-    M(1, 3) = 0.0f;
     M(2, 0) = z[0];
     M(2, 1) = z[1];
     M(2, 2) = z[2];
-    M(2, 3) = 0.0f;
     M(3, 0) = 0.0f;
     M(3, 1) = 0.0f;
     M(3, 2) = 0.0f;
     M(3, 3) = 1.0f;
-#undef M
-    {
-        int a;
-        GLfloat fixedM[16];
-        for (a = 0; a < 16; ++a)
-            fixedM[a] = m[a];
-        glMultMatrixf(fixedM);
-    }
 
     /* Translate Eye to Origin */
-    glTranslatef(-eyeX, -eyeY, -eyeZ);
-}
+    M(0, 3) = -(x[0] * eyeX + x[1] * eyeY + x[2] * eyeZ);
+    M(1, 3) = -(y[0] * eyeX + y[1] * eyeY + y[2] * eyeZ);
+    M(2, 3) = -(z[0] * eyeX + z[1] * eyeY + z[2] * eyeZ);
+#undef M
 
-#define NIT_PA_BLEND_SRC	GL_ONE
-#define NIT_PA_BLEND_DST	GL_ONE_MINUS_SRC_ALPHA
+    _device->multMatrix(m);
+}
 
 void RenderContext::setAlphaBlending(bool flag)
 {
-	if (flag)
-	{
-		glEnable(GL_BLEND);
-		glBlendFunc(NIT_PA_BLEND_SRC, NIT_PA_BLEND_DST);
-	}
-	else
-	{
-		glDisable(GL_BLEND);
-	}
+	uint32 state = getState();
+	setState(flag ? (state | RenderState::ALPHA_BLENDING) : (state & ~RenderState::ALPHA_BLENDING));
 }
 
 void RenderContext::setDepthTest(bool flag)
 {
-	if (flag)
+	uint32 state = getState();
+	setState(flag ? (state | RenderState::DEPTH_TEST) : (state & ~RenderState::DEPTH_TEST));
+}
+
+uint32 RenderContext::getState()
+{
+	_state = _device->captureState();
+	return _state;
+}
+
+void RenderContext::setState(uint32 state)
+{
+	uint32 changed = (state ^ getState()) & RenderState::ALL;
+	if (changed == 0) return;
+
+	// The queue may leave the device in another state than captured
+	flushRenderQueue();
+	changed = (state ^ getState()) & RenderState::ALL;
+
+	_device->applyState(state, changed);
+	_state = state;
+}
+
+void RenderContext::setRenderQueue(RenderQueue* queue)
+{
+	if (_renderQueue == queue) return;
+
+	flushRenderQueue();
+	_renderQueue = queue;
+}
+
+void RenderContext::flush()
+{
+	flushRenderQueue();
+
+	if (_commands.isEmpty()) return;
+
+	_device->execute(_commands, getState());
+	_commands.clear();
+}
+
+static inline void ToClip(RenderVertex& out, const float* m, const Vector2& p, uint32 color)
+{
+	out.x = m[0] * p.x + m[4] * p.y + m[12];
+	out.y = m[1] * p.x + m[5] * p.y + m[13];
+	out.z = m[2] * p.x + m[6] * p.y + m[14];
+	out.w = m[3] * p.x + m[7] * p.y + m[15];
+	out.color = color;
+}
+
+void RenderContext::recordPoints(const Vector2* points, uint numPoints)
+{
+	if (numPoints == 0) return;
+
+	float m[16];
+	_device->captureTransform(m);
+	uint32 color = _device->captureColor();
+
+	RenderVertex* v = _commands.record(RenderCommandBuffer::PRIM_POINTS, getRecordState(), numPoints);
+
+	for (uint i=0; i<numPoints; ++i)
+		ToClip(v[i], m, points[i], color);
+}
+
+void RenderContext::recordLines(const Vector2* points, uint numPoints, bool closed)
+{
+	// Strips and loops become line lists so they can be merged
+	if (numPoints < 2) return;
+
+	uint numLines = closed ? numPoints : numPoints - 1;
+
+	float m[16];
+	_device->captureTransform(m);
+	uint32 color = _device->captureColor();
+
+	RenderVertex* v = _commands.record(RenderCommandBuffer::PRIM_LINES, getRecordState(), numLines * 2);
+
+	ToClip(v[0], m, points[0], color);
+
+	for (uint i=1; i<numPoints; ++i)
 	{
-		glClearDepthf(1.0f);
-		glEnable(GL_DEPTH_TEST);
-		glDepthFunc(GL_LEQUAL);
-//		glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST);
+		ToClip(v[i*2-1], m, points[i], color);
+		if (i < numLines) v[i*2] = v[i*2-1];
 	}
-	else
+
+	if (closed)
+		v[numLines*2-1] = v[0];
+}
+
+void RenderContext::recordFan(const Vector2* points, uint numPoints)
+{
+	// Fans become triangle lists so they can be merged
+	if (numPoints < 3) return;
+
+	uint numTriangles = numPoints - 2;
+
+	float m[16];
+	_device->captureTransform(m);
+	uint32 color = _device->captureColor();
+
+	RenderVertex* v = _commands.record(RenderCommandBuffer::PRIM_TRIANGLES, getRecordState(), numTriangles * 3);
+
+	RenderVertex center, prev;
+	ToClip(center, m, points[0], color);
+	ToClip(prev, m, points[1], color);
+
+	for (uint i=0; i<numTriangles; ++i)
 	{
-		glDisable(GL_DEPTH_TEST);
+		RenderVertex* tri = &v[i*3];
+		tri[0] = center;
+		tri[1] = prev;
+		ToClip(tri[2], m, points[i+2], color);
+		prev = tri[2];
 	}
 }
 
 void RenderContext::drawPoint2d(const Vector2& point)
 {
-	float scale = _view->getScale();
+	float scale = _view ? _view->getScale() : 1.0f;
 	Vector2 p(point.x * scale, point.y * scale);
-	// Default GL states: GL_TEXTURE_2D, GL_VERTEX_ARRAY, GL_COLOR_ARRAY, GL_TEXTURE_COORD_ARRAY
-	// Needed states: GL_VERTEX_ARRAY, 
-	// Unneeded states: GL_TEXTURE_2D, GL_TEXTURE_COORD_ARRAY, GL_COLOR_ARRAY	
-	glDisable(GL_TEXTURE_2D);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
-
-	glVertexPointer(2, GL_FLOAT, 0, &p);	
-	glDrawArrays(GL_POINTS, 0, 1);
-
-	// restore default state
-	glEnableClientState(GL_COLOR_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-	glEnable(GL_TEXTURE_2D);	
+
+	recordPoints(&p, 1);
 }
 
 void RenderContext::drawPoints2d(const Vector2* points, uint numPoints)
 {
-	// Default GL states: GL_TEXTURE_2D, GL_VERTEX_ARRAY, GL_COLOR_ARRAY, GL_TEXTURE_COORD_ARRAY
-	// Needed states: GL_VERTEX_ARRAY, 
-	// Unneeded states: GL_TEXTURE_2D, GL_TEXTURE_COORD_ARRAY, GL_COLOR_ARRAY	
-	glDisable(GL_TEXTURE_2D);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
-
-	glVertexPointer(2, GL_FLOAT, 0, points);
-	glDrawArrays(GL_POINTS, 0, (GLsizei)numPoints);
-
-	// restore default state
-	glEnableClientState(GL_COLOR_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-	glEnable(GL_TEXTURE_2D);	
+	recordPoints(points, numPoints);
 }
 
 void RenderContext::drawLine2d(const Vector2& from, const Vector2& to)
@@ -222,46 +307,15 @@ void RenderContext::drawLine2d(const Vector2& from, const Vector2& to)
 		from, to
 	};
 
-	// Default GL states: GL_TEXTURE_2D, GL_VERTEX_ARRAY, GL_COLOR_ARRAY, GL_TEXTURE_COORD_ARRAY
-	// Needed states: GL_VERTEX_ARRAY, 
-	// Unneeded states: GL_TEXTURE_2D, GL_TEXTURE_COORD_ARRAY, GL_COLOR_ARRAY	
-	glDisable(GL_TEXTURE_2D);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
-
-	glVertexPointer(2, GL_FLOAT, 0, vertices);	
-	glDrawArrays(GL_LINES, 0, 2);
-
-	// restore default state
-	glEnableClientState(GL_COLOR_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-	glEnable(GL_TEXTURE_2D);	
+	recordLines(vertices, 2, false);
 }
 
 void RenderContext::drawPoly2d(const Vector2* points, uint numPoints, bool filled/*=true*/, bool closed/*=true*/)
 {
-	// Default GL states: GL_TEXTURE_2D, GL_VERTEX_ARRAY, GL_COLOR_ARRAY, GL_TEXTURE_COORD_ARRAY
-	// Needed states: GL_VERTEX_ARRAY, 
-	// Unneeded states: GL_TEXTURE_2D, GL_TEXTURE_COORD_ARRAY, GL_COLOR_ARRAY	
-	glDisable(GL_TEXTURE_2D);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
-
-	// convert to pixels ?
-
-	GLenum mode;
-	if (closed)
-		mode = filled ? GL_TRIANGLE_FAN : GL_LINE_LOOP;
+	if (filled)
+		recordFan(points, numPoints);
 	else
-		mode = filled ? GL_TRIANGLE_FAN : GL_LINE_STRIP;
-
-	glVertexPointer(2, GL_FLOAT, 0, points);
-	glDrawArrays(mode, 0, numPoints);
-
-	// restore default state
-	glEnableClientState(GL_COLOR_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-	glEnable(GL_TEXTURE_2D);
+		recordLines(points, numPoints, closed);
 }
 
 void RenderContext::drawCircle2d(const Vector2& center, float r, float a, int numSegments/*=14*/, bool drawLineToCenter/*=true*/)
@@ -274,34 +328,17 @@ void RenderContext::drawCircle2d(const Vector2& center, float r, float a, int nu
 
 	const float coef = 2.0f * (float) (M_PI) / numSegments;
 
-	vector<float>::type vertices(2 * (numSegments + 2));
+	vector<Vector2>::type vertices(numSegments + 2);
 
 	for(int i=0; i<=numSegments ;i++)
 	{
 		float rads = i*coef;
-		float j = r * cosf(rads + a) + center.x;
-		float k = r * sinf(rads + a) + center.y;
-
-		vertices[i*2] = j;
-		vertices[i*2+1] = k;
+		vertices[i].x = r * cosf(rads + a) + center.x;
+		vertices[i].y = r * sinf(rads + a) + center.y;
 	}
-	vertices[(numSegments+1)*2] = center.x;
-	vertices[(numSegments+1)*2+1] = center.y;
-
-	// Default GL states: GL_TEXTURE_2D, GL_VERTEX_ARRAY, GL_COLOR_ARRAY, GL_TEXTURE_COORD_ARRAY
-	// Needed states: GL_VERTEX_ARRAY, 
-	// Unneeded states: GL_TEXTURE_2D, GL_TEXTURE_COORD_ARRAY, GL_COLOR_ARRAY	
-	glDisable(GL_TEXTURE_2D);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
-
-	glVertexPointer(2, GL_FLOAT, 0, &vertices[0]);	
-	glDrawArrays(GL_LINE_STRIP, 0, (GLsizei) numSegments+additionalSegment);
-
-	// restore default state
-	glEnableClientState(GL_COLOR_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-	glEnable(GL_TEXTURE_2D);	
+	vertices[numSegments+1] = center;
+
+	recordLines(&vertices[0], numSegments + additionalSegment, false);
 }
 
 void RenderContext::drawQuadBezier2d(const Vector2& from, const Vector2& control, const Vector2& to, int numSegments/*=15*/)
@@ -320,20 +357,7 @@ void RenderContext::drawQuadBezier2d(const Vector2& from, const Vector2& control
 	vertices[numSegments].x = to.x;
 	vertices[numSegments].y = to.y;
 
-	// Default GL states: GL_TEXTURE_2D, GL_VERTEX_ARRAY, GL_COLOR_ARRAY, GL_TEXTURE_COORD_ARRAY
-	// Needed states: GL_VERTEX_ARRAY, 
-	// Unneeded states: GL_TEXTURE_2D, GL_TEXTURE_COORD_ARRAY, GL_COLOR_ARRAY	
-	glDisable(GL_TEXTURE_2D);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
-
-	glVertexPointer(2, GL_FLOAT, 0, &vertices[0]);	
-	glDrawArrays(GL_LINE_STRIP, 0, (GLsizei) numSegments + 1);
-
-	// restore default state
-	glEnableClientState(GL_COLOR_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-	glEnable(GL_TEXTURE_2D);	
+	recordLines(&vertices[0], numSegments + 1, false);
 }
 
 void RenderContext::drawCubicBezier2d(const Vector2& from, const Vector2& control1, const Vector2& control2, const Vector2& to, int numSegments/*=15*/)
@@ -352,35 +376,25 @@ void RenderContext::drawCubicBezier2d(const Vector2& from, const Vector2& contro
 	vertices[numSegments].x = to.x;
 	vertices[numSegments].y = to.y;
 
-	// Default GL states: GL_TEXTURE_2D, GL_VERTEX_ARRAY, GL_COLOR_ARRAY, GL_TEXTURE_COORD_ARRAY
-	// Needed states: GL_VERTEX_ARRAY, 
-	// Unneeded states: GL_TEXTURE_2D, GL_TEXTURE_COORD_ARRAY, GL_COLOR_ARRAY	
-	glDisable(GL_TEXTURE_2D);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-	glDisableClientState(GL_COLOR_ARRAY);
-
-	glVertexPointer(2, GL_FLOAT, 0, &vertices[0]);	
-	glDrawArrays(GL_LINE_STRIP, 0, (GLsizei) numSegments + 1);
-
-	// restore default state
-	glEnableClientState(GL_COLOR_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-	glEnable(GL_TEXTURE_2D);	
+	recordLines(&vertices[0], numSegments + 1, false);
 }
 
 void RenderContext::viewport(int left, int top, int width, int height)
 {
-	glViewport(left, top, width, height);
+	// Recorded primitives belong to the previous viewport
+	flush();
+
+	_device->setViewport(left, top, width, height);
 }
 
 void RenderContext::viewport(RenderView* view)
 {
 	float scale = view->getScale();
-	glViewport(
-		GLsizei(view->getLeft() * scale), 
-		GLsizei(view->getTop() * scale), 
-		GLsizei(view->getWidth() * scale), 
-		GLsizei(view->getHeight() * scale) );
+	viewport(
+		int(view->getLeft() * scale), 
+		int(view->getTop() * scale), 
+		int(view->getWidth() * scale), 
+		int(view->getHeight() * scale) );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -25,6 +25,7 @@
 #include "nitrender/nitrender.h"
 
 #include "nitrender/RenderSpec.h"
+#include "nitrender/RenderCommand.h"
 
 NS_NIT_BEGIN;
 
@@ -36,11 +37,30 @@ NS_NIT_BEGIN;
 class RenderView;
 class RenderDevice;
 class RenderService;
+class RenderContext;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// RenderQueue defers draws of a client (ex: cocos sprites) to merge them.
+// RenderContext flushes the queue before it changes its state or submits its own primitives,
+// so the queue sees the same state it was pushed under.
+
+class NITRENDER_API RenderQueue
+{
+public:
+	virtual ~RenderQueue()												{ }
+
+public:
+	virtual void						flush(RenderContext* ctx) = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////
 
 class NITRENDER_API RenderContext : public WeakSupported
 {
 public:
 	RenderContext(RenderView* view);
+	RenderContext(RenderDevice* device);		// without a view (ex: NullRenderDevice)
 	virtual ~RenderContext();
 
 public:
@@ -59,6 +79,26 @@ public:
 	void								setAlphaBlending(bool flag);
 	void								setDepthTest(bool flag);
 
+	// Clients (ex: cocos nodes) may still toggle gl states directly, so the device state is captured
+	// again whenever the context applies, records or submits instead of trusting a copy.
+	uint32								getState();
+	void								setState(uint32 state);					// for clients which toggle RenderState flags by themselves
+
+public:
+	// draw*2d() don't draw immediately but record into a command buffer, capturing the current
+	// transform and color of the device. Consecutive primitives are merged into a single draw call
+	// and states are changed only when needed.
+	// Recorded primitives are submitted by flush(), which happens on viewport change and when the context ends.
+	// Call flush() explicitly before binding another frame buffer.
+	// flush() also flushes the render queue first, if any.
+	void								flush();
+	uint								getPendingCount()						{ return _commands.getRecordCount(); }
+	uint								getPendingBatchCount()					{ return _commands.getBatches().size(); }
+
+	RenderQueue*						getRenderQueue()						{ return _renderQueue; }
+	void								setRenderQueue(RenderQueue* queue);
+	void								flushRenderQueue()						{ if (_renderQueue) _renderQueue->flush(this); }
+
 public:
 	void								drawPoint2d(const Vector2& point);
 	void								drawPoints2d(const Vector2* points, uint numPoints);
@@ -76,6 +116,16 @@ protected:
 	RenderDevice*						_device;
 	RenderService*						_service;
 	int									_beginCount;
+
+	uint32								_state;
+	RenderCommandBuffer					_commands;
+	RenderQueue*						_renderQueue;
+
+	void								recordPoints(const Vector2* points, uint numPoints);
+	void								recordLines(const Vector2* points, uint numPoints, bool closed);
+	void								recordFan(const Vector2* points, uint numPoints);
+
+	uint32								getRecordState()						{ return RenderState::COLOR_ARRAY | (getState() & (RenderState::ALPHA_BLENDING | RenderState::DEPTH_TEST)); }
 };
 
 ////////////////////////////////////////////////////////////////////////////////
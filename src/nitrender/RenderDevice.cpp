@@ -36,6 +36,8 @@ RenderDevice::RenderDevice()
 {
 	_valid			= false;
 	_renderSpec	= NULL;
+
+	memset(&_stats, 0, sizeof(_stats));
 }
 
 RenderDevice::~RenderDevice()
@@ -96,6 +98,98 @@ void RenderDevice::swapBuffers()
 	onSwapBuffers();
 }
 
+void RenderDevice::setViewport(int left, int top, int width, int height)
+{
+	if (!_valid) return;
+
+	onSetViewport(left, top, width, height);
+}
+
+void RenderDevice::multMatrix(const float m[16])
+{
+	if (!_valid) return;
+
+	onMultMatrix(m);
+}
+
+uint32 RenderDevice::captureState()
+{
+	if (!_valid) return RenderState::DEFAULT_2D;
+
+	return onCaptureState();
+}
+
+void RenderDevice::captureTransform(float outClip[16])
+{
+	if (!_valid)
+	{
+		for (int i=0; i<16; ++i)
+			outClip[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+		return;
+	}
+
+	onCaptureTransform(outClip);
+}
+
+uint32 RenderDevice::captureColor()
+{
+	if (!_valid) return 0xFFFFFFFF;
+
+	return onCaptureColor();
+}
+
+void RenderDevice::execute(RenderCommandBuffer& commands, uint32 currentState)
+{
+	if (!_valid || commands.isEmpty()) return;
+
+	const RenderCommandBuffer::Batches& batches = commands.getBatches();
+	const RenderCommandBuffer::Vertices& vertices = commands.getVertices();
+
+	onBeginBatches();
+
+	uint32 state = currentState;
+
+	for (uint i=0; i<batches.size(); ++i)
+	{
+		const RenderCommandBuffer::Batch& batch = batches[i];
+
+		if (batch.state != state)
+			applyState(batch.state, batch.state ^ state);
+
+		state = batch.state;
+
+		onDrawBatch(batch.type, &vertices[batch.first], batch.count);
+
+		++_stats.drawCalls;
+		_stats.vertices += batch.count;
+	}
+
+	if (state != currentState)
+		applyState(currentState, state ^ currentState);
+
+	onEndBatches();
+
+	++_stats.flushes;
+	_stats.primitives += commands.getRecordCount();
+}
+
+void RenderDevice::applyState(uint32 state, uint32 changed)
+{
+	if (!_valid) return;
+
+	changed &= RenderState::ALL;
+	if (changed == 0) return;
+
+	onApplyState(state, changed);
+
+	_stats.stateChanges += RenderState::countChanges(changed);
+}
+
+void RenderDevice::resetStats()
+{
+	memset(&_stats, 0, sizeof(_stats));
+}
+
 void RenderDevice::clearCaches()
 {
 	if (!_valid) return;
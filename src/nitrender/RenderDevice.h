@@ -25,6 +25,7 @@
 #include "nitrender/nitrender.h"
 
 #include "nitrender/RenderHandle.h"
+#include "nitrender/RenderCommand.h"
 
 NS_NIT_BEGIN;
 
@@ -53,6 +54,22 @@ public:
 
 	void								swapBuffers();
 
+public:									// Fixed-function access for RenderContext
+	void								setViewport(int left, int top, int width, int height);
+	void								multMatrix(const float m[16]);
+
+	uint32								captureState();
+	void								captureTransform(float outClip[16]);	// projection * modelview, column major
+	uint32								captureColor();							// RGBA in memory order
+
+	// Submits recorded batches. 'currentState' is the state the caller knows the device is in now,
+	// which is also restored after the batches. Only flags that differ from the previous batch get applied.
+	void								execute(RenderCommandBuffer& commands, uint32 currentState);
+	void								applyState(uint32 state, uint32 changed);
+
+	const RenderStats&					getStats()								{ return _stats; }
+	void								resetStats();
+
 public:
 	void								clearCaches();
 	void								invalidateHandles();
@@ -86,6 +103,18 @@ protected:
 
 	virtual void						onSwapBuffers() = 0;
 
+	virtual void						onSetViewport(int left, int top, int width, int height) = 0;
+	virtual void						onMultMatrix(const float m[16]) = 0;
+
+	virtual uint32						onCaptureState() = 0;
+	virtual void						onCaptureTransform(float outClip[16]) = 0;
+	virtual uint32						onCaptureColor() = 0;
+
+	virtual void						onBeginBatches() = 0;
+	virtual void						onApplyState(uint32 state, uint32 changed) = 0;
+	virtual void						onDrawBatch(RenderCommandBuffer::PrimitiveType type, const RenderVertex* vertices, uint count) = 0;
+	virtual void						onEndBatches() = 0;
+
 	virtual void						onClearCache() = 0;
 	virtual void						onInvalidateHandles() = 0;
 	virtual void						onInvalidate() = 0;
@@ -95,6 +124,7 @@ protected:
 protected:
 	RenderSpec*							_renderSpec;
 	CacheLookup							_caches;
+	RenderStats							_stats;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -95,6 +95,7 @@ void RenderService::endContext(RenderContext* ctx)
 	--ctx->_beginCount;
 	if (ctx->_beginCount == 0)
 	{
+		ctx->flush();
 		ctx->getDevice()->endContext(ctx);
 		if (ctx == _currentContext)
 			_currentContext = NULL;
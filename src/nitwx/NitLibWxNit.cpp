@@ -119,6 +119,7 @@ void wxNitPackDataModel::GetValue(wxVariant& variant, const wxDataViewItem& item
 		case PackArchive::PAYLOAD_VOID:	variant = "void"; return;
 		case PackArchive::PAYLOAD_ZLIB:	variant = "zlib"; return;
 		case PackArchive::PAYLOAD_ZLIB_FAST: variant = "zlib_fast"; return;
+		case PackArchive::PAYLOAD_ZLIB_CHUNKED: variant = "zlib_chunked"; return;
 		default:						variant = "???"; return;
 		}
 